@@ -144,12 +144,11 @@ bool calendar_db_open( void ) {
         CALENDAR_DB_ERROR_LOG("can't open calendar database: %s", sqlite3_errmsg( calendar_db ) );
         calendar_db = NULL;
         /**
-         * shutdown sqlite3
+         * close the database, sqlite3 stays up for other connections
          */
         sqlite3_db_cacheflush( calendar_db );
         sqlite3_close( calendar_db );
         sqlite3_db_release_memory( calendar_db );
-        sqlite3_shutdown();
     }
     else {
         CALENDAR_DB_DEBUG_LOG("calendar database open");
@@ -161,12 +160,11 @@ bool calendar_db_open( void ) {
 void calendar_db_close( void ) {
     if ( calendar_db ) {
         /**
-         * shutdown sqlite3
+         * close the database, sqlite3 stays up for other connections
          */
         sqlite3_db_cacheflush( calendar_db );
         sqlite3_close( calendar_db );
         sqlite3_db_release_memory( calendar_db );
-        sqlite3_shutdown();
         CALENDAR_DB_DEBUG_LOG("calendar database closed");
     }
     calendar_db = NULL;
@@ -33,6 +33,7 @@
 #include "gui/widget_styles.h"
 
 #include "hardware/gpsctl.h"
+#include "hardware/gpsfuse.h"
 #include "hardware/display.h"
 #include "gui/mainbar/mainbar.h"
 
@@ -222,10 +223,9 @@ void gps_status_main_setup(uint32_t tile_num) {
      */
     gpsctl_register_cb(     GPSCTL_FIX 
                           | GPSCTL_NOFIX
-                          | GPSCTL_UPDATE_LOCATION
+                          | GPSCTL_UPDATE_FUSED
                           | GPSCTL_UPDATE_SATELLITE
                           | GPSCTL_UPDATE_SATELLITE_TYPE
-                          | GPSCTL_UPDATE_SPEED
                           | GPSCTL_UPDATE_ALTITUDE
                           | GPSCTL_UPDATE_SOURCE
                           , gpsctl_gps_status_event_cb
@@ -262,6 +262,7 @@ static void enter_gps_status_setup_event_cb(lv_obj_t *obj, lv_event_t event) {
 bool gpsctl_gps_status_event_cb( EventBits_t event, void *arg ) {
     char temp[30] = "";
     gps_data_t *gps_data = (gps_data_t*)arg;
+    gpsfuse_t *fused = NULL;
 
     switch( event ) {
         case GPSCTL_FIX:
@@ -277,12 +278,15 @@ bool gpsctl_gps_status_event_cb( EventBits_t event, void *arg ) {
             lv_label_set_text( speed_value, "n/a" );
             lv_label_set_text( source_value, "n/a" );
             break;
-        case GPSCTL_UPDATE_LOCATION:
-            if( gps_data->valid_location )
-                snprintf( temp, sizeof( temp ), "%.4f/%.4f", gps_data->lat, gps_data->lon );
-            else
-                snprintf( temp, sizeof( temp ), "n/a" );
+        case GPSCTL_UPDATE_FUSED:
+            /**
+             * smoothed location and speed, only on a visible change
+             */
+            fused = (gpsfuse_t*)arg;
+            snprintf( temp, sizeof( temp ), "%.4f/%.4f", fused->lat, fused->lon );
             lv_label_set_text( pos_longlat_value, temp );
+            snprintf( temp, sizeof( temp ), "%.2fkm/h", fused->speed_mps * 3.6 );
+            lv_label_set_text( speed_value, temp );
             break;
         case GPSCTL_UPDATE_SATELLITE:
             if ( gps_data->valid_satellite )
@@ -297,13 +301,6 @@ bool gpsctl_gps_status_event_cb( EventBits_t event, void *arg ) {
                                                                    gps_data->satellite_types.baidou_satellites );
             lv_label_set_text( satellite_type, temp );
             break;
-        case GPSCTL_UPDATE_SPEED:
-            if ( gps_data->valid_speed )
-                snprintf( temp, sizeof( temp ), "%.2fkm/h", gps_data->speed_kmh );
-            else
-                snprintf( temp, sizeof( temp ), "n/a" );
-            lv_label_set_text( speed_value, temp );
-            break;
         case GPSCTL_UPDATE_ALTITUDE:
             if ( gps_data->valid_altitude )
                 snprintf( temp, sizeof( temp ), "%.1fm", gps_data->altitude_meters );
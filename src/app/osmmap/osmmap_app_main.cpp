@@ -35,13 +35,19 @@
 
 #include "hardware/display.h"
 #include "hardware/gpsctl.h"
+#include "hardware/gpsfuse.h"
 #include "hardware/blectl.h"
 #include "hardware/wifictl.h"
 #include "hardware/touch.h"
 #include "hardware/powermgm.h"
 
 #include "utils/osm_map/osm_map.h"
+#include "utils/osm_map/osm_map_view.h"
+#include "utils/osm_map/osm_map_prefetch.h"
+#include "utils/osm_map/osm_map_overlay.h"
+#include "utils/gpstrack/gpstrack.h"
 #include "utils/json_psram_allocator.h"
+#include "utils/rendergov/rendergov.h"
 
 #ifdef NATIVE_64BIT
     #include <iostream>
@@ -77,7 +83,10 @@
 lv_task_t *osmmap_main_tile_task;                               /** @brief osm active/inactive task for show/hide user interface */
 
 lv_obj_t *osmmap_app_main_tile = NULL;                          /** @brief osm main tile obj */
-lv_obj_t *osmmap_app_tile_img = NULL;                           /** @brief osm tile image obj */
+osm_map_view_t *osmmap_app_view = NULL;                         /** @brief osm tile grid view */
+osm_map_overlay_t *osmmap_app_route = NULL;                     /** @brief loaded route on top of the tiles */
+osm_map_overlay_t *osmmap_app_track = NULL;                     /** @brief travelled path of the recording track on top of the route */
+static char osmmap_app_track_name[ GPSTRACK_NAME_LEN ] = "";    /** @brief track name in the track overlay */
 lv_obj_t *osmmap_app_pos_img = NULL;                            /** @brief osm position point obj */
 lv_obj_t *osmmap_lonlat_label = NULL;                           /** @brief osm exit icon/button obj */
 lv_obj_t *osmmap_north_btn = NULL;                              /** @brief osm exit icon/button obj */
@@ -145,7 +154,10 @@ bool osmmap_gpsctl_event_cb( EventBits_t event, void *arg );
 void osmmap_add_tile_server_list( lv_obj_t *layers_list );
 void osmmap_activate_cb( void );
 void osmmap_hibernate_cb( void );
+void osmmap_load_overlays( void );
+static bool osmmap_add_overlay_fix( const gpstrack_fix_t *fix, void *arg );
 bool osmmap_button_cb( EventBits_t event, void *arg );
+bool osmmap_rendergov_event_cb( EventBits_t event, void *arg );
 
 void osmmap_app_main_setup( uint32_t tile_num ) {
     /**
@@ -183,14 +195,14 @@ void osmmap_app_main_setup( uint32_t tile_num ) {
     lv_obj_add_style( osmmap_cont, LV_OBJ_PART_MAIN, &osmmap_app_main_style );
     lv_obj_align( osmmap_cont, osmmap_app_main_tile, LV_ALIGN_IN_TOP_MID, 0, 0 );
 
-    osmmap_app_tile_img = lv_img_create( osmmap_cont, NULL );
-    lv_obj_set_width( osmmap_app_tile_img, lv_disp_get_hor_res( NULL )>512?lv_disp_get_hor_res( NULL ):240 );
-    lv_obj_set_height( osmmap_app_tile_img, lv_disp_get_hor_res( NULL )>512?lv_disp_get_hor_res( NULL ):240 );
-    lv_img_set_src( osmmap_app_tile_img, osm_map_get_no_data_image() );
 #ifdef M5PAPER
-    lv_img_set_zoom( osmmap_app_tile_img, 540 );
+    osmmap_app_view = osm_map_view_create( osmmap_cont, lv_obj_get_width( osmmap_cont ), lv_obj_get_height( osmmap_cont ), 540 );
+#else
+    osmmap_app_view = osm_map_view_create( osmmap_cont, lv_obj_get_width( osmmap_cont ), lv_obj_get_height( osmmap_cont ), LV_IMG_ZOOM_NONE );
 #endif
-    lv_obj_align( osmmap_app_tile_img, osmmap_cont, LV_ALIGN_CENTER, 0, 0 );
+    osm_map_view_set_loaded_cb( osmmap_app_view, osmmap_update_request );
+    osmmap_app_route = osm_map_overlay_create( osmmap_app_view, LV_COLOR_MAKE( 0x20, 0x60, 0xff ), 4 );
+    osmmap_app_track = osm_map_overlay_create( osmmap_app_view, LV_COLOR_MAKE( 0xe0, 0x20, 0x20 ), 3 );
 
     osmmap_app_pos_img = lv_img_create( osmmap_cont, NULL );
     lv_img_set_src( osmmap_app_pos_img, &info_fail_16px );
@@ -282,8 +294,9 @@ void osmmap_app_main_setup( uint32_t tile_num ) {
     mainbar_add_tile_activate_cb( tile_num, osmmap_activate_cb );
     mainbar_add_tile_hibernate_cb( tile_num, osmmap_hibernate_cb );
     mainbar_add_tile_button_cb( tile_num, osmmap_button_cb );
-    gpsctl_register_cb( GPSCTL_SET_APP_LOCATION | GPSCTL_UPDATE_LOCATION, osmmap_gpsctl_event_cb, "osm" );
+    gpsctl_register_cb( GPSCTL_SET_APP_LOCATION | GPSCTL_UPDATE_LOCATION | GPSCTL_UPDATE_FUSED, osmmap_gpsctl_event_cb, "osm" );
     touch_register_cb( TOUCH_UPDATE , osmmap_app_touch_event_cb, "osm touch" );
+    rendergov_register_cb( RENDERGOV_QUALITY, osmmap_rendergov_event_cb, "osm rendergov" );
 #ifdef NATIVE_64BIT
     eventmask = 0;
 #else
@@ -292,6 +305,18 @@ void osmmap_app_main_setup( uint32_t tile_num ) {
     osmmap_main_tile_task = lv_task_create( osmmap_main_tile_update_task, 250, LV_TASK_PRIO_MID, NULL );
 }
 
+bool osmmap_rendergov_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case RENDERGOV_QUALITY:
+            /**
+             * zoomed map tiles without antialias while panning
+             */
+            osm_map_view_set_antialias( osmmap_app_view, !rendergov_is_reduced() );
+            break;
+    }
+    return( true );
+}
+
 bool osmmap_app_touch_event_cb( EventBits_t event, void *arg ) {
     switch( event ) {
         case( TOUCH_UPDATE ):
@@ -453,6 +478,7 @@ void osmmap_main_tile_update_task( lv_task_t * task ) {
 
 bool osmmap_gpsctl_event_cb( EventBits_t event, void *arg ) {
     gps_data_t *gps_data = NULL;
+    gpsfuse_t *fused = NULL;
     char lonlat[64] = "";
     
     switch ( event ) {
@@ -463,6 +489,7 @@ bool osmmap_gpsctl_event_cb( EventBits_t event, void *arg ) {
             OSMMAP_APP_LOG("get new gps coor.");
             gps_data = ( gps_data_t *)arg;
             osm_map_set_lon_lat( osmmap_location, gps_data->lon, gps_data->lat );
+            osm_map_prefetch_set_motion( gps_data->lon, gps_data->lat, gps_data->valid_course ? gps_data->course : -1, gps_data->valid_speed ? gps_data->speed_mps : -1, 0 );
             snprintf( lonlat, sizeof( lonlat ), "%f° / %f°", gps_data->lat, gps_data->lon );
             lv_label_set_text( osmmap_lonlat_label, (const char*)lonlat );
             if ( osmmap_app_active )
@@ -470,12 +497,27 @@ bool osmmap_gpsctl_event_cb( EventBits_t event, void *arg ) {
             break;
         case GPSCTL_UPDATE_LOCATION:
             /**
-             * update location and tile map image on new location
+             * extend the travelled path with the raw fix like the recorder,
+             * a new track starts a new path
              */
-            OSMMAP_APP_LOG("get new gps coor.");
             gps_data = ( gps_data_t *)arg;
-            osm_map_set_lon_lat( osmmap_location, gps_data->lon, gps_data->lat );
-            snprintf( lonlat, sizeof( lonlat ), "%f° / %f°", gps_data->lat, gps_data->lon );
+            if ( osmmap_app_active && gpstrack_is_recording() ) {
+                if ( strcmp( osmmap_app_track_name, gpstrack_get_name() ) ) {
+                    osm_map_overlay_clear( osmmap_app_track );
+                    strncpy( osmmap_app_track_name, gpstrack_get_name(), sizeof( osmmap_app_track_name ) - 1 );
+                }
+                osm_map_overlay_add_point( osmmap_app_track, gps_data->lon, gps_data->lat );
+            }
+            break;
+        case GPSCTL_UPDATE_FUSED:
+            /**
+             * update location and tile map image on a smoothed location change
+             */
+            OSMMAP_APP_LOG("get new fused gps coor.");
+            fused = ( gpsfuse_t *)arg;
+            osm_map_set_lon_lat( osmmap_location, fused->lon, fused->lat );
+            osm_map_prefetch_set_motion( fused->lon, fused->lat, fused->valid_course ? fused->course : -1, fused->speed_mps, 0 );
+            snprintf( lonlat, sizeof( lonlat ), "%f° / %f°", fused->lat, fused->lon );
             lv_label_set_text( osmmap_lonlat_label, (const char*)lonlat );
             if ( osmmap_app_active )
                 osmmap_update_request();
@@ -487,15 +529,11 @@ bool osmmap_gpsctl_event_cb( EventBits_t event, void *arg ) {
 
 void osmmap_update_request( void ) {
     /**
-     * check if another osm tile image update is running
+     * check if another osm tile image update is running, the view also
+     * requests from a download worker when a tile is done
      */
 #ifdef NATIVE_64BIT
-    if ( eventmask & OSM_APP_UPDATE_REQUEST ) {
-        return;
-    }
-    else {
-        eventmask |= OSM_APP_UPDATE_REQUEST;
-    }
+    __atomic_fetch_or( &eventmask, OSM_APP_UPDATE_REQUEST, __ATOMIC_SEQ_CST );
 #else
     if ( xEventGroupGetBits( osmmap_event_handle ) & OSM_APP_UPDATE_REQUEST ) {
         return;
@@ -560,31 +598,37 @@ void osmmap_update_Task( void * pvParameters ) {
      * check if a tile image update is requested
      */
     if ( eventmask & OSM_APP_UPDATE_REQUEST ) {
+        /**
+         * clear update request flag first, a tile download done meanwhile
+         * requests the next update
+         */
+        __atomic_fetch_and( &eventmask, ~OSM_APP_UPDATE_REQUEST, __ATOMIC_SEQ_CST );
         /**
          * check if a tile image update is required and update them
          */
         OSMMAP_APP_LOG("start osm map update");
-        if( osm_map_update( osmmap_location ) ) {
-            if ( osm_map_get_tile_image( osmmap_location ) ) {
-                lv_img_set_src( osmmap_app_tile_img, osm_map_get_tile_image( osmmap_location ) );
-            }
-            lv_obj_align( osmmap_app_tile_img, lv_obj_get_parent( osmmap_app_tile_img ), LV_ALIGN_CENTER, 0 , 0 );
-            eventmask |= OSM_APP_LOAD_AHEAD_REQUEST;
-        }
+        osm_map_update( osmmap_location );
+        /**
+         * move the tile grid, only tiles that come into the grid are loaded,
+         * the prefetch replans on every motion update
+         */
+        osm_map_view_update( osmmap_app_view, osmmap_location );
+        osm_map_overlay_update( osmmap_app_route );
+        osm_map_overlay_update( osmmap_app_track );
+        eventmask |= OSM_APP_LOAD_AHEAD_REQUEST;
+        osm_map_view_bench( osmmap_app_view, osmmap_location );
+        osm_map_overlay_bench();
         /**
-         * update postion point on the tile image when is valid
+         * update postion point on the view when is valid
          */
-        if ( osmmap_location->tilexy_pos_valid ) {
-            lv_obj_align( osmmap_app_pos_img, lv_obj_get_parent( osmmap_app_pos_img ), LV_ALIGN_IN_TOP_LEFT, osmmap_location->tilex_pos - 8 , osmmap_location->tiley_pos - 8 );
+        lv_coord_t pos_x = 0, pos_y = 0;
+        if ( osm_map_view_get_pos( osmmap_app_view, osmmap_location, &pos_x, &pos_y ) ) {
+            lv_obj_align( osmmap_app_pos_img, lv_obj_get_parent( osmmap_app_pos_img ), LV_ALIGN_IN_TOP_LEFT, pos_x - 8 , pos_y - 8 );
             lv_obj_set_hidden( osmmap_app_pos_img, false );
         }
         else {
             lv_obj_set_hidden( osmmap_app_pos_img, true );
         }
-        /**
-         * clear update request flag
-         */
-        eventmask &= ~OSM_APP_UPDATE_REQUEST;
     }
 #else
     OSMMAP_APP_INFO_LOG("start osm map tile background update task, heap: %d", ESP.getFreeHeap() );
@@ -593,31 +637,35 @@ void osmmap_update_Task( void * pvParameters ) {
          * check if a tile image update is requested
          */
         if ( xEventGroupGetBits( osmmap_event_handle ) & OSM_APP_UPDATE_REQUEST ) {
+            /**
+             * clear update request flag first, a tile download done meanwhile
+             * requests the next update
+             */
+            xEventGroupClearBits( osmmap_event_handle, OSM_APP_UPDATE_REQUEST );
             /**
              * check if a tile image update is required and update them
              */
             OSMMAP_APP_LOG("start osm map update");
-            if( osm_map_update( osmmap_location ) ) {
-                if ( osm_map_get_tile_image( osmmap_location ) ) {
-                    lv_img_set_src( osmmap_app_tile_img, osm_map_get_tile_image( osmmap_location ) );
-                }
-                lv_obj_align( osmmap_app_tile_img, lv_obj_get_parent( osmmap_app_tile_img ), LV_ALIGN_CENTER, 0 , 0 );
-                xEventGroupSetBits( osmmap_event_handle, OSM_APP_LOAD_AHEAD_REQUEST );
-            }
+            osm_map_update( osmmap_location );
             /**
-             * update postion point on the tile image when is valid
+             * move the tile grid, only tiles that come into the grid are loaded,
+             * the prefetch replans on every motion update
              */
-            if ( osmmap_location->tilexy_pos_valid ) {
-                lv_obj_align( osmmap_app_pos_img, lv_obj_get_parent( osmmap_app_pos_img ), LV_ALIGN_IN_TOP_LEFT, osmmap_location->tilex_pos - 8 , osmmap_location->tiley_pos - 8 );
+            osm_map_view_update( osmmap_app_view, osmmap_location );
+            osm_map_overlay_update( osmmap_app_route );
+            osm_map_overlay_update( osmmap_app_track );
+            xEventGroupSetBits( osmmap_event_handle, OSM_APP_LOAD_AHEAD_REQUEST );
+            /**
+             * update postion point on the view when is valid
+             */
+            lv_coord_t pos_x = 0, pos_y = 0;
+            if ( osm_map_view_get_pos( osmmap_app_view, osmmap_location, &pos_x, &pos_y ) ) {
+                lv_obj_align( osmmap_app_pos_img, lv_obj_get_parent( osmmap_app_pos_img ), LV_ALIGN_IN_TOP_LEFT, pos_x - 8 , pos_y - 8 );
                 lv_obj_set_hidden( osmmap_app_pos_img, false );
             }
             else {
                 lv_obj_set_hidden( osmmap_app_pos_img, true );
             }
-            /**
-             * clear update request flag
-             */
-            xEventGroupClearBits( osmmap_event_handle, OSM_APP_UPDATE_REQUEST );
         }
         /**
          * check if for a task exit request
@@ -780,6 +828,7 @@ static void osmmap_tile_server_event_cb( lv_obj_t * obj, lv_event_t event ) {
                 const char *tile_server = doc[ lv_list_get_btn_text( obj ) ];
                 OSMMAP_APP_INFO_LOG("new tile server url: %s", tile_server );
                 osm_map_set_tile_server( osmmap_location, tile_server );
+                osm_map_set_tile_server_name( osmmap_location, lv_list_get_btn_text( obj ) );
                 strncpy( osmmap_config.osmmap, lv_list_get_btn_text( obj ), sizeof( osmmap_config.osmmap ) );
                 osmmap_add_tile_server_list( osmmap_sub_menu_layers );
                 osmmap_update_request();
@@ -811,6 +860,7 @@ void osmmap_add_tile_server_list( lv_obj_t *layers_list ) {
                 const char *osmmap_url = doc[ p.key().c_str() ];
                 OSMMAP_APP_INFO_LOG("set osmmap url: %s, %s", p.key().c_str(), osmmap_url );
                 osm_map_set_tile_server( osmmap_location, osmmap_url );
+                osm_map_set_tile_server_name( osmmap_location, p.key().c_str() );
             }
         }        
     }
@@ -863,6 +913,10 @@ void osmmap_activate_cb( void ) {
      * force redraw screen
      */
     lv_obj_invalidate( lv_scr_act() );
+    /**
+     * load route and the travelled path
+     */
+    osmmap_load_overlays();
     /**
      * set osm app active
      */
@@ -890,7 +944,6 @@ void osmmap_activate_cb( void ) {
                     &_osmmap_load_ahead_Task );  /* Task handle. */
 #endif
     osmmap_update_request();
-    lv_img_cache_invalidate_src( osmmap_app_tile_img );
     powermgm_set_perf_mode();
 }
 
@@ -909,9 +962,12 @@ void osmmap_hibernate_cb( void ) {
     watchface_enable_tile_after_wakeup( osmmap_block_watchface );
 #endif
     /**
-     * clear cache
+     * clear cache and overlays
      */
     osm_map_clear_cache( osmmap_location );
+    osm_map_overlay_clear( osmmap_app_route );
+    osm_map_overlay_clear( osmmap_app_track );
+    osmmap_app_track_name[ 0 ] = '\0';
     /**
      * set osm app inactive
      */
@@ -930,3 +986,24 @@ void osmmap_hibernate_cb( void ) {
      */
     osmmap_config.save();
 }
+
+static bool osmmap_add_overlay_fix( const gpstrack_fix_t *fix, void *arg ) {
+    return( osm_map_overlay_add_point( (osm_map_overlay_t*)arg, fix->lon / 1e7, fix->lat / 1e7 ) );
+}
+
+void osmmap_load_overlays( void ) {
+    /**
+     * the route is a stored track with the name route
+     */
+    osm_map_overlay_clear( osmmap_app_route );
+    gpstrack_read( OSMMAP_APP_ROUTE_NAME, osmmap_add_overlay_fix, osmmap_app_route );
+    /**
+     * the travelled path is the recording track so far
+     */
+    osm_map_overlay_clear( osmmap_app_track );
+    osmmap_app_track_name[ 0 ] = '\0';
+    if ( gpstrack_is_recording() ) {
+        strncpy( osmmap_app_track_name, gpstrack_get_name(), sizeof( osmmap_app_track_name ) - 1 );
+        gpstrack_read( osmmap_app_track_name, osmmap_add_overlay_fix, osmmap_app_track );
+    }
+}
@@ -32,6 +32,8 @@
     #define OSM_APP_LOAD_AHEAD_REQUEST          _BV(1)      /** @brief set tile image update flag */
     #define OSM_APP_TASK_EXIT_REQUEST           _BV(2)      /** @brief set task exit flag */
 
+    #define OSMMAP_APP_ROUTE_NAME               "route"     /** @brief stored track shown as route */
+
     /**
      * @brief osmmap app main setup routine
      * 
@@ -35,6 +35,7 @@
 #include "hardware/powermgm.h"
 #include "hardware/wifictl.h"
 #include "utils/json_psram_allocator.h"
+#include "utils/rendergov/rendergov.h"
 
 #ifdef NATIVE_64BIT
     #include "utils/logging.h"
@@ -640,6 +641,7 @@ void printer3d_send(WiFiClient client, char* buffer, const char* command) {
             JRESULT result;
 
             uint8_t failcount = 0;
+            uint32_t framecount = 0;
             while (true) {
                 if (!printer3d_state || !printer3d_open_state) {
                     log_i("3dprinter closing connection to video stream at %s", mjpeg_url);
@@ -699,9 +701,11 @@ void printer3d_send(WiFiClient client, char* buffer, const char* command) {
                             lv_img_set_offset_y( printer3d_video_img, landscape ? 0 : (maxY - decoder->height) / 2 );
                             lv_obj_align( printer3d_video_img, printer3d_app_video_tile, LV_ALIGN_IN_TOP_LEFT, 0, 0 );
                             lv_obj_set_hidden( printer3d_video_img, false );
-                        } else {
+                        } else if ( !rendergov_is_reduced() || ( framecount & 1 ) ) {
+                            // show only every second frame while the render governor reduce quality
                             lv_obj_invalidate( printer3d_video_img );
                         }
+                        framecount++;
                     } else {
                         log_d("3dprinter could not decode a video frame");
                     }
@@ -34,14 +34,13 @@
 
 #include "hardware/wifictl.h"
 #include "hardware/display.h"
+#include "utils/nmea/nmea.h"
+
+#include <math.h>
 
 #ifdef NATIVE_64BIT
-    #include <string>
     #include "utils/logging.h"
     #include "utils/millis.h"
-
-    using namespace std;
-    #define String string
 #else
     #include <Arduino.h>
     #include <WiFi.h>
@@ -80,9 +79,10 @@ LV_FONT_DECLARE(Ubuntu_32px);
 LV_FONT_DECLARE(Ubuntu_48px);
 LV_FONT_DECLARE(lv_font_montserrat_28);
 
-void rmc(char dati[]);
-void rmb(char dati[]);
-void apb(char dati[]);
+void sailing_nmea( const char *data, size_t len );
+static void sailing_rmc( const nmea_rmc_t *rmc );
+static void sailing_rmb( const nmea_rmb_t *rmb );
+static void sailing_apb( const nmea_apb_t *apb );
 
 bool sailing_style_change_event_cb( EventBits_t event, void *arg );
 bool sailing_wifictl_event_cb( EventBits_t event, void *arg );
@@ -248,22 +248,7 @@ void sailing_app_setup_udp( bool enable ) {
              * register call back function on packet
              */
             udp->onPacket( [] ( AsyncUDPPacket packet ) {
-                char buf[ packet.length() ];
-                /**
-                 * fill buffer with data
-                 */
-                for ( int i = 0 ; i < packet.length() ; i++ ) {
-                    buf[ i ]= (char)*( packet.data() + i );
-                }
-                /**
-                 * check for data
-                 */
-                if( String( buf ).startsWith( "$ECRMB" ) )
-                    rmb( buf );
-                if( String( buf ).startsWith( "$GPRMC" ) )
-                    rmc( buf );
-                if( String( buf ).startsWith( "$ECAPB" ) )
-                    apb( buf );
+                sailing_nmea( (const char*)packet.data(), packet.length() );
             });
         }
         else {
@@ -328,72 +313,54 @@ void sailing_task( lv_task_t * task ) {
     sailing_main_update_label();
 }
 
-//Makes RMC phrase understandable
-void rmc(char dati[]){
-#ifdef NATIVE_64BIT
-
-#else
-    String info[12];
-    int i,j = 0;
-
-    for(i = 0; i<12; i++){
-        info[i] = "";
-        do{
-            info[i].concat(dati[j]);
-            j++;
-        }while(dati[j] != ',');
-        j++;
+void sailing_nmea( const char *data, size_t len ) {
+    nmea_sentence_t sentence;
+    /**
+     * a packet can hold more than one sentence, one per line
+     */
+    while( len ) {
+        size_t line = 0;
+        while( line < len && data[ line ] != '\n' ) {
+            line++;
+        }
+        switch( nmea_parse( data, line, &sentence ) ) {
+            case NMEA_RMC:  sailing_rmc( &sentence.rmc );
+                            break;
+            case NMEA_RMB:  sailing_rmb( &sentence.rmb );
+                            break;
+            case NMEA_APB:  sailing_apb( &sentence.apb );
+                            break;
+            default:        break;
+        }
+        if ( line < len ) {
+            line++;
+        }
+        data += line;
+        len -= line;
     }
+}
 
+//Makes RMC phrase understandable
+static void sailing_rmc( const nmea_rmc_t *rmc ) {
     //passing RMC info to global struct
-    attuale.gspeed = info[7].toFloat();
-    attuale.heading = info[8].toFloat();
-    // Serial.println(attuale.gspeed);
-#endif
+    if ( !isnan( rmc->speed ) )
+        attuale.gspeed = rmc->speed;
+    if ( !isnan( rmc->course ) )
+        attuale.heading = rmc->course;
 }
 
 //Makes RMB phrase understandable
-void rmb(char dati[]){
-#ifdef NATIVE_64BIT
-
-#else
-    String info[14];
-    int i,j = 0;
-
-    for(i = 0; i<14; i++){
-        info[i] = "";
-        do{
-            info[i].concat(dati[j]);
-            j++;
-        }while(dati[j] != ',');
-        j++;
-    }
-
+static void sailing_rmb( const nmea_rmb_t *rmb ) {
     //passing RMB info to global struct
-    attuale.distance = info[10].toFloat();
-    attuale.vmg = info[12].toFloat();
-    //Serial.println("Recieved RMB");
-#endif
+    if ( !isnan( rmb->range ) )
+        attuale.distance = rmb->range;
+    if ( !isnan( rmb->velocity ) )
+        attuale.vmg = rmb->velocity;
 }
 
 //Makes APB phrase understandable
-void apb(char dati[]){
-#ifdef NATIVE_64BIT
-
-#else  
-    String info[14];
-    int i,j = 0;
-
-    for(i = 0; i<14; i++){
-        info[i] = "";
-        do{
-            info[i].concat(dati[j]);
-            j++;
-        }while(dati[j] != ',');
-        j++;
-    }
-
+static void sailing_apb( const nmea_apb_t *apb ) {
     //passing APB info to global struct
-    attuale.track = info[13].toFloat();
-#endif
+    if ( !isnan( apb->heading ) )
+        attuale.track = apb->heading;
 }
@@ -25,7 +25,7 @@
 #include "weather_forecast.h"
 #include "hardware/powermgm.h"
 #include "utils/json_psram_allocator.h"
-#include "utils/uri_load/uri_load.h"
+#include "utils/uri_load/uri_load_stream.h"
 
 /**
  * Utility function to convert numbers to directions
@@ -43,20 +43,20 @@ int weather_fetch_today( weather_config_t *weather_config, weather_forcast_t *we
     snprintf( url, sizeof( url ), "http://%s/data/2.5/weather?lat=%s&lon=%s&appid=%s&units=%s", OWM_HOST, weather_config->lat, weather_config->lon, weather_config->apikey, weather_units_char);
     log_d("http get: %s", url );
     /**
-     * load uri file into ram
+     * open uri stream, the json is pharsed while it arrives
      */
-    uri_load_dsc_t *uri_load_dsc = uri_load_to_ram( url );
+    UriLoadStream stream;
     /**
      * if was success, pharse the json
      */
-    if ( uri_load_dsc ) {
-        SpiRamJsonDocument doc( uri_load_dsc->size * 3 );
+    if ( stream.begin( url ) ) {
+        SpiRamJsonDocument doc( stream.jsonSize( 3 ) );
 
-        DeserializationError error = deserializeJson( doc, uri_load_dsc->data );
+        DeserializationError error = deserializeJson( doc, stream );
+        stream.end();
         if (error) {
             log_e("weather today deserializeJson() failed: %s", error.c_str() );
             doc.clear();
-            uri_load_free_all( uri_load_dsc );
             return( httpcode );
         }
 
@@ -81,10 +81,6 @@ int weather_fetch_today( weather_config_t *weather_config, weather_forcast_t *we
     else {
         httpcode = -1;
     }
-    /**
-     * clear uri dsc
-     */
-    uri_load_free_all( uri_load_dsc );
 
     return( httpcode );
 }
@@ -100,20 +96,20 @@ int weather_fetch_forecast( weather_config_t *weather_config, weather_forcast_t
     snprintf( url, sizeof( url ), "http://%s/data/2.5/forecast?cnt=%d&lat=%s&lon=%s&appid=%s&units=%s", OWM_HOST, WEATHER_MAX_FORECAST, weather_config->lat, weather_config->lon, weather_config->apikey, weather_units_char);
     log_d("http get: %s", url );
     /**
-     * load uri file into ram
+     * open uri stream, the json is pharsed while it arrives
      */
-    uri_load_dsc_t *uri_load_dsc = uri_load_to_ram( url );
+    UriLoadStream stream;
     /**
      * if was success, pharse the json
      */
-    if ( uri_load_dsc ) {
-        SpiRamJsonDocument doc( uri_load_dsc->size * 3 );
+    if ( stream.begin( url ) ) {
+        SpiRamJsonDocument doc( stream.jsonSize( 3 ) );
 
-        DeserializationError error = deserializeJson( doc, uri_load_dsc->data );
+        DeserializationError error = deserializeJson( doc, stream );
+        stream.end();
         if (error) {
             log_e("weather forecast deserializeJson() failed: %s", error.c_str() );
             doc.clear();
-            uri_load_free_all( uri_load_dsc );
             return( httpcode );
         }
 
@@ -141,10 +137,6 @@ int weather_fetch_forecast( weather_config_t *weather_config, weather_forcast_t
     else {
         httpcode = -1;
     }
-    /**
-     * clear uri dsc
-     */
-    uri_load_free_all( uri_load_dsc );
     
     return( httpcode );
 }
@@ -53,6 +53,7 @@
 #include "hardware/display.h"
 #include "hardware/hardware.h"
 #include "utils/filepath_convert.h"
+#include "utils/latency/latency.h"
 
 #ifdef NATIVE_64BIT
     #include <iostream>
@@ -299,6 +300,7 @@ bool gui_powermgm_loop_event_cb( EventBits_t event, void *arg ) {
         }
     #endif
 
+    latency_task_handler();
     lv_task_handler();
 
     if ( force_redraw ) {
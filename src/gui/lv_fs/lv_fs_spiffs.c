@@ -72,6 +72,11 @@ static lv_fs_res_t fs_dir_close (lv_fs_drv_t *drv, void *dir_p);
  */
 void lv_fs_if_spiffs_init(void)
 {
+    /*The splashscreen registers the driver before the gui, register it only once*/
+    static bool registered = false;
+    if (registered) return;
+    registered = true;
+
     /*---------------------------------------------------
      * Register the file system interface  in LittlevGL
      *--------------------------------------------------*/
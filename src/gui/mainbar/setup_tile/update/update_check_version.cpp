@@ -23,7 +23,7 @@
 #include "update_check_version.h"
 #include "utils/json_psram_allocator.h"
 #include "utils/alloc.h"
-#include "utils/uri_load/uri_load.h"
+#include "utils/uri_load/uri_load_stream.h"
 
 #ifdef NATIVE_64BIT
     #include "utils/logging.h"
@@ -40,21 +40,21 @@ int32_t firmwaresize = 0;
 int64_t update_check_new_version( char *url ) {
     int httpcode = -1;
     /**
-     * load uri file into ram
+     * open uri stream, the json is pharsed while it arrives
      */
-    uri_load_dsc_t *uri_load_dsc = uri_load_to_ram( url );
+    UriLoadStream stream;
     log_i("load update information from: %s", url );
     /**
      * if was success, pharse the json
      */
-    if ( uri_load_dsc ) {
-        SpiRamJsonDocument doc( uri_load_dsc->size * 4 );
+    if ( stream.begin( url ) ) {
+        SpiRamJsonDocument doc( stream.jsonSize( 4 ) );
 
-        DeserializationError error = deserializeJson( doc, uri_load_dsc->data );
+        DeserializationError error = deserializeJson( doc, stream );
+        stream.end();
         if (error) {
-            log_e("weather today deserializeJson() failed: %s", error.c_str() );
+            log_e("update deserializeJson() failed: %s", error.c_str() );
             doc.clear();
-            uri_load_free_all( uri_load_dsc );
             return( httpcode );
         }
 
@@ -196,10 +196,6 @@ int64_t update_check_new_version( char *url ) {
     else {
         httpcode = -1;
     }
-    /**
-     * clear uri dsc
-     */
-    uri_load_free_all( uri_load_dsc );
 
     return( firmwareversion );
 }
@@ -46,6 +46,7 @@
 #include "hardware/motion.h"
 #include "hardware/wifictl.h"
 #include "utils/filepath_convert.h"
+#include "utils/rendergov/rendergov.h"
 
 #ifdef NATIVE_64BIT
     #include <iostream>
@@ -75,6 +76,7 @@ volatile bool watchface_tile_block_show_messages = false;
 volatile bool watchface_test = false;
 volatile uint32_t watchface_return_tile = 0;
 volatile bool watchface_enable_after_wakeup = false;
+bool watchface_antialias = true;
 /**
  * watchface theme config
  */
@@ -127,6 +129,8 @@ static void exit_watchface_app_tile_event_cb( lv_obj_t * obj, lv_event_t event )
 void watchface_app_tile_update_task( lv_task_t *task );
 bool watchface_rtcctl_event_cb( EventBits_t event, void *arg );
 bool watchface_powermgm_event_cb( EventBits_t event, void *arg );
+bool watchface_rendergov_event_cb( EventBits_t event, void *arg );
+void watchface_apply_render_quality( void );
 void watchface_avtivate_cb( void );
 void watchface_hibernate_cb( void );
 void watchface_remove_theme_files ( void );
@@ -272,6 +276,7 @@ void watchface_tile_setup( void ) {
      * setup powermgm and touch callback function
      */
     powermgm_register_cb( POWERMGM_STANDBY, watchface_powermgm_event_cb, "watchface powermgm" );
+    rendergov_register_cb( RENDERGOV_QUALITY, watchface_rendergov_event_cb, "watchface rendergov" );
     /**
      * setup watchface background task
      */
@@ -283,12 +288,35 @@ void watchface_tile_setup( void ) {
 }
 
 void watchface_tile_set_antialias( bool enable ) {
-    lv_img_set_antialias( watchface_hour_s_img, enable );
-    lv_img_set_antialias( watchface_min_s_img, enable );
-    lv_img_set_antialias( watchface_sec_s_img, enable );
-    lv_img_set_antialias( watchface_hour_img, enable );
-    lv_img_set_antialias( watchface_min_img, enable );
-    lv_img_set_antialias( watchface_sec_img, enable );
+    watchface_antialias = enable;
+    watchface_apply_render_quality();
+}
+
+void watchface_apply_render_quality( void ) {
+    /**
+     * skip antialias and shadows while the render governor reduce quality
+     */
+    bool antialias = watchface_antialias && !rendergov_is_reduced();
+
+    lv_img_set_antialias( watchface_hour_s_img, antialias );
+    lv_img_set_antialias( watchface_min_s_img, antialias );
+    lv_img_set_antialias( watchface_sec_s_img, antialias );
+    lv_img_set_antialias( watchface_hour_img, antialias );
+    lv_img_set_antialias( watchface_min_img, antialias );
+    lv_img_set_antialias( watchface_sec_img, antialias );
+
+    lv_obj_set_hidden( watchface_hour_s_img, !watchface_theme_config.dial.hour_shadow.enable || rendergov_is_reduced() );
+    lv_obj_set_hidden( watchface_min_s_img, !watchface_theme_config.dial.min_shadow.enable || rendergov_is_reduced() );
+    lv_obj_set_hidden( watchface_sec_s_img, !watchface_theme_config.dial.sec_shadow.enable || rendergov_is_reduced() );
+}
+
+bool watchface_rendergov_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case RENDERGOV_QUALITY:
+            watchface_apply_render_quality();
+            break;
+    }
+    return( true );
 }
 
 void watchface_decompress_theme( void ) {
@@ -402,7 +430,7 @@ void watchface_reload_theme( void ) {
         WATCHFACE_LOG("load standard watchface hour shadow");
     }
     lv_obj_align( watchface_hour_s_img, watchface_app_tile, LV_ALIGN_CENTER, watchface_theme_config.dial.hour_shadow.x_offset, watchface_theme_config.dial.hour_shadow.y_offset );
-    lv_obj_set_hidden( watchface_hour_s_img, !watchface_theme_config.dial.hour_shadow.enable );
+    lv_obj_set_hidden( watchface_hour_s_img, !watchface_theme_config.dial.hour_shadow.enable || rendergov_is_reduced() );
     lv_obj_invalidate( watchface_hour_s_img );
     /**
      * load min shadow image
@@ -421,7 +449,7 @@ void watchface_reload_theme( void ) {
         WATCHFACE_LOG("load standard watchface min shadow");
     }
     lv_obj_align( watchface_min_s_img, watchface_app_tile, LV_ALIGN_CENTER, watchface_theme_config.dial.min_shadow.x_offset, watchface_theme_config.dial.min_shadow.y_offset );
-    lv_obj_set_hidden( watchface_min_s_img, !watchface_theme_config.dial.min_shadow.enable );
+    lv_obj_set_hidden( watchface_min_s_img, !watchface_theme_config.dial.min_shadow.enable || rendergov_is_reduced() );
     lv_obj_invalidate( watchface_min_s_img );
     /**
      * load sec shadow image
@@ -440,7 +468,7 @@ void watchface_reload_theme( void ) {
         WATCHFACE_LOG("load standard watchface sec shadow");
     }
     lv_obj_align( watchface_sec_s_img, watchface_app_tile, LV_ALIGN_CENTER, watchface_theme_config.dial.sec_shadow.x_offset, watchface_theme_config.dial.sec_shadow.y_offset );       
-    lv_obj_set_hidden( watchface_sec_s_img, !watchface_theme_config.dial.sec_shadow.enable );
+    lv_obj_set_hidden( watchface_sec_s_img, !watchface_theme_config.dial.sec_shadow.enable || rendergov_is_reduced() );
     lv_obj_invalidate( watchface_sec_s_img );
     /**
      * load hour image
@@ -80,6 +80,10 @@ void lv_4grey_as_png( const char* filename, const unsigned char* image, unsigned
     if(error) printf("error %u: %s\n", error, lodepng_error_text(error));
 }
 
+unsigned lv_png_decode32( unsigned char** out, unsigned* w, unsigned* h, const unsigned char* in, size_t insize ) {
+    return lodepng_decode32( out, w, h, in, insize );
+}
+
 /**
  * Get info about a PNG image
  * @param src can be file name or pointer to a C array
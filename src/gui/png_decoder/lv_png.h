@@ -13,6 +13,7 @@ extern "C" {
 /*********************
  *      INCLUDES
  *********************/
+#include <stddef.h>
 
 /*********************
  *      DEFINES
@@ -34,6 +35,16 @@ void lv_rgb_as_png( const char* filename, const unsigned char* image, unsigned i
 void lv_rgba_as_png( const char* filename, const unsigned char* image, unsigned int w, unsigned int h );
 void lv_8grey_as_png( const char* filename, const unsigned char* image, unsigned int w, unsigned int h );
 void lv_4grey_as_png( const char* filename, const unsigned char* image, unsigned int w, unsigned int h );
+/**
+ * Decode a PNG in memory into RGBA8888, free the image with free()
+ * @param out pointer to the decoded image
+ * @param w pointer to the image width
+ * @param h pointer to the image height
+ * @param in PNG data
+ * @param insize PNG data size
+ * @return 0: no error, else a lodepng error code
+ */
+unsigned lv_png_decode32( unsigned char** out, unsigned* w, unsigned* h, const unsigned char* in, size_t insize );
 
 /**********************
  *      MACROS
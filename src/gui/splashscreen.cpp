@@ -26,6 +26,8 @@
 #include "hardware/framebuffer.h"
 #include "gui/png_decoder/lv_png.h"
 #include "gui/sjpg_decoder/lv_sjpg.h"
+#include "gui/lv_fs/lv_fs_spiffs.h"
+#include "utils/bootprof/bootprof.h"
 #include "widget_factory.h"
 
 #ifdef NATIVE_64BIT
@@ -42,30 +44,64 @@
 #endif
 
 lv_obj_t *logo = NULL;
+lv_obj_t *logo_cont = NULL;
 lv_obj_t *preload = NULL;
 lv_obj_t *preload_label = NULL;
 lv_style_t style;
 
+static lv_coord_t logo_height = 0;
+static bool logo_progressive = false;
+
 LV_IMG_DECLARE(hedgehog);
 
+static bool splash_screen_bootprof_event_cb( EventBits_t event, void *arg );
+
+static uint32_t splash_screen_progress( bootprof_mark_t *mark ) {
+    /**
+     * scale to the splashscreen end from the last boot, without a
+     * last boot profile take the estimated boot progress
+     */
+    uint32_t end = bootprof_get_last_time( SPLASHSCREEN_BOOTPROF_END );
+    if ( !end ) {
+        return( mark->progress );
+    }
+    return( mark->time >= end ? 100 : mark->time * 100 / end );
+}
+
 void splash_screen_stage_one( void ) {
 
     lv_split_jpeg_init();
     lv_png_init();
     lv_img_cache_set_size(250);
+    /**
+     * the sjpg logo is read through the lv fs spiffs wrapper
+     */
+    lv_fs_if_spiffs_init();
 
     lv_obj_t *background = lv_bar_create(lv_scr_act(), NULL);
     lv_obj_set_size( background, lv_disp_get_hor_res( NULL ), lv_disp_get_ver_res( NULL ) );
     lv_obj_add_style( background, LV_OBJ_PART_MAIN, BACKGROUND_STYLE );
     lv_obj_align( background, NULL, LV_ALIGN_CENTER, 0, 0 );
 
-    logo = lv_img_create( background , NULL );
+    /**
+     * the logo container clips the logo, a growing container height
+     * reveals the logo line by line while booting
+     */
+    logo_cont = lv_obj_create( background, NULL );
+    lv_obj_add_style( logo_cont, LV_OBJ_PART_MAIN, MAINBAR_STYLE );
+    logo = lv_img_create( logo_cont , NULL );
 
-    // load boot logo from spiffs if exsist
+    // load boot logo from spiffs if exsist, prefer a split jpeg
     FILE* file;
-    file = fopen( SPLASHSCREENLOGO, "rb" );
+    file = fopen( SPLASHSCREENLOGO_SJPG, "rb" );
 
     if ( file ) {
+        log_i("use custom split jpeg boot logo from spiffs");
+        fclose( file );
+        lv_img_set_src( logo, "P:" SPLASHSCREENLOGO_SJPG );
+        logo_progressive = true;
+    }
+    else if ( ( file = fopen( SPLASHSCREENLOGO, "rb" ) ) ) {
         log_i("use custom boot logo from spiffs");
         fclose( file );
         lv_img_set_src( logo, SPLASHSCREENLOGO );
@@ -74,13 +110,16 @@ void splash_screen_stage_one( void ) {
         log_i("use default boot logo");
         lv_img_set_src( logo, &hedgehog );
     }
-    lv_obj_align( logo, NULL, LV_ALIGN_CENTER, 0, 0 );
     lv_obj_add_style( logo, LV_OBJ_PART_MAIN, SYSTEM_ICON_STYLE );
+    lv_obj_set_pos( logo, 0, 0 );
+    lv_obj_set_size( logo_cont, lv_obj_get_width( logo ), lv_obj_get_height( logo ) );
+    lv_obj_align( logo_cont, NULL, LV_ALIGN_CENTER, 0, 0 );
+    logo_height = lv_obj_get_height( logo );
 
     preload = lv_bar_create( lv_scr_act(), NULL );
     lv_obj_set_size( preload, lv_disp_get_hor_res( NULL ) - 80, 20 );
     lv_obj_add_style( preload, LV_OBJ_PART_MAIN, SYSTEM_ICON_STYLE );
-    lv_obj_align( preload, logo, LV_ALIGN_OUT_BOTTOM_MID, 0, 30 );
+    lv_obj_align( preload, logo_cont, LV_ALIGN_OUT_BOTTOM_MID, 0, 30 );
     lv_bar_set_anim_time( preload, 2000);
     lv_bar_set_value( preload, 0, LV_ANIM_ON);
     lv_obj_set_hidden( preload, true );
@@ -93,6 +132,14 @@ void splash_screen_stage_one( void ) {
     lv_disp_trig_activity( NULL );
 
     lv_obj_move_foreground( preload_label );
+    /**
+     * a split jpeg is decoded slice by slice, start with a hidden logo and
+     * decode the new slices between the boot steps
+     */
+    if ( logo_progressive ) {
+        lv_obj_set_height( logo_cont, 0 );
+    }
+    bootprof_register_cb( BOOTPROF_MARK, splash_screen_bootprof_event_cb, "splashscreen" );
 
     lv_task_handler();
 
@@ -115,16 +162,44 @@ void splash_screen_stage_one( void ) {
     #endif
 }
 
+static bool splash_screen_bootprof_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case BOOTPROF_MARK: {
+            if ( !preload ) {
+                break;
+            }
+            uint32_t progress = splash_screen_progress( (bootprof_mark_t*)arg );
+            /**
+             * bar and logo follow the boot progress, only the new
+             * logo lines are decoded and flushed
+             */
+            if ( logo_progressive && lv_obj_get_height( logo_cont ) < logo_height * (lv_coord_t)progress / 100 ) {
+                lv_obj_set_height( logo_cont, logo_height * progress / 100 );
+            }
+            if ( lv_bar_get_value( preload ) < (int16_t)progress ) {
+                lv_obj_set_hidden( preload, false );
+                lv_bar_set_value( preload, progress, LV_ANIM_ON );
+            }
+            lv_task_handler();
+            break;
+        }
+    }
+    return( true );
+}
+
 void splash_screen_stage_update( const char* msg, int value ) {
     lv_obj_move_foreground( preload );
     lv_disp_trig_activity( NULL );
-    lv_task_handler();
-    delay(100);
-    lv_bar_set_value( preload, 0, LV_ANIM_ON );
+    if ( lv_bar_get_value( preload ) < value ) {
+        lv_obj_set_hidden( preload, false );
+        lv_bar_set_value( preload, value, LV_ANIM_ON );
+    }
+    if ( logo_progressive && value >= 100 ) {
+        lv_obj_set_height( logo_cont, logo_height );
+    }
     lv_label_set_text( preload_label, msg );
     lv_obj_align( preload_label, preload, LV_ALIGN_OUT_BOTTOM_MID, 0, 5 );
     lv_task_handler();
-    delay(500);
 }
 
 void splash_screen_stage_finish( void ) {
@@ -145,8 +220,12 @@ void splash_screen_stage_finish( void ) {
             }   
         #endif
     #endif
-    lv_obj_del( logo );
+    lv_obj_del( logo_cont );
     lv_obj_del( preload );
     lv_obj_del( preload_label );
+    logo = NULL;
+    logo_cont = NULL;
+    preload = NULL;
+    preload_label = NULL;
     lv_task_handler();
 }
@@ -22,14 +22,16 @@
 #ifndef _SPLASHSCREEN_H
     #define _SPLASHSCREEN_H
 
-    #define SPLASHSCREENLOGO    "/spiffs/logo.png"
+    #define SPLASHSCREENLOGO        "/spiffs/logo.png"
+    #define SPLASHSCREENLOGO_SJPG   "/spiffs/logo.sjpg"     /** @brief split jpeg logo, decoded slice by slice while booting */
+    #define SPLASHSCREEN_BOOTPROF_END   "hardware"          /** @brief boot profiler mark when the splashscreen ends */
 
     /**
      * @brief start splashscreen
      */
     void splash_screen_stage_one( void );
     /**
-     * @brief update spash screen text and bar
+     * @brief update spash screen text and bar, the bar never moves backwards
      * 
      * @param   msg   splash screen text
      * @param   value splash screen bar value (0-100)
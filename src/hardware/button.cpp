@@ -23,6 +23,7 @@
 #include "button.h"
 #include "callback.h"
 #include "utils/alloc.h"
+#include "utils/latency/latency.h"
 
 bool button_send_cb( EventBits_t event, void *arg );
 
@@ -441,6 +442,10 @@ bool button_register_cb( EventBits_t event, CALLBACK_FUNC callback_func, const c
 
 bool button_send_cb( EventBits_t event, void *arg ) {
     log_i("send button cb");
+    /*
+     * start touch to photon measurement
+     */
+    latency_button( event );
     /*
      * call all callbacks with her event mask
      */
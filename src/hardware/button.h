@@ -60,5 +60,14 @@
      * @return  true if success, false if failed
      */
     bool button_register_cb( EventBits_t event, CALLBACK_FUNC callback_func, const char *id );
+    /**
+     * @brief send a button event to all registered callback functions, used to inject button events
+     *
+     * @param   event           button event mask, example: BUTTON_PWR
+     * @param   arg             pointer to an argument, NULL for most buttons
+     *
+     * @return  true if success, false if failed
+     */
+    bool button_send_cb( EventBits_t event, void *arg );
 
 #endif // _BUTTON_H
\ No newline at end of file
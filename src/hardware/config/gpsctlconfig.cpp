@@ -29,6 +29,8 @@ bool gpsctl_config_t::onSave(JsonDocument& doc) {
     doc["enable_on_standby"] = enable_on_standby;
     doc["gps_over_ip"] = gps_over_ip;
     doc["app_use_gps"] = app_use_gps;
+    doc["nmea_parser"] = nmea_parser;
+    doc["duty_cycle"] = duty_cycle;
     doc["TXPin"] = TXPin;
     doc["RXPin"] = RXPin;
 
@@ -40,6 +42,8 @@ bool gpsctl_config_t::onLoad(JsonDocument& doc) {
     enable_on_standby = doc["enable_on_standby"] | false;
     gps_over_ip = doc["gps_over_ip"] | false;
     app_use_gps = doc["app_use_gps"] | false;
+    nmea_parser = doc["nmea_parser"] | false;
+    duty_cycle = doc["duty_cycle"] | false;
     TXPin = doc["TXPin"] | -1;
     RXPin = doc["RXPin"] | -1;
 
@@ -51,6 +55,8 @@ bool gpsctl_config_t::onDefault( void ) {
     enable_on_standby = false;
     gps_over_ip = false;
     app_use_gps = false;
+    nmea_parser = false;
+    duty_cycle = false;
     TXPin = -1;
     RXPin = -1;
 
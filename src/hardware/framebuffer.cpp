@@ -23,6 +23,7 @@
 #include "lvgl.h"
 #include "framebuffer.h"
 #include "powermgm.h"
+#include "callback.h"
 #include "utils/alloc.h"
 /**
  * device depends includes and inits
@@ -64,9 +65,11 @@
 static bool framebuffer_use_dma = false;
 lv_color_t *framebuffer = NULL;                                     /** @brief pointer to a full size framebuffer */
 uint32_t framebuffer_size = FRAMEBUFFER_BUFFER_SIZE;                /** @brief framebuffer size */
+callback_t *framebuffer_callback = NULL;                            /** @brief framebuffer callback table */
 
 bool framebuffer_powermgm_event_cb( EventBits_t event, void *arg );
 bool framebuffer_powermgm_loop_cb( EventBits_t event, void *arg );
+bool framebuffer_send_event_cb( EventBits_t event, void *arg );
 static void framebuffer_flush_cb( lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p );
 
 void framebuffer_setup( void ) {
@@ -166,6 +169,30 @@ void framebuffer_setup( void ) {
     powermgm_register_loop_cb( POWERMGM_SILENCE_WAKEUP | POWERMGM_STANDBY | POWERMGM_WAKEUP , framebuffer_powermgm_loop_cb, "powermgm framebuffer loop" );
 }
 
+bool framebuffer_register_cb( EventBits_t event, CALLBACK_FUNC callback_func, const char *id ) {
+    /*
+     * check if an callback table exist, if not allocate a callback table
+     */
+    if ( framebuffer_callback == NULL ) {
+        framebuffer_callback = callback_init( "framebuffer" );
+        if ( framebuffer_callback == NULL ) {
+            log_e("framebuffer callback alloc failed");
+            while(true);
+        }
+    }
+    /*
+     * register an callback entry and return them
+     */
+    return( callback_register( framebuffer_callback, event, callback_func, id ) );
+}
+
+bool framebuffer_send_event_cb( EventBits_t event, void *arg ) {
+    /*
+     * call all callbacks with her event mask
+     */
+    return( callback_send_no_log( framebuffer_callback, event, arg ) );
+}
+
 bool framebuffer_powermgm_event_cb( EventBits_t event, void *arg ) {
     switch( event ) {
         case POWERMGM_STANDBY:          log_i("go standby, refresh framebuffer");
@@ -353,5 +380,14 @@ static void framebuffer_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area,
             tft.endWrite();
         #endif
     #endif
+    /**
+     * inform listeners like fbstream about the flushed area
+     */
+    if ( framebuffer_callback ) {
+        framebuffer_flush_t framebuffer_flush;
+        framebuffer_flush.area = area;
+        framebuffer_flush.color_p = color_p;
+        framebuffer_send_event_cb( FRAMEBUFFER_FLUSH, (void*)&framebuffer_flush );
+    }
     lv_disp_flush_ready( disp_drv );
 }
@@ -24,6 +24,8 @@
     
     #include "lvgl.h"
     #include "config.h"
+    #include "callback.h"
+    #include "utils/io.h"
 
     #ifdef NATIVE_64BIT
             #define FRAMEBUFFER_BUFFER_W        LV_HOR_RES_MAX
@@ -47,6 +49,15 @@
 
     #define FRAMEBUFFER_BUFFER_SIZE     ( FRAMEBUFFER_BUFFER_W * FRAMEBUFFER_BUFFER_H )
 
+    #define FRAMEBUFFER_FLUSH           _BV(0)      /** @brief event mask for a flushed framebuffer area, arg is a framebuffer_flush_t */
+    /**
+     * @brief framebuffer flush info structure
+     */
+    typedef struct {
+        const lv_area_t *area;                      /** @brief flushed screen area */
+        const lv_color_t *color_p;                  /** @brief pointer to the flushed pixel data */
+    } framebuffer_flush_t;
+
     /**
      * @brief setup framebuffer
      */
@@ -55,4 +66,16 @@
      * @brief force framebuffer refresh to screen/display
      */
     void framebuffer_refresh( void );
+    /**
+     * @brief registers a callback function which is called on a corresponding event
+     * 
+     * @param   event           possible values: FRAMEBUFFER_FLUSH
+     * @param   callback_func   pointer to the callback function
+     * @param   id              program id
+     * 
+     * @return  true if success, false if failed
+     * 
+     * @note    FRAMEBUFFER_FLUSH is called from the display flush path, keep the callback short
+     */
+    bool framebuffer_register_cb( EventBits_t event, CALLBACK_FUNC callback_func, const char *id );
 #endif // _FRAMEBUFFER_H
\ No newline at end of file
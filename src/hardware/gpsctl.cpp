@@ -21,8 +21,15 @@
  */
 #include "config.h"
 #include "gpsctl.h"
+#include "gpsingest.h"
+#include "gpsfuse.h"
+#include "gpsduty.h"
 #include "powermgm.h"
 #include "callback.h"
+#include "utils/nmea/nmea.h"
+
+#include <math.h>
+#include <string.h>
 
 #ifdef NATIVE_64BIT
     #include "utils/logging.h"
@@ -37,20 +44,48 @@
     #endif
 
     #include <TinyGPS++.h>
-    #include <SoftwareSerial.h>
-
-    static const uint32_t GPSBaud = 9600;
 
     TinyGPSPlus gps;
     TinyGPSCustom TGC_sats_in_view_gps;
     TinyGPSCustom TGC_sats_in_view_glonass;
     TinyGPSCustom TGC_sats_in_view_baidou;
-
-    SoftwareSerial *softserial = NULL;
 #endif
 
+/**
+ * @brief latest parser values, the updated flags are cleared every GPSCTL_INTERVAL
+ */
+typedef struct {
+    bool valid_location = false;                    /** @brief true if location valid */
+    bool valid_speed = false;                       /** @brief true if speed valid */
+    bool valid_course = false;                      /** @brief true if course valid */
+    bool valid_altitude = false;                    /** @brief true if altitude valid */
+    bool valid_satellite = false;                   /** @brief true if satellites valid */
+    bool location_updated = false;
+    bool speed_updated = false;
+    bool course_updated = false;
+    bool altitude_updated = false;
+    bool satellites_updated = false;
+    bool gps_satellites_updated = false;
+    bool glonass_satellites_updated = false;
+    bool baidou_satellites_updated = false;
+    double lat = 0;                                 /** @brief latitude in degree */
+    double lon = 0;                                 /** @brief longitude in degree */
+    double speed = 0;                               /** @brief speed in knots */
+    double course = 0;                              /** @brief course in degree */
+    double altitude = 0;                            /** @brief altitude in meters */
+    uint32_t satellites = 0;                        /** @brief satellites in use */
+    uint32_t gps_satellites = 0;                    /** @brief gps satellites in view */
+    uint32_t glonass_satellites = 0;                /** @brief glonass satellites in view */
+    uint32_t baidou_satellites = 0;                 /** @brief baidou satellites in view */
+} gpsctl_update_t;
+
 static bool gpsctl_init = false;
 static bool gpsctl_enable = false;
+static bool gpsctl_receiver = false;                /** @brief true if the receiver is powered, the duty cycle turns it off while enabled */
+static gpsctl_update_t gpsctl_update;
+#ifndef NATIVE_64BIT
+    static uint64_t gpsctl_receiver_on = 0;         /** @brief millis of the last receiver power on, TinyGPS++ values before it are stale */
+#endif
 
 gpsctl_config_t gpsctl_config;
 callback_t *gpsctl_callback = NULL;
@@ -59,8 +94,14 @@ gps_data_t gps_data;
 bool gpsctl_powermgm_loop_cb( EventBits_t event, void *arg );
 bool gpsctl_powermgm_event_cb( EventBits_t event, void *arg );
 bool gpsctl_send_cb( EventBits_t event, void *arg );
+static void gpsctl_nmea_sentence( const char *sentence, size_t len );
+static void gpsctl_send_update( void );
+#ifndef NATIVE_64BIT
+    static void gpsctl_tinygps_update( void );
+#endif
 void gpsctl_autoon_on( void );
 void gpsctl_autoon_off( void );
+static void gpsctl_receiver_power( bool on );
 
 void gpsctl_setup( void ) {
     /*
@@ -73,6 +114,18 @@ void gpsctl_setup( void ) {
      * load config from json
      */
     gpsctl_config.load();
+    /**
+     * setup the nmea ingestion path, on native it picks up a file or synthetic source
+     */
+    gpsingest_setup();
+    gpsfuse_setup();
+    gpsduty_setup();
+    #ifdef NATIVE_64BIT
+        const char *bench = getenv( NMEA_BENCH_ENV );
+        if ( bench && *bench ) {
+            nmea_bench( bench );
+        }
+    #endif
 
     #ifdef NATIVE_64BIT
 
@@ -104,8 +157,7 @@ void gpsctl_setup( void ) {
          * init tinyGPS++ if we have a valid RX/TX config
          */
         if( gpsctl_config.RXPin > 0 && gpsctl_config.TXPin > 0 ) {
-            softserial = new SoftwareSerial( gpsctl_config.RXPin, gpsctl_config.TXPin );
-            softserial->begin( GPSBaud );
+            gpsingest_set_source( gpsingest_uart_source( gpsctl_config.RXPin, gpsctl_config.TXPin, GPSINGEST_BAUD ) );
             TGC_sats_in_view_gps.begin( gps, "GPGSV", 3);
             TGC_sats_in_view_glonass.begin( gps, "GLGSV", 3);
             TGC_sats_in_view_baidou.begin( gps, "BDGSV", 3);
@@ -124,20 +176,13 @@ void gpsctl_setup( void ) {
 }
 
 bool gpsctl_get_available( void ) {
-    #ifdef NATIVE_64BIT
-        return( false );
-    #else
-        if ( softserial ) {
-            return( true );
-        }
-        else {
-            return( false );
-        }
-    #endif
+    return( gpsingest_get_available() );
 }
 
 bool gpsctl_powermgm_loop_cb( EventBits_t event, void *arg ) {
     static uint64_t lastmillis = millis();
+    char sentence[ GPSINGEST_SENTENCE_SIZE ];
+    size_t len;
     /*
      * check if gpsctl already init or turn off
      */
@@ -145,138 +190,322 @@ bool gpsctl_powermgm_loop_cb( EventBits_t event, void *arg ) {
         return( true );
     }
     /**
-     * special case
+     * power the receiver only for the fixes the activity needs
      */
-    #ifdef NATIVE_64BIT
-
-    #else
-        /**
-         * abort if we have no softserial init
-         */
-        if ( softserial ) {
-            /**
-             * check for serial data and read
-             */
-            if ( softserial->available() > 0 ) {
-                GPSCTL_DEBUG_LOG("new gps data (%d bytes)", softserial->available() );
-                while ( softserial->available() > 0 )
-                    gps.encode( softserial->read() );
-            }
+    if ( gpsctl_config.duty_cycle ) {
+        bool on = gpsduty_run();
+        if ( on != gpsctl_receiver ) {
+            gpsctl_receiver_power( on );
         }
-    #endif
+        if ( !gpsctl_receiver ) {
+            return( true );
+        }
+    }
+    /**
+     * feed the framed and verified sentences from the ingestion task
+     */
+    while( ( len = gpsingest_read_sentence( sentence, sizeof( sentence ) ) ) ) {
+        #ifdef NATIVE_64BIT
+            gpsctl_nmea_sentence( sentence, len );
+        #else
+            if ( gpsctl_config.nmea_parser ) {
+                gpsctl_nmea_sentence( sentence, len );
+                continue;
+            }
+            for( size_t i = 0 ; i < len ; i++ ) {
+                gps.encode( sentence[ i ] );
+            }
+            gps.encode( '\r' );
+            gps.encode( '\n' );
+        #endif
+    }
     /**
      * run any second
      */
-    if ( millis() - lastmillis > GPSCTL_INTERVAL ) {
+    if ( millis() - lastmillis >= GPSCTL_INTERVAL ) {
         /*
          * check if the last update is more than 2 times away
-         * to avoid callback bombing
+         * to avoid callback bombing, otherwise keep the fixed interval
          */
         if ( ( millis() - lastmillis ) > GPSCTL_INTERVAL * 2 ) {
             lastmillis = millis();
         }
         else {
-            lastmillis =+ GPSCTL_INTERVAL;
+            lastmillis += GPSCTL_INTERVAL;
         }
-        #ifdef NATIVE_64BIT
-        #else
-            /*
-            * store valid state
-            */
-            gps_data.valid_location = gps.location.isValid();
-            gps_data.valid_speed = gps.speed.isValid();
-            gps_data.valid_satellite = gps.satellites.isValid();
-            gps_data.valid_altitude = gps.altitude.isValid();
-            /*
-            * send FIX, UPDATE_SOURCE and UPDATE_LOCATION
-            */
-            if ( gps_data.valid_location != gps_data.gpsfix ) {
-                gps_data.gpsfix = gps_data.valid_location;
-                if ( gps_data.gpsfix ) {
-                    /*
-                    * send FIX and SET_APP_LOCATION event 
-                    */
-                    gpsctl_send_cb( GPSCTL_FIX, NULL );
-                    if ( gpsctl_get_app_use_gps() ) {
-                        gps_data.lat = gps.location.lat();
-                        gps_data.lon = gps.location.lng();
-                        gpsctl_send_cb( GPSCTL_SET_APP_LOCATION, (void*)&gps_data );
-                    }
-                    gpsctl_send_cb( GPSCTL_UPDATE_SOURCE, (void*)&gps_data );
-                }
-                else {
-                    /*
-                    * send NOFIX event
-                    */
-                    gpsctl_send_cb( GPSCTL_NOFIX, NULL );
-                }
-            }                
-            /*
-            * check for data updates
-            */
-            if ( gps.location.isUpdated() ) {
-                gps_data.gps_source = GPS_SOURCE_GPS;
-                gps_data.lat = gps.location.lat();
-                gps_data.lon = gps.location.lng();
-                gpsctl_send_cb( GPSCTL_UPDATE_LOCATION, (void*)&gps_data );
-                GPSCTL_DEBUG_LOG("new lat/lon: %f/%f", gps_data.lat, gps_data.lon );
+        #ifndef NATIVE_64BIT
+            if ( !gpsctl_config.nmea_parser ) {
+                gpsctl_tinygps_update();
             }
-            if ( gps.speed.isUpdated() ) {
-                gps_data.gps_source = GPS_SOURCE_GPS;
-                gps_data.speed_mph = gps.speed.mph();
-                gps_data.speed_mps = gps.speed.mps();
-                gps_data.speed_kmh = gps.speed.kmph();
-                gpsctl_send_cb( GPSCTL_UPDATE_SPEED, (void*)&gps_data );
-                GPSCTL_DEBUG_LOG("new speed: %fkmh / %fmph / %mps", gps_data.speed_kmh, gps_data.speed_mph, gps_data.speed_mps );
+        #endif
+        if ( gpsctl_config.duty_cycle ) {
+            /**
+             * a search after a duty cycle power on keeps the last fix
+             */
+            if ( gps_data.gpsfix && !gpsctl_update.valid_location ) {
+                return( true );
             }
-            if ( gps.altitude.isUpdated()) {
-                gps_data.gps_source = GPS_SOURCE_GPS;
-                gps_data.altitude_feed = gps.altitude.feet();
-                gps_data.altitude_meters = gps.altitude.meters();
-                gpsctl_send_cb( GPSCTL_UPDATE_ALTITUDE, (void*)&gps_data );
-                GPSCTL_DEBUG_LOG("new altitude: %fmeters / %ffeed", gps_data.altitude_meters, gps_data.altitude_feed );
+            if ( gpsctl_update.location_updated ) {
+                gpsduty_fix( gpsctl_update.valid_speed ? gpsctl_update.speed * 0.51444444 : 0 );
             }
-            if ( gps.satellites.isUpdated() ) {
-                if ( gps_data.satellites != gps.satellites.value() ) {
-                    gps_data.gps_source = GPS_SOURCE_GPS;
-                    gps_data.satellites = gps.satellites.value();
-                    gpsctl_send_cb( GPSCTL_UPDATE_SATELLITE, (void*)&gps_data );
-                    GPSCTL_DEBUG_LOG("new satellites: %d", gps_data.satellites );
-                }
+        }
+        gpsctl_send_update();
+    }
+    return( true );
+}
+
+/**
+ * @brief parse a sentence with the nmea parser into gpsctl_update
+ */
+static void gpsctl_nmea_sentence( const char *sentence, size_t len ) {
+    nmea_sentence_t nmea;
+
+    switch( nmea_parse( sentence, len, &nmea ) ) {
+        case NMEA_RMC:
+            gpsctl_update.valid_location = nmea.rmc.valid && !isnan( nmea.rmc.lat ) && !isnan( nmea.rmc.lon );
+            if ( !gpsctl_update.valid_location ) {
+                break;
             }
-            /*
-            * Update Custom GNSS values
-            */
-            if ( TGC_sats_in_view_gps.isUpdated() )
-            {
-                if ( gps_data.satellite_types.gps_satellites != atoi( TGC_sats_in_view_gps.value() ) ) {
-                    gps_data.gps_source = GPS_SOURCE_GPS;
-                    gps_data.satellite_types.gps_satellites = atoi( TGC_sats_in_view_gps.value() );
-                    gpsctl_send_cb( GPSCTL_UPDATE_SATELLITE_TYPE, (void *)&gps_data );
-                    GPSCTL_DEBUG_LOG("gps satellites: %d", gps_data.satellite_types.gps_satellites );
-                }
+            gpsctl_update.lat = nmea.rmc.lat;
+            gpsctl_update.lon = nmea.rmc.lon;
+            gpsctl_update.location_updated = true;
+            if ( !isnan( nmea.rmc.speed ) ) {
+                gpsctl_update.speed = nmea.rmc.speed;
+                gpsctl_update.valid_speed = true;
+                gpsctl_update.speed_updated = true;
+            }
+            if ( !isnan( nmea.rmc.course ) ) {
+                gpsctl_update.course = nmea.rmc.course;
+                gpsctl_update.valid_course = true;
+                gpsctl_update.course_updated = true;
+            }
+            break;
+        case NMEA_GGA:
+            /**
+             * satellites in use count without a fix too
+             */
+            if ( nmea.gga.satellites >= 0 ) {
+                gpsctl_update.satellites = nmea.gga.satellites;
+                gpsctl_update.valid_satellite = true;
+                gpsctl_update.satellites_updated = true;
             }
-            if ( TGC_sats_in_view_glonass.isUpdated() )
-            {
-                if ( gps_data.satellite_types.glonass_satellites != atoi( TGC_sats_in_view_glonass.value() ) ) {
-                    gps_data.gps_source = GPS_SOURCE_GPS;
-                    gps_data.satellite_types.glonass_satellites = atoi( TGC_sats_in_view_glonass.value() );
-                    gpsctl_send_cb( GPSCTL_UPDATE_SATELLITE_TYPE, (void *)&gps_data );
-                    GPSCTL_DEBUG_LOG("glosnass satellites: %d", gps_data.satellite_types.glonass_satellites );
-                }
+            gpsctl_update.valid_location = nmea.gga.quality > 0 && !isnan( nmea.gga.lat ) && !isnan( nmea.gga.lon );
+            if ( !gpsctl_update.valid_location ) {
+                break;
             }
-            if ( TGC_sats_in_view_baidou.isUpdated() )
-            {
-                if ( gps_data.satellite_types.baidou_satellites != atoi( TGC_sats_in_view_baidou.value() ) ) {
-                    gps_data.gps_source = GPS_SOURCE_GPS;
-                    gps_data.satellite_types.baidou_satellites = atoi( TGC_sats_in_view_baidou.value() );
-                    gpsctl_send_cb( GPSCTL_UPDATE_SATELLITE_TYPE, (void *)&gps_data );
-                    GPSCTL_DEBUG_LOG("baidou satellites: %d", gps_data.satellite_types.baidou_satellites );
-                }
+            gpsctl_update.lat = nmea.gga.lat;
+            gpsctl_update.lon = nmea.gga.lon;
+            gpsctl_update.location_updated = true;
+            if ( !isnan( nmea.gga.altitude ) ) {
+                gpsctl_update.altitude = nmea.gga.altitude;
+                gpsctl_update.valid_altitude = true;
+                gpsctl_update.altitude_updated = true;
             }
-        #endif // NATIVE_64BIT
+            break;
+        case NMEA_VTG:
+            if ( !isnan( nmea.vtg.speed ) ) {
+                gpsctl_update.speed = nmea.vtg.speed;
+                gpsctl_update.valid_speed = true;
+                gpsctl_update.speed_updated = true;
+            }
+            if ( !isnan( nmea.vtg.course ) ) {
+                gpsctl_update.course = nmea.vtg.course;
+                gpsctl_update.valid_course = true;
+                gpsctl_update.course_updated = true;
+            }
+            break;
+        case NMEA_GSV:
+            if ( nmea.gsv.sats_in_view < 0 ) {
+                break;
+            }
+            if ( !strcmp( nmea.talker, "GP" ) ) {
+                gpsctl_update.gps_satellites = nmea.gsv.sats_in_view;
+                gpsctl_update.gps_satellites_updated = true;
+            }
+            else if ( !strcmp( nmea.talker, "GL" ) ) {
+                gpsctl_update.glonass_satellites = nmea.gsv.sats_in_view;
+                gpsctl_update.glonass_satellites_updated = true;
+            }
+            else if ( !strcmp( nmea.talker, "BD" ) || !strcmp( nmea.talker, "GB" ) ) {
+                gpsctl_update.baidou_satellites = nmea.gsv.sats_in_view;
+                gpsctl_update.baidou_satellites_updated = true;
+            }
+            break;
+        default:
+            break;
     }
-    return( true );
+}
+
+#ifndef NATIVE_64BIT
+/**
+ * @brief collect the TinyGPS++ values into gpsctl_update
+ */
+static void gpsctl_tinygps_update( void ) {
+    /**
+     * TinyGPS++ never drops a valid value, only values received since the
+     * last receiver power on count
+     */
+    uint32_t powered = millis() - gpsctl_receiver_on;
+
+    gpsctl_update.valid_location = gps.location.isValid() && gps.location.age() < powered;
+    gpsctl_update.valid_speed = gps.speed.isValid() && gps.speed.age() < powered;
+    gpsctl_update.valid_course = gps.course.isValid() && gps.course.age() < powered;
+    gpsctl_update.valid_satellite = gps.satellites.isValid() && gps.satellites.age() < powered;
+    gpsctl_update.valid_altitude = gps.altitude.isValid() && gps.altitude.age() < powered;
+
+    if ( gps.course.isUpdated() ) {
+        gpsctl_update.course = gps.course.deg();
+        gpsctl_update.course_updated = true;
+    }
+    if ( gps.location.isUpdated() ) {
+        gpsctl_update.lat = gps.location.lat();
+        gpsctl_update.lon = gps.location.lng();
+        gpsctl_update.location_updated = true;
+    }
+    if ( gps.speed.isUpdated() ) {
+        gpsctl_update.speed = gps.speed.knots();
+        gpsctl_update.speed_updated = true;
+    }
+    if ( gps.altitude.isUpdated() ) {
+        gpsctl_update.altitude = gps.altitude.meters();
+        gpsctl_update.altitude_updated = true;
+    }
+    if ( gps.satellites.isUpdated() ) {
+        gpsctl_update.satellites = gps.satellites.value();
+        gpsctl_update.satellites_updated = true;
+    }
+    /*
+     * Custom GNSS values
+     */
+    if ( TGC_sats_in_view_gps.isUpdated() ) {
+        gpsctl_update.gps_satellites = atoi( TGC_sats_in_view_gps.value() );
+        gpsctl_update.gps_satellites_updated = true;
+    }
+    if ( TGC_sats_in_view_glonass.isUpdated() ) {
+        gpsctl_update.glonass_satellites = atoi( TGC_sats_in_view_glonass.value() );
+        gpsctl_update.glonass_satellites_updated = true;
+    }
+    if ( TGC_sats_in_view_baidou.isUpdated() ) {
+        gpsctl_update.baidou_satellites = atoi( TGC_sats_in_view_baidou.value() );
+        gpsctl_update.baidou_satellites_updated = true;
+    }
+}
+#endif
+
+/**
+ * @brief send the events for the values in gpsctl_update and clear the updated flags
+ */
+static void gpsctl_send_update( void ) {
+    /*
+     * store valid state
+     */
+    gps_data.valid_location = gpsctl_update.valid_location;
+    gps_data.valid_speed = gpsctl_update.valid_speed;
+    gps_data.valid_course = gpsctl_update.valid_course;
+    gps_data.valid_satellite = gpsctl_update.valid_satellite;
+    gps_data.valid_altitude = gpsctl_update.valid_altitude;
+    /*
+     * send FIX, UPDATE_SOURCE and UPDATE_LOCATION
+     */
+    if ( gps_data.valid_location != gps_data.gpsfix ) {
+        gps_data.gpsfix = gps_data.valid_location;
+        if ( gps_data.gpsfix ) {
+            /*
+             * send FIX and SET_APP_LOCATION event 
+             */
+            gpsctl_send_cb( GPSCTL_FIX, NULL );
+            if ( gpsctl_get_app_use_gps() ) {
+                gps_data.lat = gpsctl_update.lat;
+                gps_data.lon = gpsctl_update.lon;
+                gpsctl_send_cb( GPSCTL_SET_APP_LOCATION, (void*)&gps_data );
+            }
+            gpsctl_send_cb( GPSCTL_UPDATE_SOURCE, (void*)&gps_data );
+        }
+        else {
+            /*
+             * send NOFIX event
+             */
+            gpsfuse_reset();
+            gpsctl_send_cb( GPSCTL_NOFIX, NULL );
+        }
+    }                
+    /*
+     * check for data updates, the course first, it goes with the location
+     */
+    if ( gpsctl_update.course_updated ) {
+        gps_data.course = gpsctl_update.course;
+    }
+    if ( gpsctl_update.location_updated ) {
+        gps_data.gps_source = GPS_SOURCE_GPS;
+        gps_data.lat = gpsctl_update.lat;
+        gps_data.lon = gpsctl_update.lon;
+        gpsctl_send_cb( GPSCTL_UPDATE_LOCATION, (void*)&gps_data );
+        GPSCTL_DEBUG_LOG("new lat/lon: %f/%f", gps_data.lat, gps_data.lon );
+    }
+    if ( gpsctl_update.speed_updated ) {
+        gps_data.gps_source = GPS_SOURCE_GPS;
+        gps_data.speed_mph = gpsctl_update.speed * 1.15077945;
+        gps_data.speed_mps = gpsctl_update.speed * 0.51444444;
+        gps_data.speed_kmh = gpsctl_update.speed * 1.852;
+        gpsctl_send_cb( GPSCTL_UPDATE_SPEED, (void*)&gps_data );
+        GPSCTL_DEBUG_LOG("new speed: %fkmh / %fmph / %fmps", gps_data.speed_kmh, gps_data.speed_mph, gps_data.speed_mps );
+    }
+    if ( gpsctl_update.altitude_updated ) {
+        gps_data.gps_source = GPS_SOURCE_GPS;
+        gps_data.altitude_feed = gpsctl_update.altitude * 3.2808399;
+        gps_data.altitude_meters = gpsctl_update.altitude;
+        gpsctl_send_cb( GPSCTL_UPDATE_ALTITUDE, (void*)&gps_data );
+        GPSCTL_DEBUG_LOG("new altitude: %fmeters / %ffeed", gps_data.altitude_meters, gps_data.altitude_feed );
+    }
+    if ( gpsctl_update.satellites_updated ) {
+        if ( gps_data.satellites != gpsctl_update.satellites ) {
+            gps_data.gps_source = GPS_SOURCE_GPS;
+            gps_data.satellites = gpsctl_update.satellites;
+            gpsctl_send_cb( GPSCTL_UPDATE_SATELLITE, (void*)&gps_data );
+            GPSCTL_DEBUG_LOG("new satellites: %d", gps_data.satellites );
+        }
+    }
+    /*
+     * Update Custom GNSS values
+     */
+    if ( gpsctl_update.gps_satellites_updated ) {
+        if ( gps_data.satellite_types.gps_satellites != gpsctl_update.gps_satellites ) {
+            gps_data.gps_source = GPS_SOURCE_GPS;
+            gps_data.satellite_types.gps_satellites = gpsctl_update.gps_satellites;
+            gpsctl_send_cb( GPSCTL_UPDATE_SATELLITE_TYPE, (void *)&gps_data );
+            GPSCTL_DEBUG_LOG("gps satellites: %d", gps_data.satellite_types.gps_satellites );
+        }
+    }
+    if ( gpsctl_update.glonass_satellites_updated ) {
+        if ( gps_data.satellite_types.glonass_satellites != gpsctl_update.glonass_satellites ) {
+            gps_data.gps_source = GPS_SOURCE_GPS;
+            gps_data.satellite_types.glonass_satellites = gpsctl_update.glonass_satellites;
+            gpsctl_send_cb( GPSCTL_UPDATE_SATELLITE_TYPE, (void *)&gps_data );
+            GPSCTL_DEBUG_LOG("glosnass satellites: %d", gps_data.satellite_types.glonass_satellites );
+        }
+    }
+    if ( gpsctl_update.baidou_satellites_updated ) {
+        if ( gps_data.satellite_types.baidou_satellites != gpsctl_update.baidou_satellites ) {
+            gps_data.gps_source = GPS_SOURCE_GPS;
+            gps_data.satellite_types.baidou_satellites = gpsctl_update.baidou_satellites;
+            gpsctl_send_cb( GPSCTL_UPDATE_SATELLITE_TYPE, (void *)&gps_data );
+            GPSCTL_DEBUG_LOG("baidou satellites: %d", gps_data.satellite_types.baidou_satellites );
+        }
+    }
+    /*
+     * smoothed location after all values of the interval are in
+     */
+    if ( gpsctl_update.location_updated && gpsfuse_update( &gps_data ) ) {
+        gpsctl_send_cb( GPSCTL_UPDATE_FUSED, (void*)gpsfuse_get() );
+    }
+    gpsctl_update.location_updated = false;
+    gpsctl_update.speed_updated = false;
+    gpsctl_update.course_updated = false;
+    gpsctl_update.altitude_updated = false;
+    gpsctl_update.satellites_updated = false;
+    gpsctl_update.gps_satellites_updated = false;
+    gpsctl_update.glonass_satellites_updated = false;
+    gpsctl_update.baidou_satellites_updated = false;
 }
 
 bool gpsctl_powermgm_event_cb( EventBits_t event, void *arg ) {
@@ -336,7 +565,10 @@ bool gpsctl_send_cb( EventBits_t event, void *arg ) {
     return( callback_send( gpsctl_callback, event, arg ) );
 }
 
-void gpsctl_on( void ) {
+/**
+ * @brief power the receiver and the nmea ingestion on or off
+ */
+static void gpsctl_receiver_power( bool on ) {
     #ifdef NATIVE_64BIT
     #else
         #if defined( M5PAPER )
@@ -346,13 +578,37 @@ void gpsctl_on( void ) {
         #elif defined( LILYGO_WATCH_2020_V1 ) || defined( LILYGO_WATCH_2020_V2 ) || defined( LILYGO_WATCH_2020_V3 )
             #if defined( LILYGO_WATCH_HAS_GPS )
                 TTGOClass *ttgo = TTGOClass::getWatch();
-                ttgo->trunOnGPS();
+                if ( on )
+                    ttgo->trunOnGPS();
+                else
+                    ttgo->turnOffGPS();
             #endif
         #endif
     #endif
+    if ( on )
+        gpsingest_start();
+    else
+        gpsingest_stop();
+    /**
+     * gps_data keeps the last fix while the receiver searches again, the
+     * parser state must not report it as valid after the next power on
+     */
+    if ( !on ) {
+        gpsctl_update = gpsctl_update_t();
+    }
+    #ifndef NATIVE_64BIT
+        if ( on ) {
+            gpsctl_receiver_on = millis();
+        }
+    #endif
+    gpsctl_receiver = on;
+}
+
+void gpsctl_on( void ) {
     gps_data.gpsfix = false;
     gps_data.valid_location = false;
     gps_data.valid_speed = false;
+    gps_data.valid_course = false;
     gps_data.valid_altitude = false;
     gps_data.valid_satellite = false;
     gps_data.satellite_types.gps_satellites = 0;
@@ -361,28 +617,20 @@ void gpsctl_on( void ) {
     gpsctl_config.autoon = true;
     gpsctl_config.save();
     gpsctl_enable = true;
+    gpsctl_update = gpsctl_update_t();
+    gpsfuse_reset();
+    gpsduty_reset();
+    gpsctl_receiver_power( true );
     gpsctl_send_cb( GPSCTL_UPDATE_CONFIG, NULL );
     gpsctl_send_cb( GPSCTL_ENABLE, NULL );
     gpsctl_send_cb( GPSCTL_NOFIX, NULL );
 }
 
 void gpsctl_off( void ) {
-    #ifdef NATIVE_64BIT
-    #else
-        #if defined( M5PAPER )
-
-        #elif defined( M5CORE2 )
-
-        #elif defined( LILYGO_WATCH_2020_V1 ) || defined( LILYGO_WATCH_2020_V2 ) || defined( LILYGO_WATCH_2020_V3 )
-            #if defined( LILYGO_WATCH_HAS_GPS )
-                TTGOClass *ttgo = TTGOClass::getWatch();
-                ttgo->turnOffGPS();
-            #endif
-        #endif
-    #endif
     gps_data.gpsfix = false;
     gps_data.valid_location = false;
     gps_data.valid_speed = false;
+    gps_data.valid_course = false;
     gps_data.valid_altitude = false;
     gps_data.valid_satellite = false;
     gps_data.satellite_types.gps_satellites = 0;
@@ -391,6 +639,7 @@ void gpsctl_off( void ) {
     gpsctl_config.autoon = false;
     gpsctl_config.save();
     gpsctl_enable = false;
+    gpsctl_receiver_power( false );
     gpsctl_send_cb( GPSCTL_UPDATE_CONFIG, NULL );
     gpsctl_send_cb( GPSCTL_NOFIX, NULL );
     gpsctl_send_cb( GPSCTL_DISABLE, NULL );
@@ -401,6 +650,7 @@ void gpsctl_autoon_on( void ) {
     gps_data.gpsfix = false;
     gps_data.valid_location = false;
     gps_data.valid_speed = false;
+    gps_data.valid_course = false;
     gps_data.valid_altitude = false;
     gps_data.valid_satellite = false;
     gps_data.satellite_types.gps_satellites = 0;
@@ -409,49 +659,30 @@ void gpsctl_autoon_on( void ) {
 
     if ( gpsctl_config.autoon ) {
         if ( !gpsctl_enable ) {
-            #ifdef NATIVE_64BIT
-            #else
-                #if defined( M5PAPER )
-
-                #elif defined( M5CORE2 )
-
-                #elif defined( LILYGO_WATCH_2020_V1 ) || defined( LILYGO_WATCH_2020_V2 ) || defined( LILYGO_WATCH_2020_V3 )
-                    #if defined( LILYGO_WATCH_HAS_GPS )
-                        TTGOClass *ttgo = TTGOClass::getWatch();
-                        ttgo->trunOnGPS();
-                    #endif
-                #endif
-            #endif
             gpsctl_enable = true;
+            gpsctl_update = gpsctl_update_t();
+            gpsfuse_reset();
+            gpsduty_reset();
+            gpsctl_receiver_power( true );
             gpsctl_send_cb( GPSCTL_ENABLE, NULL );
             gpsctl_send_cb( GPSCTL_NOFIX, NULL );
         }
     }
     else {
         gpsctl_enable = false;
+        gpsctl_receiver_power( false );
         gpsctl_send_cb( GPSCTL_NOFIX, NULL );
         gpsctl_send_cb( GPSCTL_DISABLE, NULL );
     }
 }
 
 void gpsctl_autoon_off( void ) {
-    #ifdef NATIVE_64BIT
-    #else
-        #if defined( M5PAPER )
-
-        #elif defined( M5CORE2 )
-
-        #elif defined( LILYGO_WATCH_2020_V1 ) || defined( LILYGO_WATCH_2020_V2 ) || defined( LILYGO_WATCH_2020_V3 )
-            #if defined( LILYGO_WATCH_HAS_GPS )
-                TTGOClass *ttgo = TTGOClass::getWatch();
-                ttgo->turnOffGPS();
-            #endif
-        #endif
-    #endif
     gpsctl_enable = false;
+    gpsctl_receiver_power( false );
     gps_data.gpsfix = false;
     gps_data.valid_location = false;
     gps_data.valid_speed = false;
+    gps_data.valid_course = false;
     gps_data.valid_altitude = false;
     gps_data.valid_satellite = false;
     gps_data.satellite_types.gps_satellites = 0;
@@ -485,6 +716,37 @@ bool gpsctl_get_gps_over_ip( void ) {
     return( gpsctl_config.gps_over_ip );
 }
 
+bool gpsctl_get_nmea_parser( void ) {
+#ifdef NATIVE_64BIT
+    return( true );
+#else
+    return( gpsctl_config.nmea_parser );
+#endif
+}
+
+void gpsctl_set_nmea_parser( bool nmea_parser ) {
+    gpsctl_config.nmea_parser = nmea_parser;
+    gpsctl_config.save();
+    gpsctl_send_cb( GPSCTL_UPDATE_CONFIG, NULL );
+}
+
+bool gpsctl_get_duty_cycle( void ) {
+    return( gpsctl_config.duty_cycle );
+}
+
+void gpsctl_set_duty_cycle( bool duty_cycle ) {
+    gpsctl_config.duty_cycle = duty_cycle;
+    gpsctl_config.save();
+    /**
+     * without duty cycle an enabled gps is always powered
+     */
+    if ( gpsctl_enable && !gpsctl_receiver ) {
+        gpsduty_reset();
+        gpsctl_receiver_power( true );
+    }
+    gpsctl_send_cb( GPSCTL_UPDATE_CONFIG, NULL );
+}
+
 void gpsctl_set_gps_rx_tx_pin( int8_t rx, int8_t tx ) {
     gpsctl_config.RXPin = rx;
     gpsctl_config.TXPin = tx;
@@ -527,6 +789,7 @@ void gpsctl_set_location( double lat, double lon, double altitude, gps_source_t
     }
     gps_data.valid_location = true;
     gps_data.valid_speed = false;
+    gps_data.valid_course = false;
     gps_data.valid_satellite = false;
     gps_data.valid_altitude = true;
     gps_data.lat = lat;
@@ -537,6 +800,13 @@ void gpsctl_set_location( double lat, double lon, double altitude, gps_source_t
      */
     gpsctl_send_cb( GPSCTL_UPDATE_LOCATION, (void*)&gps_data );
     gpsctl_send_cb( GPSCTL_UPDATE_ALTITUDE, (void*)&gps_data );
+    /*
+     * a set location is no noisy fix, restart the filter right there
+     */
+    gpsfuse_reset();
+    if ( gpsfuse_update( &gps_data ) ) {
+        gpsctl_send_cb( GPSCTL_UPDATE_FUSED, (void*)gpsfuse_get() );
+    }
     /*
      * send SET_APP_LOCATION if enabled
      */
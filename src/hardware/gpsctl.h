@@ -46,6 +46,7 @@
     #define GPSCTL_UPDATE_SATELLITE_TYPE    _BV(11)        /** @brief event mask for GPS satellite type update*/
     #define GPSCTL_UPDATE_SOURCE            _BV(12)        /** @brief event mask for GPS source update*/
     #define GPSCTL_UPDATE_CONFIG            _BV(13)        /** @brief event mask for GPS configuration*/
+    #define GPSCTL_UPDATE_FUSED             _BV(14)        /** @brief event mask for a smoothed location update over the change thresholds, arg is a gpsfuse_t pointer */
     /**
      * @brief gps source types
      */
@@ -65,6 +66,7 @@
         bool gpsfix = false;                            /** @brief gps fix flag for internal use */
         bool valid_location = false;                    /** @brief true if location valid */
         bool valid_speed = false;                       /** @brief true if speed valid */
+        bool valid_course = false;                      /** @brief true if course valid */
         bool valid_altitude = false;                    /** @brief true if altitude valid */
         bool valid_satellite = false;                   /** @brief true if satellite valid */
         double lat = 0;                                 /** @brief gps latitude */
@@ -72,6 +74,7 @@
         double speed_mph = 0;                           /** @brief speed in miles per hour */
         double speed_mps = 0;                           /** @brief speed in meter per second */
         double speed_kmh = 0;                           /** @brief speed in kilometers per hour */
+        double course = 0;                              /** @brief course over ground in degree, 0 is north */
         double altitude_feed = 0;                       /** @brief altitude in feed */
         double altitude_meters = 0;                     /** @brief altitude in meter */
         uint32_t satellites = 0;                        /** @brief number of seen satellites */
@@ -127,6 +130,30 @@
      * @param   gps_over_ip true enable, false disable
      */
     void gpsctl_set_gps_over_ip( bool gps_over_ip );
+    /**
+     * @brief get nmea parser config, native always uses the nmea parser
+     * 
+     * @return  true if the builtin nmea parser is used instead of TinyGPS++
+     */
+    bool gpsctl_get_nmea_parser( void );
+    /**
+     * @brief set nmea parser config
+     * 
+     * @param   nmea_parser true use the builtin nmea parser, false use TinyGPS++
+     */
+    void gpsctl_set_nmea_parser( bool nmea_parser );
+    /**
+     * @brief get the motion aware duty cycle config
+     * 
+     * @return  true if the receiver is only powered for the fixes the activity needs
+     */
+    bool gpsctl_get_duty_cycle( void );
+    /**
+     * @brief set the motion aware duty cycle config
+     * 
+     * @param   duty_cycle  true power the receiver by activity, false always on while enabled
+     */
+    void gpsctl_set_duty_cycle( bool duty_cycle );
     /**
      * @brief get gps an standby config
      * 
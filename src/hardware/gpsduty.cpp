@@ -0,0 +1,511 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "gpsduty.h"
+#include "motion.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef NATIVE_64BIT
+    #include <inttypes.h>
+    #include "utils/logging.h"
+    #include "utils/millis.h"
+    #include "utils/nmea/nmea.h"
+#else
+    #include <Arduino.h>
+#endif
+/**
+ * @brief scheduler state, the live one runs on millis(), the native
+ * simulation runs its own on the trace time
+ */
+typedef struct {
+    bool on = true;                         /** @brief true if the receiver should be powered */
+    gpsduty_activity_t activity = GPSDUTY_WALK;     /** @brief activity at the last run */
+    uint64_t last_run = 0;                  /** @brief ms of the last run */
+    uint64_t on_since = 0;                  /** @brief ms of the last power on */
+    uint64_t off_base = 0;                  /** @brief ms the interval counts from while off, last fix or given up search */
+    uint64_t window_fix = 0;                /** @brief ms of the first fix in this on window, 0 if none */
+    uint64_t warm_until = 0;                /** @brief keep the receiver on until ms */
+    uint64_t ephemeris = 0;                 /** @brief ms the receiver was last on long enough for a fresh ephemeris, 0 if never */
+    uint64_t last_fix = 0;                  /** @brief ms of the last fix, 0 if none */
+    double speed = 0;                       /** @brief speed in m/s at the last fix */
+    uint32_t steps = 0;                     /** @brief last step count */
+    uint64_t last_step = 0;                 /** @brief ms of the last step count change, 0 if none */
+    uint32_t cadence_steps = 0;             /** @brief step count at the cadence window start */
+    uint64_t cadence_start = 0;             /** @brief ms of the cadence window start */
+    uint32_t cadence = 0;                   /** @brief steps per minute */
+    gpsduty_stats_t stats;
+} gpsduty_state_t;
+
+static gpsduty_state_t gpsduty_state;
+static const uint32_t gpsduty_interval[ GPSDUTY_ACTIVITY_NUM ] = { GPSDUTY_STILL_INTERVAL, GPSDUTY_WALK_INTERVAL, GPSDUTY_RUN_INTERVAL, GPSDUTY_DRIVE_INTERVAL };
+static const char *gpsduty_activity_name[ GPSDUTY_ACTIVITY_NUM ] = { "still", "walk", "run", "drive" };
+
+static bool gpsduty_bma_event_cb( EventBits_t event, void *arg );
+static void gpsduty_state_reset( gpsduty_state_t *state, uint64_t now );
+static void gpsduty_state_steps( gpsduty_state_t *state, uint64_t now, uint32_t steps );
+static void gpsduty_state_fix( gpsduty_state_t *state, uint64_t now, double speed_mps );
+static bool gpsduty_state_run( gpsduty_state_t *state, uint64_t now );
+#ifdef NATIVE_64BIT
+    static void gpsduty_sim( const char *arg );
+#endif
+
+void gpsduty_setup( void ) {
+    bma_register_cb( BMACTL_STEPCOUNTER, gpsduty_bma_event_cb, "gpsduty" );
+#ifdef NATIVE_64BIT
+    const char *sim = getenv( GPSDUTY_SIM_ENV );
+    if ( sim && *sim ) {
+        gpsduty_sim( sim );
+    }
+#endif
+}
+
+static bool gpsduty_bma_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case BMACTL_STEPCOUNTER:
+            if ( arg ) {
+                gpsduty_state_steps( &gpsduty_state, millis(), *(uint32_t*)arg );
+            }
+            break;
+    }
+    return( true );
+}
+
+void gpsduty_reset( void ) {
+    gpsduty_state_reset( &gpsduty_state, millis() );
+}
+
+bool gpsduty_run( void ) {
+    bool on = gpsduty_state.on;
+    gpsduty_activity_t activity = gpsduty_state.activity;
+
+    gpsduty_state_run( &gpsduty_state, millis() );
+
+    if ( activity != gpsduty_state.activity ) {
+        GPSDUTY_DEBUG_LOG("activity %s, fix interval %ums", gpsduty_activity_name[ gpsduty_state.activity ], gpsduty_interval[ gpsduty_state.activity ] );
+    }
+    if ( on != gpsduty_state.on ) {
+        GPSDUTY_DEBUG_LOG("receiver %s", gpsduty_state.on ? "on" : "off" );
+    }
+    return( gpsduty_state.on );
+}
+
+void gpsduty_fix( double speed_mps ) {
+    gpsduty_state_fix( &gpsduty_state, millis(), speed_mps );
+}
+
+gpsduty_activity_t gpsduty_get_activity( void ) {
+    return( gpsduty_state.activity );
+}
+
+const char *gpsduty_get_activity_str( gpsduty_activity_t activity ) {
+    if ( activity >= GPSDUTY_ACTIVITY_NUM ) {
+        return( "n/a" );
+    }
+    return( gpsduty_activity_name[ activity ] );
+}
+
+gpsduty_stats_t *gpsduty_get_stats( void ) {
+    return( &gpsduty_state.stats );
+}
+
+/**
+ * @brief restart with a powered receiver and a search, keep steps and stats
+ */
+static void gpsduty_state_reset( gpsduty_state_t *state, uint64_t now ) {
+    state->on = true;
+    state->last_run = now;
+    state->on_since = now;
+    state->off_base = now;
+    state->window_fix = 0;
+    state->warm_until = 0;
+    state->last_fix = 0;
+    state->speed = 0;
+}
+
+/**
+ * @brief track the step count and the cadence over GPSDUTY_CADENCE_WINDOW
+ */
+static void gpsduty_state_steps( gpsduty_state_t *state, uint64_t now, uint32_t steps ) {
+    if ( steps == state->steps ) {
+        return;
+    }
+    /**
+     * a counter reset or a pause restarts the cadence window
+     */
+    if ( steps < state->steps || !state->last_step || now - state->last_step > GPSDUTY_STEP_TIMEOUT ) {
+        state->cadence = 0;
+        state->cadence_steps = steps;
+        state->cadence_start = now;
+    }
+    else if ( now - state->cadence_start >= GPSDUTY_CADENCE_WINDOW ) {
+        state->cadence = ( steps - state->cadence_steps ) * 60000ULL / ( now - state->cadence_start );
+        state->cadence_steps = steps;
+        state->cadence_start = now;
+    }
+    state->steps = steps;
+    state->last_step = now;
+}
+
+static void gpsduty_state_fix( gpsduty_state_t *state, uint64_t now, double speed_mps ) {
+    state->last_fix = now;
+    state->speed = speed_mps;
+    state->stats.fixes++;
+    /**
+     * a receiver on for the refresh time has downloaded a fresh ephemeris
+     */
+    if ( state->on && now - state->on_since >= GPSDUTY_EPHEMERIS_TIME ) {
+        state->ephemeris = now;
+    }
+    /**
+     * the first fix of a window opens the keep warm window, a long one
+     * if the ephemeris gets old so the next fixes stay hot starts
+     */
+    if ( !state->window_fix ) {
+        state->window_fix = now;
+        if ( !state->ephemeris || now - state->ephemeris >= GPSDUTY_EPHEMERIS_AGE ) {
+            state->warm_until = now + GPSDUTY_EPHEMERIS_TIME;
+            state->stats.refresh++;
+        }
+        else {
+            state->warm_until = now + GPSDUTY_WARM_TIME;
+        }
+    }
+}
+
+static gpsduty_activity_t gpsduty_state_activity( gpsduty_state_t *state, uint64_t now ) {
+    if ( state->last_step && now - state->last_step < GPSDUTY_STEP_TIMEOUT ) {
+        return( state->cadence >= GPSDUTY_RUN_CADENCE ? GPSDUTY_RUN : GPSDUTY_WALK );
+    }
+    if ( state->last_fix && state->speed >= GPSDUTY_DRIVE_SPEED ) {
+        return( GPSDUTY_DRIVE );
+    }
+    if ( state->last_fix && state->speed >= GPSDUTY_STILL_SPEED ) {
+        return( GPSDUTY_WALK );
+    }
+    return( state->last_fix ? GPSDUTY_STILL : GPSDUTY_WALK );
+}
+
+static bool gpsduty_state_run( gpsduty_state_t *state, uint64_t now ) {
+    uint64_t elapsed = now - state->last_run;
+
+    state->last_run = now;
+    state->stats.activity_time[ state->activity ] += elapsed;
+    if ( state->on ) {
+        state->stats.on_time += elapsed;
+    }
+    state->activity = gpsduty_state_activity( state, now );
+    uint32_t interval = gpsduty_interval[ state->activity ];
+
+    if ( state->on ) {
+        /**
+         * short intervals keep the receiver on, otherwise go off after the
+         * keep warm window or a given up search
+         */
+        if ( interval <= GPSDUTY_CONTINUOUS ) {
+            return( true );
+        }
+        if ( state->window_fix && now >= state->warm_until ) {
+            state->on = false;
+            state->off_base = state->last_fix;
+        }
+        else if ( !state->window_fix && now - state->on_since >= GPSDUTY_FIX_TIMEOUT ) {
+            state->on = false;
+            state->off_base = now;
+            state->stats.timeouts++;
+        }
+    }
+    /**
+     * a motion change shortens the interval of a running off time
+     */
+    else if ( interval <= GPSDUTY_CONTINUOUS || now >= state->off_base + interval ) {
+        state->on = true;
+        state->on_since = now;
+        state->window_fix = 0;
+        state->stats.power_on++;
+    }
+    return( state->on );
+}
+
+#ifdef NATIVE_64BIT
+#define GPSDUTY_M_PER_DEG           111319.49       /** @brief meters per degree latitude */
+/**
+ * @brief simulated receiver on a trace, the trace is what an always on
+ * receiver has seen, one line per event:
+ *
+ *  <ms> steps <step count>
+ *  <ms> $GPRMC,...*hh
+ */
+typedef struct {
+    gpsduty_state_t duty;                   /** @brief scheduler under test */
+    bool always_on = false;                 /** @brief baseline without duty cycling */
+    bool started = false;                   /** @brief true after the first trace line */
+    bool on = false;                        /** @brief simulated receiver power */
+    uint64_t on_since = 0;                  /** @brief ms of the last power on */
+    uint64_t ephemeris = 0;                 /** @brief ms of the last ephemeris download, 0 if none */
+    uint64_t start = 0;                     /** @brief ms of the first trace line */
+    uint64_t end = 0;                       /** @brief ms of the last trace line */
+    bool fix = false;                       /** @brief true if a fix was delivered */
+    double fix_lat = 0;                     /** @brief last delivered latitude */
+    double fix_lon = 0;                     /** @brief last delivered longitude */
+    uint32_t fixes = 0;                     /** @brief delivered fixes */
+    uint32_t power_on = 0;                  /** @brief receiver power ons */
+    uint64_t on_time = 0;                   /** @brief receiver on time in ms */
+    uint32_t seconds = 0;                   /** @brief truth positions in the trace */
+    uint32_t covered = 0;                   /** @brief truth positions closer than GPSDUTY_SIM_COVERAGE to the last fix */
+    double error_sum = 0;                   /** @brief sum of the distances to the last fix */
+    double error_max = 0;                   /** @brief max distance to the last fix */
+} gpsduty_sim_t;
+/**
+ * @brief synthetic trace, a day in phases
+ */
+typedef struct {
+    uint32_t seconds;                       /** @brief phase length */
+    double speed;                           /** @brief speed in m/s */
+    uint32_t cadence;                       /** @brief steps per minute */
+} gpsduty_sim_phase_t;
+
+static const gpsduty_sim_phase_t gpsduty_sim_phases[] = {
+    { 1800, 0.0, 0 },                       /** @brief at the desk */
+    { 1200, 1.4, 110 },                     /** @brief walk */
+    { 900, 3.0, 165 },                      /** @brief run */
+    { 1200, 0.0, 0 },                       /** @brief rest */
+    { 900, 14.0, 0 },                       /** @brief drive */
+    { 600, 1.4, 105 }                       /** @brief walk */
+};
+
+typedef struct {
+    uint32_t phase = 0;                     /** @brief current phase */
+    uint32_t second = 0;                    /** @brief second in the phase */
+    uint32_t epoch = 0;                     /** @brief second in the trace */
+    bool rmc_pending = false;               /** @brief the RMC of this second is next */
+    double lat = 52.52;
+    double lon = 13.405;
+    double course = 45.0;
+    double steps = 0;
+} gpsduty_synth_t;
+
+/**
+ * @brief format a coordinate as NMEA (d)ddmm.mmmmm,H
+ */
+static void gpsduty_sim_coord( char *buf, size_t size, double value, int degree_digits, char positive, char negative ) {
+    double absolute = fabs( value );
+    int degree = (int)absolute;
+    double minutes = ( absolute - degree ) * 60.0;
+
+    snprintf( buf, size, "%0*d%08.5f,%c", degree_digits, degree, minutes, value < 0 ? negative : positive );
+}
+
+/**
+ * @brief next synthetic trace line, a step count every 5s while walking or
+ * running and a RMC every second
+ */
+static bool gpsduty_sim_synth_line( gpsduty_synth_t *synth, char *line, size_t size ) {
+    char body[ GPSDUTY_SIM_LINE_SIZE ], lat[ 16 ], lon[ 16 ];
+    uint8_t checksum = 0;
+
+    if ( synth->phase >= sizeof( gpsduty_sim_phases ) / sizeof( gpsduty_sim_phases[ 0 ] ) ) {
+        return( false );
+    }
+    const gpsduty_sim_phase_t *phase = &gpsduty_sim_phases[ synth->phase ];
+    uint64_t time = synth->epoch * 1000ULL;
+
+    if ( !synth->rmc_pending ) {
+        synth->rmc_pending = true;
+        synth->steps += phase->cadence / 60.0;
+        if ( phase->cadence && synth->second % 5 == 0 ) {
+            snprintf( line, size, "%" PRIu64 " steps %u", time, (uint32_t)synth->steps );
+            return( true );
+        }
+    }
+    synth->rmc_pending = false;
+    /**
+     * move one second along a slowly wiggling course
+     */
+    double course = fmod( synth->course + 30.0 * sin( synth->epoch / 90.0 ) + 360.0, 360.0 );
+    synth->lat += phase->speed * cos( course * M_PI / 180.0 ) / GPSDUTY_M_PER_DEG;
+    synth->lon += phase->speed * sin( course * M_PI / 180.0 ) / ( GPSDUTY_M_PER_DEG * cos( synth->lat * M_PI / 180.0 ) );
+    gpsduty_sim_coord( lat, sizeof( lat ), synth->lat, 2, 'N', 'S' );
+    gpsduty_sim_coord( lon, sizeof( lon ), synth->lon, 3, 'E', 'W' );
+
+    uint32_t seconds = ( 8 * 3600 + synth->epoch ) % 86400;
+    snprintf( body, sizeof( body ), "GPRMC,%02u%02u%02u.00,A,%s,%s,%.2f,%.1f,181026,,,A", seconds / 3600, seconds / 60 % 60, seconds % 60, lat, lon, phase->speed * 3600.0 / 1852.0, course );
+    for( const char *c = body ; *c ; c++ ) {
+        checksum ^= *c;
+    }
+    snprintf( line, size, "%" PRIu64 " $%s*%02X", time, body, checksum );
+
+    synth->epoch++;
+    if ( ++synth->second >= phase->seconds ) {
+        synth->second = 0;
+        synth->phase++;
+    }
+    return( true );
+}
+
+/**
+ * @brief run one trace line through the scheduler and the simulated receiver
+ */
+static void gpsduty_sim_line( gpsduty_sim_t *sim, const char *line ) {
+    uint64_t time = 0;
+    int pos = 0;
+    nmea_sentence_t sentence;
+
+    if ( line[ 0 ] == '#' || line[ 0 ] == '\n' || line[ 0 ] == '\r' || line[ 0 ] == '\0' ) {
+        return;
+    }
+    if ( sscanf( line, "%" SCNu64 " %n", &time, &pos ) < 1 || !pos ) {
+        GPSDUTY_ERROR_LOG("malformed trace line: %s", line );
+        return;
+    }
+    if ( !sim->started ) {
+        sim->started = true;
+        sim->start = time;
+        sim->end = time;
+        gpsduty_state_reset( &sim->duty, time );
+    }
+    /**
+     * power the simulated receiver like gpsctl
+     */
+    if ( sim->on ) {
+        sim->on_time += time - sim->end;
+    }
+    sim->end = time;
+    bool on = sim->always_on ? true : gpsduty_state_run( &sim->duty, time );
+    if ( on && !sim->on ) {
+        sim->on_since = time;
+        sim->power_on++;
+    }
+    sim->on = on;
+
+    const char *event = line + pos;
+    if ( !strncmp( event, "steps ", 6 ) ) {
+        gpsduty_state_steps( &sim->duty, time, strtoul( event + 6, NULL, 10 ) );
+        return;
+    }
+    if ( nmea_parse( event, strcspn( event, "\r\n" ), &sentence ) != NMEA_RMC || !sentence.rmc.valid ) {
+        return;
+    }
+    /**
+     * the trace position is the truth, a powered receiver delivers it after
+     * the time to first fix, a hot one with a valid ephemeris
+     */
+    sim->seconds++;
+    if ( sim->on ) {
+        bool hot = sim->ephemeris && time - sim->ephemeris < GPSDUTY_SIM_EPHEMERIS_VALID;
+        if ( time - sim->on_since >= ( hot ? GPSDUTY_SIM_HOT_TTFF : GPSDUTY_SIM_WARM_TTFF ) ) {
+            if ( time - sim->on_since >= GPSDUTY_SIM_WARM_TTFF ) {
+                sim->ephemeris = time;
+            }
+            sim->fix = true;
+            sim->fix_lat = sentence.rmc.lat;
+            sim->fix_lon = sentence.rmc.lon;
+            sim->fixes++;
+            if ( !sim->always_on ) {
+                gpsduty_state_fix( &sim->duty, time, isnan( sentence.rmc.speed ) ? 0 : sentence.rmc.speed * 0.51444444 );
+            }
+        }
+    }
+    if ( sim->fix ) {
+        double dx = ( sim->fix_lon - sentence.rmc.lon ) * GPSDUTY_M_PER_DEG * cos( sentence.rmc.lat * M_PI / 180.0 );
+        double dy = ( sim->fix_lat - sentence.rmc.lat ) * GPSDUTY_M_PER_DEG;
+        double error = sqrt( dx * dx + dy * dy );
+        sim->error_sum += error;
+        if ( error > sim->error_max ) {
+            sim->error_max = error;
+        }
+        if ( error <= GPSDUTY_SIM_COVERAGE ) {
+            sim->covered++;
+        }
+    }
+}
+
+/**
+ * @brief run a trace file or the synthetic trace and log fixes per hour and coverage
+ *
+ * @param   path        trace file, NULL for the synthetic trace
+ * @param   always_on   true for the baseline without duty cycling
+ */
+static void gpsduty_sim_run( const char *path, bool always_on ) {
+    char line[ GPSDUTY_SIM_LINE_SIZE ];
+    gpsduty_sim_t sim_state;
+    gpsduty_sim_t *sim = &sim_state;
+    gpsduty_synth_t synth;
+    FILE *file = NULL;
+
+    sim->always_on = always_on;
+    if ( path ) {
+        file = fopen( path, "r" );
+        if ( !file ) {
+            GPSDUTY_ERROR_LOG("can't open trace %s", path );
+            return;
+        }
+        while( fgets( line, sizeof( line ), file ) ) {
+            gpsduty_sim_line( sim, line );
+        }
+        fclose( file );
+    }
+    else {
+        while( gpsduty_sim_synth_line( &synth, line, sizeof( line ) ) ) {
+            gpsduty_sim_line( sim, line );
+        }
+    }
+
+    double hours = ( sim->end - sim->start ) / 3600000.0;
+    if ( !sim->seconds || hours <= 0 ) {
+        GPSDUTY_ERROR_LOG("no RMC in trace %s", path ? path : "synth" );
+        return;
+    }
+    GPSDUTY_INFO_LOG("duty sim %s %s: %.2fh, %.0f fixes/h, receiver on %.1f%%, %u power ons, coverage %.1f%% (<%.0fm), mean error %.1fm, max error %.1fm",
+                        path ? path : "synth",
+                        always_on ? "always on" : "duty cycle",
+                        hours,
+                        sim->fixes / hours,
+                        sim->on_time * 100.0 / ( sim->end - sim->start ),
+                        sim->power_on,
+                        sim->covered * 100.0 / sim->seconds,
+                        GPSDUTY_SIM_COVERAGE,
+                        sim->error_sum / sim->seconds,
+                        sim->error_max );
+    if ( !always_on ) {
+        gpsduty_stats_t *stats = &sim->duty.stats;
+        uint64_t total = sim->end - sim->start;
+        GPSDUTY_INFO_LOG("  still %.1f%% walk %.1f%% run %.1f%% drive %.1f%%, %u timeouts, %u ephemeris refresh",
+                            stats->activity_time[ GPSDUTY_STILL ] * 100.0 / total,
+                            stats->activity_time[ GPSDUTY_WALK ] * 100.0 / total,
+                            stats->activity_time[ GPSDUTY_RUN ] * 100.0 / total,
+                            stats->activity_time[ GPSDUTY_DRIVE ] * 100.0 / total,
+                            stats->timeouts,
+                            stats->refresh );
+    }
+}
+
+static void gpsduty_sim( const char *arg ) {
+    const char *path = strcmp( arg, "synth" ) ? arg : NULL;
+
+    gpsduty_sim_run( path, true );
+    gpsduty_sim_run( path, false );
+}
+#endif
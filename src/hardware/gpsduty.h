@@ -0,0 +1,113 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _GPSDUTY_H
+    #define _GPSDUTY_H
+
+    #include "gpsctl.h"
+
+    #define GPSDUTY_INFO_LOG                log_i
+    #define GPSDUTY_DEBUG_LOG               log_d
+    #define GPSDUTY_ERROR_LOG               log_e
+
+    #define GPSDUTY_RUN_CADENCE             140         /** @brief steps per minute from are running */
+    #define GPSDUTY_CADENCE_WINDOW          20000       /** @brief ms to average the step cadence over */
+    #define GPSDUTY_STEP_TIMEOUT            30000       /** @brief ms after the last step count change that still count as walking */
+    #define GPSDUTY_STILL_SPEED             0.6         /** @brief speed in m/s below is stationary if no steps */
+    #define GPSDUTY_DRIVE_SPEED             4.0         /** @brief speed in m/s from without steps is a vehicle */
+    #define GPSDUTY_STILL_INTERVAL          300000      /** @brief fix interval in ms when stationary */
+    #define GPSDUTY_WALK_INTERVAL           15000       /** @brief fix interval in ms when walking */
+    #define GPSDUTY_RUN_INTERVAL            1000        /** @brief fix interval in ms when running */
+    #define GPSDUTY_DRIVE_INTERVAL          1000        /** @brief fix interval in ms in a vehicle */
+    #define GPSDUTY_CONTINUOUS              10000       /** @brief intervals up to ms keep the receiver on, a power cycle costs more */
+    #define GPSDUTY_WARM_TIME               3000        /** @brief keep the receiver on after the first fix of a window in ms */
+    #define GPSDUTY_EPHEMERIS_AGE           1800000     /** @brief refresh the ephemeris after ms, keeps the next fixes hot */
+    #define GPSDUTY_EPHEMERIS_TIME          30000       /** @brief keep the receiver on for ms to refresh the ephemeris */
+    #define GPSDUTY_FIX_TIMEOUT             60000       /** @brief give up a fix search after ms and retry after the interval */
+    #define GPSDUTY_SIM_ENV                 "HEDGE_GPSDUTY_SIM"     /** @brief env var with a motion+NMEA trace file or "synth" for the native simulation */
+    #define GPSDUTY_SIM_LINE_SIZE           160         /** @brief max trace line length */
+    #define GPSDUTY_SIM_HOT_TTFF            2000        /** @brief simulated time to first fix in ms with a valid ephemeris */
+    #define GPSDUTY_SIM_WARM_TTFF           32000       /** @brief simulated time to first fix in ms without */
+    #define GPSDUTY_SIM_EPHEMERIS_VALID     7200000     /** @brief simulated ephemeris lifetime in ms */
+    #define GPSDUTY_SIM_COVERAGE            50.0        /** @brief a trace second is covered if the last fix is closer in m */
+    /**
+     * @brief activity, selects the fix interval
+     */
+    typedef enum {
+        GPSDUTY_STILL = 0,                      /** @brief no steps and no speed */
+        GPSDUTY_WALK,                           /** @brief steps or a slow speed */
+        GPSDUTY_RUN,                            /** @brief steps with a running cadence */
+        GPSDUTY_DRIVE,                          /** @brief speed without steps, bike or car */
+        GPSDUTY_ACTIVITY_NUM
+    } gpsduty_activity_t;
+    /**
+     * @brief duty cycle statistics
+     */
+    typedef struct {
+        uint32_t fixes = 0;                     /** @brief fixes while duty cycling */
+        uint32_t power_on = 0;                  /** @brief receiver power ons */
+        uint32_t timeouts = 0;                  /** @brief searches without a fix in GPSDUTY_FIX_TIMEOUT */
+        uint32_t refresh = 0;                   /** @brief long on windows to refresh the ephemeris */
+        uint64_t on_time = 0;                   /** @brief receiver on time in ms */
+        uint64_t activity_time[ GPSDUTY_ACTIVITY_NUM ] = { 0 };   /** @brief time per activity in ms */
+    } gpsduty_stats_t;
+    /**
+     * @brief setup the duty cycle scheduler, hooks into the step counter
+     */
+    void gpsduty_setup( void );
+    /**
+     * @brief restart the scheduler with a powered receiver, e.g. on gps enable
+     */
+    void gpsduty_reset( void );
+    /**
+     * @brief run the scheduler, call it from the gpsctl loop
+     *
+     * @return  true if the receiver should be powered
+     */
+    bool gpsduty_run( void );
+    /**
+     * @brief inform the scheduler about a new fix
+     *
+     * @param   speed_mps   speed over ground in m/s, 0 if not valid
+     */
+    void gpsduty_fix( double speed_mps );
+    /**
+     * @brief get the current activity
+     *
+     * @return  gpsduty_activity_t
+     */
+    gpsduty_activity_t gpsduty_get_activity( void );
+    /**
+     * @brief get the activity name
+     *
+     * @param   activity    gpsduty_activity_t
+     *
+     * @return  pointer to a const char string
+     */
+    const char *gpsduty_get_activity_str( gpsduty_activity_t activity );
+    /**
+     * @brief get the duty cycle statistics
+     *
+     * @return  pointer to a gpsduty_stats_t structure
+     */
+    gpsduty_stats_t *gpsduty_get_stats( void );
+
+#endif // _GPSDUTY_H
@@ -0,0 +1,353 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "gpsfuse.h"
+#include "motion.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef NATIVE_64BIT
+    #include <time.h>
+    #include "utils/logging.h"
+    #include "utils/millis.h"
+#else
+    #include <Arduino.h>
+#endif
+
+#define GPSFUSE_M_PER_DEG           111319.49       /** @brief meters per degree latitude */
+#define GPSFUSE_REANCHOR            10000.0         /** @brief move the local frame origin after m */
+/**
+ * @brief a constant velocity kalman filter in a local east/north frame,
+ * both axes get the same measurements and share one covariance
+ */
+typedef struct {
+    bool init = false;                      /** @brief true after the first fix */
+    double lat0 = 0;                        /** @brief local frame origin latitude */
+    double lon0 = 0;                        /** @brief local frame origin longitude */
+    double scale = 0;                       /** @brief meters per degree longitude at the origin */
+    double x = 0;                           /** @brief east in m */
+    double y = 0;                           /** @brief north in m */
+    double vx = 0;                          /** @brief east velocity in m/s */
+    double vy = 0;                          /** @brief north velocity in m/s */
+    double pp = 0;                          /** @brief position variance */
+    double pv = 0;                          /** @brief position/velocity covariance */
+    double vv = 0;                          /** @brief velocity variance */
+    uint64_t last = 0;                      /** @brief ms of the last fix */
+} gpsfuse_filter_t;
+
+static gpsfuse_filter_t gpsfuse_filter;
+static gpsfuse_t gpsfuse;                                           /** @brief latest fused location */
+static gpsfuse_t gpsfuse_published;                                 /** @brief last published fused location */
+static gpsfuse_stats_t gpsfuse_stats;
+static uint64_t gpsfuse_last_step = 0;                              /** @brief ms of the last step count change, 0 if none */
+static uint32_t gpsfuse_steps = 0;
+
+static bool gpsfuse_bma_event_cb( EventBits_t event, void *arg );
+static bool gpsfuse_fix( double lat, double lon, bool valid_speed, double speed, bool valid_course, double course, uint64_t now );
+#ifdef NATIVE_64BIT
+    static void gpsfuse_bench( const char *arg );
+#endif
+
+void gpsfuse_setup( void ) {
+    bma_register_cb( BMACTL_STEPCOUNTER, gpsfuse_bma_event_cb, "gpsfuse" );
+#ifdef NATIVE_64BIT
+    const char *bench = getenv( GPSFUSE_BENCH_ENV );
+    if ( bench && *bench ) {
+        gpsfuse_bench( bench );
+    }
+#endif
+}
+
+static bool gpsfuse_bma_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case BMACTL_STEPCOUNTER:
+            /**
+             * a changed step count means walking, it's no stationary
+             */
+            if ( arg && *(uint32_t*)arg != gpsfuse_steps ) {
+                gpsfuse_steps = *(uint32_t*)arg;
+                gpsfuse_last_step = millis();
+            }
+            break;
+    }
+    return( true );
+}
+
+void gpsfuse_reset( void ) {
+    gpsfuse_filter = gpsfuse_filter_t();
+    gpsfuse = gpsfuse_t();
+    gpsfuse_published = gpsfuse_t();
+}
+
+gpsfuse_t *gpsfuse_get( void ) {
+    return( &gpsfuse );
+}
+
+gpsfuse_stats_t *gpsfuse_get_stats( void ) {
+    return( &gpsfuse_stats );
+}
+
+bool gpsfuse_update( gps_data_t *gps_data ) {
+    if ( !gps_data || !gps_data->valid_location ) {
+        return( false );
+    }
+    return( gpsfuse_fix( gps_data->lat, gps_data->lon, gps_data->valid_speed, gps_data->speed_mps, gps_data->valid_course, gps_data->course, millis() ) );
+}
+
+/**
+ * @brief start the filter at a fix
+ */
+static void gpsfuse_init( double lat, double lon, uint64_t now ) {
+    gpsfuse_filter = gpsfuse_filter_t();
+    gpsfuse_filter.init = true;
+    gpsfuse_filter.lat0 = lat;
+    gpsfuse_filter.lon0 = lon;
+    gpsfuse_filter.scale = GPSFUSE_M_PER_DEG * cos( lat * M_PI / 180.0 );
+    gpsfuse_filter.pp = GPSFUSE_GPS_SIGMA * GPSFUSE_GPS_SIGMA;
+    gpsfuse_filter.vv = 4.0;
+    gpsfuse_filter.last = now;
+}
+
+/**
+ * @brief a scalar position measurement for both axes
+ */
+static void gpsfuse_update_position( double zx, double zy, double r ) {
+    gpsfuse_filter_t *f = &gpsfuse_filter;
+    double s = f->pp + r;
+    double kp = f->pp / s;
+    double kv = f->pv / s;
+
+    double ex = zx - f->x, ey = zy - f->y;
+    f->x += kp * ex;
+    f->y += kp * ey;
+    f->vx += kv * ex;
+    f->vy += kv * ey;
+
+    f->vv -= kv * f->pv;
+    f->pv *= 1.0 - kp;
+    f->pp *= 1.0 - kp;
+}
+
+/**
+ * @brief a scalar velocity measurement for both axes
+ */
+static void gpsfuse_update_velocity( double zvx, double zvy, double r ) {
+    gpsfuse_filter_t *f = &gpsfuse_filter;
+    double s = f->vv + r;
+    double kp = f->pv / s;
+    double kv = f->vv / s;
+
+    double ex = zvx - f->vx, ey = zvy - f->vy;
+    f->x += kp * ex;
+    f->y += kp * ey;
+    f->vx += kv * ex;
+    f->vy += kv * ey;
+
+    f->pp -= kp * f->pv;
+    f->pv *= 1.0 - kv;
+    f->vv *= 1.0 - kv;
+}
+
+static bool gpsfuse_fix( double lat, double lon, bool valid_speed, double speed, bool valid_course, double course, uint64_t now ) {
+    gpsfuse_filter_t *f = &gpsfuse_filter;
+
+    gpsfuse_stats.fixes++;
+    /**
+     * start over on the first fix or after a gap
+     */
+    if ( !f->init || now - f->last > GPSFUSE_RESET_TIME ) {
+        if ( f->init ) {
+            gpsfuse_stats.resets++;
+        }
+        gpsfuse_init( lat, lon, now );
+    }
+    /**
+     * predict with constant velocity
+     */
+    double dt = ( now - f->last ) / 1000.0;
+    double q = GPSFUSE_ACCEL_NOISE;
+    f->last = now;
+    f->x += f->vx * dt;
+    f->y += f->vy * dt;
+    f->pp += 2.0 * dt * f->pv + dt * dt * f->vv + q * dt * dt * dt / 3.0;
+    f->pv += dt * f->vv + q * dt * dt / 2.0;
+    f->vv += q * dt;
+    /**
+     * a jump far outside the noise starts over, e.g. after a tunnel
+     */
+    double zx = ( lon - f->lon0 ) * f->scale;
+    double zy = ( lat - f->lat0 ) * GPSFUSE_M_PER_DEG;
+    if ( hypot( zx - f->x, zy - f->y ) > GPSFUSE_RESET_DISTANCE ) {
+        gpsfuse_stats.resets++;
+        gpsfuse_init( lat, lon, now );
+        zx = zy = 0;
+    }
+    gpsfuse_update_position( zx, zy, GPSFUSE_GPS_SIGMA * GPSFUSE_GPS_SIGMA );
+    /**
+     * no steps and a slow gps speed is stationary, a zero velocity pins the
+     * position, the doppler velocity is better than the position derivation
+     */
+    bool walking = gpsfuse_last_step && now - gpsfuse_last_step < GPSFUSE_STEP_TIMEOUT;
+    bool stationary = !walking && valid_speed && speed < GPSFUSE_STILL_SPEED;
+    if ( stationary ) {
+        gpsfuse_stats.stationary++;
+        gpsfuse_update_velocity( 0, 0, GPSFUSE_STILL_SIGMA * GPSFUSE_STILL_SIGMA );
+    }
+    else if ( valid_speed && valid_course && speed >= GPSFUSE_COURSE_SPEED ) {
+        double rad = course * M_PI / 180.0;
+        gpsfuse_update_velocity( speed * sin( rad ), speed * cos( rad ), GPSFUSE_SPEED_SIGMA * GPSFUSE_SPEED_SIGMA );
+    }
+    /**
+     * keep the local frame small
+     */
+    if ( hypot( f->x, f->y ) > GPSFUSE_REANCHOR ) {
+        f->lat0 += f->y / GPSFUSE_M_PER_DEG;
+        f->lon0 += f->x / f->scale;
+        f->scale = GPSFUSE_M_PER_DEG * cos( f->lat0 * M_PI / 180.0 );
+        f->x = f->y = 0;
+    }
+    /**
+     * fused location
+     */
+    double fused_speed = hypot( f->vx, f->vy );
+    gpsfuse.valid = true;
+    gpsfuse.stationary = stationary;
+    gpsfuse.lat = f->lat0 + f->y / GPSFUSE_M_PER_DEG;
+    gpsfuse.lon = f->lon0 + f->x / f->scale;
+    gpsfuse.speed_mps = stationary ? 0 : fused_speed;
+    gpsfuse.valid_course = !stationary && fused_speed >= GPSFUSE_COURSE_SPEED;
+    if ( gpsfuse.valid_course ) {
+        gpsfuse.course = fmod( atan2( f->vx, f->vy ) * 180.0 / M_PI + 360.0, 360.0 );
+    }
+    gpsfuse.accuracy = sqrt( f->pp );
+    /**
+     * publish only changes that matter for a redraw
+     */
+    gpsfuse_t *last = &gpsfuse_published;
+    bool publish = !last->valid || last->stationary != gpsfuse.stationary;
+    if ( !publish ) {
+        double dx = ( gpsfuse.lon - last->lon ) * f->scale;
+        double dy = ( gpsfuse.lat - last->lat ) * GPSFUSE_M_PER_DEG;
+        double dc = fabs( fmod( gpsfuse.course - last->course + 540.0, 360.0 ) - 180.0 );
+        publish = hypot( dx, dy ) > GPSFUSE_MIN_DISTANCE
+               || fabs( gpsfuse.speed_mps - last->speed_mps ) > GPSFUSE_MIN_SPEED
+               || gpsfuse.valid_course != last->valid_course
+               || ( gpsfuse.valid_course && dc > GPSFUSE_MIN_COURSE );
+    }
+    if ( publish ) {
+        gpsfuse_published = gpsfuse;
+        gpsfuse_stats.published++;
+    }
+    return( publish );
+}
+
+#ifdef NATIVE_64BIT
+static uint64_t gpsfuse_bench_now( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec );
+}
+
+/**
+ * @brief gaussian noise from a xorshift, repeatable between runs
+ */
+static double gpsfuse_bench_noise( uint32_t *seed ) {
+    double u[ 2 ];
+
+    for( int i = 0 ; i < 2 ; i++ ) {
+        *seed ^= *seed << 13;
+        *seed ^= *seed >> 17;
+        *seed ^= *seed << 5;
+        u[ i ] = ( *seed + 1.0 ) / 4294967297.0;
+    }
+    return( sqrt( -2.0 * log( u[ 0 ] ) ) * cos( 2.0 * M_PI * u[ 1 ] ) );
+}
+
+/**
+ * @brief run a scenario with known truth and added gps noise through the
+ * filter, log the errors and the published updates against the fixes
+ *
+ * @param   name    scenario name
+ * @param   seconds scenario length, one fix per second
+ * @param   speed   speed in m/s, 0 for stationary
+ * @param   turn    course change in degree per second, as a slow sine
+ * @param   stop    stop for 30s every stop seconds, 0 for never
+ */
+static void gpsfuse_bench_scenario( const char *name, uint32_t seconds, double speed, double turn, uint32_t stop ) {
+    double lat = 52.52, lon = 13.405, course = 45.0;
+    double raw_error = 0, fused_error = 0, max_fused_error = 0;
+    uint64_t time = 0;
+    uint32_t seed = 0x12345678;
+
+    gpsfuse_reset();
+    gpsfuse_stats = gpsfuse_stats_t();
+
+    for( uint32_t t = 0 ; t < seconds ; t++ ) {
+        double scale = GPSFUSE_M_PER_DEG * cos( lat * M_PI / 180.0 );
+        double v = stop && t % stop >= stop - 30 ? 0 : speed;
+        /**
+         * move the truth, then measure it with noise
+         */
+        course = fmod( course + turn * sin( t / 40.0 ) + 360.0, 360.0 );
+        lat += v * cos( course * M_PI / 180.0 ) / GPSFUSE_M_PER_DEG;
+        lon += v * sin( course * M_PI / 180.0 ) / scale;
+        double nx = GPSFUSE_BENCH_NOISE * gpsfuse_bench_noise( &seed );
+        double ny = GPSFUSE_BENCH_NOISE * gpsfuse_bench_noise( &seed );
+        double measured_speed = fabs( v + 0.2 * gpsfuse_bench_noise( &seed ) );
+        double measured_course = fmod( course + 5.0 * gpsfuse_bench_noise( &seed ) + 360.0, 360.0 );
+
+        uint64_t start = gpsfuse_bench_now();
+        gpsfuse_fix( lat + ny / GPSFUSE_M_PER_DEG, lon + nx / scale, true, measured_speed, true, measured_course, t * 1000ULL );
+        time += gpsfuse_bench_now() - start;
+
+        double ex = ( gpsfuse.lon - lon ) * scale;
+        double ey = ( gpsfuse.lat - lat ) * GPSFUSE_M_PER_DEG;
+        double error = ex * ex + ey * ey;
+        raw_error += nx * nx + ny * ny;
+        fused_error += error;
+        if ( error > max_fused_error ) {
+            max_fused_error = error;
+        }
+    }
+    GPSFUSE_INFO_LOG("fuse bench %s: %u fixes, rms error raw %.2fm fused %.2fm, max fused %.2fm, %u published (%.1f%%), %u stationary, %u resets, %.0fns per fix",
+                        name, seconds,
+                        sqrt( raw_error / seconds ),
+                        sqrt( fused_error / seconds ),
+                        sqrt( max_fused_error ),
+                        gpsfuse_stats.published,
+                        gpsfuse_stats.published * 100.0 / seconds,
+                        gpsfuse_stats.stationary,
+                        gpsfuse_stats.resets,
+                        (double)time / seconds );
+}
+
+static void gpsfuse_bench( const char *arg ) {
+    gpsfuse_bench_scenario( "stationary", 3600, 0, 0, 0 );
+    gpsfuse_bench_scenario( "walk", 3600, 1.4, 3.0, 300 );
+    gpsfuse_bench_scenario( "drive", 3600, 14.0, 2.0, 600 );
+    gpsfuse_reset();
+    gpsfuse_stats = gpsfuse_stats_t();
+}
+#endif
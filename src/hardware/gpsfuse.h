@@ -0,0 +1,96 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _GPSFUSE_H
+    #define _GPSFUSE_H
+
+    #include "gpsctl.h"
+
+    #define GPSFUSE_INFO_LOG                log_i
+    #define GPSFUSE_DEBUG_LOG               log_d
+    #define GPSFUSE_ERROR_LOG               log_e
+
+    #define GPSFUSE_GPS_SIGMA               5.0         /** @brief gps position noise in m, 1 sigma */
+    #define GPSFUSE_SPEED_SIGMA             0.5         /** @brief gps doppler velocity noise in m/s, 1 sigma */
+    #define GPSFUSE_ACCEL_NOISE             0.5         /** @brief process noise, acceleration spectral density in m^2/s^3 */
+    #define GPSFUSE_STILL_SIGMA             0.05        /** @brief zero velocity noise in m/s when stationary */
+    #define GPSFUSE_STILL_SPEED             0.6         /** @brief gps speed in m/s below is stationary if no steps */
+    #define GPSFUSE_COURSE_SPEED            1.0         /** @brief min speed in m/s for a valid course */
+    #define GPSFUSE_STEP_TIMEOUT            10000       /** @brief ms after the last step count change that still count as walking */
+    #define GPSFUSE_RESET_DISTANCE          200.0       /** @brief reset the filter on a jump in m */
+    #define GPSFUSE_RESET_TIME              10000       /** @brief reset the filter after ms without a fix */
+    #define GPSFUSE_MIN_DISTANCE            3.0         /** @brief publish after a position change in m */
+    #define GPSFUSE_MIN_SPEED               0.5         /** @brief publish after a speed change in m/s */
+    #define GPSFUSE_MIN_COURSE              10.0        /** @brief publish after a course change in degree */
+    #define GPSFUSE_BENCH_ENV               "HEDGE_GPSFUSE_BENCH"   /** @brief env var to run the native bench with stationary, walk and drive scenarios */
+    #define GPSFUSE_BENCH_NOISE             4.0         /** @brief bench position noise in m, 1 sigma */
+    /**
+     * @brief fused location, the arg of a GPSCTL_UPDATE_FUSED event
+     */
+    typedef struct {
+        bool valid = false;                     /** @brief true if the filter has a position */
+        bool stationary = false;                /** @brief true if not moving */
+        bool valid_course = false;              /** @brief true if fast enough for a course */
+        double lat = 0;                         /** @brief smoothed latitude */
+        double lon = 0;                         /** @brief smoothed longitude */
+        double speed_mps = 0;                   /** @brief smoothed speed in m/s */
+        double course = 0;                      /** @brief smoothed course in degree, 0 is north */
+        double accuracy = 0;                    /** @brief estimated position error in m, 1 sigma */
+    } gpsfuse_t;
+    /**
+     * @brief fusion statistics
+     */
+    typedef struct {
+        uint32_t fixes = 0;                     /** @brief gps fixes into the filter */
+        uint32_t published = 0;                 /** @brief fused updates over the thresholds */
+        uint32_t resets = 0;                    /** @brief filter resets on a jump or a gap */
+        uint32_t stationary = 0;                /** @brief fixes while stationary */
+    } gpsfuse_stats_t;
+    /**
+     * @brief setup the location fusion, hooks into the step counter
+     */
+    void gpsfuse_setup( void );
+    /**
+     * @brief put a gps fix into the filter
+     *
+     * @param   gps_data    pointer to the gps data after a location update
+     *
+     * @return  true if the fused location has changed over the publish thresholds
+     */
+    bool gpsfuse_update( gps_data_t *gps_data );
+    /**
+     * @brief reset the filter, e.g. on a lost fix
+     */
+    void gpsfuse_reset( void );
+    /**
+     * @brief get the fused location
+     *
+     * @return  pointer to a gpsfuse_t structure
+     */
+    gpsfuse_t *gpsfuse_get( void );
+    /**
+     * @brief get the fusion statistics
+     *
+     * @return  pointer to a gpsfuse_stats_t structure
+     */
+    gpsfuse_stats_t *gpsfuse_get_stats( void );
+
+#endif // _GPSFUSE_H
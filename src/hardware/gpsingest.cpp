@@ -0,0 +1,727 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "gpsingest.h"
+#include "utils/alloc.h"
+#include "utils/nmea/nmea.h"
+#include "utils/lock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef NATIVE_64BIT
+    #include <time.h>
+    #include <unistd.h>
+    #include <pthread.h>
+    #include "utils/logging.h"
+
+    static pthread_t gpsingest_task;
+#else
+    #include <Arduino.h>
+    #include <esp_timer.h>
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/semphr.h>
+    #include <SoftwareSerial.h>
+
+    static TaskHandle_t gpsingest_task = NULL;
+#endif
+static lock_mutex_t gpsingest_mutex = LOCK_MUTEX_INITIALIZER;          /** @brief ring and source, ingestion task against gpsctl loop */
+
+/**
+ * @brief file source private data
+ */
+typedef struct {
+    char path[ 256 ];                                               /** @brief NMEA file path */
+    FILE *file;                                                     /** @brief NMEA file, open between open and close */
+    uint32_t baud;                                                  /** @brief replay pace, 0 for as fast as possible */
+    uint64_t start;                                                 /** @brief first read in us */
+    uint64_t sent;                                                  /** @brief bytes returned since start */
+} gpsingest_file_t;
+/**
+ * @brief synthetic source private data
+ */
+typedef struct {
+    double lat;                                                     /** @brief current latitude */
+    double lon;                                                     /** @brief current longitude */
+    double speed;                                                   /** @brief speed in m/s */
+    double course;                                                  /** @brief base course in degree */
+    bool paced;                                                     /** @brief one epoch per second */
+    uint32_t epoch;                                                 /** @brief epoch counter, one per second */
+    uint64_t next;                                                  /** @brief time of the next epoch in us */
+    char pending[ 512 ];                                            /** @brief sentences of the current epoch */
+    uint32_t pending_len;                                           /** @brief bytes in pending */
+    uint32_t pending_pos;                                           /** @brief bytes returned from pending */
+} gpsingest_synth_t;
+/**
+ * the ring holds framed and verified sentences, each one terminated by '\n',
+ * the ingestion task only puts complete sentences into it
+ */
+static uint8_t *gpsingest_ring = NULL;
+static uint32_t gpsingest_ring_head = 0;                            /** @brief write index, free running */
+static uint32_t gpsingest_ring_tail = 0;                            /** @brief read index, free running */
+/**
+ * framing state of the sentence in the making
+ */
+static char gpsingest_frame[ GPSINGEST_SENTENCE_SIZE ];
+static uint32_t gpsingest_frame_len = 0;
+static bool gpsingest_in_frame = false;
+
+static gpsingest_source_t *gpsingest_source = NULL;
+static volatile bool gpsingest_running = false;
+static gpsingest_stats_t gpsingest_stats;
+
+static void gpsingest_task_start( void );
+static void gpsingest_frame_bytes( const uint8_t *data, size_t len );
+static void gpsingest_frame_end( void );
+static void gpsingest_push( const char *sentence, uint32_t len );
+#ifdef NATIVE_64BIT
+    static void gpsingest_bench( const char *what );
+#endif
+
+static void gpsingest_lock( void ) {
+    lock_mutex_take( &gpsingest_mutex );
+}
+
+static void gpsingest_unlock( void ) {
+    lock_mutex_give( &gpsingest_mutex );
+}
+
+static uint64_t gpsingest_now( void ) {
+#ifdef NATIVE_64BIT
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000 );
+#else
+    return( esp_timer_get_time() );
+#endif
+}
+
+void gpsingest_setup( void ) {
+    if ( gpsingest_ring ) {
+        return;
+    }
+
+    gpsingest_ring = (uint8_t*)MALLOC( GPSINGEST_RING_SIZE );
+    if ( !gpsingest_ring ) {
+        GPSINGEST_ERROR_LOG("ring alloc failed");
+        return;
+    }
+#ifdef NATIVE_64BIT
+    const char *bench = getenv( GPSINGEST_BENCH_ENV );
+    if ( bench && *bench ) {
+        gpsingest_bench( bench );
+    }
+    /**
+     * a recorded file wins over the synthetic source
+     */
+    const char *file = getenv( GPSINGEST_FILE_ENV );
+    const char *synth = getenv( GPSINGEST_SYNTH_ENV );
+    if ( file && *file ) {
+        gpsingest_set_source( gpsingest_file_source( file, GPSINGEST_BAUD ) );
+    }
+    else if ( synth && *synth ) {
+        double lat = 0, lon = 0, speed = 0, course = 0;
+        if ( sscanf( synth, "%lf,%lf,%lf,%lf", &lat, &lon, &speed, &course ) >= 2 ) {
+            gpsingest_set_source( gpsingest_synth_source( lat, lon, speed, course, true ) );
+        }
+        else {
+            GPSINGEST_ERROR_LOG("malformed %s, use \"lat,lon,speed,course\"", GPSINGEST_SYNTH_ENV );
+        }
+    }
+#endif
+    gpsingest_task_start();
+}
+
+/**
+ * @brief the ingestion task, polls the source at a fixed interval while running
+ */
+static void gpsingest_task_loop( void ) {
+    while( true ) {
+        if ( gpsingest_running && gpsingest_poll() < 0 ) {
+            gpsingest_running = false;
+        }
+#ifdef NATIVE_64BIT
+        usleep( GPSINGEST_POLL_INTERVAL * 1000 );
+#else
+        /**
+         * sleep until the next start when stopped
+         */
+        if ( gpsingest_running ) {
+            vTaskDelay( pdMS_TO_TICKS( GPSINGEST_POLL_INTERVAL ) );
+        }
+        else {
+            ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        }
+#endif
+    }
+}
+
+#ifdef NATIVE_64BIT
+static void *gpsingest_thread( void *arg ) {
+    gpsingest_task_loop();
+    return( NULL );
+}
+#else
+static void gpsingest_Task( void *pvParameters ) {
+    gpsingest_task_loop();
+    vTaskDelete( NULL );
+}
+#endif
+
+static void gpsingest_task_start( void ) {
+#ifdef NATIVE_64BIT
+    pthread_create( &gpsingest_task, NULL, gpsingest_thread, NULL );
+#else
+    xTaskCreate(    gpsingest_Task,                     /* Function to implement the task */
+                    "gpsingest Task",                   /* Name of the task */
+                    2500,                               /* Stack size in words */
+                    NULL,                               /* Task input parameter */
+                    2,                                  /* Priority of the task */
+                    &gpsingest_task );                  /* Task handle. */
+#endif
+}
+
+bool gpsingest_set_source( gpsingest_source_t *source ) {
+    bool retval = true;
+
+    gpsingest_lock();
+    if ( gpsingest_source && gpsingest_source->close ) {
+        gpsingest_source->close( gpsingest_source );
+    }
+    gpsingest_source = source;
+    if ( source && source->open && !source->open( source ) ) {
+        GPSINGEST_ERROR_LOG("can't open source %s", source->name );
+        gpsingest_source = NULL;
+        retval = false;
+    }
+    else if ( source ) {
+        GPSINGEST_INFO_LOG("gps source: %s", source->name );
+    }
+    gpsingest_unlock();
+    return( retval );
+}
+
+bool gpsingest_get_available( void ) {
+    return( gpsingest_source != NULL );
+}
+
+void gpsingest_start( void ) {
+    gpsingest_lock();
+    gpsingest_ring_head = gpsingest_ring_tail = 0;
+    gpsingest_in_frame = false;
+    gpsingest_frame_len = 0;
+    gpsingest_running = gpsingest_source != NULL && gpsingest_ring != NULL;
+    gpsingest_unlock();
+#ifndef NATIVE_64BIT
+    if ( gpsingest_task ) {
+        xTaskNotifyGive( gpsingest_task );
+    }
+#endif
+}
+
+void gpsingest_stop( void ) {
+    if ( !gpsingest_running ) {
+        return;
+    }
+    gpsingest_running = false;
+    GPSINGEST_DEBUG_LOG("%llu bytes, %u sentences, %u checksum errors, %u malformed, %u overflows, max fill %u bytes",
+                        (unsigned long long)gpsingest_stats.bytes,
+                        gpsingest_stats.sentences,
+                        gpsingest_stats.checksum_errors,
+                        gpsingest_stats.malformed,
+                        gpsingest_stats.overflows,
+                        gpsingest_stats.max_fill );
+}
+
+int32_t gpsingest_poll( void ) {
+    uint8_t buf[ GPSINGEST_BATCH_SIZE ];
+    int32_t total = 0;
+
+    gpsingest_lock();
+    if ( !gpsingest_source || !gpsingest_ring ) {
+        gpsingest_unlock();
+        return( 0 );
+    }
+    /**
+     * drain the source in batches, a short read means it's empty for now,
+     * a ring size per round keeps a fast source from spinning here
+     */
+    while( total < GPSINGEST_RING_SIZE ) {
+        int32_t len = gpsingest_source->read( gpsingest_source, buf, sizeof( buf ) );
+        if ( len < 0 ) {
+            GPSINGEST_INFO_LOG("source %s ended", gpsingest_source->name );
+            if ( gpsingest_source->close ) {
+                gpsingest_source->close( gpsingest_source );
+            }
+            gpsingest_source = NULL;
+            total = total ? total : -1;
+            break;
+        }
+        if ( len == 0 ) {
+            break;
+        }
+        gpsingest_stats.bytes += len;
+        gpsingest_stats.reads++;
+        total += len;
+        gpsingest_frame_bytes( buf, len );
+        if ( len < (int32_t)sizeof( buf ) ) {
+            break;
+        }
+    }
+    gpsingest_unlock();
+    return( total );
+}
+
+/**
+ * @brief frame sentences from '$' to the line end, call with lock held
+ */
+static void gpsingest_frame_bytes( const uint8_t *data, size_t len ) {
+    for( size_t i = 0 ; i < len ; i++ ) {
+        uint8_t c = data[ i ];
+
+        if ( c == '$' ) {
+            if ( gpsingest_in_frame ) {
+                gpsingest_stats.malformed++;
+            }
+            gpsingest_in_frame = true;
+            gpsingest_frame_len = 0;
+            gpsingest_frame[ gpsingest_frame_len++ ] = c;
+        }
+        else if ( !gpsingest_in_frame ) {
+            continue;
+        }
+        else if ( c == '\r' || c == '\n' ) {
+            gpsingest_frame_end();
+        }
+        else if ( c < ' ' || c > '~' || gpsingest_frame_len >= GPSINGEST_SENTENCE_SIZE - 1 ) {
+            /**
+             * line noise or no line end in sight, wait for the next '$'
+             */
+            gpsingest_stats.malformed++;
+            gpsingest_in_frame = false;
+        }
+        else {
+            gpsingest_frame[ gpsingest_frame_len++ ] = c;
+        }
+    }
+}
+
+/**
+ * @brief verify the checksum of a complete sentence and put it into the ring,
+ * call with lock held
+ */
+static void gpsingest_frame_end( void ) {
+    uint32_t len = gpsingest_frame_len;
+    const char *frame = gpsingest_frame;
+
+    gpsingest_in_frame = false;
+    /**
+     * "$" + at least a talker and type + "*hh"
+     */
+    if ( len < 9 || frame[ len - 3 ] != '*' ) {
+        gpsingest_stats.malformed++;
+        return;
+    }
+    if ( !nmea_checksum( frame, len ) ) {
+        gpsingest_stats.checksum_errors++;
+        return;
+    }
+    gpsingest_push( frame, len );
+}
+
+/**
+ * @brief put a sentence into the ring or drop it if full, call with lock held
+ */
+static void gpsingest_push( const char *sentence, uint32_t len ) {
+    uint32_t fill = gpsingest_ring_head - gpsingest_ring_tail;
+
+    if ( fill + len + 1 > GPSINGEST_RING_SIZE ) {
+        gpsingest_stats.overflows++;
+        return;
+    }
+    for( uint32_t i = 0 ; i < len ; i++ ) {
+        gpsingest_ring[ ( gpsingest_ring_head + i ) & ( GPSINGEST_RING_SIZE - 1 ) ] = sentence[ i ];
+    }
+    gpsingest_ring[ ( gpsingest_ring_head + len ) & ( GPSINGEST_RING_SIZE - 1 ) ] = '\n';
+    gpsingest_ring_head += len + 1;
+    gpsingest_stats.sentences++;
+    if ( fill + len + 1 > gpsingest_stats.max_fill ) {
+        gpsingest_stats.max_fill = fill + len + 1;
+    }
+}
+
+size_t gpsingest_read_sentence( char *buf, size_t size ) {
+    size_t len = 0;
+
+    if ( !buf || !size ) {
+        return( 0 );
+    }
+
+    gpsingest_lock();
+    while( gpsingest_ring_tail != gpsingest_ring_head ) {
+        char c = gpsingest_ring[ gpsingest_ring_tail++ & ( GPSINGEST_RING_SIZE - 1 ) ];
+        if ( c == '\n' ) {
+            gpsingest_stats.consumed++;
+            break;
+        }
+        if ( len < size - 1 ) {
+            buf[ len++ ] = c;
+        }
+    }
+    gpsingest_unlock();
+    buf[ len ] = '\0';
+    return( len );
+}
+
+gpsingest_stats_t *gpsingest_get_stats( void ) {
+    return( &gpsingest_stats );
+}
+
+void gpsingest_free_source( gpsingest_source_t *source ) {
+    if ( !source ) {
+        return;
+    }
+    if ( gpsingest_source == source ) {
+        gpsingest_set_source( NULL );
+    }
+    if ( source->release ) {
+        source->release( source );
+    }
+    else {
+        free( source->ctx );
+    }
+    delete source;
+}
+
+#ifndef NATIVE_64BIT
+static int32_t gpsingest_uart_read( gpsingest_source_t *source, uint8_t *buf, size_t size ) {
+    SoftwareSerial *serial = (SoftwareSerial*)source->ctx;
+    int available = serial->available();
+
+    if ( available <= 0 ) {
+        return( 0 );
+    }
+    return( serial->read( buf, (size_t)available < size ? (size_t)available : size ) );
+}
+
+static void gpsingest_uart_release( gpsingest_source_t *source ) {
+    SoftwareSerial *serial = (SoftwareSerial*)source->ctx;
+
+    serial->end();
+    delete serial;
+}
+#endif
+
+gpsingest_source_t *gpsingest_uart_source( int8_t rx, int8_t tx, uint32_t baud ) {
+#ifdef NATIVE_64BIT
+    return( NULL );
+#else
+    gpsingest_source_t *source = new gpsingest_source_t;
+    if ( !source ) {
+        GPSINGEST_ERROR_LOG("uart source alloc failed");
+        return( NULL );
+    }
+    SoftwareSerial *serial = new SoftwareSerial( rx, tx );
+    serial->begin( baud );
+    source->name = "uart";
+    source->read = gpsingest_uart_read;
+    source->release = gpsingest_uart_release;
+    source->ctx = (void*)serial;
+    return( source );
+#endif
+}
+
+static bool gpsingest_file_open( gpsingest_source_t *source ) {
+    gpsingest_file_t *file = (gpsingest_file_t*)source->ctx;
+
+    file->file = fopen( file->path, "rb" );
+    if ( !file->file ) {
+        GPSINGEST_ERROR_LOG("can't open NMEA file %s", file->path );
+    }
+    file->start = 0;
+    file->sent = 0;
+    return( file->file != NULL );
+}
+
+static void gpsingest_file_close( gpsingest_source_t *source ) {
+    gpsingest_file_t *file = (gpsingest_file_t*)source->ctx;
+
+    if ( file->file ) {
+        fclose( file->file );
+        file->file = NULL;
+    }
+}
+
+static int32_t gpsingest_file_read( gpsingest_source_t *source, uint8_t *buf, size_t size ) {
+    gpsingest_file_t *file = (gpsingest_file_t*)source->ctx;
+    /**
+     * pace the replay like a uart with 10 bit per byte
+     */
+    if ( file->baud ) {
+        uint64_t now = gpsingest_now();
+        if ( !file->start ) {
+            file->start = now;
+        }
+        uint64_t due = ( now - file->start ) * file->baud / 10 / 1000000ULL;
+        if ( due <= file->sent ) {
+            return( 0 );
+        }
+        if ( due - file->sent < size ) {
+            size = due - file->sent;
+        }
+    }
+    size_t len = fread( buf, 1, size, file->file );
+    if ( len == 0 && ( feof( file->file ) || ferror( file->file ) ) ) {
+        return( -1 );
+    }
+    file->sent += len;
+    return( len );
+}
+
+gpsingest_source_t *gpsingest_file_source( const char *path, uint32_t baud ) {
+    gpsingest_source_t *source = new gpsingest_source_t;
+    gpsingest_file_t *file = (gpsingest_file_t*)CALLOC( 1, sizeof( gpsingest_file_t ) );
+
+    if ( !source || !file ) {
+        GPSINGEST_ERROR_LOG("file source alloc failed");
+        delete source;
+        free( file );
+        return( NULL );
+    }
+    snprintf( file->path, sizeof( file->path ), "%s", path );
+    file->baud = baud;
+    source->name = "nmea file";
+    source->open = gpsingest_file_open;
+    source->read = gpsingest_file_read;
+    source->close = gpsingest_file_close;
+    source->ctx = (void*)file;
+    return( source );
+}
+
+/**
+ * @brief append a sentence with checksum and line end to the pending buffer
+ */
+static void gpsingest_synth_sentence( gpsingest_synth_t *synth, const char *body ) {
+    uint8_t checksum = 0;
+
+    for( const char *c = body ; *c ; c++ ) {
+        checksum ^= *c;
+    }
+    int len = snprintf( synth->pending + synth->pending_len, sizeof( synth->pending ) - synth->pending_len, "$%s*%02X\r\n", body, checksum );
+    if ( len > 0 && synth->pending_len + len < sizeof( synth->pending ) ) {
+        synth->pending_len += len;
+    }
+}
+
+/**
+ * @brief format a coordinate as NMEA (d)ddmm.mmmmm,H
+ */
+static void gpsingest_synth_coord( char *buf, size_t size, double value, int degree_digits, char positive, char negative ) {
+    double absolute = fabs( value );
+    int degree = (int)absolute;
+    double minutes = ( absolute - degree ) * 60.0;
+
+    snprintf( buf, size, "%0*d%08.5f,%c", degree_digits, degree, minutes, value < 0 ? negative : positive );
+}
+
+/**
+ * @brief move one second along the course and render GGA, RMC and GSV
+ */
+static void gpsingest_synth_epoch( gpsingest_synth_t *synth ) {
+    char body[ GPSINGEST_SENTENCE_SIZE ];
+    char lat[ 16 ], lon[ 16 ], utc[ 16 ];
+    /**
+     * a slow wiggle on the course, not a ruler straight line
+     */
+    double course = fmod( synth->course + 20.0 * sin( synth->epoch / 60.0 ) + 360.0, 360.0 );
+    double rad = course * M_PI / 180.0;
+
+    synth->lat += synth->speed * cos( rad ) / 111320.0;
+    synth->lon += synth->speed * sin( rad ) / ( 111320.0 * cos( synth->lat * M_PI / 180.0 ) );
+
+    uint32_t seconds = ( 12 * 3600 + synth->epoch ) % 86400;
+    snprintf( utc, sizeof( utc ), "%02u%02u%02u.00", seconds / 3600, seconds / 60 % 60, seconds % 60 );
+    gpsingest_synth_coord( lat, sizeof( lat ), synth->lat, 2, 'N', 'S' );
+    gpsingest_synth_coord( lon, sizeof( lon ), synth->lon, 3, 'E', 'W' );
+
+    synth->pending_len = 0;
+    synth->pending_pos = 0;
+    snprintf( body, sizeof( body ), "GPGGA,%s,%s,%s,1,08,0.9,%.1f,M,46.9,M,,", utc, lat, lon, 50.0 + 5.0 * sin( synth->epoch / 30.0 ) );
+    gpsingest_synth_sentence( synth, body );
+    snprintf( body, sizeof( body ), "GPRMC,%s,A,%s,%s,%.2f,%.1f,181026,,,A", utc, lat, lon, synth->speed * 3600.0 / 1852.0, course );
+    gpsingest_synth_sentence( synth, body );
+    gpsingest_synth_sentence( synth, "GPGSV,1,1,04,05,63,106,42,13,41,250,38,15,22,049,35,24,58,302,44" );
+    gpsingest_synth_sentence( synth, "GLGSV,1,1,04,65,34,067,33,71,55,178,40,72,17,226,29,87,45,321,37" );
+    synth->epoch++;
+}
+
+static int32_t gpsingest_synth_read( gpsingest_source_t *source, uint8_t *buf, size_t size ) {
+    gpsingest_synth_t *synth = (gpsingest_synth_t*)source->ctx;
+    size_t len = 0;
+
+    while( len < size ) {
+        if ( synth->pending_pos == synth->pending_len ) {
+            if ( synth->paced ) {
+                uint64_t now = gpsingest_now();
+                if ( now < synth->next ) {
+                    break;
+                }
+                synth->next = synth->next ? synth->next + 1000000ULL : now + 1000000ULL;
+            }
+            gpsingest_synth_epoch( synth );
+        }
+        size_t chunk = synth->pending_len - synth->pending_pos;
+        if ( chunk > size - len ) {
+            chunk = size - len;
+        }
+        memcpy( buf + len, synth->pending + synth->pending_pos, chunk );
+        synth->pending_pos += chunk;
+        len += chunk;
+    }
+    return( len );
+}
+
+gpsingest_source_t *gpsingest_synth_source( double lat, double lon, double speed, double course, bool paced ) {
+    gpsingest_source_t *source = new gpsingest_source_t;
+    gpsingest_synth_t *synth = (gpsingest_synth_t*)CALLOC( 1, sizeof( gpsingest_synth_t ) );
+
+    if ( !source || !synth ) {
+        GPSINGEST_ERROR_LOG("synth source alloc failed");
+        delete source;
+        free( synth );
+        return( NULL );
+    }
+    synth->lat = lat;
+    synth->lon = lon;
+    synth->speed = speed;
+    synth->course = course;
+    synth->paced = paced;
+    source->name = "synthetic";
+    source->read = gpsingest_synth_read;
+    source->ctx = (void*)synth;
+    return( source );
+}
+
+#ifdef NATIVE_64BIT
+/**
+ * @brief limits a source to one byte per read, the old byte by byte path
+ */
+static bool gpsingest_bench_bytewise_open( gpsingest_source_t *source ) {
+    gpsingest_source_t *inner = (gpsingest_source_t*)source->ctx;
+    return( inner->open ? inner->open( inner ) : true );
+}
+
+static int32_t gpsingest_bench_bytewise_read( gpsingest_source_t *source, uint8_t *buf, size_t size ) {
+    gpsingest_source_t *inner = (gpsingest_source_t*)source->ctx;
+    return( inner->read( inner, buf, 1 ) );
+}
+
+static void gpsingest_bench_bytewise_close( gpsingest_source_t *source ) {
+    gpsingest_source_t *inner = (gpsingest_source_t*)source->ctx;
+    if ( inner->close ) {
+        inner->close( inner );
+    }
+}
+
+/**
+ * @brief the bench source, a NMEA file or GPSINGEST_BENCH_EPOCHS synthetic epochs
+ */
+static gpsingest_source_t *gpsingest_bench_source( const char *what ) {
+    if ( strcmp( what, "synth" ) ) {
+        return( gpsingest_file_source( what, 0 ) );
+    }
+    return( gpsingest_synth_source( 52.52, 13.405, 5.0, 45.0, false ) );
+}
+
+/**
+ * @brief run the whole ingestion path from the source to the consumer, in
+ * batches and byte by byte, log throughput and framing stats
+ */
+static void gpsingest_bench( const char *what ) {
+    char sentence[ GPSINGEST_SENTENCE_SIZE ];
+    bool synth = !strcmp( what, "synth" );
+
+    for( int bytewise = 0 ; bytewise < 2 ; bytewise++ ) {
+        gpsingest_source_t *source = gpsingest_bench_source( what );
+        gpsingest_source_t wrapper;
+        if ( !source ) {
+            return;
+        }
+        wrapper.name = "bytewise";
+        wrapper.open = gpsingest_bench_bytewise_open;
+        wrapper.read = gpsingest_bench_bytewise_read;
+        wrapper.close = gpsingest_bench_bytewise_close;
+        wrapper.ctx = (void*)source;
+
+        gpsingest_stats = gpsingest_stats_t();
+        if ( !gpsingest_set_source( bytewise ? &wrapper : source ) ) {
+            gpsingest_free_source( source );
+            return;
+        }
+        gpsingest_start();
+
+        uint64_t start = gpsingest_now();
+        uint32_t checksum = 0;
+        while( true ) {
+            int32_t len = 0;
+            /**
+             * one poll is one ingestion task round, byte by byte needs a poll per byte
+             */
+            for( int i = 0 ; i < ( bytewise ? GPSINGEST_BATCH_SIZE : 1 ) && len >= 0 ; i++ ) {
+                len = gpsingest_poll();
+            }
+            size_t size;
+            while( ( size = gpsingest_read_sentence( sentence, sizeof( sentence ) ) ) ) {
+                checksum += size + sentence[ size - 1 ];
+            }
+            if ( len < 0 || ( synth && gpsingest_stats.sentences >= GPSINGEST_BENCH_EPOCHS * 4 ) ) {
+                break;
+            }
+        }
+        uint64_t time = gpsingest_now() - start;
+        if ( !time ) {
+            time = 1;
+        }
+        GPSINGEST_INFO_LOG("ingest bench %s %s: %llu bytes in %u reads, %u sentences, %u consumed, %u checksum errors, %u malformed, %u overflows, max fill %u, %.1fus, %.2f MB/s, %.0f sentences/s (sum %u)",
+                            what, bytewise ? "byte by byte" : "batched",
+                            (unsigned long long)gpsingest_stats.bytes,
+                            gpsingest_stats.reads,
+                            gpsingest_stats.sentences,
+                            gpsingest_stats.consumed,
+                            gpsingest_stats.checksum_errors,
+                            gpsingest_stats.malformed,
+                            gpsingest_stats.overflows,
+                            gpsingest_stats.max_fill,
+                            (double)time,
+                            gpsingest_stats.bytes / (double)time,
+                            gpsingest_stats.sentences * 1000000.0 / time,
+                            checksum );
+
+        gpsingest_stop();
+        gpsingest_set_source( NULL );
+        gpsingest_free_source( source );
+    }
+    gpsingest_stats = gpsingest_stats_t();
+}
+#endif
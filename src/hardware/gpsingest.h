@@ -0,0 +1,154 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _GPSINGEST_H
+    #define _GPSINGEST_H
+
+    #include <stdint.h>
+    #include <stddef.h>
+
+    #define GPSINGEST_INFO_LOG              log_i
+    #define GPSINGEST_DEBUG_LOG             log_d
+    #define GPSINGEST_ERROR_LOG             log_e
+
+    #define GPSINGEST_BAUD                  9600        /** @brief default gps uart baudrate */
+    #define GPSINGEST_RING_SIZE             4096        /** @brief framed sentence ring buffer in bytes, power of two, ~4s at 9600 baud */
+    #define GPSINGEST_SENTENCE_SIZE         128         /** @brief max sentence length, NMEA says 82, vendor sentences are longer */
+    #define GPSINGEST_BATCH_SIZE            256         /** @brief bytes per source read */
+    #define GPSINGEST_POLL_INTERVAL         20          /** @brief ingestion task poll interval in ms, 20ms are 192 bytes at 9600 baud */
+    #define GPSINGEST_FILE_ENV              "HEDGE_GPS_NMEA_FILE"   /** @brief env var with a recorded NMEA file to replay on native */
+    #define GPSINGEST_SYNTH_ENV             "HEDGE_GPS_SYNTH"       /** @brief env var with "lat,lon,speed in m/s,course" for the synthetic source on native */
+    #define GPSINGEST_BENCH_ENV             "HEDGE_GPS_INGEST_BENCH"    /** @brief env var with a NMEA file or "synth" for the native bench */
+    #define GPSINGEST_BENCH_EPOCHS          20000       /** @brief synthetic epochs for the bench */
+    /**
+     * @brief a byte source, e.g. the gps uart, a recorded NMEA file or a generator
+     */
+    typedef struct gpsingest_source_t {
+        const char *name = "";                                              /** @brief source name for the log */
+        bool ( *open )( struct gpsingest_source_t *source ) = NULL;         /** @brief open the source, NULL if not needed */
+        int32_t ( *read )( struct gpsingest_source_t *source, uint8_t *buf, size_t size ) = NULL;    /** @brief read up to size bytes, return bytes read, 0 for nothing yet, -1 on end or error */
+        void ( *close )( struct gpsingest_source_t *source ) = NULL;        /** @brief close the source, NULL if not needed */
+        void ( *release )( struct gpsingest_source_t *source ) = NULL;      /** @brief free ctx, NULL if ctx is allocated with MALLOC/CALLOC */
+        void *ctx = NULL;                                                   /** @brief source private data */
+    } gpsingest_source_t;
+    /**
+     * @brief ingestion statistics
+     */
+    typedef struct {
+        uint64_t bytes = 0;                     /** @brief bytes read from the source */
+        uint32_t reads = 0;                     /** @brief source reads with data */
+        uint32_t sentences = 0;                 /** @brief valid sentences put into the ring */
+        uint32_t consumed = 0;                  /** @brief sentences taken from the ring */
+        uint32_t checksum_errors = 0;           /** @brief sentences with a wrong checksum */
+        uint32_t malformed = 0;                 /** @brief sentences without checksum, too long or cut by a new '$' */
+        uint32_t overflows = 0;                 /** @brief sentences dropped on a full ring */
+        uint32_t max_fill = 0;                  /** @brief max ring fill level in bytes */
+    } gpsingest_stats_t;
+    /**
+     * @brief setup the ingestion path, on native a source from GPSINGEST_FILE_ENV or
+     * GPSINGEST_SYNTH_ENV is opened and GPSINGEST_BENCH_ENV runs the bench
+     */
+    void gpsingest_setup( void );
+    /**
+     * @brief set the byte source, a running source is closed first
+     *
+     * @param   source  pointer to a gpsingest_source_t, must stay valid, NULL for none
+     *
+     * @return  true if the source is open
+     */
+    bool gpsingest_set_source( gpsingest_source_t *source );
+    /**
+     * @brief check if a source is set
+     *
+     * @return  true if a source is set
+     */
+    bool gpsingest_get_available( void );
+    /**
+     * @brief create the gps uart source, only on the ESP32
+     *
+     * @param   rx      rx pin
+     * @param   tx      tx pin
+     * @param   baud    baudrate
+     *
+     * @return  pointer to the source or NULL if failed
+     */
+    gpsingest_source_t *gpsingest_uart_source( int8_t rx, int8_t tx, uint32_t baud );
+    /**
+     * @brief create a recorded NMEA file source
+     *
+     * @param   path    file path
+     * @param   baud    replay pace in baud, 0 for as fast as possible
+     *
+     * @return  pointer to the source or NULL if failed
+     */
+    gpsingest_source_t *gpsingest_file_source( const char *path, uint32_t baud );
+    /**
+     * @brief create a synthetic source, one GGA, RMC and GSV epoch per second
+     * moving along a course
+     *
+     * @param   lat     start latitude
+     * @param   lon     start longitude
+     * @param   speed   speed in m/s
+     * @param   course  course in degree, 0 is north
+     * @param   paced   true for one epoch per second, false for as fast as possible
+     *
+     * @return  pointer to the source or NULL if failed
+     */
+    gpsingest_source_t *gpsingest_synth_source( double lat, double lon, double speed, double course, bool paced );
+    /**
+     * @brief release a source created by one of the gpsingest_*_source functions,
+     * a uart source closes its port
+     *
+     * @param   source  pointer to the source
+     */
+    void gpsingest_free_source( gpsingest_source_t *source );
+    /**
+     * @brief start the ingestion, clears the ring and the framing state
+     */
+    void gpsingest_start( void );
+    /**
+     * @brief stop the ingestion
+     */
+    void gpsingest_stop( void );
+    /**
+     * @brief read the source and frame the sentences into the ring, called from the
+     * ingestion task, only needed by hand when the task is not running
+     *
+     * @return  number of bytes read, -1 if the source has ended
+     */
+    int32_t gpsingest_poll( void );
+    /**
+     * @brief take the next framed and checksum verified sentence from the ring
+     *
+     * @param   buf     pointer to a char buffer, GPSINGEST_SENTENCE_SIZE fits all
+     * @param   size    buffer size
+     *
+     * @return  sentence length without line end, 0 if the ring is empty
+     */
+    size_t gpsingest_read_sentence( char *buf, size_t size );
+    /**
+     * @brief get the ingestion statistics
+     *
+     * @return  pointer to a gpsingest_stats_t structure
+     */
+    gpsingest_stats_t *gpsingest_get_stats( void );
+
+#endif // _GPSINGEST_H
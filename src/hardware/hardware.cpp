@@ -20,7 +20,18 @@
 #include "sensor.h"
 
 #include "utils/fakegps.h"
+#include "utils/fbstream/fbstream.h"
+#include "utils/inputrec/inputrec.h"
+#include "utils/latency/latency.h"
+#include "utils/rendergov/rendergov.h"
+#include "utils/gpstrack/gpstrack.h"
+#include "utils/geofence/geofence.h"
 #include "gui/splashscreen.h"
+#include "utils/bootprof/bootprof.h"
+#include "utils/uri_load/uri_load_pool.h"
+#include "utils/uri_load/uri_load_sched.h"
+#include "utils/osm_map/osm_map_store.h"
+#include "utils/osm_map/osm_map_prefetch.h"
 #include "gui/screenshot.h"
 
 #ifdef NATIVE_64BIT
@@ -41,7 +52,11 @@
         log_i("start lvgl ticker");
         while(1) {
             SDL_Delay(5);   /*Sleep for 5 millisecond*/
-            lv_tick_inc(5); /*Tell LittelvGL that 5 milliseconds were elapsed*/
+            /**
+             * a input replay advances the tick from the recorded times
+             */
+            if ( !inputrec_is_replaying() )
+                lv_tick_inc(5); /*Tell LittelvGL that 5 milliseconds were elapsed*/
         }
         return 0;
     }
@@ -184,15 +199,22 @@ void hardware_setup( void ) {
      * driver init
      */
     sdcard_setup();
+    bootprof_mark( "sdcard" );
     powermgm_setup();
+    bootprof_mark( "powermgm" );
     button_setup();
+    bootprof_mark( "button" );
     motor_setup();
+    bootprof_mark( "motor" );
     display_setup();
+    bootprof_mark( "display" );
     screenshot_setup();
+    bootprof_mark( "screenshot" );
     /**
      * splashscreen setup
      */
     splash_screen_stage_one();
+    bootprof_mark( "splashscreen" );
     /**
      * work on SPIFFS
      */
@@ -212,20 +234,55 @@ void hardware_setup( void ) {
             }
         }
     #endif
-    splash_screen_stage_update( "init hardware", 60 );  
+    /**
+     * the step times from the last boot drive the splashscreen progress
+     */
+    bootprof_load();
+    splash_screen_stage_update( "init hardware", 0 );  
 
     pmu_setup();
+    bootprof_mark( "pmu" );
     bma_setup();
+    bootprof_mark( "bma" );
     wifictl_setup();
+    bootprof_mark( "wifictl" );
+    uri_load_pool_setup();
+    bootprof_mark( "uri_load_pool" );
+    uri_load_sched_setup();
+    bootprof_mark( "uri_load_sched" );
+    osm_map_store_setup();
+    bootprof_mark( "osm_map_store" );
+    osm_map_prefetch_setup();
+    bootprof_mark( "osm_map_prefetch" );
     touch_setup();
+    bootprof_mark( "touch" );
     rtcctl_setup();
+    bootprof_mark( "rtcctl" );
     timesync_setup();
+    bootprof_mark( "timesync" );
     sensor_setup();
+    bootprof_mark( "sensor" );
     sound_read_config();
+    bootprof_mark( "sound_read_config" );
     fakegps_setup();
+    bootprof_mark( "fakegps" );
+    fbstream_setup();
+    bootprof_mark( "fbstream" );
+    inputrec_setup();
+    bootprof_mark( "inputrec" );
+    latency_setup();
+    bootprof_mark( "latency" );
+    rendergov_setup();
+    bootprof_mark( "rendergov" );
+    gpstrack_setup();
+    bootprof_mark( "gpstrack" );
+    geofence_setup();
+    bootprof_mark( "geofence" );
     blectl_read_config();
+    bootprof_mark( "blectl_read_config" );
+    bootprof_mark( SPLASHSCREEN_BOOTPROF_END );
 
-    splash_screen_stage_update( "init gui", 80 );
+    splash_screen_stage_update( "init gui", 100 );
     splash_screen_stage_finish();
 
     #ifdef NATIVE_64BIT
@@ -248,14 +305,21 @@ void hardware_post_setup( void ) {
     }
 
     sound_setup();
+    bootprof_mark( "sound" );
     gpsctl_setup();
+    bootprof_mark( "gpsctl" );
     powermgm_set_event( POWERMGM_WAKEUP );
 
     #ifndef NO_BLUETOOTH
         blectl_setup();
+        bootprof_mark( "blectl" );
     #endif
 
     display_set_brightness( display_get_brightness() );
+    /**
+     * the watchface is up
+     */
+    bootprof_finish();
 
     #ifdef NATIVE_64BIT
     #else
@@ -26,11 +26,13 @@
 #include "touch.h"
 #include "powermgm.h"
 #include "callback.h"
+#include "utils/latency/latency.h"
 
 #ifdef NATIVE_64BIT
     #include "utils/logging.h"
     #include "indev/mouse.h"
     #include "indev/mousewheel.h"
+    #include "utils/inputrec/inputrec.h"
 #else
     #include <Arduino.h>
     #if defined( M5PAPER )
@@ -141,6 +143,7 @@ void touch_setup( void ) {
     lv_indev_drv_init( &indev_drv );
     indev_drv.type = LV_INDEV_TYPE_POINTER;
     indev_drv.read_cb = touch_read;
+    indev_drv.feedback_cb = latency_indev_feedback_cb;
     lv_indev_drv_register( &indev_drv );
     /*
      * register powermgm callback function
@@ -400,6 +403,10 @@ static bool touch_read(lv_indev_drv_t * drv, lv_indev_data_t*data) {
     
     #ifdef NATIVE_64BIT
         retval = mouse_read( drv, data );
+        /**
+         * record or replace with replayed input
+         */
+        inputrec_touch_read( data );
     #else
         #if defined( M5PAPER )
             if ( M5.TP.avaliable() ) {
@@ -498,6 +505,10 @@ static bool touch_read(lv_indev_drv_t * drv, lv_indev_data_t*data) {
     if ( touch_send_event_cb( TOUCH_UPDATE, (void*)&touch ) ) {
         data->state = LV_INDEV_STATE_REL;
     }
+    /**
+     * start touch to photon measurement
+     */
+    latency_touch_read( data );
 
     return( retval );
 }
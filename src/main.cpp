@@ -3,6 +3,7 @@
 
 #include "hardware/hardware.h"
 #include "hardware/powermgm.h"
+#include "utils/bootprof/bootprof.h"
 
 #include "app/calc/calc_app.h"
 #include "app/FindPhone/FindPhone.h"
@@ -56,36 +57,61 @@ void setup() {
      * gui setup
      */
     gui_setup();
+    bootprof_mark( "gui" );
     /**
      * apps here
      */
     stopwatch_app_setup();
+    bootprof_mark( "stopwatch_app" );
     alarm_clock_setup();
+    bootprof_mark( "alarm_clock" );
     activity_app_setup();
+    bootprof_mark( "activity_app" );
     calendar_app_setup();
+    bootprof_mark( "calendar_app" );
     mail_app_setup();
+    bootprof_mark( "mail_app" );
     calc_app_setup();
+    bootprof_mark( "calc_app" );
     printer3d_app_setup();
+    bootprof_mark( "printer3d_app" );
     weather_app_setup();
+    bootprof_mark( "weather_app" );
     weather_station_app_setup();
+    bootprof_mark( "weather_station_app" );
     IRController_setup();
+    bootprof_mark( "IRController" );
     //sailing_setup();
     gps_status_setup();
+    bootprof_mark( "gps_status" );
     osmmap_app_setup();
+    bootprof_mark( "osmmap_app" );
     osmand_app_setup();
+    bootprof_mark( "osmand_app" );
     kodi_remote_app_setup();
+    bootprof_mark( "kodi_remote_app" );
     mqtt_player_app_setup();
+    bootprof_mark( "mqtt_player_app" );
     mqtt_control_app_setup();
+    bootprof_mark( "mqtt_control_app" );
     //fxrates_app_setup();
     //powermeter_app_setup();
     FindPhone_setup();
+    bootprof_mark( "FindPhone" );
     tiltmouse_app_setup();
+    bootprof_mark( "tiltmouse_app" );
     NetTools_setup();
+    bootprof_mark( "NetTools" );
     ping_app_setup();
+    bootprof_mark( "ping_app" );
     wireless_app_setup();
+    bootprof_mark( "wireless_app" );
     wifimon_app_setup();
+    bootprof_mark( "wifimon_app" );
     tic_tac_toe_game_setup();
+    bootprof_mark( "tic_tac_toe_game" );
     pong_game_setup();
+    bootprof_mark( "pong_game" );
     /**
      * post hardware setup
      */
@@ -6,7 +6,7 @@
  ****/
 
 #include "jsonrequest.h"
-#include "utils/uri_load/uri_load.h"
+#include "utils/uri_load/uri_load_stream.h"
 
 JsonRequest::JsonRequest(size_t maxJsonBufferSize) : SpiRamJsonDocument(maxJsonBufferSize)
 {
@@ -24,16 +24,17 @@ bool JsonRequest::process(const char* url)
     time(&now);
     localtime_r(&now, &timeStamp);
     /**
-     * load uri file into ram
+     * open uri stream, the json is pharsed while it arrives
      */
-    uri_load_dsc_t *uri_load_dsc = uri_load_to_ram( url );
+    UriLoadStream stream;
     /**
      * if was success, pharse the json
      */
-    if ( uri_load_dsc ) {
+    if ( stream.begin( url ) ) {
         httpcode = 200;
 
-        dsError = deserializeJson(*this, uri_load_dsc->data );
+        dsError = deserializeJson(*this, stream );
+        stream.end();
         if (dsError) {
             log_e("deserializeJson() failed: %s", dsError.c_str());
             clear();
@@ -43,10 +44,6 @@ bool JsonRequest::process(const char* url)
     else {
         httpcode = -1;
     }
-    /**
-     * clear uri dsc
-     */
-    uri_load_free_all( uri_load_dsc );
 
     return true;
 }
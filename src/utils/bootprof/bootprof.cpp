@@ -0,0 +1,272 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "bootprof.h"
+#include "utils/filepath_convert.h"
+
+#ifdef NATIVE_64BIT
+    #include <stdio.h>
+    #include <string.h>
+    #include <time.h>
+    #include "utils/logging.h"
+#else
+    #include <Arduino.h>
+    #include <esp_timer.h>
+#endif
+
+callback_t *bootprof_callback = NULL;
+
+static bootprof_mark_t bootprof_marks[ BOOTPROF_MAX_MARKS ];       /** @brief marks from this boot */
+static uint32_t bootprof_num_marks = 0;
+static bootprof_mark_t bootprof_last_marks[ BOOTPROF_MAX_MARKS ];  /** @brief marks from the last boot */
+static uint32_t bootprof_num_last_marks = 0;
+static uint32_t bootprof_last_boot_time = 0;                        /** @brief time to watchface from the last boot */
+static char bootprof_last_firmware[ BOOTPROF_FIRMWARE_LEN ] = "";   /** @brief firmware of the last boot */
+static char bootprof_baseline_firmware[ BOOTPROF_FIRMWARE_LEN ] = "";   /** @brief firmware before the current one */
+static uint32_t bootprof_baseline_boot_time = 0;                    /** @brief time to watchface with the firmware before */
+static uint32_t bootprof_boot_time = 0;                             /** @brief time to watchface from this boot */
+static uint32_t bootprof_progress = 0;
+
+static bool bootprof_send_event_cb( EventBits_t event, void *arg );
+
+static uint32_t bootprof_now( void ) {
+#ifdef NATIVE_64BIT
+    static uint64_t start = 0;
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    uint64_t now = (uint64_t)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000;
+    if ( !start ) {
+        start = now;
+    }
+    return( now - start );
+#else
+    return( esp_timer_get_time() / 1000 );
+#endif
+}
+
+bool bootprof_register_cb( EventBits_t event, CALLBACK_FUNC callback_func, const char *id ) {
+    /*
+     * check if an callback table exist, if not allocate a callback table
+     */
+    if ( bootprof_callback == NULL ) {
+        bootprof_callback = callback_init( "bootprof" );
+        if ( bootprof_callback == NULL ) {
+            log_e("bootprof callback alloc failed");
+            while(true);
+        }
+    }
+    /*
+     * register an callback entry and return them
+     */
+    return( callback_register( bootprof_callback, event, callback_func, id ) );
+}
+
+static bool bootprof_send_event_cb( EventBits_t event, void *arg ) {
+    /*
+     * call all callbacks with her event mask
+     */
+    return( callback_send_no_log( bootprof_callback, event, arg ) );
+}
+
+void bootprof_load( void ) {
+    char filename[ 256 ] = "";
+    char line[ 64 ];
+
+    filepath_convert( filename, sizeof( filename ), BOOTPROF_FILE );
+    FILE *file = fopen( filename, "r" );
+    if ( !file ) {
+        BOOTPROF_DEBUG_LOG("no boot profile from last boot");
+        return;
+    }
+
+    bootprof_num_last_marks = 0;
+    while( fgets( line, sizeof( line ), file ) && bootprof_num_last_marks < BOOTPROF_MAX_MARKS ) {
+        bootprof_mark_t *mark = &bootprof_last_marks[ bootprof_num_last_marks ];
+        if ( sscanf( line, "# firmware %15s", bootprof_last_firmware ) == 1 )
+            continue;
+        if ( sscanf( line, "# baseline %15s %u", bootprof_baseline_firmware, &bootprof_baseline_boot_time ) == 2 )
+            continue;
+        if ( line[ 0 ] == '#' )
+            continue;
+        if ( sscanf( line, "%u %23s", &mark->time, mark->name ) != 2 )
+            continue;
+        bootprof_num_last_marks++;
+    }
+    fclose( file );
+    /**
+     * the last mark is the watchface
+     */
+    if ( bootprof_num_last_marks ) {
+        bootprof_last_boot_time = bootprof_last_marks[ bootprof_num_last_marks - 1 ].time;
+    }
+    BOOTPROF_DEBUG_LOG("boot profile from last boot: %d marks, %dms", bootprof_num_last_marks, bootprof_last_boot_time );
+}
+
+static bootprof_mark_t *bootprof_find_last_mark( const char *name ) {
+    for( uint32_t i = 0 ; i < bootprof_num_last_marks ; i++ ) {
+        if ( !strcmp( bootprof_last_marks[ i ].name, name ) ) {
+            return( &bootprof_last_marks[ i ] );
+        }
+    }
+    return( NULL );
+}
+
+uint32_t bootprof_get_last_time( const char *name ) {
+    bootprof_mark_t *mark = bootprof_find_last_mark( name );
+    return( mark ? mark->time : 0 );
+}
+
+static uint32_t bootprof_estimate_progress( const char *name ) {
+    /**
+     * known step, take the time share from the last boot
+     */
+    bootprof_mark_t *last_mark = bootprof_find_last_mark( name );
+    if ( bootprof_last_boot_time && last_mark ) {
+        return( last_mark->time * 100 / bootprof_last_boot_time );
+    }
+    /**
+     * unknown step, every step has the same weight
+     */
+    uint32_t expected = bootprof_num_last_marks ? bootprof_num_last_marks : BOOTPROF_DEFAULT_MARKS;
+    if ( bootprof_num_marks >= expected ) {
+        return( 99 );
+    }
+    return( bootprof_num_marks * 100 / expected );
+}
+
+void bootprof_mark( const char *name ) {
+    bootprof_mark_t mark;
+
+    strncpy( mark.name, name, sizeof( mark.name ) - 1 );
+    mark.name[ sizeof( mark.name ) - 1 ] = '\0';
+    /**
+     * no spaces in the name, the profile file is space separated
+     */
+    for( char *c = mark.name ; *c ; c++ ) {
+        if ( *c == ' ' )
+            *c = '_';
+    }
+    mark.time = bootprof_now();
+
+    if ( bootprof_num_marks < BOOTPROF_MAX_MARKS ) {
+        bootprof_marks[ bootprof_num_marks++ ] = mark;
+    }
+    /**
+     * the progress bar never moves backwards
+     */
+    uint32_t progress = bootprof_estimate_progress( mark.name );
+    if ( progress > bootprof_progress && !bootprof_boot_time ) {
+        bootprof_progress = progress > 99 ? 99 : progress;
+    }
+    mark.progress = bootprof_progress;
+
+    BOOTPROF_DEBUG_LOG("boot step %s done at %dms (%d%%)", mark.name, mark.time, mark.progress );
+
+    if ( bootprof_callback ) {
+        bootprof_send_event_cb( BOOTPROF_MARK, (void*)&mark );
+    }
+}
+
+/**
+ * @brief check if the profile from this boot is worth a flash write
+ */
+static bool bootprof_changed( void ) {
+    if ( strcmp( bootprof_last_firmware, __FIRMWARE__ ) || bootprof_num_marks != bootprof_num_last_marks ) {
+        return( true );
+    }
+    for( uint32_t i = 0 ; i < bootprof_num_marks ; i++ ) {
+        bootprof_mark_t *mark = &bootprof_marks[ i ];
+        bootprof_mark_t *last_mark = &bootprof_last_marks[ i ];
+        if ( strcmp( mark->name, last_mark->name ) || mark->time > last_mark->time + BOOTPROF_SAVE_THRESHOLD || last_mark->time > mark->time + BOOTPROF_SAVE_THRESHOLD ) {
+            return( true );
+        }
+    }
+    return( false );
+}
+
+void bootprof_finish( void ) {
+    char filename[ 256 ] = "";
+
+    if ( bootprof_boot_time ) {
+        return;
+    }
+    bootprof_mark( "watchface" );
+    bootprof_boot_time = bootprof_marks[ bootprof_num_marks - 1 ].time;
+    bootprof_progress = 100;
+    /**
+     * the first boot of a new firmware makes the last boot the baseline
+     */
+    if ( *bootprof_last_firmware && strcmp( bootprof_last_firmware, __FIRMWARE__ ) && bootprof_last_boot_time ) {
+        strcpy( bootprof_baseline_firmware, bootprof_last_firmware );
+        bootprof_baseline_boot_time = bootprof_last_boot_time;
+    }
+    /**
+     * log the boot profile
+     */
+    if ( bootprof_last_boot_time ) {
+        BOOTPROF_INFO_LOG("time to watchface: %dms (last boot %dms, %+dms)", bootprof_boot_time, bootprof_last_boot_time, (int32_t)( bootprof_boot_time - bootprof_last_boot_time ) );
+    }
+    else {
+        BOOTPROF_INFO_LOG("time to watchface: %dms", bootprof_boot_time );
+    }
+    if ( bootprof_baseline_boot_time ) {
+        BOOTPROF_INFO_LOG("time to watchface firmware %s: %dms, firmware %s: %dms (%+dms)", bootprof_baseline_firmware, bootprof_baseline_boot_time, __FIRMWARE__, bootprof_boot_time, (int32_t)( bootprof_boot_time - bootprof_baseline_boot_time ) );
+    }
+    for( uint32_t i = 0 ; i < bootprof_num_marks ; i++ ) {
+        BOOTPROF_DEBUG_LOG("  %-24s %6dms (+%dms)", bootprof_marks[ i ].name, bootprof_marks[ i ].time, bootprof_marks[ i ].time - ( i ? bootprof_marks[ i - 1 ].time : 0 ) );
+    }
+    /**
+     * save the step times for the progress estimation on the next boot,
+     * a boot like the last one spares the flash write
+     */
+    if ( !bootprof_changed() ) {
+        BOOTPROF_DEBUG_LOG("boot profile unchanged, not saved");
+        return;
+    }
+    filepath_convert( filename, sizeof( filename ), BOOTPROF_FILE );
+    FILE *file = fopen( filename, "w" );
+    if ( !file ) {
+        BOOTPROF_ERROR_LOG("can't write boot profile %s", filename );
+        return;
+    }
+    fprintf( file, "# %s %s boot profile\n", HARDWARE_NAME, __FIRMWARE__ );
+    fprintf( file, "# firmware %s\n", __FIRMWARE__ );
+    if ( bootprof_baseline_boot_time ) {
+        fprintf( file, "# baseline %s %u\n", bootprof_baseline_firmware, bootprof_baseline_boot_time );
+    }
+    for( uint32_t i = 0 ; i < bootprof_num_marks ; i++ ) {
+        fprintf( file, "%u %s\n", bootprof_marks[ i ].time, bootprof_marks[ i ].name );
+    }
+    fclose( file );
+}
+
+uint32_t bootprof_get_progress( void ) {
+    return( bootprof_progress );
+}
+
+uint32_t bootprof_get_boot_time( void ) {
+    return( bootprof_boot_time );
+}
+
+uint32_t bootprof_get_last_boot_time( void ) {
+    return( bootprof_last_boot_time );
+}
@@ -0,0 +1,99 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _BOOTPROF_H
+    #define _BOOTPROF_H
+
+    #include "hardware/callback.h"
+    #include "utils/io.h"
+
+    #define BOOTPROF_INFO_LOG           log_i
+    #define BOOTPROF_DEBUG_LOG          log_d
+    #define BOOTPROF_ERROR_LOG          log_e
+
+    #define BOOTPROF_MARK               _BV(0)                  /** @brief event mask for a boot step mark, arg is a pointer to a bootprof_mark_t */
+    #define BOOTPROF_FILE               "/spiffs/bootprof.txt"  /** @brief step times from the last boot */
+    #define BOOTPROF_MAX_MARKS          80                      /** @brief max boot steps */
+    #define BOOTPROF_NAME_LEN           24                      /** @brief max step name length */
+    #define BOOTPROF_FIRMWARE_LEN       16                      /** @brief max firmware version length */
+    #define BOOTPROF_DEFAULT_MARKS      60                      /** @brief expected steps without a last boot profile */
+    #define BOOTPROF_SAVE_THRESHOLD     50                      /** @brief ms a step has to differ from the last boot to rewrite the profile */
+    /**
+     * @brief boot step mark
+     */
+    typedef struct {
+        char name[ BOOTPROF_NAME_LEN ] = "";    /** @brief step name */
+        uint32_t time = 0;                      /** @brief ms since boot when the step was done */
+        uint32_t progress = 0;                  /** @brief estimated boot progress in percent */
+    } bootprof_mark_t;
+    /**
+     * @brief mark a finished boot step, informs all registered callbacks
+     *
+     * @param   name    step name, e.g. "pmu"
+     */
+    void bootprof_mark( const char *name );
+    /**
+     * @brief load the step times from the last boot, call it when spiffs is mounted
+     */
+    void bootprof_load( void );
+    /**
+     * @brief mark the boot as finished, log the time to watchface against the last boot
+     * and the last firmware, save the step times if a step differs more than BOOTPROF_SAVE_THRESHOLD
+     */
+    void bootprof_finish( void );
+    /**
+     * @brief registers a callback function which is called on a corresponding event
+     *
+     * @param   event           possible values: BOOTPROF_MARK
+     * @param   callback_func   pointer to the callback function
+     * @param   id              program id
+     *
+     * @return  true if success, false if failed
+     */
+    bool bootprof_register_cb( EventBits_t event, CALLBACK_FUNC callback_func, const char *id );
+    /**
+     * @brief get the estimated boot progress, based on the step times from the last boot
+     *
+     * @return  progress in percent
+     */
+    uint32_t bootprof_get_progress( void );
+    /**
+     * @brief get the time of a step from the last boot
+     *
+     * @param   name    step name
+     *
+     * @return  ms since boot, 0 if unknown
+     */
+    uint32_t bootprof_get_last_time( const char *name );
+    /**
+     * @brief get the time to watchface
+     *
+     * @return  ms from boot to bootprof_finish(), 0 if not finished
+     */
+    uint32_t bootprof_get_boot_time( void );
+    /**
+     * @brief get the time to watchface from the last boot
+     *
+     * @return  ms, 0 if unknown
+     */
+    uint32_t bootprof_get_last_boot_time( void );
+
+#endif // _BOOTPROF_H
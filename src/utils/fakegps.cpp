@@ -23,7 +23,7 @@
 #include "fakegps.h"
 #include "hardware/gpsctl.h"
 #include "hardware/wifictl.h"
-#include "utils/uri_load/uri_load.h"
+#include "utils/uri_load/uri_load_stream.h"
 #include "utils/json_psram_allocator.h"
 
 #ifdef NATIVE_64BIT
@@ -130,12 +130,13 @@ void fakegps_get_location_Task( void * pvParameters ) {
         log_i("start fakegps task, heap: %d", ESP.getFreeHeap() );
         if ( xEventGroupGetBits( fakegps_event ) & FAKEGPS_SYNC_REQUEST ) {
     #endif
-            uri_load_dsc_t *uri_load_dsc = uri_load_to_ram( GEOIP_URL );
-            if ( uri_load_dsc ) {
+            UriLoadStream stream;
+            if ( stream.begin( GEOIP_URL ) ) {
 
-                SpiRamJsonDocument doc( uri_load_dsc->size * 4 );
+                SpiRamJsonDocument doc( stream.jsonSize( 4 ) );
 
-                DeserializationError error = deserializeJson( doc, uri_load_dsc->data );
+                DeserializationError error = deserializeJson( doc, stream );
+                stream.end();
                 if (error) {
                     log_e("fakegps deserializeJson() failed: %s", error.c_str() );
                 }
@@ -152,7 +153,6 @@ void fakegps_get_location_Task( void * pvParameters ) {
             else {
                 log_e("get location via fakegps failed");
             }
-            uri_load_free_all( uri_load_dsc );
         }
     #ifdef NATIVE_64BIT
         fakegps_event &= ~FAKEGPS_SYNC_REQUEST;
@@ -0,0 +1,474 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "lvgl.h"
+#include "fbstream.h"
+#include "hardware/framebuffer.h"
+#include "hardware/powermgm.h"
+#include "utils/alloc.h"
+
+#ifdef NATIVE_64BIT
+    #include <string.h>
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <errno.h>
+    #include <sys/types.h>
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include "utils/logging.h"
+
+    static int fbstream_server_fd = -1;                             /** @brief listening socket */
+    static int fbstream_client_fd = -1;                             /** @brief connected client socket */
+    static uint8_t *fbstream_pending = NULL;                        /** @brief not yet sent packet data */
+    static size_t fbstream_pending_size = 0;                        /** @brief bytes in the pending buffer */
+    static size_t fbstream_pending_offset = 0;                      /** @brief bytes already sent from the pending buffer */
+#else
+    #include <Arduino.h>
+    #include <AsyncTCP.h>
+    #include <ESPAsyncWebServer.h>
+
+    AsyncWebSocket fbstream_ws( FBSTREAM_WS_URI );                  /** @brief websocket for the builtin webserver */
+#endif
+
+static uint16_t *fbstream_current = NULL;                           /** @brief current screen content as RGB565 */
+static uint16_t *fbstream_sent = NULL;                              /** @brief screen content the clients have */
+static uint8_t *fbstream_packet = NULL;                             /** @brief packet encode buffer */
+static lv_area_t fbstream_dirty;                                    /** @brief screen area changed since the last packet */
+static bool fbstream_dirty_valid = false;                           /** @brief true if fbstream_dirty is set */
+static bool fbstream_keyframe = false;                              /** @brief a full screen keyframe is being sent */
+static lv_coord_t fbstream_keyframe_y = 0;                          /** @brief first keyframe line the client has not got */
+static volatile bool fbstream_refresh_request = false;              /** @brief a new client needs a full screen */
+static volatile uint32_t fbstream_clients = 0;                      /** @brief connected clients */
+static uint32_t fbstream_last_packet = 0;                           /** @brief lv_tick of the last sent packet */
+static fbstream_stats_t fbstream_stats;
+
+bool fbstream_framebuffer_event_cb( EventBits_t event, void *arg );
+bool fbstream_powermgm_loop_cb( EventBits_t event, void *arg );
+static bool fbstream_alloc( void );
+static bool fbstream_can_send( void );
+static bool fbstream_send( const uint8_t *data, size_t size );
+static void fbstream_send_dirty( void );
+static lv_coord_t fbstream_send_area( const lv_area_t *area, bool keyframe );
+
+void fbstream_setup( void ) {
+    lv_area_set( &fbstream_dirty, 0, 0, 0, 0 );
+    fbstream_dirty_valid = false;
+
+    #ifdef NATIVE_64BIT
+        /**
+         * open a non blocking tcp listener for the native emulator
+         */
+        fbstream_server_fd = socket( AF_INET, SOCK_STREAM, 0 );
+        if ( fbstream_server_fd >= 0 ) {
+            int reuse = 1;
+            struct sockaddr_in addr;
+            memset( &addr, 0, sizeof( addr ) );
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+            addr.sin_port = htons( FBSTREAM_NATIVE_PORT );
+            setsockopt( fbstream_server_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof( reuse ) );
+            if ( bind( fbstream_server_fd, (struct sockaddr *)&addr, sizeof( addr ) ) == 0 && listen( fbstream_server_fd, 1 ) == 0 ) {
+                fcntl( fbstream_server_fd, F_SETFL, fcntl( fbstream_server_fd, F_GETFL, 0 ) | O_NONBLOCK );
+                FBSTREAM_INFO_LOG("framebuffer stream on tcp://127.0.0.1:%d", FBSTREAM_NATIVE_PORT );
+            }
+            else {
+                FBSTREAM_ERROR_LOG("framebuffer stream: bind/listen failed");
+                close( fbstream_server_fd );
+                fbstream_server_fd = -1;
+            }
+        }
+    #else
+        /**
+         * count clients and request a keyframe for each new one,
+         * all lvgl work is done later in the loop
+         */
+        fbstream_ws.onEvent( []( AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len ) {
+            switch( type ) {
+                case WS_EVT_CONNECT:
+                    FBSTREAM_INFO_LOG("fbstream client #%u connected", client->id() );
+                    fbstream_refresh_request = true;
+                    fbstream_clients = server->count();
+                    break;
+                case WS_EVT_DISCONNECT:
+                    FBSTREAM_INFO_LOG("fbstream client #%u disconnected", client->id() );
+                    fbstream_clients = server->count();
+                    break;
+                default:
+                    break;
+            }
+        });
+    #endif
+    /**
+     * register framebuffer and powermgm callback functions
+     */
+    framebuffer_register_cb( FRAMEBUFFER_FLUSH, fbstream_framebuffer_event_cb, "fbstream" );
+    powermgm_register_loop_cb( POWERMGM_WAKEUP | POWERMGM_SILENCE_WAKEUP, fbstream_powermgm_loop_cb, "fbstream loop" );
+}
+
+#ifndef NATIVE_64BIT
+AsyncWebHandler *fbstream_get_handler( void ) {
+    return( &fbstream_ws );
+}
+#endif
+
+fbstream_stats_t *fbstream_get_stats( void ) {
+    fbstream_stats.clients = fbstream_clients;
+    return( &fbstream_stats );
+}
+
+static bool fbstream_alloc( void ) {
+    /**
+     * allocate frame buffers on first use, they stay allocated
+     */
+    if ( !fbstream_current )
+        fbstream_current = (uint16_t*)CALLOC( RES_X_MAX * RES_Y_MAX, sizeof( uint16_t ) );
+    if ( !fbstream_sent )
+        fbstream_sent = (uint16_t*)CALLOC( RES_X_MAX * RES_Y_MAX, sizeof( uint16_t ) );
+    if ( !fbstream_packet )
+        fbstream_packet = (uint8_t*)MALLOC( FBSTREAM_MAX_PACKET_SIZE );
+
+    if ( !fbstream_current || !fbstream_sent || !fbstream_packet ) {
+        FBSTREAM_ERROR_LOG("fbstream buffer alloc failed");
+        return( false );
+    }
+    return( true );
+}
+
+bool fbstream_framebuffer_event_cb( EventBits_t event, void *arg ) {
+    framebuffer_flush_t *framebuffer_flush = (framebuffer_flush_t*)arg;
+    /**
+     * nothing to do without a client
+     */
+    if ( !fbstream_clients || !fbstream_current ) {
+        return( true );
+    }
+
+    switch( event ) {
+        case FRAMEBUFFER_FLUSH: {
+            const lv_area_t *area = framebuffer_flush->area;
+            const lv_color_t *color = framebuffer_flush->color_p;
+            /**
+             * copy the flushed area into the current frame
+             */
+            for( lv_coord_t y = area->y1 ; y <= area->y2 ; y++ ) {
+                uint16_t *dst = &fbstream_current[ y * RES_X_MAX + area->x1 ];
+                for( lv_coord_t x = area->x1 ; x <= area->x2 ; x++ ) {
+                    *dst++ = lv_color_to16( *color );
+                    color++;
+                }
+            }
+            /**
+             * merge into the dirty area, a pending area means this flush
+             * is coalesced into the next packet
+             */
+            if ( fbstream_dirty_valid ) {
+                _lv_area_join( &fbstream_dirty, &fbstream_dirty, area );
+                fbstream_stats.coalesced++;
+            }
+            else {
+                lv_area_copy( &fbstream_dirty, area );
+                fbstream_dirty_valid = true;
+            }
+            fbstream_stats.flushes++;
+            break;
+        }
+    }
+    return( true );
+}
+
+bool fbstream_powermgm_loop_cb( EventBits_t event, void *arg ) {
+    #ifdef NATIVE_64BIT
+        /**
+         * accept a new client, a new one replaces the old one
+         */
+        if ( fbstream_server_fd >= 0 ) {
+            int fd = accept( fbstream_server_fd, NULL, NULL );
+            if ( fd >= 0 ) {
+                int nodelay = 1;
+                fcntl( fd, F_SETFL, fcntl( fd, F_GETFL, 0 ) | O_NONBLOCK );
+                setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof( nodelay ) );
+                if ( fbstream_client_fd >= 0 )
+                    close( fbstream_client_fd );
+                fbstream_client_fd = fd;
+                fbstream_pending_size = 0;
+                fbstream_pending_offset = 0;
+                fbstream_clients = 1;
+                fbstream_refresh_request = true;
+                FBSTREAM_INFO_LOG("fbstream client connected");
+            }
+        }
+    #else
+        fbstream_ws.cleanupClients();
+    #endif
+
+    if ( !fbstream_clients ) {
+        return( true );
+    }
+    /**
+     * a new client need a full screen, redraw the screen into the current frame
+     */
+    if ( fbstream_refresh_request ) {
+        fbstream_refresh_request = false;
+        if ( fbstream_alloc() ) {
+            fbstream_keyframe = true;
+            fbstream_keyframe_y = 0;
+            lv_obj_invalidate( lv_scr_act() );
+            lv_refr_now( NULL );
+        }
+    }
+    /**
+     * limit packet rate, flushes in between are coalesced
+     */
+    if ( lv_tick_elaps( fbstream_last_packet ) < FBSTREAM_MIN_INTERVAL ) {
+        return( true );
+    }
+    /**
+     * send only if the client has taken all data, otherwise keep
+     * merging dirty areas until the client is ready
+     */
+    if ( !fbstream_dirty_valid && !fbstream_keyframe ) {
+        return( true );
+    }
+    if ( !fbstream_can_send() ) {
+        fbstream_stats.backpressure++;
+        return( true );
+    }
+    fbstream_send_dirty();
+    fbstream_last_packet = lv_tick_get();
+
+    return( true );
+}
+
+static void fbstream_send_dirty( void ) {
+    /**
+     * a keyframe resumes at the first line the client has not got, a slow
+     * client gets it over several loops without starting over
+     */
+    if ( fbstream_keyframe ) {
+        lv_area_t area;
+        lv_area_set( &area, 0, fbstream_keyframe_y, RES_X_MAX - 1, RES_Y_MAX - 1 );
+        fbstream_keyframe_y = fbstream_send_area( &area, true );
+        if ( fbstream_keyframe_y < RES_Y_MAX ) {
+            return;
+        }
+        fbstream_keyframe = false;
+        fbstream_keyframe_y = 0;
+    }
+    /**
+     * areas changed meanwhile go as delta, lines of the keyframe sent
+     * after the change are skipped
+     */
+    if ( fbstream_dirty_valid ) {
+        lv_coord_t y = fbstream_send_area( &fbstream_dirty, false );
+        if ( y <= fbstream_dirty.y2 ) {
+            fbstream_dirty.y1 = y;
+            return;
+        }
+        fbstream_dirty_valid = false;
+    }
+}
+
+/**
+ * @brief send an area in strips that fit into one packet in the worst case
+ *
+ * @param   area        area to send
+ * @param   keyframe    true to send without delta
+ *
+ * @return  first line not sent because the client is full, area->y2 + 1 if done
+ */
+static lv_coord_t fbstream_send_area( const lv_area_t *area, bool keyframe ) {
+    uint16_t *reference = keyframe ? NULL : fbstream_sent;
+    uint16_t x = area->x1;
+    uint16_t w = lv_area_get_width( area );
+    uint16_t lines = ( FBSTREAM_MAX_PACKET_SIZE - FBSTREAM_HEADER_SIZE ) / ( w * 2 + w / FBSTREAM_MAX_LITERAL + 1 );
+
+    for( lv_coord_t y = area->y1 ; y <= area->y2 ; y += lines ) {
+        uint16_t h = ( area->y2 - y + 1 ) < lines ? ( area->y2 - y + 1 ) : lines;
+        /**
+         * stop if the client is full, the rest is sent later
+         */
+        if ( !fbstream_can_send() ) {
+            fbstream_stats.backpressure++;
+            return( y );
+        }
+        size_t size = fbstream_encode( fbstream_packet, FBSTREAM_MAX_PACKET_SIZE, fbstream_current, reference, RES_X_MAX, x, y, w, h );
+        if ( !size ) {
+            FBSTREAM_ERROR_LOG("fbstream encode failed");
+            break;
+        }
+        /**
+         * keyframe bypass the delta, so update the reference by hand
+         */
+        if ( !reference ) {
+            for( uint16_t line = 0 ; line < h ; line++ )
+                memcpy( &fbstream_sent[ ( y + line ) * RES_X_MAX + x ], &fbstream_current[ ( y + line ) * RES_X_MAX + x ], w * sizeof( uint16_t ) );
+        }
+        if ( !fbstream_send( fbstream_packet, size ) ) {
+            break;
+        }
+        fbstream_stats.packets++;
+        fbstream_stats.raw_bytes += w * h * sizeof( uint16_t );
+        fbstream_stats.encoded_bytes += size;
+    }
+    return( area->y2 + 1 );
+}
+
+static bool fbstream_can_send( void ) {
+    #ifdef NATIVE_64BIT
+        /**
+         * try to get rid of the pending data
+         */
+        while( fbstream_client_fd >= 0 && fbstream_pending_offset < fbstream_pending_size ) {
+            ssize_t sent = send( fbstream_client_fd, fbstream_pending + fbstream_pending_offset, fbstream_pending_size - fbstream_pending_offset, MSG_NOSIGNAL | MSG_DONTWAIT );
+            if ( sent < 0 ) {
+                if ( errno == EAGAIN || errno == EWOULDBLOCK ) {
+                    return( false );
+                }
+                FBSTREAM_INFO_LOG("fbstream client disconnected");
+                close( fbstream_client_fd );
+                fbstream_client_fd = -1;
+                fbstream_clients = 0;
+                return( false );
+            }
+            fbstream_pending_offset += sent;
+        }
+        fbstream_pending_size = 0;
+        fbstream_pending_offset = 0;
+        return( fbstream_client_fd >= 0 );
+    #else
+        return( fbstream_ws.availableForWriteAll() );
+    #endif
+}
+
+static bool fbstream_send( const uint8_t *data, size_t size ) {
+    #ifdef NATIVE_64BIT
+        if ( fbstream_client_fd < 0 ) {
+            return( false );
+        }
+        if ( !fbstream_pending ) {
+            fbstream_pending = (uint8_t*)MALLOC( FBSTREAM_MAX_PACKET_SIZE );
+            if ( !fbstream_pending ) {
+                FBSTREAM_ERROR_LOG("fbstream pending buffer alloc failed");
+                return( false );
+            }
+        }
+        /**
+         * queue the packet and try to send it right now
+         */
+        memcpy( fbstream_pending, data, size );
+        fbstream_pending_size = size;
+        fbstream_pending_offset = 0;
+        fbstream_can_send();
+        return( true );
+    #else
+        fbstream_ws.binaryAll( (uint8_t*)data, size );
+        return( true );
+    #endif
+}
+
+static inline uint8_t *fbstream_put_pixel( uint8_t *dst, uint16_t pixel ) {
+    *dst++ = pixel & 0xff;
+    *dst++ = pixel >> 8;
+    return( dst );
+}
+
+size_t fbstream_encode( uint8_t *dst, size_t dst_size, const uint16_t *current, uint16_t *reference, uint16_t stride, uint16_t x, uint16_t y, uint16_t w, uint16_t h ) {
+    uint8_t *out = dst + FBSTREAM_HEADER_SIZE;
+    uint8_t *end = dst + dst_size;
+
+    if ( dst_size < FBSTREAM_HEADER_SIZE ) {
+        return( 0 );
+    }
+    /**
+     * encode line by line, tokens never cross a line
+     */
+    for( uint16_t line = 0 ; line < h ; line++ ) {
+        const uint16_t *cur = &current[ ( y + line ) * stride + x ];
+        uint16_t *ref = reference ? &reference[ ( y + line ) * stride + x ] : NULL;
+        uint16_t i = 0;
+
+        while( i < w ) {
+            uint16_t n = 1;
+            /**
+             * unchanged pixels
+             */
+            if ( ref && cur[ i ] == ref[ i ] ) {
+                while( i + n < w && n < FBSTREAM_MAX_SKIP && cur[ i + n ] == ref[ i + n ] )
+                    n++;
+                if ( out + 1 > end )
+                    return( 0 );
+                *out++ = FBSTREAM_TOKEN_SKIP | ( n - 1 );
+            }
+            /**
+             * run of the same pixel
+             */
+            else if ( i + 1 < w && cur[ i + 1 ] == cur[ i ] ) {
+                while( i + n < w && n < FBSTREAM_MAX_REPEAT && cur[ i + n ] == cur[ i ] )
+                    n++;
+                if ( out + 3 > end )
+                    return( 0 );
+                *out++ = FBSTREAM_TOKEN_REPEAT | ( n - 1 );
+                out = fbstream_put_pixel( out, cur[ i ] );
+            }
+            /**
+             * literal pixels until an unchanged pixel or a run starts
+             */
+            else {
+                while( i + n < w && n < FBSTREAM_MAX_LITERAL ) {
+                    if ( ref && cur[ i + n ] == ref[ i + n ] )
+                        break;
+                    if ( i + n + 1 < w && cur[ i + n + 1 ] == cur[ i + n ] )
+                        break;
+                    n++;
+                }
+                if ( out + 1 + n * 2 > end )
+                    return( 0 );
+                *out++ = FBSTREAM_TOKEN_LITERAL | ( n - 1 );
+                for( uint16_t j = 0 ; j < n ; j++ )
+                    out = fbstream_put_pixel( out, cur[ i + j ] );
+            }
+            /**
+             * the client has these pixels now
+             */
+            if ( ref )
+                memcpy( &ref[ i ], &cur[ i ], n * sizeof( uint16_t ) );
+            i += n;
+        }
+    }
+    /**
+     * write packet header
+     */
+    uint32_t payload = out - dst - FBSTREAM_HEADER_SIZE;
+    dst[ 0 ] = 'F';
+    dst[ 1 ] = 'B';
+    dst[ 2 ] = FBSTREAM_VERSION;
+    dst[ 3 ] = reference ? 0 : FBSTREAM_FLAG_KEYFRAME;
+    fbstream_put_pixel( &dst[ 4 ], x );
+    fbstream_put_pixel( &dst[ 6 ], y );
+    fbstream_put_pixel( &dst[ 8 ], w );
+    fbstream_put_pixel( &dst[ 10 ], h );
+    fbstream_put_pixel( &dst[ 12 ], payload & 0xffff );
+    fbstream_put_pixel( &dst[ 14 ], payload >> 16 );
+
+    return( out - dst );
+}
@@ -0,0 +1,113 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _FBSTREAM_H
+    #define _FBSTREAM_H
+
+    #include <stdint.h>
+    #include <stddef.h>
+
+    #define FBSTREAM_INFO_LOG           log_i
+    #define FBSTREAM_DEBUG_LOG          log_d
+    #define FBSTREAM_ERROR_LOG          log_e
+
+    #define FBSTREAM_WS_URI             "/fbstream"         /** @brief websocket uri on the builtin webserver */
+    #define FBSTREAM_NATIVE_PORT        8081                /** @brief tcp port for the native emulator stream */
+    #define FBSTREAM_MAX_PACKET_SIZE    16384               /** @brief max encoded packet size, bigger areas are split by lines */
+    #define FBSTREAM_MIN_INTERVAL       40                  /** @brief min time between two packets in ms */
+    /**
+     * stream packet format, all values little endian
+     *
+     * offset  size  description
+     *  0      2     magic 'F','B'
+     *  2      1     version, FBSTREAM_VERSION
+     *  3      1     flags, FBSTREAM_FLAG_*
+     *  4      2     x
+     *  6      2     y
+     *  8      2     w
+     *  10     2     h
+     *  12     4     payload length in bytes
+     *  16     n     payload, RLE tokens over w*h RGB565 pixels in line order
+     *
+     * payload tokens:
+     *  00nnnnnn            skip n+1 pixels, unchanged since the last packet
+     *  01nnnnnn pppp       repeat pixel pppp n+1 times
+     *  1nnnnnnn pppp ...   n+1 literal pixels follow
+     */
+    #define FBSTREAM_VERSION            1
+    #define FBSTREAM_HEADER_SIZE        16
+    #define FBSTREAM_FLAG_KEYFRAME      0x01                /** @brief area is not a delta, clear it before decode */
+
+    #define FBSTREAM_TOKEN_SKIP         0x00
+    #define FBSTREAM_TOKEN_REPEAT       0x40
+    #define FBSTREAM_TOKEN_LITERAL      0x80
+    #define FBSTREAM_MAX_SKIP           64
+    #define FBSTREAM_MAX_REPEAT         64
+    #define FBSTREAM_MAX_LITERAL        128
+    /**
+     * @brief fbstream statistics
+     */
+    typedef struct {
+        uint32_t clients = 0;                   /** @brief number of connected clients */
+        uint32_t flushes = 0;                   /** @brief number of flushed areas seen */
+        uint32_t packets = 0;                   /** @brief number of packets sent */
+        uint32_t coalesced = 0;                 /** @brief number of flushes merged into a later packet */
+        uint32_t backpressure = 0;              /** @brief number of send attempts deferred by a slow client */
+        uint64_t raw_bytes = 0;                 /** @brief raw RGB565 bytes covered by sent packets */
+        uint64_t encoded_bytes = 0;             /** @brief encoded bytes sent */
+    } fbstream_stats_t;
+    /**
+     * @brief setup framebuffer streaming, hooks into the framebuffer flush path
+     */
+    void fbstream_setup( void );
+    /**
+     * @brief get the current stream statistics
+     *
+     * @return  pointer to a fbstream_stats_t structure
+     */
+    fbstream_stats_t *fbstream_get_stats( void );
+    /**
+     * @brief encode a screen area as delta against a reference frame and update the reference
+     *
+     * @param   dst         pointer to the output buffer
+     * @param   dst_size    size of the output buffer
+     * @param   current     pointer to the current RGB565 frame
+     * @param   reference   pointer to the RGB565 frame the client has, NULL for a keyframe
+     * @param   stride      frame width in pixel
+     * @param   x           area x
+     * @param   y           area y
+     * @param   w           area width
+     * @param   h           area height
+     *
+     * @return  packet size in bytes incl. header, 0 if the output buffer is to small
+     */
+    size_t fbstream_encode( uint8_t *dst, size_t dst_size, const uint16_t *current, uint16_t *reference, uint16_t stride, uint16_t x, uint16_t y, uint16_t w, uint16_t h );
+    #ifndef NATIVE_64BIT
+        #include <ESPAsyncWebServer.h>
+        /**
+         * @brief get the websocket handler for the builtin webserver
+         *
+         * @return  pointer to an AsyncWebHandler
+         */
+        AsyncWebHandler *fbstream_get_handler( void );
+    #endif
+
+#endif // _FBSTREAM_H
@@ -0,0 +1,680 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "geofence.h"
+#include "hardware/gpsctl.h"
+#include "utils/alloc.h"
+#include "utils/lock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef NATIVE_64BIT
+    #include <time.h>
+    #include "utils/logging.h"
+    #include "utils/millis.h"
+#else
+    #include <Arduino.h>
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/semphr.h>
+#endif
+static lock_mutex_t geofence_mutex = LOCK_MUTEX_INITIALIZER;           /** @brief fixes from the gpsctl loop, fences from apps */
+
+#define GEOFENCE_M_PER_DEG          111319.49       /** @brief meters per degree latitude */
+/**
+ * @brief a circle or a polygon with its bounding box, the box includes
+ * the hysteresis
+ */
+typedef struct {
+    bool used = false;                      /** @brief true if the slot holds a fence */
+    bool polygon = false;                   /** @brief true for a polygon, false for a circle */
+    bool inside = false;                    /** @brief true if the last fix was inside */
+    bool dwelled = false;                   /** @brief true if the dwell event was sent */
+    char name[ GEOFENCE_NAME_LEN ] = "";    /** @brief fence name */
+    double lat = 0;                         /** @brief circle center latitude */
+    double lon = 0;                         /** @brief circle center longitude */
+    double scale = 0;                       /** @brief meters per degree longitude at the center */
+    double radius = 0;                      /** @brief circle radius in m */
+    geofence_point_t *points = NULL;        /** @brief polygon points */
+    uint32_t count = 0;                     /** @brief polygon point count */
+    double min_lat = 0;                     /** @brief bounding box */
+    double max_lat = 0;
+    double min_lon = 0;
+    double max_lon = 0;
+    uint32_t dwell = 0;                     /** @brief ms inside before a dwell event, 0 for none */
+    uint64_t enter_time = 0;                /** @brief ms of the enter event */
+    uint32_t stamp = 0;                     /** @brief fix number of the last test, tests a fence once per fix */
+} geofence_t;
+/**
+ * @brief a fence in a grid cell, chained per hash bucket
+ */
+typedef struct {
+    int32_t cell_lat;                       /** @brief cell row */
+    int32_t cell_lon;                       /** @brief cell column */
+    uint32_t fence;                         /** @brief fence index */
+    int32_t next;                           /** @brief next entry in the bucket, -1 for the end */
+} geofence_cell_t;
+/**
+ * @brief a event, collected under the lock and sent after it
+ */
+typedef struct {
+    EventBits_t event;                      /** @brief GEOFENCE_ENTER, GEOFENCE_EXIT or GEOFENCE_DWELL */
+    geofence_event_t arg;                   /** @brief event arg */
+} geofence_pending_t;
+
+callback_t *geofence_callback = NULL;
+
+static geofence_stats_t geofence_stats;
+static geofence_t *geofence_fences = NULL;                          /** @brief fence slots, the index is the id */
+static uint32_t geofence_fences_num = 0;                            /** @brief used slots, free ones included */
+static uint32_t geofence_fences_size = 0;                           /** @brief allocated slots */
+/**
+ * the grid index, a fence is in every cell its bounding box touches, the
+ * cells are hashed into buckets, large fences go into a list of its own
+ */
+static geofence_cell_t *geofence_cells = NULL;
+static uint32_t geofence_cells_num = 0;
+static uint32_t geofence_cells_size = 0;
+static int32_t geofence_bucket[ GEOFENCE_BUCKETS ];
+static int32_t geofence_large = -1;                                 /** @brief chain of fences over GEOFENCE_MAX_CELLS */
+static bool geofence_dirty = true;                                  /** @brief rebuild the index before the next fix */
+/**
+ * fences the last fix was inside, they are tested even if the next fix
+ * is in another cell
+ */
+static uint32_t *geofence_inside = NULL;
+static uint32_t *geofence_inside_next = NULL;
+static uint32_t geofence_inside_num = 0;
+static uint32_t geofence_inside_next_num = 0;
+static uint32_t geofence_stamp = 0;
+static bool geofence_linear = false;                                /** @brief test all fences without the grid, for the bench */
+
+static geofence_pending_t geofence_pending[ GEOFENCE_MAX_EVENTS ];
+static uint32_t geofence_pending_num = 0;
+
+static bool geofence_gpsctl_event_cb( EventBits_t event, void *arg );
+static bool geofence_send_event_cb( EventBits_t event, void *arg );
+static bool geofence_index_add( uint32_t fence );
+static void geofence_index_rebuild( void );
+#ifdef NATIVE_64BIT
+    static void geofence_bench( const char *arg );
+#endif
+
+static void geofence_lock( void ) {
+    lock_mutex_take( &geofence_mutex );
+}
+
+static void geofence_unlock( void ) {
+    lock_mutex_give( &geofence_mutex );
+}
+
+void geofence_setup( void ) {
+    gpsctl_register_cb( GPSCTL_UPDATE_LOCATION, geofence_gpsctl_event_cb, "geofence" );
+#ifdef NATIVE_64BIT
+    const char *bench = getenv( GEOFENCE_BENCH_ENV );
+    if ( bench && *bench ) {
+        geofence_bench( bench );
+    }
+#endif
+}
+
+bool geofence_register_cb( EventBits_t event, CALLBACK_FUNC callback_func, const char *id ) {
+    /*
+     * check if an callback table exist, if not allocate a callback table
+     */
+    if ( geofence_callback == NULL ) {
+        geofence_callback = callback_init( "geofence" );
+        if ( geofence_callback == NULL ) {
+            GEOFENCE_ERROR_LOG("geofence callback alloc failed");
+            while(true);
+        }
+    }
+    /*
+     * register an callback entry and return them
+     */
+    return( callback_register( geofence_callback, event, callback_func, id ) );
+}
+
+static bool geofence_send_event_cb( EventBits_t event, void *arg ) {
+    /*
+     * call all callbacks with her event mask
+     */
+    return( callback_send( geofence_callback, event, arg ) );
+}
+
+static bool geofence_gpsctl_event_cb( EventBits_t event, void *arg ) {
+    gps_data_t *gps_data = (gps_data_t*)arg;
+
+    switch( event ) {
+        case GPSCTL_UPDATE_LOCATION:
+            if ( gps_data && gps_data->valid_location ) {
+                geofence_check( gps_data->lat, gps_data->lon );
+            }
+            break;
+    }
+    return( true );
+}
+
+geofence_stats_t *geofence_get_stats( void ) {
+    return( &geofence_stats );
+}
+
+/**
+ * @brief get a free fence slot, grow the slots and the inside lists if needed
+ *
+ * @return  slot index, -1 if failed
+ */
+static int32_t geofence_alloc( void ) {
+    for( uint32_t i = 0 ; i < geofence_fences_num ; i++ ) {
+        if ( !geofence_fences[ i ].used ) {
+            return( i );
+        }
+    }
+    if ( geofence_fences_num == geofence_fences_size ) {
+        uint32_t size = geofence_fences_size ? geofence_fences_size * 2 : 16;
+        geofence_t *fences = (geofence_t*)REALLOC( geofence_fences, sizeof( geofence_t ) * size );
+        if ( !fences ) {
+            return( -1 );
+        }
+        geofence_fences = fences;
+        uint32_t *inside = (uint32_t*)REALLOC( geofence_inside, sizeof( uint32_t ) * size );
+        if ( inside ) {
+            geofence_inside = inside;
+        }
+        uint32_t *inside_next = (uint32_t*)REALLOC( geofence_inside_next, sizeof( uint32_t ) * size );
+        if ( inside_next ) {
+            geofence_inside_next = inside_next;
+        }
+        if ( !inside || !inside_next ) {
+            return( -1 );
+        }
+        geofence_fences_size = size;
+    }
+    geofence_fences[ geofence_fences_num ] = geofence_t();
+    return( geofence_fences_num++ );
+}
+
+/**
+ * @brief take a filled slot into use
+ */
+static int32_t geofence_commit( int32_t id ) {
+    geofence_t *fence = &geofence_fences[ id ];
+
+    fence->used = true;
+    if ( !geofence_dirty && !geofence_index_add( id ) ) {
+        free( fence->points );
+        geofence_fences[ id ] = geofence_t();
+        return( -1 );
+    }
+    geofence_stats.fences++;
+    return( id );
+}
+
+int32_t geofence_add_circle( const char *name, double lat, double lon, double radius, uint32_t dwell ) {
+    if ( radius <= 0 || fabs( lat ) > 89.0 ) {
+        GEOFENCE_ERROR_LOG("invalid circle fence");
+        return( -1 );
+    }
+    geofence_lock();
+    int32_t id = geofence_alloc();
+    if ( id < 0 ) {
+        geofence_unlock();
+        GEOFENCE_ERROR_LOG("fence alloc failed");
+        return( -1 );
+    }
+    geofence_t *fence = &geofence_fences[ id ];
+    snprintf( fence->name, sizeof( fence->name ), "%s", name ? name : "" );
+    fence->lat = lat;
+    fence->lon = lon;
+    fence->scale = GEOFENCE_M_PER_DEG * cos( lat * M_PI / 180.0 );
+    fence->radius = radius;
+    fence->dwell = dwell;
+    double dlat = ( radius + GEOFENCE_HYSTERESIS ) / GEOFENCE_M_PER_DEG;
+    double dlon = ( radius + GEOFENCE_HYSTERESIS ) / fence->scale;
+    fence->min_lat = lat - dlat;
+    fence->max_lat = lat + dlat;
+    fence->min_lon = lon - dlon;
+    fence->max_lon = lon + dlon;
+    id = geofence_commit( id );
+    geofence_unlock();
+    return( id );
+}
+
+int32_t geofence_add_polygon( const char *name, const geofence_point_t *points, uint32_t count, uint32_t dwell ) {
+    if ( !points || count < 3 || count > GEOFENCE_MAX_POINTS ) {
+        GEOFENCE_ERROR_LOG("invalid polygon fence");
+        return( -1 );
+    }
+    geofence_point_t *copy = (geofence_point_t*)MALLOC( sizeof( geofence_point_t ) * count );
+    if ( !copy ) {
+        GEOFENCE_ERROR_LOG("polygon alloc failed");
+        return( -1 );
+    }
+    memcpy( copy, points, sizeof( geofence_point_t ) * count );
+
+    geofence_lock();
+    int32_t id = geofence_alloc();
+    if ( id < 0 ) {
+        geofence_unlock();
+        free( copy );
+        GEOFENCE_ERROR_LOG("fence alloc failed");
+        return( -1 );
+    }
+    geofence_t *fence = &geofence_fences[ id ];
+    snprintf( fence->name, sizeof( fence->name ), "%s", name ? name : "" );
+    fence->polygon = true;
+    fence->points = copy;
+    fence->count = count;
+    fence->dwell = dwell;
+    fence->min_lat = fence->max_lat = copy[ 0 ].lat;
+    fence->min_lon = fence->max_lon = copy[ 0 ].lon;
+    for( uint32_t i = 1 ; i < count ; i++ ) {
+        fence->min_lat = fmin( fence->min_lat, copy[ i ].lat );
+        fence->max_lat = fmax( fence->max_lat, copy[ i ].lat );
+        fence->min_lon = fmin( fence->min_lon, copy[ i ].lon );
+        fence->max_lon = fmax( fence->max_lon, copy[ i ].lon );
+    }
+    double dlat = GEOFENCE_HYSTERESIS / GEOFENCE_M_PER_DEG;
+    double dlon = GEOFENCE_HYSTERESIS / ( GEOFENCE_M_PER_DEG * cos( fmax( fabs( fence->min_lat ), fabs( fence->max_lat ) ) * M_PI / 180.0 ) );
+    fence->min_lat -= dlat;
+    fence->max_lat += dlat;
+    fence->min_lon -= dlon;
+    fence->max_lon += dlon;
+    id = geofence_commit( id );
+    geofence_unlock();
+    return( id );
+}
+
+bool geofence_remove( int32_t id ) {
+    geofence_lock();
+    if ( id < 0 || (uint32_t)id >= geofence_fences_num || !geofence_fences[ id ].used ) {
+        geofence_unlock();
+        return( false );
+    }
+    free( geofence_fences[ id ].points );
+    geofence_fences[ id ] = geofence_t();
+    geofence_stats.fences--;
+    geofence_dirty = true;
+    geofence_unlock();
+    return( true );
+}
+
+void geofence_clear( void ) {
+    geofence_lock();
+    for( uint32_t i = 0 ; i < geofence_fences_num ; i++ ) {
+        free( geofence_fences[ i ].points );
+    }
+    geofence_fences_num = 0;
+    geofence_inside_num = 0;
+    geofence_stats.fences = 0;
+    geofence_dirty = true;
+    geofence_unlock();
+}
+
+bool geofence_is_inside( int32_t id ) {
+    bool retval = false;
+
+    geofence_lock();
+    if ( id >= 0 && (uint32_t)id < geofence_fences_num && geofence_fences[ id ].used ) {
+        retval = geofence_fences[ id ].inside;
+    }
+    geofence_unlock();
+    return( retval );
+}
+
+static uint32_t geofence_hash( int32_t cell_lat, int32_t cell_lon ) {
+    return( ( (uint32_t)cell_lat * 73856093U ^ (uint32_t)cell_lon * 19349663U ) & ( GEOFENCE_BUCKETS - 1 ) );
+}
+
+/**
+ * @brief append a cell entry to a chain
+ */
+static bool geofence_cell_add( int32_t *head, int32_t cell_lat, int32_t cell_lon, uint32_t fence ) {
+    if ( geofence_cells_num == geofence_cells_size ) {
+        uint32_t size = geofence_cells_size ? geofence_cells_size * 2 : 64;
+        geofence_cell_t *cells = (geofence_cell_t*)REALLOC( geofence_cells, sizeof( geofence_cell_t ) * size );
+        if ( !cells ) {
+            GEOFENCE_ERROR_LOG("grid alloc failed");
+            return( false );
+        }
+        geofence_cells = cells;
+        geofence_cells_size = size;
+    }
+    geofence_cell_t *cell = &geofence_cells[ geofence_cells_num ];
+    cell->cell_lat = cell_lat;
+    cell->cell_lon = cell_lon;
+    cell->fence = fence;
+    cell->next = *head;
+    *head = geofence_cells_num++;
+    return( true );
+}
+
+/**
+ * @brief put a fence in all cells of its bounding box or in the large list
+ */
+static bool geofence_index_add( uint32_t id ) {
+    geofence_t *fence = &geofence_fences[ id ];
+    int32_t lat0 = (int32_t)floor( fence->min_lat / GEOFENCE_CELL_SIZE );
+    int32_t lat1 = (int32_t)floor( fence->max_lat / GEOFENCE_CELL_SIZE );
+    int32_t lon0 = (int32_t)floor( fence->min_lon / GEOFENCE_CELL_SIZE );
+    int32_t lon1 = (int32_t)floor( fence->max_lon / GEOFENCE_CELL_SIZE );
+
+    if ( (uint64_t)( lat1 - lat0 + 1 ) * ( lon1 - lon0 + 1 ) > GEOFENCE_MAX_CELLS ) {
+        if ( !geofence_cell_add( &geofence_large, 0, 0, id ) ) {
+            return( false );
+        }
+        geofence_stats.large++;
+        return( true );
+    }
+    for( int32_t cell_lat = lat0 ; cell_lat <= lat1 ; cell_lat++ ) {
+        for( int32_t cell_lon = lon0 ; cell_lon <= lon1 ; cell_lon++ ) {
+            if ( !geofence_cell_add( &geofence_bucket[ geofence_hash( cell_lat, cell_lon ) ], cell_lat, cell_lon, id ) ) {
+                return( false );
+            }
+            geofence_stats.cells++;
+        }
+    }
+    return( true );
+}
+
+static void geofence_index_rebuild( void ) {
+    geofence_cells_num = 0;
+    geofence_large = -1;
+    geofence_stats.cells = 0;
+    geofence_stats.large = 0;
+    for( uint32_t i = 0 ; i < GEOFENCE_BUCKETS ; i++ ) {
+        geofence_bucket[ i ] = -1;
+    }
+    for( uint32_t i = 0 ; i < geofence_fences_num ; i++ ) {
+        if ( geofence_fences[ i ].used ) {
+            geofence_index_add( i );
+        }
+    }
+    geofence_dirty = false;
+}
+
+/**
+ * @brief distance from the origin to a segment in m
+ */
+static double geofence_segment_distance( double ax, double ay, double bx, double by ) {
+    double dx = bx - ax;
+    double dy = by - ay;
+    double len = dx * dx + dy * dy;
+    double t = len > 0 ? -( ax * dx + ay * dy ) / len : 0;
+
+    t = fmax( 0.0, fmin( 1.0, t ) );
+    return( hypot( ax + t * dx, ay + t * dy ) );
+}
+
+/**
+ * @brief test a fix against a fence
+ *
+ * @param   margin  distance in m outside that still counts as inside
+ */
+static bool geofence_test( geofence_t *fence, double lat, double lon, double margin ) {
+    geofence_stats.tests++;
+
+    if ( lat < fence->min_lat || lat > fence->max_lat || lon < fence->min_lon || lon > fence->max_lon ) {
+        return( false );
+    }
+    if ( !fence->polygon ) {
+        double dx = ( lon - fence->lon ) * fence->scale;
+        double dy = ( lat - fence->lat ) * GEOFENCE_M_PER_DEG;
+        double r = fence->radius + margin;
+        return( dx * dx + dy * dy <= r * r );
+    }
+    /**
+     * ray casting, a scaled axis doesn't change the crossings
+     */
+    bool inside = false;
+    geofence_point_t *points = fence->points;
+    for( uint32_t i = 0, j = fence->count - 1 ; i < fence->count ; j = i++ ) {
+        if ( ( points[ i ].lat > lat ) != ( points[ j ].lat > lat ) &&
+             lon < ( points[ j ].lon - points[ i ].lon ) * ( lat - points[ i ].lat ) / ( points[ j ].lat - points[ i ].lat ) + points[ i ].lon ) {
+            inside = !inside;
+        }
+    }
+    if ( inside || margin <= 0 ) {
+        return( inside );
+    }
+    /**
+     * outside, but maybe within the margin to an edge
+     */
+    double scale = GEOFENCE_M_PER_DEG * cos( lat * M_PI / 180.0 );
+    for( uint32_t i = 0, j = fence->count - 1 ; i < fence->count ; j = i++ ) {
+        if ( geofence_segment_distance( ( points[ j ].lon - lon ) * scale, ( points[ j ].lat - lat ) * GEOFENCE_M_PER_DEG,
+                                        ( points[ i ].lon - lon ) * scale, ( points[ i ].lat - lat ) * GEOFENCE_M_PER_DEG ) <= margin ) {
+            return( true );
+        }
+    }
+    return( false );
+}
+
+/**
+ * @brief queue a event, a full queue defers the state change to the next fix
+ */
+static bool geofence_queue( EventBits_t event, uint32_t id, uint32_t inside_time, double lat, double lon ) {
+    if ( geofence_pending_num >= GEOFENCE_MAX_EVENTS ) {
+        geofence_stats.deferred++;
+        return( false );
+    }
+    geofence_pending_t *pending = &geofence_pending[ geofence_pending_num++ ];
+    pending->event = event;
+    pending->arg.id = id;
+    memcpy( pending->arg.name, geofence_fences[ id ].name, sizeof( pending->arg.name ) );
+    pending->arg.inside_time = inside_time;
+    pending->arg.lat = lat;
+    pending->arg.lon = lon;
+    return( true );
+}
+
+/**
+ * @brief test a fence once per fix and queue its enter, exit and dwell events
+ */
+static void geofence_process( uint32_t id, double lat, double lon, uint64_t now ) {
+    geofence_t *fence = &geofence_fences[ id ];
+
+    if ( !fence->used || fence->stamp == geofence_stamp ) {
+        return;
+    }
+    fence->stamp = geofence_stamp;
+
+    bool inside = geofence_test( fence, lat, lon, fence->inside ? GEOFENCE_HYSTERESIS : 0 );
+    if ( inside && !fence->inside ) {
+        if ( geofence_queue( GEOFENCE_ENTER, id, 0, lat, lon ) ) {
+            fence->inside = true;
+            fence->dwelled = false;
+            fence->enter_time = now;
+        }
+    }
+    else if ( !inside && fence->inside ) {
+        if ( geofence_queue( GEOFENCE_EXIT, id, now - fence->enter_time, lat, lon ) ) {
+            fence->inside = false;
+        }
+    }
+    else if ( inside && fence->dwell && !fence->dwelled && now - fence->enter_time >= fence->dwell ) {
+        if ( geofence_queue( GEOFENCE_DWELL, id, now - fence->enter_time, lat, lon ) ) {
+            fence->dwelled = true;
+        }
+    }
+    if ( fence->inside ) {
+        geofence_inside_next[ geofence_inside_next_num++ ] = id;
+    }
+}
+
+void geofence_check( double lat, double lon ) {
+    uint64_t now = millis();
+
+    geofence_lock();
+    if ( geofence_dirty ) {
+        geofence_index_rebuild();
+    }
+    geofence_stamp++;
+    geofence_stats.fixes++;
+    geofence_pending_num = 0;
+    geofence_inside_next_num = 0;
+    /**
+     * the fences in the cell of the fix, the large ones and the ones the
+     * last fix was inside
+     */
+    if ( geofence_linear ) {
+        for( uint32_t i = 0 ; i < geofence_fences_num ; i++ ) {
+            geofence_process( i, lat, lon, now );
+        }
+    }
+    else {
+        int32_t cell_lat = (int32_t)floor( lat / GEOFENCE_CELL_SIZE );
+        int32_t cell_lon = (int32_t)floor( lon / GEOFENCE_CELL_SIZE );
+        for( int32_t i = geofence_bucket[ geofence_hash( cell_lat, cell_lon ) ] ; i >= 0 ; i = geofence_cells[ i ].next ) {
+            if ( geofence_cells[ i ].cell_lat == cell_lat && geofence_cells[ i ].cell_lon == cell_lon ) {
+                geofence_process( geofence_cells[ i ].fence, lat, lon, now );
+            }
+        }
+        for( int32_t i = geofence_large ; i >= 0 ; i = geofence_cells[ i ].next ) {
+            geofence_process( geofence_cells[ i ].fence, lat, lon, now );
+        }
+    }
+    for( uint32_t i = 0 ; i < geofence_inside_num ; i++ ) {
+        if ( geofence_inside[ i ] < geofence_fences_num ) {
+            geofence_process( geofence_inside[ i ], lat, lon, now );
+        }
+    }
+    uint32_t *inside = geofence_inside;
+    geofence_inside = geofence_inside_next;
+    geofence_inside_next = inside;
+    geofence_inside_num = geofence_inside_next_num;
+    /**
+     * send after the unlock, a callback may add or remove fences
+     */
+    uint32_t pending_num = geofence_pending_num;
+    geofence_pending_t pending[ GEOFENCE_MAX_EVENTS ];
+    memcpy( pending, geofence_pending, sizeof( geofence_pending_t ) * pending_num );
+    geofence_stats.events += pending_num;
+    geofence_unlock();
+
+    if ( geofence_callback ) {
+        for( uint32_t i = 0 ; i < pending_num ; i++ ) {
+            GEOFENCE_LOG("%s fence %d \"%s\"", pending[ i ].event == GEOFENCE_ENTER ? "enter" : pending[ i ].event == GEOFENCE_EXIT ? "exit" : "dwell in", pending[ i ].arg.id, pending[ i ].arg.name );
+            geofence_send_event_cb( pending[ i ].event, (void*)&pending[ i ].arg );
+        }
+    }
+}
+
+#ifdef NATIVE_64BIT
+static uint64_t geofence_bench_now( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec );
+}
+
+/**
+ * @brief uniform random number in [0,1) from a xorshift, repeatable between runs
+ */
+static double geofence_bench_random( uint32_t *seed ) {
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return( *seed / 4294967296.0 );
+}
+
+/**
+ * @brief run a random walk through the fences
+ *
+ * @return  ns per fix
+ */
+static double geofence_bench_walk( uint32_t *events, uint64_t *tests ) {
+    double lat = 52.52, lon = 13.405, course = 0;
+    uint32_t seed = 0x2545f491;
+    uint64_t time = 0;
+
+    geofence_stats.events = 0;
+    geofence_stats.tests = 0;
+    for( uint32_t i = 0 ; i < GEOFENCE_BENCH_FIXES ; i++ ) {
+        /**
+         * 5m steps with a random course change, bounced back into the fence area
+         */
+        course += ( geofence_bench_random( &seed ) - 0.5 ) * 0.6;
+        lat += 5.0 * cos( course ) / GEOFENCE_M_PER_DEG;
+        lon += 5.0 * sin( course ) / ( GEOFENCE_M_PER_DEG * cos( lat * M_PI / 180.0 ) );
+        if ( fabs( lat - 52.52 ) > 0.2 || fabs( lon - 13.405 ) > 0.3 ) {
+            course += M_PI;
+        }
+        uint64_t start = geofence_bench_now();
+        geofence_check( lat, lon );
+        time += geofence_bench_now() - start;
+    }
+    *events = geofence_stats.events;
+    *tests = geofence_stats.tests;
+    return( (double)time / GEOFENCE_BENCH_FIXES );
+}
+
+/**
+ * @brief random circles and polygons around a random walk, checked with
+ * the grid and with a linear scan, both have to send the same events
+ */
+static void geofence_bench( const char *arg ) {
+    uint32_t fences = atoi( arg ) > 0 ? atoi( arg ) : GEOFENCE_BENCH_FENCES;
+    uint32_t seed = 0x12345678;
+    geofence_point_t points[ 8 ];
+
+    geofence_clear();
+    for( uint32_t i = 0 ; i < fences ; i++ ) {
+        double lat = 52.52 + ( geofence_bench_random( &seed ) - 0.5 ) * 0.4;
+        double lon = 13.405 + ( geofence_bench_random( &seed ) - 0.5 ) * 0.6;
+        double radius = 20.0 + geofence_bench_random( &seed ) * 480.0;
+        if ( i % 2 ) {
+            geofence_add_circle( "bench", lat, lon, radius, 60000 );
+            continue;
+        }
+        uint32_t count = 3 + i % 6;
+        for( uint32_t p = 0 ; p < count ; p++ ) {
+            double angle = 2.0 * M_PI * p / count;
+            double r = radius * ( 0.5 + 0.5 * geofence_bench_random( &seed ) );
+            points[ p ].lat = lat + r * cos( angle ) / GEOFENCE_M_PER_DEG;
+            points[ p ].lon = lon + r * sin( angle ) / ( GEOFENCE_M_PER_DEG * cos( lat * M_PI / 180.0 ) );
+        }
+        geofence_add_polygon( "bench", points, count, 60000 );
+    }
+
+    uint32_t grid_events = 0, linear_events = 0;
+    uint64_t grid_tests = 0, linear_tests = 0;
+    double grid_time = geofence_bench_walk( &grid_events, &grid_tests );
+    geofence_inside_num = 0;
+    for( uint32_t i = 0 ; i < geofence_fences_num ; i++ ) {
+        geofence_fences[ i ].inside = false;
+    }
+    geofence_linear = true;
+    double linear_time = geofence_bench_walk( &linear_events, &linear_tests );
+    geofence_linear = false;
+
+    GEOFENCE_INFO_LOG("geofence bench: %u fences, %u cell entries, %u large, %u fixes", geofence_stats.fences, geofence_stats.cells, geofence_stats.large, GEOFENCE_BENCH_FIXES );
+    GEOFENCE_INFO_LOG("  grid   %.0fns per fix, %.1f tests per fix, %u events", grid_time, (double)grid_tests / GEOFENCE_BENCH_FIXES, grid_events );
+    GEOFENCE_INFO_LOG("  linear %.0fns per fix, %.1f tests per fix, %u events", linear_time, (double)linear_tests / GEOFENCE_BENCH_FIXES, linear_events );
+    if ( grid_events != linear_events ) {
+        GEOFENCE_ERROR_LOG("grid and linear events differ");
+    }
+    geofence_clear();
+    geofence_stats = geofence_stats_t();
+}
+#endif
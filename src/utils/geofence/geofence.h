@@ -0,0 +1,147 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _GEOFENCE_H
+    #define _GEOFENCE_H
+
+    #include "hardware/callback.h"
+    #include "utils/io.h"
+
+    #define GEOFENCE_INFO_LOG               log_i
+    #define GEOFENCE_LOG                    log_d
+    #define GEOFENCE_ERROR_LOG              log_e
+
+    #define GEOFENCE_ENTER                  _BV(0)              /** @brief event mask for entering a fence, callback arg is (geofence_event_t*) */
+    #define GEOFENCE_EXIT                   _BV(1)              /** @brief event mask for leaving a fence, callback arg is (geofence_event_t*) */
+    #define GEOFENCE_DWELL                  _BV(2)              /** @brief event mask for staying in a fence for its dwell time, callback arg is (geofence_event_t*) */
+
+    #define GEOFENCE_NAME_LEN               24                  /** @brief max fence name length */
+    #define GEOFENCE_MAX_POINTS             64                  /** @brief max polygon points */
+    #define GEOFENCE_HYSTERESIS             10.0                /** @brief leave a fence only this far outside in m, no flapping on gps noise */
+    #define GEOFENCE_CELL_SIZE              0.01                /** @brief grid cell size in degree, ~1.1km north/south */
+    #define GEOFENCE_BUCKETS                1024                /** @brief grid hash buckets, power of two */
+    #define GEOFENCE_MAX_CELLS              256                 /** @brief fences over more cells are checked on every fix */
+    #define GEOFENCE_MAX_EVENTS             16                  /** @brief events per fix, more are sent with the next fix */
+    #define GEOFENCE_BENCH_ENV              "HEDGE_GEOFENCE_BENCH"  /** @brief env var with a fence count for the native bench */
+    #define GEOFENCE_BENCH_FENCES           5000                /** @brief default bench fence count */
+    #define GEOFENCE_BENCH_FIXES            20000               /** @brief bench fixes, a random walk */
+    /**
+     * @brief a point of a polygon fence
+     */
+    typedef struct {
+        double lat = 0;                         /** @brief latitude in degree */
+        double lon = 0;                         /** @brief longitude in degree */
+    } geofence_point_t;
+    /**
+     * @brief the arg of a GEOFENCE_ENTER, GEOFENCE_EXIT or GEOFENCE_DWELL event
+     */
+    typedef struct {
+        int32_t id = -1;                        /** @brief fence id */
+        char name[ GEOFENCE_NAME_LEN ] = "";    /** @brief fence name */
+        uint32_t inside_time = 0;               /** @brief ms inside the fence, 0 on enter */
+        double lat = 0;                         /** @brief latitude of the fix */
+        double lon = 0;                         /** @brief longitude of the fix */
+    } geofence_event_t;
+    /**
+     * @brief geofence statistics
+     */
+    typedef struct {
+        uint32_t fences = 0;                    /** @brief active fences */
+        uint32_t cells = 0;                     /** @brief grid cell entries */
+        uint32_t large = 0;                     /** @brief fences over GEOFENCE_MAX_CELLS, checked on every fix */
+        uint32_t fixes = 0;                     /** @brief checked fixes */
+        uint64_t tests = 0;                     /** @brief fence tests */
+        uint32_t events = 0;                    /** @brief sent events */
+        uint32_t deferred = 0;                  /** @brief events deferred to the next fix */
+    } geofence_stats_t;
+    /**
+     * @brief setup geofence, hooks into the gpsctl location updates
+     */
+    void geofence_setup( void );
+    /**
+     * @brief registers a callback function which is called on a corresponding event
+     *
+     * @param   event           possible values: GEOFENCE_ENTER, GEOFENCE_EXIT and GEOFENCE_DWELL
+     * @param   callback_func   pointer to the callback function
+     * @param   id              program id
+     *
+     * @return  true if success, false if failed
+     */
+    bool geofence_register_cb( EventBits_t event, CALLBACK_FUNC callback_func, const char *id );
+    /**
+     * @brief add a circular fence
+     *
+     * @param   name    fence name, passed with the events
+     * @param   lat     center latitude in degree
+     * @param   lon     center longitude in degree
+     * @param   radius  radius in m
+     * @param   dwell   ms inside before a GEOFENCE_DWELL event, 0 for none
+     *
+     * @return  fence id, -1 if failed
+     */
+    int32_t geofence_add_circle( const char *name, double lat, double lon, double radius, uint32_t dwell );
+    /**
+     * @brief add a polygon fence, the last point connects to the first one
+     *
+     * @param   name    fence name, passed with the events
+     * @param   points  pointer to the points, they are copied
+     * @param   count   number of points, 3 up to GEOFENCE_MAX_POINTS
+     * @param   dwell   ms inside before a GEOFENCE_DWELL event, 0 for none
+     *
+     * @return  fence id, -1 if failed
+     */
+    int32_t geofence_add_polygon( const char *name, const geofence_point_t *points, uint32_t count, uint32_t dwell );
+    /**
+     * @brief remove a fence, the id can be reused by a new fence
+     *
+     * @param   id      fence id
+     *
+     * @return  true if removed
+     */
+    bool geofence_remove( int32_t id );
+    /**
+     * @brief remove all fences
+     */
+    void geofence_clear( void );
+    /**
+     * @brief check if a fix is inside a fence
+     *
+     * @param   id      fence id
+     *
+     * @return  true if the last fix was inside
+     */
+    bool geofence_is_inside( int32_t id );
+    /**
+     * @brief check a fix against all nearby fences and send the events,
+     * called on every gpsctl location update
+     *
+     * @param   lat     latitude in degree
+     * @param   lon     longitude in degree
+     */
+    void geofence_check( double lat, double lon );
+    /**
+     * @brief get the geofence statistics
+     *
+     * @return  pointer to a geofence_stats_t structure
+     */
+    geofence_stats_t *geofence_get_stats( void );
+
+#endif // _GEOFENCE_H
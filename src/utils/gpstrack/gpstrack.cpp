@@ -0,0 +1,780 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "gpstrack.h"
+#include "gpstrackconfig.h"
+#include "hardware/gpsctl.h"
+#include "hardware/powermgm.h"
+#include "utils/alloc.h"
+#include "utils/filepath_convert.h"
+#include "utils/lock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef NATIVE_64BIT
+    #include "utils/logging.h"
+    #include "utils/millis.h"
+#else
+    #include <Arduino.h>
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/semphr.h>
+#endif
+static lock_mutex_t gpstrack_mutex = LOCK_MUTEX_INITIALIZER;           /** @brief fixes from the gpsctl task, flush and export from the ui */
+
+/**
+ * @brief a block in the making
+ */
+typedef struct {
+    uint8_t *data = NULL;                                           /** @brief GPSTRACK_BLOCK_SIZE bytes */
+    uint32_t len = GPSTRACK_BLOCK_HEADER;                           /** @brief used bytes, header included */
+    uint32_t fixes = 0;                                             /** @brief fixes in the block */
+    gpstrack_fix_t prev;                                            /** @brief last fix, deltas are relative to it */
+} gpstrack_block_t;
+
+gpstrack_config_t gpstrack_config;
+
+static gpstrack_stats_t gpstrack_stats;
+static bool gpstrack_recording = false;
+static char gpstrack_name[ GPSTRACK_NAME_LEN ] = "";
+static char gpstrack_path[ 256 ] = "";                              /** @brief track file of the current track */
+static gpstrack_fix_t gpstrack_last;                                /** @brief last recorded fix, for the interval and a missing altitude */
+static bool gpstrack_last_valid = false;
+/**
+ * the ring buffer, the block at head is filled, the queued blocks before
+ * head wait for the next write
+ */
+static uint8_t *gpstrack_ring = NULL;
+static uint32_t gpstrack_ring_head = 0;
+static uint32_t gpstrack_ring_queued = 0;
+static gpstrack_block_t gpstrack_block;
+static uint32_t gpstrack_last_write = 0;                            /** @brief millis of the last file write */
+
+static bool gpstrack_gpsctl_event_cb( EventBits_t event, void *arg );
+static bool gpstrack_powermgm_event_cb( EventBits_t event, void *arg );
+static void gpstrack_block_init( gpstrack_block_t *block, uint8_t *data );
+static bool gpstrack_block_add( gpstrack_block_t *block, const gpstrack_fix_t *fix );
+static void gpstrack_block_close( gpstrack_block_t *block );
+static void gpstrack_next_block( void );
+static void gpstrack_write( void );
+static void gpstrack_flush_standby( void );
+static void gpstrack_stop_locked( void );
+static bool gpstrack_get_dir( char *dir, size_t size );
+#ifdef NATIVE_64BIT
+    static void gpstrack_bench( const char *tracks );
+#endif
+
+static void gpstrack_lock( void ) {
+    lock_mutex_take( &gpstrack_mutex );
+}
+
+static void gpstrack_unlock( void ) {
+    lock_mutex_give( &gpstrack_mutex );
+}
+
+void gpstrack_setup( void ) {
+    gpstrack_config.load();
+
+    gpsctl_register_cb( GPSCTL_UPDATE_LOCATION | GPSCTL_DISABLE, gpstrack_gpsctl_event_cb, "gpstrack" );
+    powermgm_register_cb( POWERMGM_STANDBY, gpstrack_powermgm_event_cb, "gpstrack" );
+#ifdef NATIVE_64BIT
+    const char *tracks = getenv( GPSTRACK_BENCH_ENV );
+    if ( tracks && *tracks ) {
+        gpstrack_bench( tracks );
+    }
+#endif
+}
+
+static bool gpstrack_gpsctl_event_cb( EventBits_t event, void *arg ) {
+    gps_data_t *gps_data = (gps_data_t*)arg;
+
+    switch( event ) {
+        case GPSCTL_UPDATE_LOCATION: {
+            /**
+             * only real fixes make a track
+             */
+            if ( !gps_data || !gps_data->valid_location || gps_data->gps_source != GPS_SOURCE_GPS ) {
+                break;
+            }
+            if ( !gpstrack_is_recording() ) {
+                if ( !gpstrack_config.enable || !gpstrack_start( NULL ) ) {
+                    break;
+                }
+            }
+            gpstrack_fix_t fix;
+            fix.time = time( NULL );
+            fix.lat = (int32_t)lround( gps_data->lat * 1e7 );
+            fix.lon = (int32_t)lround( gps_data->lon * 1e7 );
+            fix.alt = gps_data->valid_altitude ? (int32_t)lround( gps_data->altitude_meters * 10 ) : gpstrack_last.alt;
+            gpstrack_add_fix( &fix );
+            break;
+        }
+        case GPSCTL_DISABLE:
+            gpstrack_stop();
+            break;
+    }
+    return( true );
+}
+
+static bool gpstrack_powermgm_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case POWERMGM_STANDBY:
+            /**
+             * a track survives a empty battery in standby
+             */
+            gpstrack_flush_standby();
+            break;
+    }
+    return( true );
+}
+
+/**
+ * @brief get the track dir, the sd card or spiffs without a sd card
+ */
+static bool gpstrack_get_dir( char *dir, size_t size ) {
+#ifdef NATIVE_64BIT
+    filepath_convert( dir, size, "sd/" GPSTRACK_DIR );
+#else
+    DIR *sd = opendir( "/sd" );
+    if ( sd ) {
+        closedir( sd );
+        snprintf( dir, size, "/sd/" GPSTRACK_DIR );
+    }
+    else {
+        snprintf( dir, size, "/spiffs/" GPSTRACK_DIR );
+    }
+#endif
+    mkdir( dir, 0700 );
+    return( true );
+}
+
+bool gpstrack_start( const char *name ) {
+    char dir[ 192 ] = "";
+    char time_name[ GPSTRACK_NAME_LEN ] = "";
+
+    if ( !name ) {
+        time_t now = time( NULL );
+        struct tm tm;
+        gmtime_r( &now, &tm );
+        strftime( time_name, sizeof( time_name ), "%Y%m%d-%H%M%S", &tm );
+        name = time_name;
+    }
+    if ( !*name || strlen( name ) >= GPSTRACK_NAME_LEN || strchr( name, '/' ) ) {
+        GPSTRACK_ERROR_LOG("invalid track name");
+        return( false );
+    }
+
+    gpstrack_lock();
+    gpstrack_stop_locked();
+    /**
+     * the ring lives only while recording
+     */
+    gpstrack_ring = (uint8_t*)MALLOC( GPSTRACK_RING_BLOCKS * GPSTRACK_BLOCK_SIZE );
+    if ( !gpstrack_ring ) {
+        GPSTRACK_ERROR_LOG("track ring buffer alloc failed");
+        gpstrack_unlock();
+        return( false );
+    }
+    gpstrack_get_dir( dir, sizeof( dir ) );
+    snprintf( gpstrack_path, sizeof( gpstrack_path ), "%s/%s" GPSTRACK_EXT, dir, name );
+    strcpy( gpstrack_name, name );
+    gpstrack_ring_head = 0;
+    gpstrack_ring_queued = 0;
+    gpstrack_block_init( &gpstrack_block, gpstrack_ring );
+    gpstrack_last_write = millis();
+    gpstrack_last_valid = false;
+    gpstrack_recording = true;
+    gpstrack_unlock();
+
+    GPSTRACK_INFO_LOG("record track into %s", gpstrack_path );
+    return( true );
+}
+
+/**
+ * @brief write the last blocks and free the ring, call with lock held
+ */
+static void gpstrack_stop_locked( void ) {
+    if ( !gpstrack_recording ) {
+        return;
+    }
+    if ( gpstrack_block.fixes ) {
+        gpstrack_next_block();
+    }
+    gpstrack_write();
+    if ( gpstrack_ring_queued ) {
+        GPSTRACK_ERROR_LOG("%d blocks of track %s lost", gpstrack_ring_queued, gpstrack_name );
+        gpstrack_stats.dropped += gpstrack_ring_queued;
+    }
+    free( gpstrack_ring );
+    gpstrack_ring = NULL;
+    gpstrack_recording = false;
+}
+
+void gpstrack_stop( void ) {
+    gpstrack_lock();
+    gpstrack_stop_locked();
+    gpstrack_unlock();
+}
+
+bool gpstrack_is_recording( void ) {
+    return( gpstrack_recording );
+}
+
+const char *gpstrack_get_name( void ) {
+    return( gpstrack_name );
+}
+
+bool gpstrack_add_fix( const gpstrack_fix_t *fix ) {
+    if ( !fix ) {
+        return( false );
+    }
+    gpstrack_lock();
+    if ( !gpstrack_recording ) {
+        gpstrack_unlock();
+        return( false );
+    }
+    /**
+     * keep the interval, a clock set back starts over
+     */
+    if ( gpstrack_last_valid && fix->time >= gpstrack_last.time && fix->time - gpstrack_last.time < (uint32_t)gpstrack_config.interval ) {
+        gpstrack_stats.skipped++;
+        gpstrack_unlock();
+        return( false );
+    }
+    if ( !gpstrack_block_add( &gpstrack_block, fix ) ) {
+        gpstrack_next_block();
+        gpstrack_block_add( &gpstrack_block, fix );
+    }
+    gpstrack_last = *fix;
+    gpstrack_last_valid = true;
+    gpstrack_stats.fixes++;
+    /**
+     * write full blocks in one go
+     */
+    if ( gpstrack_ring_queued >= GPSTRACK_FLUSH_BLOCKS ) {
+        gpstrack_write();
+    }
+    gpstrack_unlock();
+
+    return( true );
+}
+
+void gpstrack_flush( void ) {
+    gpstrack_lock();
+    if ( gpstrack_recording ) {
+        if ( gpstrack_block.fixes ) {
+            gpstrack_next_block();
+        }
+        gpstrack_write();
+    }
+    gpstrack_unlock();
+}
+
+/**
+ * @brief write on standby only if it is worth a flash write, full blocks, an
+ * almost full block or a partial block after GPSTRACK_STANDBY_INTERVAL, a
+ * short screen off keeps the partial block in ram
+ */
+static void gpstrack_flush_standby( void ) {
+    gpstrack_lock();
+    if ( gpstrack_recording ) {
+        if ( gpstrack_block.fixes && ( gpstrack_block.len >= GPSTRACK_STANDBY_FILL || millis() - gpstrack_last_write >= GPSTRACK_STANDBY_INTERVAL ) ) {
+            gpstrack_next_block();
+        }
+        gpstrack_write();
+    }
+    gpstrack_unlock();
+}
+
+void gpstrack_set_enable( bool enable ) {
+    gpstrack_config.enable = enable;
+    gpstrack_config.save();
+    if ( !enable ) {
+        gpstrack_stop();
+    }
+}
+
+bool gpstrack_get_enable( void ) {
+    return( gpstrack_config.enable );
+}
+
+gpstrack_stats_t *gpstrack_get_stats( void ) {
+    return( &gpstrack_stats );
+}
+
+static void gpstrack_block_init( gpstrack_block_t *block, uint8_t *data ) {
+    block->data = data;
+    block->len = GPSTRACK_BLOCK_HEADER;
+    block->fixes = 0;
+    block->prev = gpstrack_fix_t();
+}
+
+/**
+ * @brief add a fix to a block
+ *
+ * @return  false if the block is full
+ */
+static bool gpstrack_block_add( gpstrack_block_t *block, const gpstrack_fix_t *fix ) {
+    if ( block->len + GPSTRACK_MAX_FIX_BYTES > GPSTRACK_BLOCK_SIZE || block->fixes >= 0xffff ) {
+        return( false );
+    }
+    block->len += gpstrack_encode_fix( block->data + block->len, &block->prev, fix );
+    block->prev = *fix;
+    block->fixes++;
+    return( true );
+}
+
+/**
+ * @brief write the block header
+ */
+static void gpstrack_block_close( gpstrack_block_t *block ) {
+    uint32_t payload = block->len - GPSTRACK_BLOCK_HEADER;
+
+    block->data[ 0 ] = 'G';
+    block->data[ 1 ] = 'T';
+    block->data[ 2 ] = GPSTRACK_VERSION;
+    block->data[ 3 ] = 0;
+    block->data[ 4 ] = payload & 0xff;
+    block->data[ 5 ] = payload >> 8;
+    block->data[ 6 ] = block->fixes & 0xff;
+    block->data[ 7 ] = block->fixes >> 8;
+}
+
+/**
+ * @brief queue the current block and start the next one in the ring, a full
+ * ring drops the oldest block, call with lock held
+ */
+static void gpstrack_next_block( void ) {
+    gpstrack_block_close( &gpstrack_block );
+    gpstrack_stats.blocks++;
+    gpstrack_stats.bytes += gpstrack_block.len;
+
+    gpstrack_ring_head = ( gpstrack_ring_head + 1 ) % GPSTRACK_RING_BLOCKS;
+    gpstrack_ring_queued++;
+    if ( gpstrack_ring_queued >= GPSTRACK_RING_BLOCKS ) {
+        gpstrack_ring_queued--;
+        gpstrack_stats.dropped++;
+        GPSTRACK_ERROR_LOG("track ring buffer full, drop a block");
+    }
+    gpstrack_block_init( &gpstrack_block, gpstrack_ring + gpstrack_ring_head * GPSTRACK_BLOCK_SIZE );
+}
+
+/**
+ * @brief append the queued blocks to the track file, call with lock held
+ */
+static void gpstrack_write( void ) {
+    if ( !gpstrack_ring_queued ) {
+        return;
+    }
+    FILE *file = fopen( gpstrack_path, "ab" );
+    if ( !file ) {
+        GPSTRACK_ERROR_LOG("can't open track file %s", gpstrack_path );
+        return;
+    }
+    /**
+     * unbuffered, a block goes out in one write and a failed one leaves
+     * nothing behind that fclose could still append
+     */
+    setvbuf( file, NULL, _IONBF, 0 );
+    fseek( file, 0, SEEK_END );
+    while( gpstrack_ring_queued ) {
+        uint8_t *block = gpstrack_ring + ( ( gpstrack_ring_head + GPSTRACK_RING_BLOCKS - gpstrack_ring_queued ) % GPSTRACK_RING_BLOCKS ) * GPSTRACK_BLOCK_SIZE;
+        size_t len = GPSTRACK_BLOCK_HEADER + ( block[ 4 ] | block[ 5 ] << 8 );
+        long start = ftell( file );
+        if ( fwrite( block, 1, len, file ) != len ) {
+            /**
+             * cut the partial block, it stays queued for the next write
+             */
+            GPSTRACK_ERROR_LOG("track file %s write failed", gpstrack_path );
+            if ( start < 0 || ftruncate( fileno( file ), start ) ) {
+                GPSTRACK_ERROR_LOG("can't truncate track file %s", gpstrack_path );
+            }
+            break;
+        }
+        gpstrack_stats.written += len;
+        gpstrack_ring_queued--;
+    }
+    fclose( file );
+    gpstrack_stats.flushes++;
+    gpstrack_last_write = millis();
+}
+
+static size_t gpstrack_put_varint( uint8_t *buf, int32_t value ) {
+    uint32_t zigzag = ( (uint32_t)value << 1 ) ^ (uint32_t)( value >> 31 );
+    size_t len = 0;
+
+    while( zigzag >= 0x80 ) {
+        buf[ len++ ] = ( zigzag & 0x7f ) | 0x80;
+        zigzag >>= 7;
+    }
+    buf[ len++ ] = zigzag;
+    return( len );
+}
+
+/**
+ * @brief read a zigzag varint
+ *
+ * @return  bytes read, 0 if the varint runs over the end
+ */
+static size_t gpstrack_get_varint( const uint8_t *buf, size_t size, int32_t *value ) {
+    uint32_t zigzag = 0;
+
+    for( size_t len = 0 ; len < size && len < 5 ; len++ ) {
+        zigzag |= (uint32_t)( buf[ len ] & 0x7f ) << ( 7 * len );
+        if ( !( buf[ len ] & 0x80 ) ) {
+            *value = (int32_t)( ( zigzag >> 1 ) ^ -( zigzag & 1 ) );
+            return( len + 1 );
+        }
+    }
+    return( 0 );
+}
+
+size_t gpstrack_encode_fix( uint8_t *buf, const gpstrack_fix_t *prev, const gpstrack_fix_t *fix ) {
+    size_t len = 0;
+    /**
+     * the deltas wrap around in 32 bit, the decoder wraps them back
+     */
+    len += gpstrack_put_varint( buf + len, (int32_t)( fix->time - prev->time ) );
+    len += gpstrack_put_varint( buf + len, (int32_t)( (uint32_t)fix->lat - (uint32_t)prev->lat ) );
+    len += gpstrack_put_varint( buf + len, (int32_t)( (uint32_t)fix->lon - (uint32_t)prev->lon ) );
+    len += gpstrack_put_varint( buf + len, (int32_t)( (uint32_t)fix->alt - (uint32_t)prev->alt ) );
+    return( len );
+}
+
+int32_t gpstrack_decode_block( const uint8_t *block, size_t size, GPSTRACK_DECODE_FUNC func, void *arg ) {
+    gpstrack_fix_t fix;
+
+    if ( !block || size < GPSTRACK_BLOCK_HEADER || block[ 0 ] != 'G' || block[ 1 ] != 'T' || block[ 2 ] != GPSTRACK_VERSION ) {
+        return( -1 );
+    }
+    size_t end = GPSTRACK_BLOCK_HEADER + ( block[ 4 ] | block[ 5 ] << 8 );
+    uint32_t fixes = block[ 6 ] | block[ 7 ] << 8;
+    if ( end > size ) {
+        return( -1 );
+    }
+
+    size_t pos = GPSTRACK_BLOCK_HEADER;
+    for( uint32_t i = 0 ; i < fixes ; i++ ) {
+        int32_t delta[ 4 ];
+        for( int field = 0 ; field < 4 ; field++ ) {
+            size_t len = gpstrack_get_varint( block + pos, end - pos, &delta[ field ] );
+            if ( !len ) {
+                return( -1 );
+            }
+            pos += len;
+        }
+        fix.time += (uint32_t)delta[ 0 ];
+        fix.lat = (int32_t)( (uint32_t)fix.lat + (uint32_t)delta[ 1 ] );
+        fix.lon = (int32_t)( (uint32_t)fix.lon + (uint32_t)delta[ 2 ] );
+        fix.alt = (int32_t)( (uint32_t)fix.alt + (uint32_t)delta[ 3 ] );
+        if ( func && !func( &fix, arg ) ) {
+            return( i + 1 );
+        }
+    }
+    return( fixes );
+}
+
+/**
+ * @brief export state
+ */
+typedef struct {
+    FILE *file;                                                     /** @brief output file */
+    gpstrack_format_t format;                                       /** @brief output format */
+    uint32_t fixes;                                                 /** @brief exported fixes */
+} gpstrack_export_t;
+
+static bool gpstrack_export_fix( const gpstrack_fix_t *fix, void *arg ) {
+    gpstrack_export_t *export_dsc = (gpstrack_export_t*)arg;
+
+    if ( export_dsc->format == GPSTRACK_GPX ) {
+        time_t time = fix->time;
+        struct tm tm;
+        gmtime_r( &time, &tm );
+        fprintf( export_dsc->file, "<trkpt lat=\"%.7f\" lon=\"%.7f\"><ele>%.1f</ele><time>%04d-%02d-%02dT%02d:%02d:%02dZ</time></trkpt>\n",
+                    fix->lat / 1e7, fix->lon / 1e7, fix->alt / 10.0,
+                    tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec );
+    }
+    else {
+        fprintf( export_dsc->file, "%s[%.7f,%.7f,%.1f]", export_dsc->fixes ? "," : "", fix->lon / 1e7, fix->lat / 1e7, fix->alt / 10.0 );
+    }
+    export_dsc->fixes++;
+    return( true );
+}
+
+int32_t gpstrack_read( const char *name, GPSTRACK_DECODE_FUNC func, void *arg ) {
+    char dir[ 192 ] = "";
+    char path[ 256 ] = "";
+    long limit = -1;
+    int32_t fixes = 0;
+
+    if ( !name || !*name || strchr( name, '/' ) ) {
+        return( -1 );
+    }
+    /**
+     * a running track is written first, newer blocks are not read
+     */
+    gpstrack_lock();
+    if ( gpstrack_recording && !strcmp( name, gpstrack_name ) ) {
+        if ( gpstrack_block.fixes ) {
+            gpstrack_next_block();
+        }
+        gpstrack_write();
+    }
+    gpstrack_unlock();
+
+    gpstrack_get_dir( dir, sizeof( dir ) );
+    snprintf( path, sizeof( path ), "%s/%s" GPSTRACK_EXT, dir, name );
+    FILE *track = fopen( path, "rb" );
+    if ( !track ) {
+        GPSTRACK_LOG("can't open track %s", path );
+        return( -1 );
+    }
+    fseek( track, 0, SEEK_END );
+    limit = ftell( track );
+    fseek( track, 0, SEEK_SET );
+
+    uint8_t *block = (uint8_t*)MALLOC( GPSTRACK_BLOCK_SIZE );
+    if ( !block ) {
+        GPSTRACK_ERROR_LOG("track block alloc failed");
+        fclose( track );
+        return( -1 );
+    }
+    /**
+     * block by block, every block starts with a absolute fix
+     */
+    long pos = 0;
+    while( pos + GPSTRACK_BLOCK_HEADER <= limit && fread( block, 1, GPSTRACK_BLOCK_HEADER, track ) == GPSTRACK_BLOCK_HEADER ) {
+        size_t payload = block[ 4 ] | block[ 5 ] << 8;
+        if ( GPSTRACK_BLOCK_HEADER + payload > GPSTRACK_BLOCK_SIZE || pos + GPSTRACK_BLOCK_HEADER + (long)payload > limit || fread( block + GPSTRACK_BLOCK_HEADER, 1, payload, track ) != payload ) {
+            break;
+        }
+        uint32_t block_fixes = block[ 6 ] | block[ 7 ] << 8;
+        int32_t decoded = gpstrack_decode_block( block, GPSTRACK_BLOCK_HEADER + payload, func, arg );
+        if ( decoded < 0 ) {
+            GPSTRACK_ERROR_LOG("invalid block at %ld in track %s", pos, name );
+            break;
+        }
+        fixes += decoded;
+        if ( (uint32_t)decoded < block_fixes ) {
+            break;
+        }
+        pos += GPSTRACK_BLOCK_HEADER + payload;
+    }
+    fclose( track );
+    free( block );
+
+    return( fixes );
+}
+
+int32_t gpstrack_export( const char *name, gpstrack_format_t format ) {
+    char dir[ 192 ] = "";
+    char path[ 256 ] = "";
+    gpstrack_export_t export_dsc;
+
+    if ( !name || !*name || strchr( name, '/' ) ) {
+        return( -1 );
+    }
+    gpstrack_get_dir( dir, sizeof( dir ) );
+    snprintf( path, sizeof( path ), "%s/%s%s", dir, name, format == GPSTRACK_GPX ? ".gpx" : ".geojson" );
+    export_dsc.file = fopen( path, "w" );
+    export_dsc.format = format;
+    export_dsc.fixes = 0;
+    if ( !export_dsc.file ) {
+        GPSTRACK_ERROR_LOG("can't export track to %s", path );
+        return( -1 );
+    }
+
+    if ( format == GPSTRACK_GPX ) {
+        fprintf( export_dsc.file, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<gpx version=\"1.1\" creator=\"%s %s\" xmlns=\"http://www.topografix.com/GPX/1/1\">\n<trk><name>%s</name><trkseg>\n", HARDWARE_NAME, __FIRMWARE__, name );
+    }
+    else {
+        fprintf( export_dsc.file, "{\"type\":\"Feature\",\"properties\":{\"name\":\"%s\"},\"geometry\":{\"type\":\"LineString\",\"coordinates\":[", name );
+    }
+    int32_t fixes = gpstrack_read( name, gpstrack_export_fix, &export_dsc );
+
+    if ( format == GPSTRACK_GPX ) {
+        fprintf( export_dsc.file, "</trkseg></trk>\n</gpx>\n" );
+    }
+    else {
+        fprintf( export_dsc.file, "]}}\n" );
+    }
+    fclose( export_dsc.file );
+    if ( fixes < 0 ) {
+        GPSTRACK_ERROR_LOG("can't read track %s", name );
+        remove( path );
+        return( -1 );
+    }
+    GPSTRACK_INFO_LOG("exported %d fixes to %s", export_dsc.fixes, path );
+
+    return( export_dsc.fixes );
+}
+
+#ifdef NATIVE_64BIT
+/**
+ * @brief bench decode callback, compare with the source fixes
+ */
+typedef struct {
+    const gpstrack_fix_t *fixes;                                    /** @brief source fixes */
+    uint32_t pos;                                                   /** @brief next fix to compare */
+    uint32_t mismatches;                                            /** @brief decoded fixes that differ */
+} gpstrack_bench_check_t;
+
+static bool gpstrack_bench_check( const gpstrack_fix_t *fix, void *arg ) {
+    gpstrack_bench_check_t *check = (gpstrack_bench_check_t*)arg;
+    const gpstrack_fix_t *src = &check->fixes[ check->pos++ ];
+
+    if ( src->time != fix->time || src->lat != fix->lat || src->lon != fix->lon || src->alt != fix->alt ) {
+        check->mismatches++;
+    }
+    return( true );
+}
+
+static uint64_t gpstrack_bench_now( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000 );
+}
+
+/**
+ * @brief encode and decode tracks with a "lat lon [alt]" per line and second,
+ * log the throughput and the size against raw fixes and gpx
+ */
+static void gpstrack_bench( const char *tracks ) {
+    char list[ 512 ] = "";
+    char *save = NULL;
+
+    snprintf( list, sizeof( list ), "%s", tracks );
+    for( char *track = strtok_r( list, ":", &save ) ; track ; track = strtok_r( NULL, ":", &save ) ) {
+        FILE *file = fopen( track, "r" );
+        if ( !file ) {
+            GPSTRACK_ERROR_LOG("can't open bench track %s", track );
+            continue;
+        }
+        /**
+         * read the track, one fix per second
+         */
+        uint32_t count = 0, size = 1024;
+        gpstrack_fix_t *fixes = (gpstrack_fix_t*)MALLOC( size * sizeof( gpstrack_fix_t ) );
+        char line[ 128 ];
+        uint32_t start_time = 1700000000;
+        uint64_t gpx_bytes = 0;
+
+        while( fixes && fgets( line, sizeof( line ), file ) ) {
+            double lat = 0, lon = 0, alt = 0;
+            if ( *line == '#' || sscanf( line, "%lf %lf %lf", &lat, &lon, &alt ) < 2 ) {
+                continue;
+            }
+            if ( count >= size ) {
+                gpstrack_fix_t *grown = (gpstrack_fix_t*)REALLOC( fixes, size * 2 * sizeof( gpstrack_fix_t ) );
+                if ( !grown ) {
+                    GPSTRACK_ERROR_LOG("bench track alloc failed, use %d fixes", count );
+                    break;
+                }
+                fixes = grown;
+                size *= 2;
+            }
+            fixes[ count ].time = start_time + count;
+            fixes[ count ].lat = (int32_t)lround( lat * 1e7 );
+            fixes[ count ].lon = (int32_t)lround( lon * 1e7 );
+            fixes[ count ].alt = (int32_t)lround( alt * 10 );
+            /**
+             * the same trkpt line the gpx export writes
+             */
+            gpx_bytes += snprintf( line, sizeof( line ), "<trkpt lat=\"%.7f\" lon=\"%.7f\"><ele>%.1f</ele><time>2023-11-14T22:13:20Z</time></trkpt>\n", lat, lon, alt );
+            count++;
+        }
+        fclose( file );
+        if ( !fixes || !count ) {
+            GPSTRACK_ERROR_LOG("no fixes in bench track %s", track );
+            if ( fixes ) {
+                free( fixes );
+            }
+            continue;
+        }
+        /**
+         * encode into blocks, worst case every fix needs GPSTRACK_MAX_FIX_BYTES
+         */
+        uint32_t max_blocks = count / ( ( GPSTRACK_BLOCK_SIZE - GPSTRACK_BLOCK_HEADER ) / GPSTRACK_MAX_FIX_BYTES ) + 1;
+        uint8_t *blocks = (uint8_t*)MALLOC( max_blocks * GPSTRACK_BLOCK_SIZE );
+        uint32_t *block_len = (uint32_t*)MALLOC( max_blocks * sizeof( uint32_t ) );
+        uint32_t block_count = 0;
+        uint64_t bytes = 0;
+        uint64_t encode_time = 0, decode_time = 0;
+        gpstrack_bench_check_t check;
+
+        for( int round = 0 ; round < GPSTRACK_BENCH_ROUNDS && blocks && block_len ; round++ ) {
+            gpstrack_block_t block;
+            uint64_t start = gpstrack_bench_now();
+
+            block_count = 0;
+            gpstrack_block_init( &block, blocks );
+            for( uint32_t i = 0 ; i < count ; i++ ) {
+                if ( !gpstrack_block_add( &block, &fixes[ i ] ) ) {
+                    gpstrack_block_close( &block );
+                    block_len[ block_count++ ] = block.len;
+                    gpstrack_block_init( &block, blocks + block_count * GPSTRACK_BLOCK_SIZE );
+                    gpstrack_block_add( &block, &fixes[ i ] );
+                }
+            }
+            gpstrack_block_close( &block );
+            block_len[ block_count++ ] = block.len;
+            encode_time += gpstrack_bench_now() - start;
+
+            start = gpstrack_bench_now();
+            check.fixes = fixes;
+            check.pos = 0;
+            check.mismatches = 0;
+            for( uint32_t i = 0 ; i < block_count ; i++ ) {
+                gpstrack_decode_block( blocks + i * GPSTRACK_BLOCK_SIZE, block_len[ i ], gpstrack_bench_check, &check );
+            }
+            decode_time += gpstrack_bench_now() - start;
+        }
+        bytes = 0;
+        for( uint32_t i = 0 ; i < block_count ; i++ ) {
+            bytes += block_len[ i ];
+        }
+        uint64_t total = (uint64_t)count * GPSTRACK_BENCH_ROUNDS;
+        GPSTRACK_INFO_LOG("track bench %s: %u fixes, %u blocks, %llu bytes, %.2f bytes per fix", track, count, block_count, (unsigned long long)bytes, (double)bytes / count );
+        GPSTRACK_INFO_LOG("  %.1fx smaller than %u byte fixed point fixes, %.1fx smaller than %u byte double fixes, %.1fx smaller than gpx",
+                            (double)count * sizeof( gpstrack_fix_t ) / bytes, (unsigned)sizeof( gpstrack_fix_t ),
+                            (double)count * 24 / bytes, 24,
+                            (double)gpx_bytes / bytes );
+        GPSTRACK_INFO_LOG("  encode %.1f Mfix/s (%.1f MB/s), decode %.1f Mfix/s (%.1f MB/s), %u mismatches after decode",
+                            encode_time ? total / (double)encode_time : 0, encode_time ? bytes * GPSTRACK_BENCH_ROUNDS / (double)encode_time : 0,
+                            decode_time ? total / (double)decode_time : 0, decode_time ? bytes * GPSTRACK_BENCH_ROUNDS / (double)decode_time : 0,
+                            check.mismatches + ( check.pos != count ? count : 0 ) );
+        free( fixes );
+        if ( blocks ) {
+            free( blocks );
+        }
+        if ( block_len ) {
+            free( block_len );
+        }
+    }
+}
+#endif
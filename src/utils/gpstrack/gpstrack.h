@@ -0,0 +1,181 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _GPSTRACK_H
+    #define _GPSTRACK_H
+
+    #include "utils/io.h"
+
+    #define GPSTRACK_INFO_LOG               log_i
+    #define GPSTRACK_LOG                    log_d
+    #define GPSTRACK_ERROR_LOG              log_e
+
+    #define GPSTRACK_DIR                    "tracks"            /** @brief track dir on /sd, /spiffs without sd card, ~/.hedge/sd on native */
+    #define GPSTRACK_EXT                    ".trk"              /** @brief track file extension */
+    #define GPSTRACK_NAME_LEN               32                  /** @brief max track name length */
+    #define GPSTRACK_BLOCK_SIZE             4096                /** @brief block size in bytes, header included */
+    #define GPSTRACK_BLOCK_HEADER           8                   /** @brief "GT", version, reserved, payload bytes and fixes, little endian uint16 */
+    #define GPSTRACK_VERSION                1                   /** @brief block format version */
+    #define GPSTRACK_MAX_FIX_BYTES          20                  /** @brief max bytes of a encoded fix, four varints */
+    #define GPSTRACK_RING_BLOCKS            4                   /** @brief blocks in the ram ring buffer */
+    #define GPSTRACK_FLUSH_BLOCKS           2                   /** @brief full blocks that are written together */
+    #define GPSTRACK_STANDBY_FILL           ( GPSTRACK_BLOCK_SIZE * 3 / 4 )   /** @brief block fill in bytes that is written on standby */
+    #define GPSTRACK_STANDBY_INTERVAL       ( 15 * 60 * 1000 )  /** @brief ms after the last write a standby writes a partial block */
+    #define GPSTRACK_BENCH_ENV              "HEDGE_GPSTRACK_BENCH"  /** @brief env var with ':' separated "lat lon [alt]" per line track files for the native bench */
+    #define GPSTRACK_BENCH_ROUNDS           20                  /** @brief encode/decode rounds per bench track */
+    /**
+     * @brief a fix in fixed point, in a block every fix is stored as zigzag varint
+     * deltas to the previous one, the first fix of a block to zero
+     */
+    typedef struct {
+        uint32_t time = 0;                      /** @brief utc time in s */
+        int32_t lat = 0;                        /** @brief latitude in 1e-7 degree */
+        int32_t lon = 0;                        /** @brief longitude in 1e-7 degree */
+        int32_t alt = 0;                        /** @brief altitude in dm */
+    } gpstrack_fix_t;
+    /**
+     * @brief export formats
+     */
+    typedef enum {
+        GPSTRACK_GPX = 0,                       /** @brief gpx 1.1 track */
+        GPSTRACK_GEOJSON                        /** @brief geojson feature with a linestring */
+    } gpstrack_format_t;
+    /**
+     * @brief recorder statistics
+     */
+    typedef struct {
+        uint32_t fixes = 0;                     /** @brief recorded fixes */
+        uint32_t skipped = 0;                   /** @brief fixes inside the interval */
+        uint32_t blocks = 0;                    /** @brief closed blocks */
+        uint32_t dropped = 0;                   /** @brief blocks dropped from a full ring */
+        uint32_t flushes = 0;                   /** @brief file writes */
+        uint64_t bytes = 0;                     /** @brief encoded bytes, block headers included */
+        uint64_t written = 0;                   /** @brief bytes written to the file */
+    } gpstrack_stats_t;
+    /**
+     * @brief decode callback, called for every fix of a block
+     *
+     * @param   fix     pointer to the fix
+     * @param   arg     user argument
+     *
+     * @return  false to stop decoding
+     */
+    typedef bool ( * GPSTRACK_DECODE_FUNC ) ( const gpstrack_fix_t *fix, void *arg );
+    /**
+     * @brief setup the gps track recorder
+     */
+    void gpstrack_setup( void );
+    /**
+     * @brief start a new track, a running track is stopped
+     *
+     * @param   name    track name, NULL for the current time as YYYYMMDD-HHMMSS
+     *
+     * @return  true if started
+     */
+    bool gpstrack_start( const char *name );
+    /**
+     * @brief stop the track, all blocks are written
+     */
+    void gpstrack_stop( void );
+    /**
+     * @brief check if a track is recorded
+     *
+     * @return  true if recording
+     */
+    bool gpstrack_is_recording( void );
+    /**
+     * @brief get the name of the current or last track
+     *
+     * @return  track name, empty if no track was recorded
+     */
+    const char *gpstrack_get_name( void );
+    /**
+     * @brief add a fix to the current track
+     *
+     * @param   fix     pointer to the fix
+     *
+     * @return  true if recorded, false if not recording or inside the interval
+     */
+    bool gpstrack_add_fix( const gpstrack_fix_t *fix );
+    /**
+     * @brief write all blocks, the current block is closed
+     */
+    void gpstrack_flush( void );
+    /**
+     * @brief enable or disable automatic recording while the gps has a fix
+     *
+     * @param   enable  true to enable
+     */
+    void gpstrack_set_enable( bool enable );
+    /**
+     * @brief get automatic recording config
+     *
+     * @return  true if enabled
+     */
+    bool gpstrack_get_enable( void );
+    /**
+     * @brief encode a fix as delta to the previous one
+     *
+     * @param   buf     pointer to the output, GPSTRACK_MAX_FIX_BYTES fit all
+     * @param   prev    pointer to the previous fix, a zero fix for the first one
+     * @param   fix     pointer to the fix
+     *
+     * @return  number of bytes written
+     */
+    size_t gpstrack_encode_fix( uint8_t *buf, const gpstrack_fix_t *prev, const gpstrack_fix_t *fix );
+    /**
+     * @brief decode a block
+     *
+     * @param   block   pointer to the block, header included
+     * @param   size    block size
+     * @param   func    callback for every fix
+     * @param   arg     user argument for the callback
+     *
+     * @return  number of decoded fixes, -1 if the block is invalid
+     */
+    int32_t gpstrack_decode_block( const uint8_t *block, size_t size, GPSTRACK_DECODE_FUNC func, void *arg );
+    /**
+     * @brief read a stored track fix by fix, a running track is flushed first
+     *
+     * @param   name    track name
+     * @param   func    decode callback, return false to stop reading
+     * @param   arg     user argument for the callback
+     *
+     * @return  number of read fixes, -1 if the track can't be opened
+     */
+    int32_t gpstrack_read( const char *name, GPSTRACK_DECODE_FUNC func, void *arg );
+    /**
+     * @brief export a stored track as <name>.gpx or <name>.geojson next to it
+     *
+     * @param   name    track name
+     * @param   format  GPSTRACK_GPX or GPSTRACK_GEOJSON
+     *
+     * @return  number of exported fixes, -1 if failed
+     */
+    int32_t gpstrack_export( const char *name, gpstrack_format_t format );
+    /**
+     * @brief get the recorder statistics
+     *
+     * @return  pointer to a gpstrack_stats_t structure
+     */
+    gpstrack_stats_t *gpstrack_get_stats( void );
+
+#endif // _GPSTRACK_H
@@ -0,0 +1,46 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _GPSTRACK_CONFIG_H
+    #define _GPSTRACK_CONFIG_H
+
+    #include "utils/basejsonconfig.h"
+
+    #define GPSTRACK_JSON_CONFIG_FILE       "/gpstrack.json"    /** @brief defines json config file name */
+
+    /**
+     * @brief gps track recorder config structure in memory
+     */
+    class gpstrack_config_t : public BaseJsonConfig {
+        public:
+        gpstrack_config_t();
+        bool enable = false;                    /** @brief record a track while the gps has a fix */
+        int32_t interval = 1;                   /** @brief min time in s between two recorded fixes */
+
+        protected:
+        ////////////// Available for overloading: //////////////
+        virtual bool onLoad(JsonDocument& document);
+        virtual bool onSave(JsonDocument& document);
+        virtual bool onDefault( void );
+        virtual size_t getJsonBufferSize() { return 1000; }
+    };
+
+#endif // _GPSTRACK_CONFIG_H
@@ -0,0 +1,291 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "inputrec.h"
+
+#ifdef NATIVE_64BIT
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <string.h>
+    #include "hardware/button.h"
+    #include "hardware/framebuffer.h"
+    #include "hardware/powermgm.h"
+    #include "utils/latency/latency.h"
+    #include "utils/logging.h"
+    #include "utils/millis.h"
+
+    static FILE *inputrec_record_file = NULL;                   /** @brief file to record into */
+    static FILE *inputrec_replay_file = NULL;                   /** @brief file to replay from */
+    static uint32_t inputrec_start = 0;                         /** @brief lv tick at record start, wall clock ms at replay start */
+    static uint32_t inputrec_tick = 0;                          /** @brief virtual replay time in ms, the recorded time of the lv tick */
+    static lv_indev_data_t inputrec_touch;                      /** @brief last recorded/replayed pointer state */
+    /**
+     * next event from the replay file, read ahead until its time has come
+     */
+    static bool inputrec_next_valid = false;
+    static uint32_t inputrec_next_time = 0;
+    static inputrec_type_t inputrec_next_type = INPUTREC_TOUCH;
+    static int32_t inputrec_next_arg[ 3 ] = { 0, 0, 0 };
+
+    static volatile uint32_t inputrec_flushes = 0;              /** @brief flushes since setup */
+    static const char *inputrec_type_name[ INPUTREC_NUM ] = { "touch", "button", "powermgm", "exit" };
+
+    static bool inputrec_button_event_cb( EventBits_t event, void *arg );
+    static bool inputrec_framebuffer_event_cb( EventBits_t event, void *arg );
+    static bool inputrec_powermgm_loop_cb( EventBits_t event, void *arg );
+    static bool inputrec_read_next( void );
+    static void inputrec_replay_end( void );
+#endif
+
+static inputrec_stats_t inputrec_stats;
+
+void inputrec_setup( void ) {
+#ifdef NATIVE_64BIT
+    const char *record = getenv( INPUTREC_RECORD_ENV );
+    const char *replay = getenv( INPUTREC_REPLAY_ENV );
+
+    memset( &inputrec_touch, 0, sizeof( inputrec_touch ) );
+    inputrec_touch.state = LV_INDEV_STATE_REL;
+    /**
+     * replay wins over record, recording a replay makes no sense
+     */
+    if ( replay && *replay ) {
+        inputrec_replay_file = fopen( replay, "r" );
+        if ( !inputrec_replay_file ) {
+            INPUTREC_ERROR_LOG("can't open replay file %s", replay );
+            return;
+        }
+        INPUTREC_INFO_LOG("replay input from %s", replay );
+    }
+    else if ( record && *record ) {
+        inputrec_record_file = fopen( record, "w" );
+        if ( !inputrec_record_file ) {
+            INPUTREC_ERROR_LOG("can't open record file %s", record );
+            return;
+        }
+        fprintf( inputrec_record_file, "# %s %s input record\n", HARDWARE_NAME, __FIRMWARE__ );
+        fflush( inputrec_record_file );
+        button_register_cb( 0xffffffff, inputrec_button_event_cb, "inputrec button" );
+        INPUTREC_INFO_LOG("record input into %s", record );
+    }
+    else {
+        return;
+    }
+    inputrec_start = inputrec_replay_file ? millis() : lv_tick_get();
+    framebuffer_register_cb( FRAMEBUFFER_FLUSH, inputrec_framebuffer_event_cb, "inputrec" );
+    powermgm_register_loop_cb( POWERMGM_WAKEUP | POWERMGM_SILENCE_WAKEUP | POWERMGM_STANDBY, inputrec_powermgm_loop_cb, "inputrec loop" );
+#endif
+}
+
+void inputrec_touch_read( lv_indev_data_t *data ) {
+#ifdef NATIVE_64BIT
+    if ( inputrec_replay_file ) {
+        /**
+         * ignore the live pointer, the replay owns the pointer state
+         */
+        data->state = inputrec_touch.state;
+        data->point = inputrec_touch.point;
+    }
+    else if ( inputrec_record_file ) {
+        /**
+         * record press/release and movement while pressed
+         */
+        if ( data->state != inputrec_touch.state || ( data->state == LV_INDEV_STATE_PR && ( data->point.x != inputrec_touch.point.x || data->point.y != inputrec_touch.point.y ) ) ) {
+            fprintf( inputrec_record_file, "%u touch %d %d %d\n", lv_tick_elaps( inputrec_start ), data->state == LV_INDEV_STATE_PR ? 1 : 0, data->point.x, data->point.y );
+            fflush( inputrec_record_file );
+            inputrec_touch.state = data->state;
+            inputrec_touch.point = data->point;
+        }
+    }
+#endif
+}
+
+bool inputrec_is_replaying( void ) {
+#ifdef NATIVE_64BIT
+    return( inputrec_replay_file != NULL );
+#else
+    return( false );
+#endif
+}
+
+inputrec_stats_t *inputrec_get_stats( void ) {
+    return( &inputrec_stats );
+}
+
+#ifdef NATIVE_64BIT
+static bool inputrec_button_event_cb( EventBits_t event, void *arg ) {
+    if ( inputrec_record_file ) {
+        fprintf( inputrec_record_file, "%u button %04x\n", lv_tick_elaps( inputrec_start ), event );
+        fflush( inputrec_record_file );
+    }
+    return( true );
+}
+
+static bool inputrec_framebuffer_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case FRAMEBUFFER_FLUSH:
+            inputrec_flushes++;
+            break;
+    }
+    return( true );
+}
+
+static bool inputrec_read_next( void ) {
+    char line[ INPUTREC_LINE_SIZE ];
+    char type[ 16 ];
+
+    inputrec_next_valid = false;
+
+    while( fgets( line, sizeof( line ), inputrec_replay_file ) ) {
+        /**
+         * skip comments and empty lines
+         */
+        if ( line[ 0 ] == '#' || line[ 0 ] == '\n' || line[ 0 ] == '\r' )
+            continue;
+
+        uint32_t time = 0;
+        int args = 0;
+        inputrec_next_arg[ 0 ] = inputrec_next_arg[ 1 ] = inputrec_next_arg[ 2 ] = 0;
+        if ( sscanf( line, "%u %15s %n", &time, type, &args ) < 2 ) {
+            INPUTREC_ERROR_LOG("malformed replay line: %s", line );
+            continue;
+        }
+
+        int type_num = 0;
+        for( type_num = 0 ; type_num < INPUTREC_NUM ; type_num++ ) {
+            if ( !strcmp( type, inputrec_type_name[ type_num ] ) )
+                break;
+        }
+
+        bool valid = false;
+        switch( type_num ) {
+            case INPUTREC_TOUCH:
+                valid = sscanf( line + args, "%d %d %d", &inputrec_next_arg[ 0 ], &inputrec_next_arg[ 1 ], &inputrec_next_arg[ 2 ] ) == 3;
+                break;
+            case INPUTREC_BUTTON:
+            case INPUTREC_POWERMGM:
+                valid = sscanf( line + args, "%x", (uint32_t*)&inputrec_next_arg[ 0 ] ) == 1;
+                break;
+            case INPUTREC_EXIT:
+                valid = true;
+                break;
+        }
+        if ( !valid ) {
+            INPUTREC_ERROR_LOG("malformed replay line: %s", line );
+            continue;
+        }
+
+        inputrec_next_time = time;
+        inputrec_next_type = (inputrec_type_t)type_num;
+        inputrec_next_valid = true;
+        break;
+    }
+    return( inputrec_next_valid );
+}
+
+static void inputrec_replay_end( void ) {
+    inputrec_stats.duration = millis() - inputrec_start;
+    inputrec_stats.ticks = inputrec_tick;
+    INPUTREC_INFO_LOG("replay finished: %u events, %ums replayed in %ums", inputrec_stats.events, inputrec_stats.ticks, inputrec_stats.duration );
+    INPUTREC_INFO_LOG("  %u flushes, %u frames, avg frame %llums, max frame %ums",
+                        inputrec_stats.flushes,
+                        inputrec_stats.frames,
+                        inputrec_stats.frames ? (unsigned long long)( inputrec_stats.sum_frame_time / inputrec_stats.frames ) : 0ULL,
+                        inputrec_stats.max_frame_time );
+    latency_log_report();
+    fclose( inputrec_replay_file );
+    inputrec_replay_file = NULL;
+}
+
+static bool inputrec_powermgm_loop_cb( EventBits_t event, void *arg ) {
+    static uint32_t last_flushes = 0;
+    static uint32_t last_round = 0;
+    /**
+     * frame timing, a loop round is one lv_task_handler call, the lv tick
+     * is virtual so the wall clock is taken
+     */
+    if ( inputrec_replay_file ) {
+        uint32_t flushes = inputrec_flushes;
+        if ( flushes != last_flushes && last_round ) {
+            uint32_t frame_time = millis() - last_round;
+            inputrec_stats.flushes += flushes - last_flushes;
+            inputrec_stats.frames++;
+            inputrec_stats.sum_frame_time += frame_time;
+            if ( frame_time > inputrec_stats.max_frame_time )
+                inputrec_stats.max_frame_time = frame_time;
+        }
+        last_flushes = flushes;
+        last_round = millis();
+    }
+    /**
+     * advance the virtual tick towards the next event, capped to hit the
+     * recorded time of the event exactly
+     */
+    if ( inputrec_replay_file && ( inputrec_next_valid || inputrec_read_next() ) && inputrec_next_time > inputrec_tick ) {
+        uint32_t step = inputrec_next_time - inputrec_tick;
+        if ( step > INPUTREC_TICK_STEP )
+            step = INPUTREC_TICK_STEP;
+        inputrec_tick += step;
+        lv_tick_inc( step );
+    }
+    /**
+     * inject all events that are due
+     */
+    while( inputrec_replay_file ) {
+        if ( !inputrec_next_valid && !inputrec_read_next() ) {
+            inputrec_replay_end();
+            break;
+        }
+        if ( inputrec_tick < inputrec_next_time )
+            break;
+
+        inputrec_next_valid = false;
+        inputrec_stats.events++;
+
+        switch( inputrec_next_type ) {
+            case INPUTREC_TOUCH:
+                inputrec_touch.state = inputrec_next_arg[ 0 ] ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+                inputrec_touch.point.x = inputrec_next_arg[ 1 ];
+                inputrec_touch.point.y = inputrec_next_arg[ 2 ];
+                break;
+            case INPUTREC_BUTTON:
+                button_send_cb( (EventBits_t)inputrec_next_arg[ 0 ], (void*)NULL );
+                break;
+            case INPUTREC_POWERMGM:
+                powermgm_set_event( (EventBits_t)inputrec_next_arg[ 0 ] );
+                break;
+            case INPUTREC_EXIT:
+                inputrec_replay_end();
+                exit( 0 );
+                break;
+            default:
+                break;
+        }
+        /**
+         * only one touch change per round, lvgl has to see every state
+         */
+        if ( inputrec_next_type == INPUTREC_TOUCH )
+            break;
+    }
+    return( true );
+}
+#endif
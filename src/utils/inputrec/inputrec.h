@@ -0,0 +1,94 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _INPUTREC_H
+    #define _INPUTREC_H
+
+    #include "lvgl.h"
+
+    #define INPUTREC_INFO_LOG           log_i
+    #define INPUTREC_DEBUG_LOG          log_d
+    #define INPUTREC_ERROR_LOG          log_e
+
+    #define INPUTREC_RECORD_ENV         "HEDGE_INPUT_RECORD"    /** @brief env var with the file to record into */
+    #define INPUTREC_REPLAY_ENV         "HEDGE_INPUT_REPLAY"    /** @brief env var with the file to replay */
+    #define INPUTREC_LINE_SIZE          128                     /** @brief max line length in a record file */
+    #define INPUTREC_TICK_STEP          5                       /** @brief max ms the virtual lv tick advances per loop round while replaying */
+    /**
+     * record file format, one event per line, time in ms since start of
+     * recording/replay, empty lines and lines starting with '#' are ignored
+     *
+     *  <ms> touch <0|1> <x> <y>    pointer released/pressed at x/y
+     *  <ms> button <mask>          button event, BUTTON_* mask in hex
+     *  <ms> powermgm <mask>        powermgm_set_event(), POWERMGM_* mask in hex
+     *  <ms> exit                   print the replay statistics and exit
+     *
+     * a replay owns the lv tick, it advances per loop round from the recorded
+     * times and not from the wall clock, so every replay sees the same ticks
+     *
+     * run a replay headless with SDL_VIDEODRIVER=dummy
+     */
+    typedef enum {
+        INPUTREC_TOUCH = 0,
+        INPUTREC_BUTTON,
+        INPUTREC_POWERMGM,
+        INPUTREC_EXIT,
+        INPUTREC_NUM
+    } inputrec_type_t;
+    /**
+     * @brief replay statistics
+     */
+    typedef struct {
+        uint32_t events = 0;                    /** @brief number of replayed events */
+        uint32_t duration = 0;                  /** @brief replay duration in wall clock ms */
+        uint32_t ticks = 0;                     /** @brief replayed virtual lv ticks in ms */
+        uint32_t flushes = 0;                   /** @brief number of framebuffer flushes while replaying */
+        uint32_t frames = 0;                    /** @brief number of loop rounds with at least one flush */
+        uint32_t max_frame_time = 0;            /** @brief longest loop round with a flush in ms */
+        uint64_t sum_frame_time = 0;            /** @brief sum of all loop rounds with a flush in ms */
+    } inputrec_stats_t;
+    /**
+     * @brief setup input record/replay, reads INPUTREC_RECORD_ENV/INPUTREC_REPLAY_ENV
+     * on native, does nothing on the hardware
+     */
+    void inputrec_setup( void );
+    /**
+     * @brief filter a pointer read, called from the touch indev read callback.
+     * when recording the data is logged, when replaying the data is replaced
+     * by the replayed pointer state
+     *
+     * @param   data    pointer to the lvgl indev data
+     */
+    void inputrec_touch_read( lv_indev_data_t *data );
+    /**
+     * @brief check if a replay is running, the lv ticker must not advance the lv tick then
+     *
+     * @return  true if replaying
+     */
+    bool inputrec_is_replaying( void );
+    /**
+     * @brief get the replay statistics
+     *
+     * @return  pointer to a inputrec_stats_t structure
+     */
+    inputrec_stats_t *inputrec_get_stats( void );
+
+#endif // _INPUTREC_H
@@ -0,0 +1,292 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "latency.h"
+#include "hardware/framebuffer.h"
+#include "hardware/powermgm.h"
+#include "utils/alloc.h"
+
+#ifdef NATIVE_64BIT
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <string.h>
+    #include <time.h>
+    #include "utils/logging.h"
+#else
+    #include <Arduino.h>
+    #include <esp_timer.h>
+#endif
+/**
+ * one measurement is running at a time, from the input sample to the first
+ * flush after the input has triggered something, a lvgl event or a button
+ */
+static bool latency_pending = false;                                /** @brief measurement running */
+static bool latency_armed = false;                                  /** @brief input triggered something, next flush ends the measurement */
+static latency_type_t latency_type = LATENCY_TOUCH;                 /** @brief interaction type of the running measurement */
+static uint64_t latency_input_time = 0;                             /** @brief input sample time in us */
+static uint64_t latency_event_time = 0;                             /** @brief first event time in us */
+static uint32_t latency_rounds = 0;                                 /** @brief lv_task_handler rounds since input */
+/**
+ * pointer state to detect press and drag
+ */
+static bool latency_pressed = false;
+static bool latency_dragging = false;
+static lv_point_t latency_press_point;
+static lv_point_t latency_last_point;
+
+static latency_stats_t latency_stats[ LATENCY_NUM ];
+static const char *latency_type_name[ LATENCY_NUM ] = { "swipe", "touch", "keyboard", "button" };
+
+#ifdef NATIVE_64BIT
+    static uint32_t latency_report_interval = 0;                    /** @brief native report interval in s, 0 = off */
+    static bool latency_powermgm_loop_cb( EventBits_t event, void *arg );
+#endif
+static bool latency_framebuffer_event_cb( EventBits_t event, void *arg );
+static void latency_start( latency_type_t type );
+
+static uint64_t latency_now( void ) {
+#ifdef NATIVE_64BIT
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000 );
+#else
+    return( esp_timer_get_time() );
+#endif
+}
+
+void latency_setup( void ) {
+    latency_reset_stats();
+    framebuffer_register_cb( FRAMEBUFFER_FLUSH, latency_framebuffer_event_cb, "latency" );
+#ifdef NATIVE_64BIT
+    const char *interval = getenv( LATENCY_REPORT_ENV );
+    if ( interval && atoi( interval ) > 0 ) {
+        latency_report_interval = atoi( interval );
+        powermgm_register_loop_cb( POWERMGM_WAKEUP | POWERMGM_SILENCE_WAKEUP | POWERMGM_STANDBY, latency_powermgm_loop_cb, "latency loop" );
+    }
+#endif
+}
+
+static void latency_start( latency_type_t type ) {
+    /**
+     * an armed measurement waits for its flush, don't restart it
+     */
+    if ( latency_armed && latency_now() - latency_input_time < LATENCY_TIMEOUT * 1000ULL )
+        return;
+    if ( latency_armed ) {
+        latency_stats[ latency_type ].dropped++;
+    }
+    latency_pending = true;
+    latency_armed = false;
+    latency_type = type;
+    latency_input_time = latency_now();
+    latency_event_time = 0;
+    latency_rounds = 0;
+}
+
+void latency_touch_read( lv_indev_data_t *data ) {
+    if ( data->state == LV_INDEV_STATE_PR ) {
+        if ( !latency_pressed ) {
+            /**
+             * new press
+             */
+            latency_pressed = true;
+            latency_dragging = false;
+            latency_press_point = data->point;
+            latency_last_point = data->point;
+            latency_start( LATENCY_TOUCH );
+        }
+        else if ( data->point.x != latency_last_point.x || data->point.y != latency_last_point.y ) {
+            /**
+             * movement while pressed, every move sample is a new swipe measurement
+             */
+            latency_last_point = data->point;
+            if ( !latency_dragging && ( abs( data->point.x - latency_press_point.x ) > LATENCY_DRAG_LIMIT || abs( data->point.y - latency_press_point.y ) > LATENCY_DRAG_LIMIT ) ) {
+                latency_dragging = true;
+            }
+            if ( latency_dragging ) {
+                latency_start( LATENCY_SWIPE );
+            }
+        }
+    }
+    else if ( latency_pressed ) {
+        /**
+         * release, measure the release response as touch if not swiped
+         */
+        latency_pressed = false;
+        latency_start( latency_dragging ? LATENCY_SWIPE : LATENCY_TOUCH );
+        latency_dragging = false;
+    }
+}
+
+void latency_indev_feedback_cb( lv_indev_drv_t *drv, uint8_t event ) {
+    if ( !latency_pending || latency_armed ) {
+        return;
+    }
+    latency_event_time = latency_now();
+    latency_armed = true;
+    /**
+     * a press on a keyboard is a keyboard interaction
+     */
+    if ( latency_type == LATENCY_TOUCH ) {
+        lv_obj_t *obj = lv_indev_get_obj_act();
+        if ( obj ) {
+            lv_obj_type_t type;
+            lv_obj_get_type( obj, &type );
+            if ( type.type[ 0 ] && !strcmp( type.type[ 0 ], "lv_keyboard" ) ) {
+                latency_type = LATENCY_KEYBOARD;
+            }
+        }
+    }
+}
+
+void latency_button( EventBits_t event ) {
+    latency_start( LATENCY_BUTTON );
+    /**
+     * the button callbacks are called right after, no event needed
+     */
+    latency_event_time = latency_input_time;
+    latency_armed = true;
+}
+
+void latency_task_handler( void ) {
+    if ( !latency_pending ) {
+        return;
+    }
+    latency_rounds++;
+    if ( latency_now() - latency_input_time > LATENCY_TIMEOUT * 1000ULL ) {
+        if ( latency_armed ) {
+            latency_stats[ latency_type ].dropped++;
+        }
+        latency_pending = false;
+        latency_armed = false;
+    }
+}
+
+static bool latency_framebuffer_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case FRAMEBUFFER_FLUSH: {
+            if ( !latency_armed ) {
+                break;
+            }
+            uint64_t now = latency_now();
+            uint32_t total = now - latency_input_time;
+            latency_stats_t *stats = &latency_stats[ latency_type ];
+            /**
+             * update stats and histogram
+             */
+            if ( stats->count == 0 || total < stats->min ) stats->min = total;
+            if ( total > stats->max ) stats->max = total;
+            stats->count++;
+            stats->sum += total;
+            stats->sum_event += latency_event_time - latency_input_time;
+            stats->sum_render += now - latency_event_time;
+            stats->rounds += latency_rounds;
+
+            uint32_t bucket = 0;
+            for( uint32_t ms = total / 1000 ; ms && bucket < LATENCY_BUCKETS - 1 ; ms >>= 1 ) {
+                bucket++;
+            }
+            stats->histogram[ bucket ]++;
+
+            latency_pending = false;
+            latency_armed = false;
+            break;
+        }
+    }
+    return( true );
+}
+
+latency_stats_t *latency_get_stats( latency_type_t type ) {
+    if ( type >= LATENCY_NUM ) {
+        return( NULL );
+    }
+    return( &latency_stats[ type ] );
+}
+
+void latency_reset_stats( void ) {
+    for( int i = 0 ; i < LATENCY_NUM ; i++ ) {
+        latency_stats[ i ] = latency_stats_t();
+    }
+    latency_pending = false;
+    latency_armed = false;
+}
+
+size_t latency_get_report( char *buf, size_t size ) {
+    size_t len = 0;
+
+    if ( !buf || !size ) {
+        return( 0 );
+    }
+    buf[ 0 ] = '\0';
+    /**
+     * one line per type, then the histogram
+     */
+    for( int i = 0 ; i < LATENCY_NUM && len < size ; i++ ) {
+        latency_stats_t *stats = &latency_stats[ i ];
+        uint32_t count = stats->count ? stats->count : 1;
+
+        len += snprintf( buf + len, size - len, "%s: %u samples, %u dropped, min %.1fms avg %.1fms max %.1fms (event %.1fms, render %.1fms, %.1f rounds)\n",
+                            latency_type_name[ i ],
+                            stats->count,
+                            stats->dropped,
+                            stats->min / 1000.0,
+                            stats->sum / count / 1000.0,
+                            stats->max / 1000.0,
+                            stats->sum_event / count / 1000.0,
+                            stats->sum_render / count / 1000.0,
+                            (float)stats->rounds / count );
+        if ( !stats->count || len >= size ) {
+            continue;
+        }
+        len += snprintf( buf + len, size - len, "  " );
+        for( int bucket = 0 ; bucket < LATENCY_BUCKETS && len < size ; bucket++ ) {
+            len += snprintf( buf + len, size - len, "%s%u:%u ", bucket == LATENCY_BUCKETS - 1 ? ">=" : "<", bucket == LATENCY_BUCKETS - 1 ? 1 << ( bucket - 1 ) : 1 << bucket, stats->histogram[ bucket ] );
+        }
+        if ( len < size ) {
+            len += snprintf( buf + len, size - len, "\n" );
+        }
+    }
+    return( len < size ? len : size - 1 );
+}
+
+void latency_log_report( void ) {
+    char *report = (char*)MALLOC( LATENCY_REPORT_SIZE );
+    if ( !report ) {
+        LATENCY_ERROR_LOG("report alloc failed");
+        return;
+    }
+    latency_get_report( report, LATENCY_REPORT_SIZE );
+    LATENCY_INFO_LOG("touch to photon latency:\n%s", report );
+    free( report );
+}
+
+#ifdef NATIVE_64BIT
+static bool latency_powermgm_loop_cb( EventBits_t event, void *arg ) {
+    static uint32_t last_report = lv_tick_get();
+
+    if ( lv_tick_elaps( last_report ) > latency_report_interval * 1000 ) {
+        last_report = lv_tick_get();
+        latency_log_report();
+    }
+    return( true );
+}
+#endif
@@ -0,0 +1,114 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _LATENCY_H
+    #define _LATENCY_H
+
+    #include "lvgl.h"
+    #include "hardware/callback.h"
+
+    #define LATENCY_INFO_LOG            log_i
+    #define LATENCY_DEBUG_LOG           log_d
+    #define LATENCY_ERROR_LOG           log_e
+
+    #define LATENCY_REPORT_ENV          "HEDGE_LATENCY_REPORT"  /** @brief env var with a report interval in seconds on native */
+    #define LATENCY_DRAG_LIMIT          10                      /** @brief pointer movement in pixel after a press is a swipe */
+    #define LATENCY_TIMEOUT             1000                    /** @brief drop a measurement without a flush after ms */
+    #define LATENCY_BUCKETS             11                      /** @brief histogram buckets, <1ms, <2ms, <4ms ... <512ms, >=512ms */
+    #define LATENCY_REPORT_SIZE         1536                    /** @brief buffer size for a text report */
+    /**
+     * @brief interaction types
+     */
+    typedef enum {
+        LATENCY_SWIPE = 0,                      /** @brief pointer moved while pressed, e.g. tile swipe */
+        LATENCY_TOUCH,                          /** @brief pointer press on a object, e.g. button */
+        LATENCY_KEYBOARD,                       /** @brief pointer press on a keyboard */
+        LATENCY_BUTTON,                         /** @brief hardware button */
+        LATENCY_NUM
+    } latency_type_t;
+    /**
+     * @brief latency statistics for one interaction type, all times in us
+     */
+    typedef struct {
+        uint32_t count = 0;                     /** @brief number of measurements */
+        uint32_t dropped = 0;                   /** @brief measurements without a flush in LATENCY_TIMEOUT */
+        uint32_t min = 0;                       /** @brief min input to photon time */
+        uint32_t max = 0;                       /** @brief max input to photon time */
+        uint64_t sum = 0;                       /** @brief sum of input to photon time */
+        uint64_t sum_event = 0;                 /** @brief sum of input to first event time */
+        uint64_t sum_render = 0;                /** @brief sum of first event to first flush time */
+        uint32_t rounds = 0;                    /** @brief sum of lv_task_handler rounds between input and flush */
+        uint32_t histogram[ LATENCY_BUCKETS ];  /** @brief input to photon histogram */
+    } latency_stats_t;
+    /**
+     * @brief setup latency measurement, hooks into the framebuffer flush path
+     */
+    void latency_setup( void );
+    /**
+     * @brief start a measurement from a pointer read, called from the touch indev read callback
+     *
+     * @param   data    pointer to the lvgl indev data
+     */
+    void latency_touch_read( lv_indev_data_t *data );
+    /**
+     * @brief lvgl indev feedback callback, called for every event a indev triggers
+     *
+     * @param   drv     pointer to the indev driver
+     * @param   event   lvgl event
+     */
+    void latency_indev_feedback_cb( lv_indev_drv_t *drv, uint8_t event );
+    /**
+     * @brief start a measurement from a hardware button event
+     *
+     * @param   event   button event mask
+     */
+    void latency_button( EventBits_t event );
+    /**
+     * @brief count a lv_task_handler round, call it right before lv_task_handler()
+     */
+    void latency_task_handler( void );
+    /**
+     * @brief get the latency statistics
+     *
+     * @param   type    interaction type
+     *
+     * @return  pointer to a latency_stats_t structure, NULL if type is invalid
+     */
+    latency_stats_t *latency_get_stats( latency_type_t type );
+    /**
+     * @brief clear all latency statistics
+     */
+    void latency_reset_stats( void );
+    /**
+     * @brief write a text report with all histograms
+     *
+     * @param   buf     pointer to a char buffer
+     * @param   size    buffer size, LATENCY_REPORT_SIZE fits all
+     *
+     * @return  report length
+     */
+    size_t latency_get_report( char *buf, size_t size );
+    /**
+     * @brief log the text report
+     */
+    void latency_log_report( void );
+
+#endif // _LATENCY_H
@@ -0,0 +1,48 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "lock.h"
+
+void lock_mutex_take( lock_mutex_t *mutex ) {
+#ifdef NATIVE_64BIT
+    pthread_mutex_lock( mutex );
+#else
+    /**
+     * the loser of a concurrent first use deletes his mutex and takes
+     * the one that won
+     */
+    if ( *mutex == NULL ) {
+        SemaphoreHandle_t created = xSemaphoreCreateMutex();
+        if ( !__sync_bool_compare_and_swap( mutex, NULL, created ) ) {
+            vSemaphoreDelete( created );
+        }
+    }
+    xSemaphoreTake( *mutex, portMAX_DELAY );
+#endif
+}
+
+void lock_mutex_give( lock_mutex_t *mutex ) {
+#ifdef NATIVE_64BIT
+    pthread_mutex_unlock( mutex );
+#else
+    xSemaphoreGive( *mutex );
+#endif
+}
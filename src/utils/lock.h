@@ -0,0 +1,52 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _LOCK_H
+    #define _LOCK_H
+
+    #ifdef NATIVE_64BIT
+        #include <pthread.h>
+
+        typedef pthread_mutex_t lock_mutex_t;
+        #define LOCK_MUTEX_INITIALIZER      PTHREAD_MUTEX_INITIALIZER   /** @brief static initializer of a lock_mutex_t */
+    #else
+        #include <freertos/FreeRTOS.h>
+        #include <freertos/semphr.h>
+
+        typedef SemaphoreHandle_t lock_mutex_t;
+        #define LOCK_MUTEX_INITIALIZER      NULL                        /** @brief static initializer of a lock_mutex_t, created on first use */
+    #endif
+    /**
+     * @brief take a module mutex, a statically initialized mutex is created
+     * on first use, two tasks that take it first at the same time get the
+     * same mutex
+     *
+     * @param   mutex   pointer to a lock_mutex_t initialized with LOCK_MUTEX_INITIALIZER
+     */
+    void lock_mutex_take( lock_mutex_t *mutex );
+    /**
+     * @brief give a mutex taken by lock_mutex_take() back
+     *
+     * @param   mutex   pointer to the lock_mutex_t
+     */
+    void lock_mutex_give( lock_mutex_t *mutex );
+
+#endif // _LOCK_H
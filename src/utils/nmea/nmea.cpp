@@ -0,0 +1,440 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "nmea.h"
+#include "utils/alloc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef NATIVE_64BIT
+    #include <time.h>
+    #include "utils/logging.h"
+#else
+    #include <Arduino.h>
+#endif
+
+static const char *nmea_type_name[ NMEA_NUM ] = { "invalid", "unknown", "RMC", "GGA", "VTG", "GSV", "RMB", "APB", "MWV" };
+static const double nmea_pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+static char nmea_empty[] = "";
+
+/**
+ * @brief strip the line end
+ */
+static size_t nmea_trim( const char *sentence, size_t len ) {
+    while( len && ( sentence[ len - 1 ] == '\r' || sentence[ len - 1 ] == '\n' ) ) {
+        len--;
+    }
+    return( len );
+}
+
+static uint8_t nmea_hex( char c ) {
+    if ( c >= '0' && c <= '9' ) return( c - '0' );
+    if ( c >= 'A' && c <= 'F' ) return( c - 'A' + 10 );
+    if ( c >= 'a' && c <= 'f' ) return( c - 'a' + 10 );
+    return( 0xff );
+}
+
+bool nmea_checksum( const char *sentence, size_t len ) {
+    uint8_t checksum = 0;
+
+    if ( !sentence ) {
+        return( false );
+    }
+    len = nmea_trim( sentence, len );
+    if ( len < 4 || ( sentence[ 0 ] != '$' && sentence[ 0 ] != '!' ) || sentence[ len - 3 ] != '*' ) {
+        return( false );
+    }
+    for( size_t i = 1 ; i < len - 3 ; i++ ) {
+        checksum ^= sentence[ i ];
+    }
+    uint8_t high = nmea_hex( sentence[ len - 2 ] );
+    uint8_t low = nmea_hex( sentence[ len - 1 ] );
+    return( high <= 0xf && low <= 0xf && checksum == ( ( high << 4 ) | low ) );
+}
+
+uint32_t nmea_split( char *sentence, char **fields, uint32_t max ) {
+    uint32_t count = 0;
+    char *c = sentence;
+
+    if ( !sentence || !fields || !max ) {
+        return( 0 );
+    }
+    if ( *c == '$' || *c == '!' ) {
+        c++;
+    }
+    fields[ count++ ] = c;
+    for( ; *c ; c++ ) {
+        if ( *c == ',' ) {
+            *c = '\0';
+            if ( count == max ) {
+                break;
+            }
+            fields[ count++ ] = c + 1;
+        }
+        else if ( *c == '*' || *c == '\r' || *c == '\n' ) {
+            *c = '\0';
+            break;
+        }
+    }
+    return( count );
+}
+
+/**
+ * @brief decimal field without exponent, NAN if empty, not a number or more
+ * than 18 integer digits, the mantissa stays within 18 digits
+ */
+static double nmea_float( const char *field ) {
+    const char *c = field;
+    bool negative = false;
+    bool digits = false;
+    int64_t mantissa = 0;
+    int32_t scale = 0;
+    int32_t count = 0;
+
+    if ( *c == '-' || *c == '+' ) {
+        negative = *c++ == '-';
+    }
+    for( ; *c >= '0' && *c <= '9' ; c++ ) {
+        if ( count++ == 18 ) {
+            return( NAN );
+        }
+        mantissa = mantissa * 10 + ( *c - '0' );
+        digits = true;
+    }
+    if ( *c == '.' ) {
+        for( c++ ; *c >= '0' && *c <= '9' ; c++ ) {
+            if ( scale < 15 && count < 18 ) {
+                mantissa = mantissa * 10 + ( *c - '0' );
+                scale++;
+                count++;
+            }
+            digits = true;
+        }
+    }
+    if ( !digits || *c ) {
+        return( NAN );
+    }
+    return( ( negative ? -mantissa : mantissa ) / nmea_pow10[ scale ] );
+}
+
+/**
+ * @brief integer field, -1 if empty, not a number or more than 9 digits
+ */
+static int32_t nmea_int( const char *field ) {
+    int32_t value = 0;
+    const char *c = field;
+
+    if ( !*c ) {
+        return( -1 );
+    }
+    for( ; *c >= '0' && *c <= '9' ; c++ ) {
+        if ( c - field == 9 ) {
+            return( -1 );
+        }
+        value = value * 10 + ( *c - '0' );
+    }
+    return( *c ? -1 : value );
+}
+
+/**
+ * @brief (d)ddmm.mmmm and hemisphere to degree
+ */
+static double nmea_coord( const char *field, const char *hemisphere ) {
+    double value = nmea_float( field );
+
+    if ( isnan( value ) ) {
+        return( NAN );
+    }
+    double degree = floor( value / 100.0 );
+    degree += ( value - degree * 100.0 ) / 60.0;
+    return( *hemisphere == 'S' || *hemisphere == 'W' ? -degree : degree );
+}
+
+/**
+ * @brief hhmmss.sss to ms since midnight, -1 if empty
+ */
+static int32_t nmea_time( const char *field ) {
+    int32_t digits[ 6 ];
+
+    for( int i = 0 ; i < 6 ; i++ ) {
+        if ( field[ i ] < '0' || field[ i ] > '9' ) {
+            return( -1 );
+        }
+        digits[ i ] = field[ i ] - '0';
+    }
+    int32_t time = ( ( ( digits[ 0 ] * 10 + digits[ 1 ] ) * 60 + digits[ 2 ] * 10 + digits[ 3 ] ) * 60 + digits[ 4 ] * 10 + digits[ 5 ] ) * 1000;
+    if ( field[ 6 ] == '.' ) {
+        int32_t scale = 100;
+        for( const char *c = field + 7 ; *c >= '0' && *c <= '9' && scale ; c++, scale /= 10 ) {
+            time += ( *c - '0' ) * scale;
+        }
+    }
+    return( time );
+}
+
+static void nmea_copy( char *dst, size_t size, const char *field ) {
+    size_t len = strlen( field );
+
+    if ( len >= size ) {
+        len = size - 1;
+    }
+    memcpy( dst, field, len );
+    dst[ len ] = '\0';
+}
+
+static void nmea_parse_rmc( char **f, nmea_rmc_t *rmc ) {
+    rmc->time = nmea_time( f[ 1 ] );
+    rmc->valid = f[ 2 ][ 0 ] == 'A';
+    rmc->lat = nmea_coord( f[ 3 ], f[ 4 ] );
+    rmc->lon = nmea_coord( f[ 5 ], f[ 6 ] );
+    rmc->speed = nmea_float( f[ 7 ] );
+    rmc->course = nmea_float( f[ 8 ] );
+    int32_t date = strlen( f[ 9 ] ) == 6 ? nmea_int( f[ 9 ] ) : -1;
+    rmc->day = date < 0 ? -1 : date / 10000;
+    rmc->month = date < 0 ? -1 : date / 100 % 100;
+    rmc->year = date < 0 ? -1 : ( date % 100 < 80 ? 2000 : 1900 ) + date % 100;
+    rmc->variation = nmea_float( f[ 10 ] );
+    if ( f[ 11 ][ 0 ] == 'W' ) {
+        rmc->variation = -rmc->variation;
+    }
+}
+
+static void nmea_parse_gga( char **f, nmea_gga_t *gga ) {
+    gga->time = nmea_time( f[ 1 ] );
+    gga->lat = nmea_coord( f[ 2 ], f[ 3 ] );
+    gga->lon = nmea_coord( f[ 4 ], f[ 5 ] );
+    gga->quality = nmea_int( f[ 6 ] );
+    gga->satellites = nmea_int( f[ 7 ] );
+    gga->hdop = nmea_float( f[ 8 ] );
+    gga->altitude = nmea_float( f[ 9 ] );
+    gga->geoid = nmea_float( f[ 11 ] );
+}
+
+static void nmea_parse_vtg( char **f, nmea_vtg_t *vtg ) {
+    vtg->course = nmea_float( f[ 1 ] );
+    vtg->course_magnetic = nmea_float( f[ 3 ] );
+    vtg->speed = nmea_float( f[ 5 ] );
+    vtg->speed_kmh = nmea_float( f[ 7 ] );
+}
+
+static void nmea_parse_gsv( char **f, uint32_t count, nmea_gsv_t *gsv ) {
+    gsv->messages = nmea_int( f[ 1 ] );
+    gsv->message = nmea_int( f[ 2 ] );
+    gsv->sats_in_view = nmea_int( f[ 3 ] );
+    gsv->count = 0;
+    for( uint32_t i = 4 ; i < count && gsv->count < NMEA_GSV_SATS ; i += 4 ) {
+        if ( !f[ i ][ 0 ] ) {
+            break;
+        }
+        gsv->sat[ gsv->count ].prn = nmea_int( f[ i ] );
+        gsv->sat[ gsv->count ].elevation = nmea_int( f[ i + 1 ] );
+        gsv->sat[ gsv->count ].azimuth = nmea_int( f[ i + 2 ] );
+        gsv->sat[ gsv->count ].snr = nmea_int( f[ i + 3 ] );
+        gsv->count++;
+    }
+}
+
+static void nmea_parse_rmb( char **f, nmea_rmb_t *rmb ) {
+    rmb->valid = f[ 1 ][ 0 ] == 'A';
+    rmb->xte = nmea_float( f[ 2 ] );
+    rmb->steer = f[ 3 ][ 0 ];
+    nmea_copy( rmb->origin, sizeof( rmb->origin ), f[ 4 ] );
+    nmea_copy( rmb->dest, sizeof( rmb->dest ), f[ 5 ] );
+    rmb->dest_lat = nmea_coord( f[ 6 ], f[ 7 ] );
+    rmb->dest_lon = nmea_coord( f[ 8 ], f[ 9 ] );
+    rmb->range = nmea_float( f[ 10 ] );
+    rmb->bearing = nmea_float( f[ 11 ] );
+    rmb->velocity = nmea_float( f[ 12 ] );
+    rmb->arrived = f[ 13 ][ 0 ] == 'A';
+}
+
+static void nmea_parse_apb( char **f, nmea_apb_t *apb ) {
+    apb->valid = f[ 1 ][ 0 ] == 'A' && f[ 2 ][ 0 ] == 'A';
+    apb->xte = nmea_float( f[ 3 ] );
+    apb->steer = f[ 4 ][ 0 ];
+    apb->xte_unit = f[ 5 ][ 0 ];
+    apb->arrival_circle = f[ 6 ][ 0 ] == 'A';
+    apb->perpendicular = f[ 7 ][ 0 ] == 'A';
+    apb->bearing_origin = nmea_float( f[ 8 ] );
+    apb->bearing_origin_magnetic = f[ 9 ][ 0 ] == 'M';
+    nmea_copy( apb->dest, sizeof( apb->dest ), f[ 10 ] );
+    apb->bearing = nmea_float( f[ 11 ] );
+    apb->bearing_magnetic = f[ 12 ][ 0 ] == 'M';
+    apb->heading = nmea_float( f[ 13 ] );
+    apb->heading_magnetic = f[ 14 ][ 0 ] == 'M';
+}
+
+static void nmea_parse_mwv( char **f, nmea_mwv_t *mwv ) {
+    mwv->angle = nmea_float( f[ 1 ] );
+    mwv->relative = f[ 2 ][ 0 ] == 'R';
+    mwv->speed = nmea_float( f[ 3 ] );
+    mwv->unit = f[ 4 ][ 0 ];
+    mwv->valid = f[ 5 ][ 0 ] == 'A';
+}
+
+nmea_type_t nmea_parse( const char *sentence, size_t len, nmea_sentence_t *out ) {
+    char buf[ NMEA_SENTENCE_SIZE ];
+    char *fields[ NMEA_FIELDS ];
+
+    if ( !sentence || !out ) {
+        return( NMEA_INVALID );
+    }
+    out->type = NMEA_INVALID;
+    out->talker[ 0 ] = '\0';
+
+    len = nmea_trim( sentence, len );
+    if ( len >= sizeof( buf ) || !nmea_checksum( sentence, len ) ) {
+        return( NMEA_INVALID );
+    }
+    /**
+     * split a copy, missing trailing fields read as empty
+     */
+    memcpy( buf, sentence, len );
+    buf[ len ] = '\0';
+    uint32_t count = nmea_split( buf, fields, NMEA_FIELDS );
+    for( uint32_t i = count ; i < NMEA_FIELDS ; i++ ) {
+        fields[ i ] = nmea_empty;
+    }
+    /**
+     * address is talker and type, proprietary sentences start with 'P'
+     */
+    const char *address = fields[ 0 ];
+    size_t address_len = strlen( address );
+    out->type = NMEA_UNKNOWN;
+    if ( address_len != 5 || address[ 0 ] == 'P' ) {
+        return( NMEA_UNKNOWN );
+    }
+    out->talker[ 0 ] = address[ 0 ];
+    out->talker[ 1 ] = address[ 1 ];
+    out->talker[ 2 ] = '\0';
+
+    int type;
+    for( type = NMEA_RMC ; type < NMEA_NUM ; type++ ) {
+        if ( address[ 2 ] == nmea_type_name[ type ][ 0 ] && address[ 3 ] == nmea_type_name[ type ][ 1 ] && address[ 4 ] == nmea_type_name[ type ][ 2 ] ) {
+            break;
+        }
+    }
+    switch( type ) {
+        case NMEA_RMC:  nmea_parse_rmc( fields, &out->rmc );
+                        break;
+        case NMEA_GGA:  nmea_parse_gga( fields, &out->gga );
+                        break;
+        case NMEA_VTG:  nmea_parse_vtg( fields, &out->vtg );
+                        break;
+        case NMEA_GSV:  nmea_parse_gsv( fields, count, &out->gsv );
+                        break;
+        case NMEA_RMB:  nmea_parse_rmb( fields, &out->rmb );
+                        break;
+        case NMEA_APB:  nmea_parse_apb( fields, &out->apb );
+                        break;
+        case NMEA_MWV:  nmea_parse_mwv( fields, &out->mwv );
+                        break;
+        default:        return( NMEA_UNKNOWN );
+    }
+    out->type = (nmea_type_t)type;
+    return( out->type );
+}
+
+#ifdef NATIVE_64BIT
+static uint64_t nmea_bench_now( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000 );
+}
+
+void nmea_bench( const char *path ) {
+    FILE *file = fopen( path, "rb" );
+    if ( !file ) {
+        NMEA_ERROR_LOG("can't open bench log %s", path );
+        return;
+    }
+    fseek( file, 0, SEEK_END );
+    long size = ftell( file );
+    fseek( file, 0, SEEK_SET );
+    char *data = (char*)MALLOC( size + 1 );
+    if ( !data || fread( data, 1, size, file ) != (size_t)size ) {
+        NMEA_ERROR_LOG("can't read bench log %s", path );
+        free( data );
+        fclose( file );
+        return;
+    }
+    fclose( file );
+    data[ size ] = '\0';
+    /**
+     * parse line by line, sum up some fields that the compiler can't drop the parser
+     */
+    uint32_t types[ NMEA_NUM ];
+    uint32_t lines = 0;
+    double sum = 0;
+    uint64_t time = 0;
+
+    for( int round = 0 ; round < NMEA_BENCH_ROUNDS ; round++ ) {
+        memset( types, 0, sizeof( types ) );
+        lines = 0;
+        sum = 0;
+        uint64_t start = nmea_bench_now();
+        for( char *line = data ; *line ; ) {
+            char *end = strchr( line, '\n' );
+            size_t len = end ? end - line : strlen( line );
+            nmea_sentence_t sentence;
+
+            switch( nmea_parse( line, len, &sentence ) ) {
+                case NMEA_RMC:  if ( sentence.rmc.valid ) sum += sentence.rmc.lat + sentence.rmc.speed;
+                                break;
+                case NMEA_GGA:  sum += sentence.gga.satellites;
+                                break;
+                case NMEA_RMB:  sum += sentence.rmb.range;
+                                break;
+                case NMEA_APB:  sum += sentence.apb.heading;
+                                break;
+                default:        break;
+            }
+            types[ sentence.type ]++;
+            lines++;
+            line += end ? len + 1 : len;
+        }
+        time += nmea_bench_now() - start;
+    }
+    if ( !time ) {
+        time = 1;
+    }
+
+    NMEA_INFO_LOG("nmea bench %s: %u lines, %ld bytes, %.1fns per sentence, %.1f MB/s, %.0f sentences/s (sum %.3f)",
+                    path, lines, size,
+                    time * 1000.0 / ( (double)lines * NMEA_BENCH_ROUNDS ),
+                    (double)size * NMEA_BENCH_ROUNDS / time,
+                    (double)lines * NMEA_BENCH_ROUNDS * 1000000.0 / time,
+                    sum );
+    for( int type = 0 ; type < NMEA_NUM ; type++ ) {
+        if ( types[ type ] ) {
+            NMEA_INFO_LOG("  %s: %u", nmea_type_name[ type ], types[ type ] );
+        }
+    }
+    free( data );
+}
+#else
+void nmea_bench( const char *path ) {
+}
+#endif
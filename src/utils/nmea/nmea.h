@@ -0,0 +1,204 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _NMEA_H
+    #define _NMEA_H
+
+    #include <stdint.h>
+    #include <stddef.h>
+
+    #define NMEA_INFO_LOG                   log_i
+    #define NMEA_LOG                        log_d
+    #define NMEA_ERROR_LOG                  log_e
+
+    #define NMEA_SENTENCE_SIZE              128                 /** @brief max sentence length, NMEA says 82, vendor sentences are longer */
+    #define NMEA_FIELDS                     24                  /** @brief max fields per sentence, GSV has 20 */
+    #define NMEA_ID_SIZE                    16                  /** @brief max waypoint id length */
+    #define NMEA_GSV_SATS                   4                   /** @brief satellites per GSV sentence */
+    #define NMEA_BENCH_ENV                  "HEDGE_NMEA_BENCH"  /** @brief env var with a NMEA log for the native parser bench */
+    #define NMEA_BENCH_ROUNDS               5                   /** @brief parse rounds over the bench log */
+    /**
+     * @brief sentence types, all talkers are accepted
+     */
+    typedef enum {
+        NMEA_INVALID = 0,                       /** @brief no '$', too long or a wrong checksum */
+        NMEA_UNKNOWN,                           /** @brief valid but not supported sentence */
+        NMEA_RMC,                               /** @brief recommended minimum navigation data */
+        NMEA_GGA,                               /** @brief fix data */
+        NMEA_VTG,                               /** @brief course and speed over ground */
+        NMEA_GSV,                               /** @brief satellites in view */
+        NMEA_RMB,                               /** @brief recommended minimum navigation to a waypoint */
+        NMEA_APB,                               /** @brief autopilot sentence B */
+        NMEA_MWV,                               /** @brief wind speed and angle */
+        NMEA_NUM
+    } nmea_type_t;
+    /**
+     * numeric fields are NAN if empty, integer fields -1
+     */
+    /**
+     * @brief RMC sentence
+     */
+    typedef struct {
+        int32_t time;                           /** @brief utc time in ms since midnight */
+        bool valid;                             /** @brief status 'A' */
+        double lat;                             /** @brief latitude in degree, south is negative */
+        double lon;                             /** @brief longitude in degree, west is negative */
+        double speed;                           /** @brief speed over ground in knots */
+        double course;                          /** @brief course over ground in degree true */
+        int32_t day;                            /** @brief day of month */
+        int32_t month;                          /** @brief month */
+        int32_t year;                           /** @brief year, four digits */
+        double variation;                       /** @brief magnetic variation in degree, west is negative */
+    } nmea_rmc_t;
+    /**
+     * @brief GGA sentence
+     */
+    typedef struct {
+        int32_t time;                           /** @brief utc time in ms since midnight */
+        double lat;                             /** @brief latitude in degree, south is negative */
+        double lon;                             /** @brief longitude in degree, west is negative */
+        int32_t quality;                        /** @brief fix quality, 0 is no fix */
+        int32_t satellites;                     /** @brief satellites in use */
+        double hdop;                            /** @brief horizontal dilution of precision */
+        double altitude;                        /** @brief altitude above mean sea level in m */
+        double geoid;                           /** @brief geoid separation in m */
+    } nmea_gga_t;
+    /**
+     * @brief VTG sentence
+     */
+    typedef struct {
+        double course;                          /** @brief course over ground in degree true */
+        double course_magnetic;                 /** @brief course over ground in degree magnetic */
+        double speed;                           /** @brief speed over ground in knots */
+        double speed_kmh;                       /** @brief speed over ground in km/h */
+    } nmea_vtg_t;
+    /**
+     * @brief GSV sentence, one of a group
+     */
+    typedef struct {
+        int32_t messages;                       /** @brief messages in the group */
+        int32_t message;                        /** @brief message number, starts at 1 */
+        int32_t sats_in_view;                   /** @brief satellites in view */
+        int32_t count;                          /** @brief satellites in this message */
+        struct {
+            int32_t prn;                        /** @brief satellite id */
+            int32_t elevation;                  /** @brief elevation in degree */
+            int32_t azimuth;                    /** @brief azimuth in degree */
+            int32_t snr;                        /** @brief snr in dB, -1 if not tracked */
+        } sat[ NMEA_GSV_SATS ];
+    } nmea_gsv_t;
+    /**
+     * @brief RMB sentence
+     */
+    typedef struct {
+        bool valid;                             /** @brief status 'A' */
+        double xte;                             /** @brief cross track error in nm */
+        char steer;                             /** @brief 'L' or 'R' to correct */
+        char origin[ NMEA_ID_SIZE ];            /** @brief origin waypoint id */
+        char dest[ NMEA_ID_SIZE ];              /** @brief destination waypoint id */
+        double dest_lat;                        /** @brief destination latitude in degree */
+        double dest_lon;                        /** @brief destination longitude in degree */
+        double range;                           /** @brief range to destination in nm */
+        double bearing;                         /** @brief bearing to destination in degree true */
+        double velocity;                        /** @brief closing velocity in knots */
+        bool arrived;                           /** @brief arrival status 'A' */
+    } nmea_rmb_t;
+    /**
+     * @brief APB sentence
+     */
+    typedef struct {
+        bool valid;                             /** @brief both status fields 'A' */
+        double xte;                             /** @brief cross track error */
+        char steer;                             /** @brief 'L' or 'R' to correct */
+        char xte_unit;                          /** @brief cross track error unit, 'N' for nm */
+        bool arrival_circle;                    /** @brief arrival circle entered */
+        bool perpendicular;                     /** @brief perpendicular passed at waypoint */
+        double bearing_origin;                  /** @brief bearing origin to destination in degree */
+        bool bearing_origin_magnetic;           /** @brief bearing_origin is magnetic */
+        char dest[ NMEA_ID_SIZE ];              /** @brief destination waypoint id */
+        double bearing;                         /** @brief bearing present position to destination in degree */
+        bool bearing_magnetic;                  /** @brief bearing is magnetic */
+        double heading;                         /** @brief heading to steer in degree */
+        bool heading_magnetic;                  /** @brief heading is magnetic */
+    } nmea_apb_t;
+    /**
+     * @brief MWV sentence
+     */
+    typedef struct {
+        double angle;                           /** @brief wind angle in degree */
+        bool relative;                          /** @brief 'R' relative, else true */
+        double speed;                           /** @brief wind speed */
+        char unit;                              /** @brief 'K' km/h, 'M' m/s, 'N' knots */
+        bool valid;                             /** @brief status 'A' */
+    } nmea_mwv_t;
+    /**
+     * @brief a parsed sentence
+     */
+    typedef struct {
+        nmea_type_t type;                       /** @brief sentence type, selects the union member */
+        char talker[ 3 ];                       /** @brief talker id, e.g. "GP" */
+        union {
+            nmea_rmc_t rmc;
+            nmea_gga_t gga;
+            nmea_vtg_t vtg;
+            nmea_gsv_t gsv;
+            nmea_rmb_t rmb;
+            nmea_apb_t apb;
+            nmea_mwv_t mwv;
+        };
+    } nmea_sentence_t;
+    /**
+     * @brief verify the checksum of a sentence
+     *
+     * @param   sentence    pointer to the sentence, starts with '$', line end is ignored
+     * @param   len         sentence length
+     *
+     * @return  true if "*hh" matches the xor between '$' and '*'
+     */
+    bool nmea_checksum( const char *sentence, size_t len );
+    /**
+     * @brief split a sentence in place into fields, ',' and '*' become '\0'
+     *
+     * @param   sentence    pointer to a writable sentence, starts with '$'
+     * @param   fields      pointer to a field pointer array, field 0 is the address, e.g. "GPRMC"
+     * @param   max         field pointer array size
+     *
+     * @return  number of fields
+     */
+    uint32_t nmea_split( char *sentence, char **fields, uint32_t max );
+    /**
+     * @brief verify and parse a sentence without heap allocation
+     *
+     * @param   sentence    pointer to the sentence, starts with '$', line end is ignored
+     * @param   len         sentence length
+     * @param   out         pointer to a nmea_sentence_t to fill
+     *
+     * @return  sentence type, NMEA_INVALID or NMEA_UNKNOWN
+     */
+    nmea_type_t nmea_parse( const char *sentence, size_t len, nmea_sentence_t *out );
+    /**
+     * @brief parse every line of a NMEA log and log the throughput, native only
+     *
+     * @param   path        NMEA log file
+     */
+    void nmea_bench( const char *path );
+
+#endif // _NMEA_H
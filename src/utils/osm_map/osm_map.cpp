@@ -22,8 +22,10 @@
 #include "config.h"
 
 #include "osm_map.h"
+#include "osm_map_prefetch.h"
 #include "utils/alloc.h"
 #include "utils/uri_load/uri_load.h"
+#include "utils/uri_load/uri_load_sched.h"
 
 #ifdef NATIVE_64BIT
     #include "utils/logging.h"
@@ -58,8 +60,14 @@ uint32_t osm_map_lat2tiley(double lat, uint32_t z);
 double osm_map_tilex2long(int x, uint32_t z);
 double osm_map_tiley2lat(int y, uint32_t z);
 osm_location_t *osm_map_update_tile_image( osm_location_t *osm_location );
-uri_load_dsc_t *osm_map_get_cache_tile_image( osm_location_t *osm_location );
+uri_load_dsc_t *osm_map_get_cache_tile_image( osm_location_t *osm_location, uri_load_prio_t prio );
+static uri_load_dsc_t *osm_map_get_cache_tile( osm_location_t *osm_location, uint32_t zoom, uint32_t x, uint32_t y, uri_load_prio_t prio, osm_map_cache_key_t *pin );
+static uri_load_dsc_t *osm_map_put_cache_tile( osm_location_t *osm_location, const osm_map_cache_key_t *key, uri_load_dsc_t *uri_load_dsc );
 void osm_map_gen_url( osm_location_t *osm_location );
+static void osm_map_gen_tile_url( const char *tile_server, uint32_t zoom, uint32_t x, uint32_t y, char *url, size_t size );
+static void osm_map_set_default_tile_server( osm_location_t *osm_location );
+static bool osm_map_wrap_tile( uint32_t zoom, int32_t *x, int32_t y );
+static void osm_map_get_store_ns( osm_location_t *osm_location, char *ns, size_t size );
 
 osm_location_t *osm_map_create_location_obj( void ) {
     /**
@@ -95,6 +103,7 @@ osm_location_t *osm_map_create_location_obj( void ) {
         osm_location->tile_server_source_update = false;    
         osm_location->tile_server = NULL;
         osm_location->current_tile_url = NULL;
+        *osm_location->tile_store_ns = '\0';
         osm_location->osm_map_data.header.always_zero = 0;
         osm_location->osm_map_data.header.cf = LV_IMG_CF_RAW_ALPHA;
         osm_location->osm_map_data.header.w = 256;
@@ -102,11 +111,7 @@ osm_location_t *osm_map_create_location_obj( void ) {
         osm_location->osm_map_data.data = NULL;
         osm_location->osm_map_data.data_size = 0;
         osm_location->load_ahead = false;
-        osm_location->cache_size = 0;
-        osm_location->cached_fies = 0;
-        for( int i = 0 ; i < DEFAULT_OSM_CACHE_SIZE ; i++ ) {
-            osm_location->uri_load_dsc[ i ] = NULL;
-        }
+        osm_map_cache_init( &osm_location->cache );
 #ifndef NATIVE_64BIT
         osm_location->xSemaphoreMutex = xSemaphoreCreateMutex();;
 #endif
@@ -472,7 +477,7 @@ osm_location_t *osm_map_update_tile_image( osm_location_t *osm_location ) {
     /**
      * download file into RAM
      */
-    uri_load_dsc = osm_map_get_cache_tile_image( osm_location );
+    uri_load_dsc = osm_map_get_cache_tile_image( osm_location, URI_LOAD_PRIO_VISIBLE );
     /**
      * enter critical section
      */
@@ -504,9 +509,6 @@ osm_location_t *osm_map_update_tile_image( osm_location_t *osm_location ) {
 }
 
 bool osm_map_load_tiles_ahead( osm_location_t *osm_location ) {
-    static uint32_t tilex = 0, tiley = 0;
-    static uint32_t load_ahead_progress = 0;
-    static bool load_ahead_in_progress = false;
     /**
      * check if osm_location set
      */
@@ -517,68 +519,24 @@ bool osm_map_load_tiles_ahead( osm_location_t *osm_location ) {
      * enter critical section
      */
     osm_map_take( osm_location );
-    if ( osm_location->load_ahead ) {
-        /**
-         * check if viewed tile has change
-         */
-        if ( tilex != osm_location->tilex || tiley != osm_location->tiley ) {
-            tilex = osm_location->tilex;
-            tiley = osm_location->tiley;
-            load_ahead_in_progress = true;
-            load_ahead_progress = 0;
-            OSM_MAP_LOG("start load 4 tiles ahead");
-        }
-        /**
-         * if a load ahead need?
-         */
-        if ( load_ahead_in_progress ) {
-            switch( load_ahead_progress ) {
-                case 0:
-                    osm_location->tiley = tiley;
-                    osm_location->tilex = tilex - 1;
-                    break;
-                case 1:
-                    osm_location->tiley = tiley;
-                    osm_location->tilex = tilex + 1;
-                    break;
-                case 2:
-                    osm_location->tilex = tilex;
-                    osm_location->tiley = tiley - 1;
-                    break;
-                case 3:
-                    osm_location->tilex = tilex;
-                    osm_location->tiley = tiley + 1;
-                    break;
-                default:
-                    load_ahead_in_progress = false;
-            }
-            if ( load_ahead_in_progress ) {
-                load_ahead_progress++;
-                    /**
-                     * leave critical section
-                     */
-                    osm_map_give( osm_location );
-                    osm_map_get_cache_tile_image( osm_location );
-                    /**
-                     * enter critical section
-                     */
-                    osm_map_take( osm_location );
-            }
-            osm_location->tilex = tilex;
-            osm_location->tiley = tiley;
-        }
-    }
+    bool load_ahead = osm_location->load_ahead;
     /**
      * leave critical section
      */
     osm_map_give( osm_location );
-    return( load_ahead_in_progress );
+    /**
+     * the prefetch plans the tiles from the motion and loads one per step
+     */
+    if ( !load_ahead ) {
+        return( false );
+    }
+    return( osm_map_prefetch_step( osm_location ) );
 }
 
 uint32_t osm_map_get_used_cache_size( osm_location_t *osm_location ) {
     uint32_t cache_size = 0;
     if ( osm_location )
-        cache_size = osm_location->cache_size;
+        cache_size = osm_location->cache.stats.bytes;
     
     return( cache_size );
 }
@@ -586,11 +544,20 @@ uint32_t osm_map_get_used_cache_size( osm_location_t *osm_location ) {
 uint32_t osm_map_get_cache_files( osm_location_t *osm_location ) {
     uint32_t cached_file = 0;
     if ( osm_location )
-        cached_file = osm_location->cached_fies;
+        cached_file = osm_location->cache.stats.entries;
     
     return( cached_file );
 }
 
+osm_map_cache_stats_t *osm_map_get_cache_stats( osm_location_t *osm_location ) {
+    osm_map_cache_stats_t *stats = NULL;
+
+    if ( osm_location )
+        stats = &osm_location->cache.stats;
+
+    return( stats );
+}
+
 bool osm_map_get_load_ahead( osm_location_t *osm_location ) {
     bool load_ahead = false;
     
@@ -624,8 +591,6 @@ char *osm_map_get_current_tile_uri( osm_location_t *osm_location ) {
 }
 
 void osm_map_clear_cache( osm_location_t *osm_location ) {
-    uint32_t cache_size = 0;
-    uint32_t cache_files = 0;
     /**
      * check if osm_location set
      */
@@ -640,37 +605,22 @@ void osm_map_clear_cache( osm_location_t *osm_location ) {
      * clear cache
      * leave the current used tile image in memory
      */
-    for( int i = 0 ; i < DEFAULT_OSM_CACHE_SIZE ; i++ ) {
-        if ( osm_location->uri_load_dsc[ i ] ) {
-            if ( osm_location->uri_load_dsc[ i ]->data != osm_location->osm_map_data.data ) {
-                uri_load_free_all( osm_location->uri_load_dsc[ i ] );
-                osm_location->uri_load_dsc[ i ] = NULL;
-            }
-        }
-    }
+    osm_map_cache_clear( &osm_location->cache, osm_location->osm_map_data.data );
     /**
-     * get cache size
+     * and the mbtiles statement and page cache
      */
-    for( int i = 0 ; i < DEFAULT_OSM_CACHE_SIZE ; i++ ) {
-        if ( osm_location->uri_load_dsc[ i ] ) {
-            cache_size += osm_location->uri_load_dsc[ i ]->size;
-            cache_files++;
-        }
-    }
-    osm_location->cache_size = cache_size;
-    osm_location->cached_fies = cache_files;
+    osm_map_mbtiles_close();
     /**
      * leave critical section
      */
     osm_map_give( osm_location );
+    /**
+     * planned tiles are gone or from the old tile server
+     */
+    osm_map_prefetch_reset();
 }
 
-uri_load_dsc_t *osm_map_get_cache_tile_image( osm_location_t *osm_location ) {
-    size_t tile = -1;
-    size_t cache_size = 0;
-    size_t cache_file = 0;
-    uint64_t timestamp = millis();
-    uri_load_dsc_t *uri_load_dsc = NULL;
+uri_load_dsc_t *osm_map_get_cache_tile_image( osm_location_t *osm_location, uri_load_prio_t prio ) {
     /**
      * check if osm_location set
      */
@@ -681,28 +631,241 @@ uri_load_dsc_t *osm_map_get_cache_tile_image( osm_location_t *osm_location ) {
      * generate tile image utl/uri
      */
     osm_map_gen_url( osm_location );
+
+    return( osm_map_get_cache_tile( osm_location, osm_location->zoom, osm_location->tilex, osm_location->tiley, prio, NULL ) );
+}
+
+uri_load_dsc_t *osm_map_get_tile( osm_location_t *osm_location, uint32_t zoom, int32_t x, int32_t y, uri_load_prio_t prio, osm_map_cache_key_t *pin ) {
+    /**
+     * check if osm_location set and the tile exist
+     */
+    if ( !osm_location || !osm_map_wrap_tile( zoom, &x, y ) ) {
+        return( NULL );
+    }
+    return( osm_map_get_cache_tile( osm_location, zoom, x, y, prio, pin ) );
+}
+
+void osm_map_release_tile( osm_location_t *osm_location, const osm_map_cache_key_t *pin ) {
+    /**
+     * check if osm_location set
+     */
+    if ( !osm_location || !pin ) {
+        return;
+    }
     /**
      * enter critical section
      */
     osm_map_take( osm_location );
+    osm_map_cache_unpin( &osm_location->cache, pin );
     /**
-     * check if tile image exist
+     * leave critical section
+     */
+    osm_map_give( osm_location );
+}
+
+bool osm_map_is_tile_cached( osm_location_t *osm_location, uint32_t zoom, int32_t x, int32_t y ) {
+    bool cached = false;
+    /**
+     * check if osm_location set and the tile exist
+     */
+    if ( !osm_location || !osm_map_wrap_tile( zoom, &x, y ) ) {
+        return( false );
+    }
+    /**
+     * enter critical section
+     */
+    osm_map_take( osm_location );
+    osm_map_set_default_tile_server( osm_location );
+    osm_map_cache_key_t key = osm_map_cache_key( osm_location->tile_server, zoom, x, y );
+    cached = osm_map_cache_peek( &osm_location->cache, &key ) != NULL;
+    /**
+     * leave critical section
+     */
+    osm_map_give( osm_location );
+    return( cached );
+}
+
+uri_load_dsc_t *osm_map_peek_tile( osm_location_t *osm_location, uint32_t zoom, int32_t x, int32_t y, osm_map_cache_key_t *pin ) {
+    uri_load_dsc_t *uri_load_dsc = NULL;
+    /**
+     * check if osm_location set and the tile exist
+     */
+    if ( !osm_location || !pin || !osm_map_wrap_tile( zoom, &x, y ) ) {
+        return( NULL );
+    }
+    /**
+     * enter critical section
+     */
+    osm_map_take( osm_location );
+    osm_map_set_default_tile_server( osm_location );
+    osm_map_cache_key_t key = osm_map_cache_key( osm_location->tile_server, zoom, x, y );
+    uri_load_dsc = osm_map_cache_peek( &osm_location->cache, &key );
+    if ( uri_load_dsc ) {
+        osm_map_cache_pin( &osm_location->cache, &key );
+        *pin = key;
+    }
+    /**
+     * leave critical section
      */
-    for( int i = 0 ; i < DEFAULT_OSM_CACHE_SIZE ; i++ ) {
-        if ( osm_location->uri_load_dsc[ i ] ) {
-            if ( !strcmp( osm_location->current_tile_url, osm_location->uri_load_dsc[ i ]->uri ) ) {
-                tile = i;
-                break;
+    osm_map_give( osm_location );
+    return( uri_load_dsc );
+}
+
+uri_load_job_t *osm_map_request_tile( osm_location_t *osm_location, uint32_t zoom, int32_t x, int32_t y, uri_load_prio_t prio ) {
+    uri_load_job_t *job = NULL;
+    /**
+     * check if osm_location set and the tile exist
+     */
+    if ( !osm_location || !osm_map_wrap_tile( zoom, &x, y ) ) {
+        return( NULL );
+    }
+    /**
+     * enter critical section
+     */
+    osm_map_take( osm_location );
+    osm_map_set_default_tile_server( osm_location );
+    /**
+     * cached, stored and mbtiles tiles need no download
+     */
+    osm_map_cache_key_t key = osm_map_cache_key( osm_location->tile_server, zoom, x, y );
+    char ns[ OSM_MAP_STORE_NS_LEN ] = "";
+    osm_map_get_store_ns( osm_location, ns, sizeof( ns ) );
+    if ( !osm_map_cache_peek( &osm_location->cache, &key ) && !osm_map_mbtiles_is_source( osm_location->tile_server ) && !osm_map_store_contains( ns, zoom, x, y ) ) {
+        char *uri = (char*)MALLOC( MAX_CURRENT_TILE_URL_LEN );
+        if ( uri ) {
+            osm_map_gen_tile_url( osm_location->tile_server, zoom, x, y, uri, MAX_CURRENT_TILE_URL_LEN );
+            if ( *uri ) {
+                job = uri_load_sched_submit( uri, prio );
             }
+            free( uri );
         }
     }
+    /**
+     * leave critical section
+     */
+    osm_map_give( osm_location );
+    return( job );
+}
+
+uri_load_dsc_t *osm_map_collect_tile( osm_location_t *osm_location, uint32_t zoom, int32_t x, int32_t y, uri_load_job_t *job, osm_map_cache_key_t *pin ) {
+    uri_load_dsc_t *uri_load_dsc = NULL;
+    /**
+     * check if osm_location set and the tile exist
+     */
+    if ( !osm_location || !job || !osm_map_wrap_tile( zoom, &x, y ) ) {
+        uri_load_sched_cancel( job );
+        return( NULL );
+    }
+    /**
+     * the job is done, this does not block
+     */
+    uri_load_dsc = uri_load_sched_wait( job );
+    /**
+     * enter critical section
+     */
+    osm_map_take( osm_location );
+    osm_map_set_default_tile_server( osm_location );
+    osm_map_cache_key_t key = osm_map_cache_key( osm_location->tile_server, zoom, x, y );
+    if ( uri_load_dsc ) {
+        char ns[ OSM_MAP_STORE_NS_LEN ] = "";
+        osm_map_get_store_ns( osm_location, ns, sizeof( ns ) );
+        osm_map_store_save( ns, key.zoom, key.x, key.y, uri_load_dsc );
+    }
+    uri_load_dsc = osm_map_put_cache_tile( osm_location, &key, uri_load_dsc );
+    if ( uri_load_dsc && pin ) {
+        osm_map_cache_pin( &osm_location->cache, &key );
+        *pin = key;
+    }
+    /**
+     * leave critical section
+     */
+    osm_map_give( osm_location );
+    return( uri_load_dsc );
+}
+
+/**
+ * @brief put a loaded tile into the cache, call with osm_location taken
+ *
+ * @param osm_location  pointer to the osm_location structure
+ * @param key   tile key
+ * @param uri_load_dsc  loaded tile, owned by the cache afterwards, can be NULL
+ *
+ * @return  pointer to the cached tile or NULL if failed
+ */
+static uri_load_dsc_t *osm_map_put_cache_tile( osm_location_t *osm_location, const osm_map_cache_key_t *key, uri_load_dsc_t *uri_load_dsc ) {
+    if ( !uri_load_dsc ) {
+        return( NULL );
+    }
+    /**
+     * the same tile can be stored by a other task in the meantime
+     */
+    uri_load_dsc_t *stored = osm_map_cache_peek( &osm_location->cache, key );
+    if ( stored ) {
+        OSM_MAP_LOG("tile stored in the meantime: %s", uri_load_dsc->uri );
+        uri_load_free_all( uri_load_dsc );
+        return( stored );
+    }
+    /**
+     * store the tile, the least recently used tiles are evicted
+     * until it fits into the byte budget
+     */
+    if ( !osm_map_cache_put( &osm_location->cache, key, uri_load_dsc, osm_location->osm_map_data.data ) ) {
+        uri_load_free_all( uri_load_dsc );
+        return( NULL );
+    }
+    return( uri_load_dsc );
+}
+
+/**
+ * @brief wrap a tile x around the date line and check the tile y
+ * 
+ * @param zoom  zoom level
+ * @param x     pointer to the tile x, wraped into 0..2^zoom-1
+ * @param y     tile y
+ * 
+ * @return  true if the tile exist
+ */
+static bool osm_map_wrap_tile( uint32_t zoom, int32_t *x, int32_t y ) {
+    int32_t tiles = 1 << zoom;
+
+    if ( y < 0 || y >= tiles ) {
+        return( false );
+    }
+    *x = ( ( *x % tiles ) + tiles ) % tiles;
+
+    return( true );
+}
+
+/**
+ * @brief get a tile from the cache, the tile store or the tile server
+ * 
+ * @param osm_location  pointer to the osm_location structure
+ * @param zoom  zoom level
+ * @param x     tile x
+ * @param y     tile y
+ * @param prio  download priority
+ * @param pin   pointer to a tile key, if set the tile is pinned in the cache
+ * 
+ * @return  pointer to the cached tile or NULL if failed
+ */
+static uri_load_dsc_t *osm_map_get_cache_tile( osm_location_t *osm_location, uint32_t zoom, uint32_t x, uint32_t y, uri_load_prio_t prio, osm_map_cache_key_t *pin ) {
+    uri_load_dsc_t *uri_load_dsc = NULL;
+    osm_map_cache_key_t key;
+    /**
+     * enter critical section
+     */
+    osm_map_take( osm_location );
+    osm_map_set_default_tile_server( osm_location );
+    /**
+     * check if tile image exist
+     */
+    key = osm_map_cache_key( osm_location->tile_server, zoom, x, y );
+    uri_load_dsc = osm_map_cache_get( &osm_location->cache, &key );
     /**
      * check for a cache hit
      */
-    if ( tile != -1 ) {
-        OSM_MAP_LOG("url cache hit: %s", osm_location->uri_load_dsc[ tile ]->uri );
-        uri_load_dsc = osm_location->uri_load_dsc[ tile ];
-        uri_load_dsc->timestamp = millis();
+    if ( uri_load_dsc ) {
+        OSM_MAP_LOG("url cache hit: %s", uri_load_dsc->uri );
     }
     else {
         /**
@@ -713,68 +876,37 @@ uri_load_dsc_t *osm_map_get_cache_tile_image( osm_location_t *osm_location ) {
          * and give semaphore away in the time to download
          * and take it back after that
          */
-        char *uri = (char*)MALLOC( strlen( osm_location->current_tile_url ) + 1 );
+        char ns[ OSM_MAP_STORE_NS_LEN ] = "";
+        char *uri = (char*)MALLOC( MAX_CURRENT_TILE_URL_LEN );
         if ( uri ) {
-            strncpy( uri, osm_location->current_tile_url, strlen( osm_location->current_tile_url ) + 1 );
+            osm_map_gen_tile_url( osm_location->tile_server, zoom, x, y, uri, MAX_CURRENT_TILE_URL_LEN );
+            bool mbtiles = osm_map_mbtiles_is_source( osm_location->tile_server );
+            osm_map_get_store_ns( osm_location, ns, sizeof( ns ) );
             osm_map_give( osm_location );
-            uri_load_dsc = uri_load_to_ram( (const char*)uri );
-            osm_map_take( osm_location );
-            free( uri );
-        }
-        /**
-         * 2nd stage
-         * seek for a free tile cache
-         */
-        tile = -1;
-        for( int i = 0 ; i < DEFAULT_OSM_CACHE_SIZE ; i++ ) {
-            if ( !osm_location->uri_load_dsc[ i ] ) {
-                tile = i;
-                break;
-            }
-        }
-        /**
-         * 3rd stage
-         * if ne free tile, search for the oldest tile
-         */
-        if ( tile == -1 ) {
             /**
-             * search the oldest one
+             * a mbtiles file, or the tile store first and then the network
              */
-            for( int i = 0 ; i < DEFAULT_OSM_CACHE_SIZE ; i++ ) {
-                if ( osm_location->uri_load_dsc[ i ]->timestamp <= timestamp && osm_location->uri_load_dsc[ i ] ) {
-                    timestamp = osm_location->uri_load_dsc[ i ]->timestamp;
-                    tile = i;
-                }
+            if ( !*uri ) {
+                uri_load_dsc = NULL;
             }
-            /**
-             * delete the oldest one
-             */
-            OSM_MAP_LOG("cache full, delete the oldest: %s", osm_location->uri_load_dsc[ tile ]->uri );
-            uri_load_free_all( osm_location->uri_load_dsc[ tile ] );
-            osm_location->uri_load_dsc[ tile ] = NULL;
-        }
-        osm_location->uri_load_dsc[ tile ] = uri_load_dsc;
-#ifdef NATIVE_64BIT
-        OSM_MAP_LOG("use tile cache %ld", tile );
-#else
-        OSM_MAP_LOG("use tile cache %d", tile );
-#endif
-        /**
-         * get cache size
-         */
-        for( int i = 0 ; i < DEFAULT_OSM_CACHE_SIZE ; i++ ) {
-            if ( osm_location->uri_load_dsc[ i ] ) {
-                cache_size += osm_location->uri_load_dsc[ i ]->size;
-                cache_file++;
+            else if ( mbtiles ) {
+                uri_load_dsc = osm_map_mbtiles_load( uri, key.zoom, key.x, key.y, uri );
             }
+            else if ( !( uri_load_dsc = osm_map_store_load( ns, key.zoom, key.x, key.y, uri ) ) ) {
+                uri_load_dsc = uri_load_sched_to_ram( (const char*)uri, prio );
+                osm_map_store_save( ns, key.zoom, key.x, key.y, uri_load_dsc );
+            }
+            osm_map_take( osm_location );
+            free( uri );
         }
-        osm_location->cache_size = cache_size;
-        osm_location->cached_fies = cache_file;
-#ifdef NATIVE_64BIT
-        OSM_MAP_LOG("cached files: %ld, cachesize = %ld bytes", cache_file, cache_size );
-#else
-        OSM_MAP_LOG("cached files: %d, cachesize = %d bytes", cache_file, cache_size );
-#endif
+        uri_load_dsc = osm_map_put_cache_tile( osm_location, &key, uri_load_dsc );
+    }
+    /**
+     * pin the tile while it is on screen
+     */
+    if ( uri_load_dsc && pin ) {
+        osm_map_cache_pin( &osm_location->cache, &key );
+        *pin = key;
     }
     /**
      * leave critical section
@@ -810,17 +942,81 @@ void osm_map_set_tile_server( osm_location_t *osm_location, const char* tile_ser
         OSM_MAP_LOG("osm_location->tile_server: %s", osm_location->tile_server );
     }
     osm_location->tile_server_source_update = true;
+    *osm_location->tile_store_ns = '\0';
+    osm_map_mbtiles_close();
     /**
      * leave critical section
      */
     osm_map_give( osm_location );
+    /**
+     * planned tiles are gone or from the old tile server
+     */
+    osm_map_prefetch_reset();
+}
+
+void osm_map_set_tile_server_name( osm_location_t *osm_location, const char* name ) {
+    /**
+     * check if osm_location set
+     */
+    if ( !osm_location ) {
+        return;
+    }
+    /**
+     * enter critical section
+     */
+    osm_map_take( osm_location );
+    osm_map_store_namespace( osm_location->tile_store_ns, sizeof( osm_location->tile_store_ns ), name );
+    OSM_MAP_LOG("tile store namespace: %s", osm_location->tile_store_ns );
+    /**
+     * leave critical section
+     */
+    osm_map_give( osm_location );
+}
+
+uint32_t osm_map_get_tile_server_hash( osm_location_t *osm_location ) {
+    uint32_t hash = 0;
+    /**
+     * check if osm_location set
+     */
+    if ( !osm_location ) {
+        return( hash );
+    }
+    /**
+     * enter critical section
+     */
+    osm_map_take( osm_location );
+    osm_map_set_default_tile_server( osm_location );
+    hash = osm_map_cache_key( osm_location->tile_server, 0, 0, 0 ).server;
+    /**
+     * leave critical section
+     */
+    osm_map_give( osm_location );
+    return( hash );
+}
+
+/**
+ * @brief get the tile store namespace of the current tile server, call with lock held
+ * 
+ * @param osm_location  pointer to the osm_location structure
+ * @param ns    pointer to a char buffer, empty if the tiles are not stored
+ * @param size  buffer size
+ */
+static void osm_map_get_store_ns( osm_location_t *osm_location, char *ns, size_t size ) {
+    /**
+     * local tiles are not stored again
+     */
+    if ( !osm_location->tile_server || !strncmp( osm_location->tile_server, "file://", 7 ) || osm_map_mbtiles_is_source( osm_location->tile_server ) ) {
+        *ns = '\0';
+    }
+    else if ( *osm_location->tile_store_ns ) {
+        snprintf( ns, size, "%s", osm_location->tile_store_ns );
+    }
+    else {
+        snprintf( ns, size, "%08x", osm_map_cache_key( osm_location->tile_server, 0, 0, 0 ).server );
+    }
 }
 
 void osm_map_gen_url( osm_location_t *osm_location ) {
-    char *tile_server_p = NULL;
-    char *current_tile_url_p = NULL;
-    char temp_str[32] = "";
-    char *temp_str_p = NULL;
     /**
      * check if osm_location set
      */
@@ -834,20 +1030,7 @@ void osm_map_gen_url( osm_location_t *osm_location ) {
     /**
      * is a tile server set?
      */
-    if ( !osm_location->tile_server ) {
-        OSM_MAP_LOG("set default osm tile server");
-        osm_location->tile_server = (char*)MALLOC( sizeof( DEFAULT_OSM_TILE_SERVER ) );
-        if ( !osm_location->tile_server ) {
-            OSM_MAP_ERROR_LOG("osm_location->tile_server: alloc failed");
-            while(1);
-        }
-#ifdef NATIVE_64BIT
-        OSM_MAP_LOG("osm_location->tile_server: alloc %ld bytes at %p", sizeof( DEFAULT_OSM_TILE_SERVER ), osm_location->tile_server );
-#else
-        OSM_MAP_LOG("osm_location->tile_server: alloc %d bytes at %p", sizeof( DEFAULT_OSM_TILE_SERVER ), osm_location->tile_server );
-#endif
-        strcpy( osm_location->tile_server, DEFAULT_OSM_TILE_SERVER );
-    }
+    osm_map_set_default_tile_server( osm_location );
     /**
      * alloc current tile url
      */
@@ -863,49 +1046,85 @@ void osm_map_gen_url( osm_location_t *osm_location ) {
     /**
      * generate current tile url from tile server
      */
-    tile_server_p = osm_location->tile_server;
-    current_tile_url_p = osm_location->current_tile_url;
+    osm_map_gen_tile_url( osm_location->tile_server, osm_location->zoom, osm_location->tilex, osm_location->tiley, osm_location->current_tile_url, MAX_CURRENT_TILE_URL_LEN );
+    OSM_MAP_LOG("tile server: %s -> %s", osm_location->tile_server, osm_location->current_tile_url );
+    /**
+     * leave critical section
+     */
+    osm_map_give( osm_location );
+}
+
+/**
+ * @brief set the default tile server if no one is set, call with lock held
+ * 
+ * @param osm_location  pointer to the osm_location structure
+ */
+static void osm_map_set_default_tile_server( osm_location_t *osm_location ) {
+    if ( osm_location->tile_server ) {
+        return;
+    }
+    OSM_MAP_LOG("set default osm tile server");
+    osm_location->tile_server = (char*)MALLOC( sizeof( DEFAULT_OSM_TILE_SERVER ) );
+    if ( !osm_location->tile_server ) {
+        OSM_MAP_ERROR_LOG("osm_location->tile_server: alloc failed");
+        while(1);
+    }
+#ifdef NATIVE_64BIT
+    OSM_MAP_LOG("osm_location->tile_server: alloc %ld bytes at %p", sizeof( DEFAULT_OSM_TILE_SERVER ), osm_location->tile_server );
+#else
+    OSM_MAP_LOG("osm_location->tile_server: alloc %d bytes at %p", sizeof( DEFAULT_OSM_TILE_SERVER ), osm_location->tile_server );
+#endif
+    strcpy( osm_location->tile_server, DEFAULT_OSM_TILE_SERVER );
+}
+
+/**
+ * @brief generate a tile url from a tile server uri, $z, $x and $y are replaced
+ * 
+ * @param tile_server   tile server uri
+ * @param zoom  zoom level
+ * @param x     tile x
+ * @param y     tile y
+ * @param url   pointer to a char buffer, empty if the url does not fit
+ * @param size  buffer size
+ */
+static void osm_map_gen_tile_url( const char *tile_server, uint32_t zoom, uint32_t x, uint32_t y, char *url, size_t size ) {
+    const char *tile_server_p = tile_server;
+    size_t len = 0;
+    char temp_str[32] = "";
+
+    *url = '\0';
 
     while( *tile_server_p ) {
-        if ( *tile_server_p == '$' ) {
+        if ( *tile_server_p == '$' && *( tile_server_p + 1 ) ) {
             tile_server_p++;
             switch ( *tile_server_p ) {
                 case 'z':
-                    snprintf( temp_str, sizeof( temp_str ), "%d", osm_location->zoom );
+                    snprintf( temp_str, sizeof( temp_str ), "%d", zoom );
                     break;
                 case 'x':
-                    snprintf( temp_str, sizeof( temp_str ), "%d", osm_location->tilex );
+                    snprintf( temp_str, sizeof( temp_str ), "%d", x );
                     break;
                 case 'y':
-                    snprintf( temp_str, sizeof( temp_str ), "%d", osm_location->tiley );
+                    snprintf( temp_str, sizeof( temp_str ), "%d", y );
                     break;
                 default:
                     snprintf( temp_str, sizeof( temp_str ), "$%c", *tile_server_p );
                     break;
             }
-            temp_str_p = temp_str;
-            while( *temp_str_p ) {
-                *current_tile_url_p = *temp_str_p;
-                current_tile_url_p++;
-                temp_str_p++;
-            }
         }
         else {
-            *current_tile_url_p = *tile_server_p;
-            current_tile_url_p++;
+            temp_str[ 0 ] = *tile_server_p;
+            temp_str[ 1 ] = '\0';
         }
         tile_server_p++;
-        *current_tile_url_p = '\0';
-        if ( strlen( osm_location->current_tile_url ) >= MAX_CURRENT_TILE_URL_LEN ) {
-            OSM_MAP_ERROR_LOG("osm_location->current_tile_url: MAX_CURRENT_TILE_URL_LEN reached");
-            *osm_location->current_tile_url = '\0';
-            break;
+
+        size_t temp_len = strlen( temp_str );
+        if ( len + temp_len >= size ) {
+            OSM_MAP_ERROR_LOG("tile url: MAX_CURRENT_TILE_URL_LEN reached");
+            *url = '\0';
+            return;
         }
-        log_d("current url: %s", osm_location->current_tile_url );
+        memcpy( url + len, temp_str, temp_len + 1 );
+        len += temp_len;
     }
-    OSM_MAP_LOG("tile server: %s -> %s", osm_location->tile_server, osm_location->current_tile_url );
-    /**
-     * leave critical section
-     */
-    osm_map_give( osm_location );
-}
\ No newline at end of file
+}
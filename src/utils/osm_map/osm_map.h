@@ -2,6 +2,10 @@
     #define _OSM_HELPER_H
 
     #include "utils/uri_load/uri_load.h"
+    #include "utils/uri_load/uri_load_sched.h"
+    #include "osm_map_cache.h"
+    #include "osm_map_store.h"
+    #include "osm_map_mbtiles.h"
     #ifdef NATIVE_64BIT
         #include "utils/logging.h"
     #else
@@ -12,7 +16,7 @@
     #define OSM_MAP_ERROR_LOG           log_e
 
     #define MAX_CURRENT_TILE_URL_LEN    256
-    #define DEFAULT_OSM_CACHE_SIZE      32
+    #define OSM_MAP_LOAD_AHEAD_TILES    4       /** @brief neighbour tiles loaded ahead */
     #define DEFAULT_OSM_TILE_SERVER     "http://a.tile.openstreetmap.org/$z/$x/$y.png"   /** @brief osm tile map server */
 
     /**
@@ -44,11 +48,10 @@
         bool tile_server_source_update = false;         /** @brief indicates a tile server uri has change */
         char *tile_server = NULL;                       /** @brief the current tile server uri */
         char *current_tile_url = NULL;                  /** @brief the current tile image uri */
+        char tile_store_ns[ OSM_MAP_STORE_NS_LEN ];     /** @brief tile store namespace of the tile server, empty for the server hash */
         bool load_ahead = false;                        /** @brief enable load ahead feature */
-        uint32_t cache_size = 0;
-        uint32_t cached_fies = 0;
         lv_img_dsc_t osm_map_data;                      /** @brief pointer to an lv_img_dsc for lvgl use */
-        uri_load_dsc_t *uri_load_dsc[ DEFAULT_OSM_CACHE_SIZE ];
+        osm_map_cache_t cache;                          /** @brief tile image cache */
 #ifndef NATIVE_64BIT
         SemaphoreHandle_t xSemaphoreMutex;
 #endif
@@ -137,6 +140,21 @@
      * @param tile_server pointer t a tile server uri
      */ 
     void osm_map_set_tile_server( osm_location_t *osm_location, const char* tile_server );
+    /**
+     * @brief set the name of the current tile server, names the tile store namespace
+     * 
+     * @param osm_location  pointer to the osm_location structure
+     * @param name  tile server name from osmtileserver.json, e.g. "OSM Standard"
+     */
+    void osm_map_set_tile_server_name( osm_location_t *osm_location, const char* name );
+    /**
+     * @brief get the hash of the current tile server uri, the same as in the tile cache key
+     * 
+     * @param osm_location  pointer to the osm_location structure
+     * 
+     * @return FNV-1a hash of the tile server uri
+     */
+    uint32_t osm_map_get_tile_server_hash( osm_location_t *osm_location );
     /**
      * @brief navigate the current tile view one step in a direction
      * 
@@ -151,6 +169,75 @@
      */
     void osm_map_center_location( osm_location_t *osm_location );
     bool osm_map_load_tiles_ahead( osm_location_t *osm_location );
+    /**
+     * @brief get a tile image from the cache, the tile store or the tile server, blocks until loaded
+     * 
+     * @param osm_location  pointer to the osm_location structure
+     * @param zoom  zoom level
+     * @param x     tile x, wraps around the date line
+     * @param y     tile y
+     * @param prio  download priority
+     * @param pin   pointer to a tile key, if set the tile is pinned in the cache until osm_map_release_tile()
+     * 
+     * @return pointer to the tile image, NULL if failed or the tile does not exist
+     */
+    uri_load_dsc_t *osm_map_get_tile( osm_location_t *osm_location, uint32_t zoom, int32_t x, int32_t y, uri_load_prio_t prio, osm_map_cache_key_t *pin );
+    /**
+     * @brief release a tile pinned by osm_map_get_tile()
+     * 
+     * @param osm_location  pointer to the osm_location structure
+     * @param pin   pointer to the tile key from osm_map_get_tile()
+     */
+    void osm_map_release_tile( osm_location_t *osm_location, const osm_map_cache_key_t *pin );
+    /**
+     * @brief check if a tile is in the ram cache
+     * 
+     * @param osm_location  pointer to the osm_location structure
+     * @param zoom  zoom level
+     * @param x     tile x, wraps around the date line
+     * @param y     tile y
+     * 
+     * @return true if cached
+     */
+    bool osm_map_is_tile_cached( osm_location_t *osm_location, uint32_t zoom, int32_t x, int32_t y );
+    /**
+     * @brief get a tile from the ram cache only, nothing is loaded
+     * 
+     * @param osm_location  pointer to the osm_location structure
+     * @param zoom  zoom level
+     * @param x     tile x, wraps around the date line
+     * @param y     tile y
+     * @param pin   pointer to a key that pins the tile until osm_map_release_tile(), must be set
+     * 
+     * @return pointer to the tile image, NULL if not cached
+     */
+    uri_load_dsc_t *osm_map_peek_tile( osm_location_t *osm_location, uint32_t zoom, int32_t x, int32_t y, osm_map_cache_key_t *pin );
+    /**
+     * @brief start the download of a tile that is not cached or stored
+     * 
+     * @param osm_location  pointer to the osm_location structure
+     * @param zoom  zoom level
+     * @param x     tile x, wraps around the date line
+     * @param y     tile y
+     * @param prio  download priority
+     * 
+     * @return job handle, release it with uri_load_sched_cancel(), NULL if no download is needed
+     */
+    uri_load_job_t *osm_map_request_tile( osm_location_t *osm_location, uint32_t zoom, int32_t x, int32_t y, uri_load_prio_t prio );
+    /**
+     * @brief take the result of a done osm_map_request_tile() job into the
+     * cache and the tile store, the job handle is released
+     * 
+     * @param osm_location  pointer to the osm_location structure
+     * @param zoom  zoom level
+     * @param x     tile x, wraps around the date line
+     * @param y     tile y
+     * @param job   done job handle from osm_map_request_tile()
+     * @param pin   pointer to a tile key, if set the tile is pinned in the cache until osm_map_release_tile()
+     * 
+     * @return pointer to the tile image, NULL if the download failed
+     */
+    uri_load_dsc_t *osm_map_collect_tile( osm_location_t *osm_location, uint32_t zoom, int32_t x, int32_t y, uri_load_job_t *job, osm_map_cache_key_t *pin );
     /**
      * @brief get the numbers of bytes in the cache
      * 
@@ -167,6 +254,14 @@
      * @return number of cached tile images
      */
     uint32_t osm_map_get_cache_files( osm_location_t *osm_location );
+    /**
+     * @brief get the tile cache statistics
+     * 
+     * @param osm_location  pointer to the osm_location structure
+     * 
+     * @return pointer to a osm_map_cache_stats_t structure, NULL if osm_location not set
+     */
+    osm_map_cache_stats_t *osm_map_get_cache_stats( osm_location_t *osm_location );
     /**
      * @brief get the load ahead config flag
      * 
@@ -0,0 +1,262 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "osm_map_cache.h"
+#include "utils/alloc.h"
+
+#ifdef NATIVE_64BIT
+    #include <string.h>
+    #include "utils/logging.h"
+    #include "utils/millis.h"
+#else
+    #include <Arduino.h>
+#endif
+
+static uint32_t osm_map_cache_hash( const osm_map_cache_key_t *key );
+static osm_map_cache_entry_t *osm_map_cache_find( osm_map_cache_t *cache, const osm_map_cache_key_t *key );
+static void osm_map_cache_lru_unlink( osm_map_cache_t *cache, osm_map_cache_entry_t *entry );
+static void osm_map_cache_lru_push( osm_map_cache_t *cache, osm_map_cache_entry_t *entry );
+static void osm_map_cache_remove( osm_map_cache_t *cache, osm_map_cache_entry_t *entry );
+
+void osm_map_cache_init( osm_map_cache_t *cache ) {
+    for( int i = 0 ; i < OSM_MAP_CACHE_BUCKETS ; i++ ) {
+        cache->bucket[ i ] = NULL;
+    }
+    cache->lru_head = NULL;
+    cache->lru_tail = NULL;
+    cache->stats = osm_map_cache_stats_t();
+    cache->stats.budget = osm_map_cache_get_budget( cache );
+}
+
+osm_map_cache_key_t osm_map_cache_key( const char *tile_server, uint32_t zoom, uint32_t x, uint32_t y ) {
+    osm_map_cache_key_t key;
+    /**
+     * FNV-1a over the tile server uri
+     */
+    key.server = 2166136261u;
+    for( const char *c = tile_server ; c && *c ; c++ ) {
+        key.server = ( key.server ^ (uint8_t)*c ) * 16777619u;
+    }
+    key.zoom = zoom;
+    key.x = x;
+    key.y = y;
+
+    return( key );
+}
+
+static uint32_t osm_map_cache_hash( const osm_map_cache_key_t *key ) {
+    /**
+     * neighbour tiles differ only in the low bits of x/y, mix them over all bits
+     */
+    uint32_t hash = key->server ^ ( key->zoom * 0x9e3779b1u ) ^ ( key->x * 0x85ebca6bu ) ^ ( key->y * 0xc2b2ae35u );
+    hash ^= hash >> 16;
+    hash *= 0x7feb352du;
+    hash ^= hash >> 15;
+
+    return( hash & ( OSM_MAP_CACHE_BUCKETS - 1 ) );
+}
+
+static osm_map_cache_entry_t *osm_map_cache_find( osm_map_cache_t *cache, const osm_map_cache_key_t *key ) {
+    osm_map_cache_entry_t *entry = cache->bucket[ osm_map_cache_hash( key ) ];
+
+    while( entry ) {
+        if ( entry->key.x == key->x && entry->key.y == key->y && entry->key.zoom == key->zoom && entry->key.server == key->server )
+            break;
+        entry = entry->hash_next;
+    }
+    return( entry );
+}
+
+static void osm_map_cache_lru_unlink( osm_map_cache_t *cache, osm_map_cache_entry_t *entry ) {
+    if ( entry->lru_prev )
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        cache->lru_head = entry->lru_next;
+
+    if ( entry->lru_next )
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        cache->lru_tail = entry->lru_prev;
+
+    entry->lru_prev = NULL;
+    entry->lru_next = NULL;
+}
+
+static void osm_map_cache_lru_push( osm_map_cache_t *cache, osm_map_cache_entry_t *entry ) {
+    entry->lru_prev = NULL;
+    entry->lru_next = cache->lru_head;
+    if ( cache->lru_head )
+        cache->lru_head->lru_prev = entry;
+    cache->lru_head = entry;
+    if ( !cache->lru_tail )
+        cache->lru_tail = entry;
+}
+
+static void osm_map_cache_remove( osm_map_cache_t *cache, osm_map_cache_entry_t *entry ) {
+    osm_map_cache_entry_t **link = &cache->bucket[ osm_map_cache_hash( &entry->key ) ];
+    /**
+     * unlink from hash chain and lru list
+     */
+    while( *link && *link != entry ) {
+        link = &(*link)->hash_next;
+    }
+    if ( *link )
+        *link = entry->hash_next;
+    osm_map_cache_lru_unlink( cache, entry );
+
+    cache->stats.entries--;
+    cache->stats.bytes -= entry->uri_load_dsc->size;
+    uri_load_free_all( entry->uri_load_dsc );
+    free( entry );
+}
+
+uri_load_dsc_t *osm_map_cache_get( osm_map_cache_t *cache, const osm_map_cache_key_t *key ) {
+    osm_map_cache_entry_t *entry = osm_map_cache_find( cache, key );
+
+    if ( !entry ) {
+        cache->stats.misses++;
+        return( NULL );
+    }
+    cache->stats.hits++;
+    /**
+     * move to the front of the lru list
+     */
+    if ( entry != cache->lru_head ) {
+        osm_map_cache_lru_unlink( cache, entry );
+        osm_map_cache_lru_push( cache, entry );
+    }
+    entry->uri_load_dsc->timestamp = millis();
+
+    return( entry->uri_load_dsc );
+}
+
+uri_load_dsc_t *osm_map_cache_peek( osm_map_cache_t *cache, const osm_map_cache_key_t *key ) {
+    osm_map_cache_entry_t *entry = osm_map_cache_find( cache, key );
+
+    return( entry ? entry->uri_load_dsc : NULL );
+}
+
+bool osm_map_cache_pin( osm_map_cache_t *cache, const osm_map_cache_key_t *key ) {
+    osm_map_cache_entry_t *entry = osm_map_cache_find( cache, key );
+
+    if ( !entry ) {
+        return( false );
+    }
+    entry->pins++;
+
+    return( true );
+}
+
+void osm_map_cache_unpin( osm_map_cache_t *cache, const osm_map_cache_key_t *key ) {
+    osm_map_cache_entry_t *entry = osm_map_cache_find( cache, key );
+
+    if ( entry && entry->pins ) {
+        entry->pins--;
+    }
+}
+
+uint32_t osm_map_cache_get_budget( osm_map_cache_t *cache ) {
+#ifdef NATIVE_64BIT
+    return( OSM_MAP_CACHE_NATIVE_BUDGET );
+#else
+    /**
+     * the cached tiles are part of the used psram, count them as available
+     */
+    uint32_t free_psram = ESP.getFreePsram();
+    if ( !free_psram ) {
+        return( OSM_MAP_CACHE_NO_PSRAM_BUDGET );
+    }
+    uint32_t budget = ( free_psram + cache->stats.bytes ) / OSM_MAP_CACHE_PSRAM_SHARE;
+
+    if ( budget < OSM_MAP_CACHE_MIN_BUDGET )
+        budget = OSM_MAP_CACHE_MIN_BUDGET;
+    if ( budget > OSM_MAP_CACHE_MAX_BUDGET )
+        budget = OSM_MAP_CACHE_MAX_BUDGET;
+
+    return( budget );
+#endif
+}
+
+bool osm_map_cache_put( osm_map_cache_t *cache, const osm_map_cache_key_t *key, uri_load_dsc_t *uri_load_dsc, const void *keep ) {
+    if ( !uri_load_dsc ) {
+        return( false );
+    }
+    /**
+     * evict from the lru tail until the new tile fits, the tiles on
+     * screen are skipped, their data is still in use by lvgl
+     */
+    cache->stats.budget = osm_map_cache_get_budget( cache );
+    osm_map_cache_entry_t *victim = cache->lru_tail;
+    while( victim && cache->stats.bytes + uri_load_dsc->size > cache->stats.budget ) {
+        osm_map_cache_entry_t *prev = victim->lru_prev;
+        if ( victim->uri_load_dsc->data != keep && !victim->pins ) {
+            OSM_MAP_CACHE_LOG("evict tile %d/%d/%d, %d bytes", victim->key.zoom, victim->key.x, victim->key.y, victim->uri_load_dsc->size );
+            osm_map_cache_remove( cache, victim );
+            cache->stats.evictions++;
+        }
+        victim = prev;
+    }
+#ifndef NATIVE_64BIT
+    /**
+     * low on psram, other users come first
+     */
+    victim = cache->lru_tail;
+    while( victim && ESP.getFreePsram() && ESP.getFreePsram() < OSM_MAP_CACHE_PSRAM_RESERVE ) {
+        osm_map_cache_entry_t *prev = victim->lru_prev;
+        if ( victim->uri_load_dsc->data != keep && !victim->pins ) {
+            osm_map_cache_remove( cache, victim );
+            cache->stats.evictions++;
+        }
+        victim = prev;
+    }
+#endif
+    osm_map_cache_entry_t *entry = (osm_map_cache_entry_t*)MALLOC( sizeof( osm_map_cache_entry_t ) );
+    if ( !entry ) {
+        OSM_MAP_CACHE_ERROR_LOG("cache entry alloc failed");
+        return( false );
+    }
+    uint32_t hash = osm_map_cache_hash( key );
+    entry->key = *key;
+    entry->uri_load_dsc = uri_load_dsc;
+    entry->pins = 0;
+    entry->hash_next = cache->bucket[ hash ];
+    cache->bucket[ hash ] = entry;
+    osm_map_cache_lru_push( cache, entry );
+
+    cache->stats.entries++;
+    cache->stats.bytes += uri_load_dsc->size;
+    OSM_MAP_CACHE_LOG("cached tiles: %d, %d/%d bytes", cache->stats.entries, cache->stats.bytes, cache->stats.budget );
+
+    return( true );
+}
+
+void osm_map_cache_clear( osm_map_cache_t *cache, const void *keep ) {
+    osm_map_cache_entry_t *entry = cache->lru_head;
+
+    while( entry ) {
+        osm_map_cache_entry_t *next = entry->lru_next;
+        if ( entry->uri_load_dsc->data != keep && !entry->pins ) {
+            osm_map_cache_remove( cache, entry );
+        }
+        entry = next;
+    }
+}
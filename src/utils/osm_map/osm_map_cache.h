@@ -0,0 +1,156 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _OSM_MAP_CACHE_H
+    #define _OSM_MAP_CACHE_H
+
+    #include "utils/uri_load/uri_load.h"
+
+    #define OSM_MAP_CACHE_LOG               log_d
+    #define OSM_MAP_CACHE_ERROR_LOG         log_e
+
+    #define OSM_MAP_CACHE_BUCKETS           64                  /** @brief hash buckets, power of two */
+    #define OSM_MAP_CACHE_PSRAM_SHARE       4                   /** @brief max share of the psram for tile images, 1/n */
+    #define OSM_MAP_CACHE_PSRAM_RESERVE     256 * 1024          /** @brief evict down to one tile when free psram falls below */
+    #define OSM_MAP_CACHE_MIN_BUDGET        256 * 1024          /** @brief min byte budget with psram */
+    #define OSM_MAP_CACHE_MAX_BUDGET        2 * 1024 * 1024     /** @brief max byte budget with psram */
+    #define OSM_MAP_CACHE_NO_PSRAM_BUDGET   64 * 1024           /** @brief byte budget without psram */
+    #define OSM_MAP_CACHE_NATIVE_BUDGET     8 * 1024 * 1024     /** @brief byte budget on native */
+    /**
+     * @brief tile cache key, the tile server is hashed, the same tile from a other server is a other tile
+     */
+    typedef struct {
+        uint32_t server = 0;                            /** @brief FNV-1a hash of the tile server uri */
+        uint32_t zoom = 0;                              /** @brief zoom level */
+        uint32_t x = 0;                                 /** @brief tile x */
+        uint32_t y = 0;                                 /** @brief tile y */
+    } osm_map_cache_key_t;
+    /**
+     * @brief tile cache entry, member of a hash chain and the lru list
+     */
+    typedef struct osm_map_cache_entry_t {
+        osm_map_cache_key_t key;                        /** @brief tile key */
+        uri_load_dsc_t *uri_load_dsc = NULL;            /** @brief tile image */
+        uint32_t pins = 0;                              /** @brief pins of tiles on screen, a pinned tile is never evicted */
+        struct osm_map_cache_entry_t *hash_next = NULL; /** @brief next entry in the hash chain */
+        struct osm_map_cache_entry_t *lru_prev = NULL;  /** @brief more recently used entry */
+        struct osm_map_cache_entry_t *lru_next = NULL;  /** @brief less recently used entry */
+    } osm_map_cache_entry_t;
+    /**
+     * @brief tile cache statistics
+     */
+    typedef struct {
+        uint32_t hits = 0;                              /** @brief lookups with a cached tile */
+        uint32_t misses = 0;                            /** @brief lookups without a cached tile */
+        uint32_t evictions = 0;                         /** @brief tiles evicted for the byte budget */
+        uint32_t entries = 0;                           /** @brief cached tiles */
+        uint32_t bytes = 0;                             /** @brief cached bytes */
+        uint32_t budget = 0;                            /** @brief byte budget at the last insert */
+    } osm_map_cache_stats_t;
+    /**
+     * @brief tile cache, not locked, the owner holds his lock
+     */
+    typedef struct {
+        osm_map_cache_entry_t *bucket[ OSM_MAP_CACHE_BUCKETS ];    /** @brief hash buckets */
+        osm_map_cache_entry_t *lru_head = NULL;         /** @brief most recently used entry */
+        osm_map_cache_entry_t *lru_tail = NULL;         /** @brief least recently used entry */
+        osm_map_cache_stats_t stats;                    /** @brief statistics */
+    } osm_map_cache_t;
+    /**
+     * @brief init a empty tile cache
+     *
+     * @param   cache       pointer to the cache
+     */
+    void osm_map_cache_init( osm_map_cache_t *cache );
+    /**
+     * @brief build a tile key
+     *
+     * @param   tile_server tile server uri
+     * @param   zoom        zoom level
+     * @param   x           tile x
+     * @param   y           tile y
+     *
+     * @return  tile key
+     */
+    osm_map_cache_key_t osm_map_cache_key( const char *tile_server, uint32_t zoom, uint32_t x, uint32_t y );
+    /**
+     * @brief look up a tile, counts a hit or miss and marks the tile as most recently used
+     *
+     * @param   cache       pointer to the cache
+     * @param   key         pointer to the tile key
+     *
+     * @return  pointer to the tile image or NULL if not cached
+     */
+    uri_load_dsc_t *osm_map_cache_get( osm_map_cache_t *cache, const osm_map_cache_key_t *key );
+    /**
+     * @brief look up a tile without touching the stats and the lru order
+     *
+     * @param   cache       pointer to the cache
+     * @param   key         pointer to the tile key
+     *
+     * @return  pointer to the tile image or NULL if not cached
+     */
+    uri_load_dsc_t *osm_map_cache_peek( osm_map_cache_t *cache, const osm_map_cache_key_t *key );
+    /**
+     * @brief pin a tile, a pinned tile is skipped by the eviction and osm_map_cache_clear()
+     *
+     * @param   cache       pointer to the cache
+     * @param   key         pointer to the tile key
+     *
+     * @return  true if the tile is cached and pinned
+     */
+    bool osm_map_cache_pin( osm_map_cache_t *cache, const osm_map_cache_key_t *key );
+    /**
+     * @brief release a pin from osm_map_cache_pin()
+     *
+     * @param   cache       pointer to the cache
+     * @param   key         pointer to the tile key
+     */
+    void osm_map_cache_unpin( osm_map_cache_t *cache, const osm_map_cache_key_t *key );
+    /**
+     * @brief insert a tile as most recently used, evicts the least recently used
+     * tiles until the tile fits into the byte budget
+     *
+     * @param   cache       pointer to the cache
+     * @param   key         pointer to the tile key
+     * @param   uri_load_dsc    tile image, owned by the cache on success
+     * @param   keep        image data that is never evicted, e.g. the tile on screen
+     *
+     * @return  true if success, false if failed
+     */
+    bool osm_map_cache_put( osm_map_cache_t *cache, const osm_map_cache_key_t *key, uri_load_dsc_t *uri_load_dsc, const void *keep );
+    /**
+     * @brief free all tiles
+     *
+     * @param   cache       pointer to the cache
+     * @param   keep        image data that is kept, e.g. the tile on screen, pinned tiles are kept too
+     */
+    void osm_map_cache_clear( osm_map_cache_t *cache, const void *keep );
+    /**
+     * @brief get the byte budget for the current free psram
+     *
+     * @param   cache       pointer to the cache
+     *
+     * @return  byte budget
+     */
+    uint32_t osm_map_cache_get_budget( osm_map_cache_t *cache );
+
+#endif // _OSM_MAP_CACHE_H
@@ -0,0 +1,351 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "osm_map_fallback.h"
+#include "gui/png_decoder/lv_png.h"
+#include "utils/alloc.h"
+#include "utils/lock.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef NATIVE_64BIT
+    #include <time.h>
+    #include "utils/logging.h"
+#else
+    #include <Arduino.h>
+    #include <esp_timer.h>
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/semphr.h>
+#endif
+static lock_mutex_t osm_map_fallback_mutex = LOCK_MUTEX_INITIALIZER;   /** @brief guards the last decoded source tile */
+
+/**
+ * the last decoded source tile, a zoom in needs the same parent for up to four
+ * tiles of the view, decode it only once
+ */
+static osm_map_cache_key_t osm_map_fallback_src_key;
+static uint8_t *osm_map_fallback_src = NULL;                        /** @brief RGBA8888 image */
+static osm_map_fallback_stats_t osm_map_fallback_stats;
+/**
+ * provisional tiles are only shown until their download is done, a few
+ * buffers are kept and handed out again instead of one allocation per tile
+ */
+static lv_color_t *osm_map_fallback_buf[ OSM_MAP_FALLBACK_BUFFERS ];    /** @brief true color buffers, NULL if not allocated */
+static bool osm_map_fallback_buf_used[ OSM_MAP_FALLBACK_BUFFERS ];      /** @brief buffer is shown by a tile */
+
+static const uint8_t *osm_map_fallback_decode( uri_load_dsc_t *uri_load_dsc, const osm_map_cache_key_t *key );
+static void osm_map_fallback_scale_up( const uint8_t *src, uint32_t level, uint32_t offset_x, uint32_t offset_y, lv_color_t *dest );
+static void osm_map_fallback_scale_down( const uint8_t *src, uint32_t quadrant_x, uint32_t quadrant_y, lv_color_t *dest );
+static void osm_map_fallback_fill( lv_color_t *dest, uint32_t quadrant_x, uint32_t quadrant_y );
+static lv_color_t *osm_map_fallback_get_buf( void );
+static void osm_map_fallback_put_buf( const void *buf );
+
+static void osm_map_fallback_lock( void ) {
+    lock_mutex_take( &osm_map_fallback_mutex );
+}
+
+static void osm_map_fallback_unlock( void ) {
+    lock_mutex_give( &osm_map_fallback_mutex );
+}
+
+static uint64_t osm_map_fallback_now( void ) {
+#ifdef NATIVE_64BIT
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000 );
+#else
+    return( esp_timer_get_time() );
+#endif
+}
+
+bool osm_map_fallback_create( osm_location_t *osm_location, uint32_t zoom, int32_t x, int32_t y, lv_img_dsc_t *dsc ) {
+    osm_map_cache_key_t pin[ 4 ];
+    uri_load_dsc_t *child[ 4 ];
+    uint32_t children = 0;
+    bool created = false;
+    uint64_t start = osm_map_fallback_now();
+    /**
+     * check if osm_location and dsc set and the tile exist
+     */
+    if ( !osm_location || !dsc || zoom > 30 || y < 0 || y >= ( 1 << zoom ) ) {
+        return( false );
+    }
+    x = ( ( x % ( 1 << zoom ) ) + ( 1 << zoom ) ) % ( 1 << zoom );
+    /**
+     * pin the cached children, all four give a full tile
+     */
+    for( int i = 0 ; i < 4 ; i++ ) {
+        child[ i ] = osm_map_peek_tile( osm_location, zoom + 1, x * 2 + i % 2, y * 2 + i / 2, &pin[ i ] );
+        if ( child[ i ] ) {
+            children++;
+        }
+    }
+
+    osm_map_fallback_lock();
+    lv_color_t *dest = osm_map_fallback_get_buf();
+    /**
+     * a quadrant of the nearest cached parent
+     */
+    if ( dest && children < 4 ) {
+        for( uint32_t level = 1 ; level <= OSM_MAP_FALLBACK_LEVELS && level <= zoom && !created ; level++ ) {
+            osm_map_cache_key_t parent_pin;
+            uri_load_dsc_t *parent = osm_map_peek_tile( osm_location, zoom - level, x >> level, y >> level, &parent_pin );
+            if ( !parent ) {
+                continue;
+            }
+            const uint8_t *src = osm_map_fallback_decode( parent, &parent_pin );
+            if ( src ) {
+                uint32_t span = OSM_MAP_FALLBACK_TILE_SIZE >> level;
+                osm_map_fallback_scale_up( src, level, ( x & ( ( 1 << level ) - 1 ) ) * span, ( y & ( ( 1 << level ) - 1 ) ) * span, dest );
+                osm_map_fallback_stats.parents++;
+                created = true;
+            }
+            osm_map_release_tile( osm_location, &parent_pin );
+        }
+    }
+    /**
+     * a mosaic of the cached children, the missing quadrants are filled
+     */
+    if ( dest && children && !created ) {
+        for( int i = 0 ; i < 4 ; i++ ) {
+            const uint8_t *src = child[ i ] ? osm_map_fallback_decode( child[ i ], &pin[ i ] ) : NULL;
+            if ( src ) {
+                osm_map_fallback_scale_down( src, i % 2, i / 2, dest );
+                created = true;
+            }
+            else {
+                osm_map_fallback_fill( dest, i % 2, i / 2 );
+            }
+        }
+        if ( created ) {
+            osm_map_fallback_stats.mosaics++;
+        }
+    }
+    if ( !created && dest ) {
+        osm_map_fallback_stats.misses++;
+        osm_map_fallback_put_buf( dest );
+    }
+    uint32_t time = osm_map_fallback_now() - start;
+    osm_map_fallback_stats.time += time;
+    if ( time > osm_map_fallback_stats.max_time )
+        osm_map_fallback_stats.max_time = time;
+    osm_map_fallback_unlock();
+
+    for( int i = 0 ; i < 4 ; i++ ) {
+        if ( child[ i ] ) {
+            osm_map_release_tile( osm_location, &pin[ i ] );
+        }
+    }
+    if ( !created ) {
+        return( false );
+    }
+    dsc->header.always_zero = 0;
+    dsc->header.cf = LV_IMG_CF_TRUE_COLOR;
+    dsc->header.w = OSM_MAP_FALLBACK_TILE_SIZE;
+    dsc->header.h = OSM_MAP_FALLBACK_TILE_SIZE;
+    dsc->data = (const uint8_t*)dest;
+    dsc->data_size = OSM_MAP_FALLBACK_TILE_SIZE * OSM_MAP_FALLBACK_TILE_SIZE * sizeof( lv_color_t );
+    OSM_MAP_FALLBACK_LOG("fallback tile %d/%d/%d in %dus", zoom, x, y, time );
+
+    return( true );
+}
+
+void osm_map_fallback_free( lv_img_dsc_t *dsc ) {
+    if ( !dsc || !dsc->data ) {
+        return;
+    }
+    osm_map_fallback_lock();
+    osm_map_fallback_put_buf( dsc->data );
+    osm_map_fallback_unlock();
+    dsc->data = NULL;
+    dsc->data_size = 0;
+}
+
+void osm_map_fallback_flush( void ) {
+    osm_map_fallback_lock();
+    if ( osm_map_fallback_src ) {
+        free( osm_map_fallback_src );
+        osm_map_fallback_src = NULL;
+    }
+    for( int i = 0 ; i < OSM_MAP_FALLBACK_BUFFERS ; i++ ) {
+        if ( osm_map_fallback_buf[ i ] && !osm_map_fallback_buf_used[ i ] ) {
+            free( osm_map_fallback_buf[ i ] );
+            osm_map_fallback_buf[ i ] = NULL;
+        }
+    }
+    osm_map_fallback_unlock();
+}
+
+osm_map_fallback_stats_t *osm_map_fallback_get_stats( void ) {
+    return( &osm_map_fallback_stats );
+}
+
+/**
+ * @brief get a free buffer, an allocated one first, call with lock held
+ *
+ * @return  pointer to a true color tile buffer, NULL if all in use or alloc failed
+ */
+static lv_color_t *osm_map_fallback_get_buf( void ) {
+    int slot = -1;
+
+    for( int i = 0 ; i < OSM_MAP_FALLBACK_BUFFERS ; i++ ) {
+        if ( osm_map_fallback_buf_used[ i ] ) {
+            continue;
+        }
+        if ( osm_map_fallback_buf[ i ] ) {
+            slot = i;
+            break;
+        }
+        if ( slot < 0 ) {
+            slot = i;
+        }
+    }
+    if ( slot < 0 ) {
+        osm_map_fallback_stats.capped++;
+        return( NULL );
+    }
+    if ( !osm_map_fallback_buf[ slot ] ) {
+        osm_map_fallback_buf[ slot ] = (lv_color_t*)MALLOC( OSM_MAP_FALLBACK_TILE_SIZE * OSM_MAP_FALLBACK_TILE_SIZE * sizeof( lv_color_t ) );
+        if ( !osm_map_fallback_buf[ slot ] ) {
+            OSM_MAP_FALLBACK_ERROR_LOG("fallback tile alloc failed");
+            return( NULL );
+        }
+    }
+    osm_map_fallback_buf_used[ slot ] = true;
+    return( osm_map_fallback_buf[ slot ] );
+}
+
+/**
+ * @brief give a buffer back, call with lock held
+ */
+static void osm_map_fallback_put_buf( const void *buf ) {
+    for( int i = 0 ; i < OSM_MAP_FALLBACK_BUFFERS ; i++ ) {
+        if ( osm_map_fallback_buf[ i ] == buf ) {
+            osm_map_fallback_buf_used[ i ] = false;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief decode a pinned tile or reuse the last decode, call with lock held
+ *
+ * @return  pointer to a RGBA8888 image, NULL if failed
+ */
+static const uint8_t *osm_map_fallback_decode( uri_load_dsc_t *uri_load_dsc, const osm_map_cache_key_t *key ) {
+    unsigned width = 0, height = 0;
+    uint8_t *rgba = NULL;
+
+    if ( osm_map_fallback_src && !memcmp( key, &osm_map_fallback_src_key, sizeof( osm_map_cache_key_t ) ) ) {
+        osm_map_fallback_stats.reused++;
+        return( osm_map_fallback_src );
+    }
+    if ( osm_map_fallback_src ) {
+        free( osm_map_fallback_src );
+        osm_map_fallback_src = NULL;
+    }
+    if ( lv_png_decode32( &rgba, &width, &height, uri_load_dsc->data, uri_load_dsc->size ) ) {
+        OSM_MAP_FALLBACK_ERROR_LOG("tile %d/%d/%d decode failed", key->zoom, key->x, key->y );
+        return( NULL );
+    }
+    if ( width != OSM_MAP_FALLBACK_TILE_SIZE || height != OSM_MAP_FALLBACK_TILE_SIZE ) {
+        OSM_MAP_FALLBACK_ERROR_LOG("tile %d/%d/%d has %dx%dpx", key->zoom, key->x, key->y, width, height );
+        free( rgba );
+        return( NULL );
+    }
+    osm_map_fallback_stats.decodes++;
+    osm_map_fallback_src = rgba;
+    osm_map_fallback_src_key = *key;
+
+    return( osm_map_fallback_src );
+}
+
+/**
+ * @brief scale a square of 256 >> level px at offset up to a full tile, bilinear
+ * in 1/256 px steps
+ */
+static void osm_map_fallback_scale_up( const uint8_t *src, uint32_t level, uint32_t offset_x, uint32_t offset_y, lv_color_t *dest ) {
+    const uint32_t size = OSM_MAP_FALLBACK_TILE_SIZE;
+
+    for( uint32_t py = 0 ; py < size ; py++ ) {
+        uint32_t fy = ( offset_y << 8 ) + ( py << 8 >> level );
+        uint32_t y0 = fy >> 8;
+        uint32_t y1 = y0 + 1 < size ? y0 + 1 : y0;
+        uint32_t wy = fy & 0xff;
+
+        for( uint32_t px = 0 ; px < size ; px++ ) {
+            uint32_t fx = ( offset_x << 8 ) + ( px << 8 >> level );
+            uint32_t x0 = fx >> 8;
+            uint32_t x1 = x0 + 1 < size ? x0 + 1 : x0;
+            uint32_t wx = fx & 0xff;
+            const uint8_t *p00 = &src[ ( y0 * size + x0 ) * 4 ];
+            const uint8_t *p01 = &src[ ( y0 * size + x1 ) * 4 ];
+            const uint8_t *p10 = &src[ ( y1 * size + x0 ) * 4 ];
+            const uint8_t *p11 = &src[ ( y1 * size + x1 ) * 4 ];
+            uint8_t c[ 3 ];
+
+            for( int i = 0 ; i < 3 ; i++ ) {
+                uint32_t top = p00[ i ] * ( 256 - wx ) + p01[ i ] * wx;
+                uint32_t bottom = p10[ i ] * ( 256 - wx ) + p11[ i ] * wx;
+                c[ i ] = ( top * ( 256 - wy ) + bottom * wy ) >> 16;
+            }
+            dest[ py * size + px ] = lv_color_make( c[ 0 ], c[ 1 ], c[ 2 ] );
+        }
+    }
+}
+
+/**
+ * @brief scale a child tile down into his quadrant, 2x2 px average
+ */
+static void osm_map_fallback_scale_down( const uint8_t *src, uint32_t quadrant_x, uint32_t quadrant_y, lv_color_t *dest ) {
+    const uint32_t size = OSM_MAP_FALLBACK_TILE_SIZE;
+    const uint32_t half = OSM_MAP_FALLBACK_TILE_SIZE / 2;
+
+    for( uint32_t py = 0 ; py < half ; py++ ) {
+        const uint8_t *row0 = &src[ py * 2 * size * 4 ];
+        const uint8_t *row1 = row0 + size * 4;
+        lv_color_t *out = &dest[ ( quadrant_y * half + py ) * size + quadrant_x * half ];
+
+        for( uint32_t px = 0 ; px < half ; px++, row0 += 8, row1 += 8 ) {
+            out[ px ] = lv_color_make( ( row0[ 0 ] + row0[ 4 ] + row1[ 0 ] + row1[ 4 ] ) >> 2,
+                                       ( row0[ 1 ] + row0[ 5 ] + row1[ 1 ] + row1[ 5 ] ) >> 2,
+                                       ( row0[ 2 ] + row0[ 6 ] + row1[ 2 ] + row1[ 6 ] ) >> 2 );
+        }
+    }
+}
+
+/**
+ * @brief fill a quadrant without a cached child
+ */
+static void osm_map_fallback_fill( lv_color_t *dest, uint32_t quadrant_x, uint32_t quadrant_y ) {
+    const uint32_t size = OSM_MAP_FALLBACK_TILE_SIZE;
+    const uint32_t half = OSM_MAP_FALLBACK_TILE_SIZE / 2;
+    lv_color_t color = OSM_MAP_FALLBACK_BG_COLOR;
+
+    for( uint32_t py = 0 ; py < half ; py++ ) {
+        lv_color_t *out = &dest[ ( quadrant_y * half + py ) * size + quadrant_x * half ];
+        for( uint32_t px = 0 ; px < half ; px++ ) {
+            out[ px ] = color;
+        }
+    }
+}
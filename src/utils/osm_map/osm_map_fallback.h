@@ -0,0 +1,81 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _OSM_MAP_FALLBACK_H
+    #define _OSM_MAP_FALLBACK_H
+
+    #include "lvgl.h"
+    #include "osm_map.h"
+
+    #define OSM_MAP_FALLBACK_INFO_LOG       log_i
+    #define OSM_MAP_FALLBACK_LOG            log_d
+    #define OSM_MAP_FALLBACK_ERROR_LOG      log_e
+
+    #define OSM_MAP_FALLBACK_TILE_SIZE      256             /** @brief tile image size in px */
+    #define OSM_MAP_FALLBACK_LEVELS         3               /** @brief max zoom levels up to a cached parent, a quadrant of 32px at 3 */
+    #define OSM_MAP_FALLBACK_BUFFERS        4               /** @brief max provisional tiles at once, the view never shows more than four tiles */
+    #define OSM_MAP_FALLBACK_BG_COLOR       LV_COLOR_MAKE( 0xf2, 0xef, 0xe9 )  /** @brief fill color of child quadrants that are not cached, the osm land color */
+    /**
+     * @brief fallback statistics, all times in us
+     */
+    typedef struct {
+        uint32_t parents = 0;                   /** @brief tiles scaled up from a parent */
+        uint32_t mosaics = 0;                   /** @brief tiles scaled down from cached children */
+        uint32_t misses = 0;                    /** @brief tiles without a cached parent or child */
+        uint32_t capped = 0;                    /** @brief tiles without a free buffer */
+        uint32_t decodes = 0;                   /** @brief decoded source tiles */
+        uint32_t reused = 0;                    /** @brief source tiles reused from the last decode */
+        uint64_t time = 0;                      /** @brief sum of create times */
+        uint32_t max_time = 0;                  /** @brief max create time */
+    } osm_map_fallback_stats_t;
+    /**
+     * @brief create a provisional tile from the ram cache, the matching quadrant of a
+     * cached parent up to OSM_MAP_FALLBACK_LEVELS up or a mosaic of the cached children,
+     * all four children are preferred over a parent, they are sharper
+     *
+     * @param   osm_location    pointer to the osm_location structure
+     * @param   zoom            zoom level
+     * @param   x               tile x
+     * @param   y               tile y
+     * @param   dsc             pointer to a image dsc, gets a true color image that must be freed with osm_map_fallback_free()
+     *
+     * @return  true if a provisional tile was created, false if none is cached or all
+     *          OSM_MAP_FALLBACK_BUFFERS buffers are in use
+     */
+    bool osm_map_fallback_create( osm_location_t *osm_location, uint32_t zoom, int32_t x, int32_t y, lv_img_dsc_t *dsc );
+    /**
+     * @brief give the buffer of a provisional tile from osm_map_fallback_create() back
+     *
+     * @param   dsc             pointer to the image dsc
+     */
+    void osm_map_fallback_free( lv_img_dsc_t *dsc );
+    /**
+     * @brief free the last decoded source tile and the unused buffers, call it when the view is released
+     */
+    void osm_map_fallback_flush( void );
+    /**
+     * @brief get the fallback statistics
+     *
+     * @return  pointer to a osm_map_fallback_stats_t structure
+     */
+    osm_map_fallback_stats_t *osm_map_fallback_get_stats( void );
+
+#endif // _OSM_MAP_FALLBACK_H
@@ -0,0 +1,221 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "osm_map_mbtiles.h"
+#include "utils/alloc.h"
+#include "utils/filepath_convert.h"
+#include "utils/sqlite3/sqlite3.h"
+#include "utils/lock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef NATIVE_64BIT
+    #include <time.h>
+    #include "utils/logging.h"
+    #include "utils/millis.h"
+#else
+    #include <Arduino.h>
+    #include <esp_timer.h>
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/semphr.h>
+#endif
+static lock_mutex_t osm_map_mbtiles_mutex = LOCK_MUTEX_INITIALIZER;    /** @brief one connection for the ui and the load ahead task */
+
+static sqlite3 *osm_map_mbtiles_db = NULL;                          /** @brief open mbtiles file */
+static sqlite3_stmt *osm_map_mbtiles_stmt = NULL;                   /** @brief prepared tile query */
+static char osm_map_mbtiles_path[ OSM_MAP_MBTILES_PATH_LEN ] = "";  /** @brief tile server uri of the open file */
+static osm_map_mbtiles_stats_t osm_map_mbtiles_stats;
+
+static void osm_map_mbtiles_lock( void ) {
+    lock_mutex_take( &osm_map_mbtiles_mutex );
+}
+
+static void osm_map_mbtiles_unlock( void ) {
+    lock_mutex_give( &osm_map_mbtiles_mutex );
+}
+
+static uint64_t osm_map_mbtiles_now( void ) {
+#ifdef NATIVE_64BIT
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000 );
+#else
+    return( esp_timer_get_time() );
+#endif
+}
+
+bool osm_map_mbtiles_is_source( const char *tile_server ) {
+    return( tile_server && !strncmp( tile_server, OSM_MAP_MBTILES_SCHEME, strlen( OSM_MAP_MBTILES_SCHEME ) ) );
+}
+
+/**
+ * @brief close the database, call with lock held
+ */
+static void osm_map_mbtiles_close_locked( void ) {
+    if ( osm_map_mbtiles_stmt ) {
+        sqlite3_finalize( osm_map_mbtiles_stmt );
+        osm_map_mbtiles_stmt = NULL;
+    }
+    if ( osm_map_mbtiles_db ) {
+        sqlite3_close( osm_map_mbtiles_db );
+        osm_map_mbtiles_db = NULL;
+        OSM_MAP_MBTILES_LOG("mbtiles closed: %s", osm_map_mbtiles_path );
+    }
+    *osm_map_mbtiles_path = '\0';
+}
+
+/**
+ * @brief open a mbtiles file and prepare the tile query, call with lock held
+ */
+static bool osm_map_mbtiles_open( const char *tile_server ) {
+    char filename[ OSM_MAP_MBTILES_PATH_LEN ] = "";
+    sqlite3_stmt *stmt = NULL;
+    /**
+     * keep the open file
+     */
+    if ( osm_map_mbtiles_db && !strcmp( osm_map_mbtiles_path, tile_server ) ) {
+        return( true );
+    }
+    osm_map_mbtiles_close_locked();
+
+    const char *path = tile_server + strlen( OSM_MAP_MBTILES_SCHEME );
+#ifdef NATIVE_64BIT
+    filepath_convert( filename, sizeof( filename ), *path == '/' ? path + 1 : path );
+#else
+    snprintf( filename, sizeof( filename ), "%s", path );
+#endif
+    osm_map_mbtiles_stats.opens++;
+    /**
+     * sqlite is built with SQLITE_OMIT_AUTOINIT, the calendar may not have
+     * initialized it yet, a second call does nothing
+     */
+    if ( sqlite3_initialize() != SQLITE_OK ) {
+        OSM_MAP_MBTILES_ERROR_LOG("sqlite3 init failed");
+        osm_map_mbtiles_stats.errors++;
+        return( false );
+    }
+    if ( sqlite3_open_v2( filename, &osm_map_mbtiles_db, SQLITE_OPEN_READONLY, NULL ) != SQLITE_OK ) {
+        OSM_MAP_MBTILES_ERROR_LOG("can't open mbtiles %s: %s", filename, sqlite3_errmsg( osm_map_mbtiles_db ) );
+        sqlite3_close( osm_map_mbtiles_db );
+        osm_map_mbtiles_db = NULL;
+        osm_map_mbtiles_stats.errors++;
+        return( false );
+    }
+    /**
+     * only raster tiles can be shown
+     */
+    if ( sqlite3_prepare_v2( osm_map_mbtiles_db, "SELECT name, value FROM metadata WHERE name IN ( 'name', 'format', 'minzoom', 'maxzoom' );", -1, &stmt, NULL ) == SQLITE_OK ) {
+        while( sqlite3_step( stmt ) == SQLITE_ROW ) {
+            const char *name = (const char*)sqlite3_column_text( stmt, 0 );
+            const char *value = (const char*)sqlite3_column_text( stmt, 1 );
+            OSM_MAP_MBTILES_INFO_LOG("mbtiles %s: %s", name ? name : "", value ? value : "" );
+            if ( name && value && !strcmp( name, "format" ) && strcmp( value, "png" ) ) {
+                OSM_MAP_MBTILES_ERROR_LOG("mbtiles format %s is not supported, use png tiles", value );
+            }
+        }
+        sqlite3_finalize( stmt );
+    }
+    /**
+     * prepared once, every tile only binds and steps
+     */
+    if ( sqlite3_prepare_v2( osm_map_mbtiles_db, "SELECT tile_data FROM tiles WHERE zoom_level = ?1 AND tile_column = ?2 AND tile_row = ?3;", -1, &osm_map_mbtiles_stmt, NULL ) != SQLITE_OK ) {
+        OSM_MAP_MBTILES_ERROR_LOG("no tiles table in %s: %s", filename, sqlite3_errmsg( osm_map_mbtiles_db ) );
+        osm_map_mbtiles_close_locked();
+        osm_map_mbtiles_stats.errors++;
+        return( false );
+    }
+    snprintf( osm_map_mbtiles_path, sizeof( osm_map_mbtiles_path ), "%s", tile_server );
+    OSM_MAP_MBTILES_INFO_LOG("mbtiles open: %s", filename );
+    return( true );
+}
+
+uri_load_dsc_t *osm_map_mbtiles_load( const char *tile_server, uint32_t zoom, uint32_t x, uint32_t y, const char *uri ) {
+    uri_load_dsc_t *uri_load_dsc = NULL;
+
+    if ( !osm_map_mbtiles_is_source( tile_server ) || !uri || zoom > 30 || y >= ( 1UL << zoom ) ) {
+        return( NULL );
+    }
+    osm_map_mbtiles_lock();
+    if ( !osm_map_mbtiles_open( tile_server ) ) {
+        osm_map_mbtiles_unlock();
+        return( NULL );
+    }
+    uint64_t start = osm_map_mbtiles_now();
+    /**
+     * mbtiles rows count from the bottom (tms)
+     */
+    sqlite3_reset( osm_map_mbtiles_stmt );
+    sqlite3_bind_int( osm_map_mbtiles_stmt, 1, zoom );
+    sqlite3_bind_int( osm_map_mbtiles_stmt, 2, x );
+    sqlite3_bind_int( osm_map_mbtiles_stmt, 3, ( 1UL << zoom ) - 1 - y );
+
+    int rc = sqlite3_step( osm_map_mbtiles_stmt );
+    if ( rc == SQLITE_ROW && sqlite3_column_bytes( osm_map_mbtiles_stmt, 0 ) > 0 ) {
+        int size = sqlite3_column_bytes( osm_map_mbtiles_stmt, 0 );
+        const void *blob = sqlite3_column_blob( osm_map_mbtiles_stmt, 0 );
+
+        uri_load_dsc = (uri_load_dsc_t*)CALLOC( 1, sizeof( uri_load_dsc_t ) );
+        if ( uri_load_dsc ) {
+            uri_load_dsc->data = (uint8_t*)MALLOC( size + 1 );
+            uri_load_dsc->uri = (char*)MALLOC( strlen( uri ) + 1 );
+            uri_load_dsc->size = size;
+            uri_load_dsc->timestamp = millis();
+            if ( uri_load_dsc->data && uri_load_dsc->uri ) {
+                memcpy( uri_load_dsc->data, blob, size );
+                strcpy( uri_load_dsc->uri, uri );
+            }
+            else {
+                OSM_MAP_MBTILES_ERROR_LOG("tile alloc failed");
+                uri_load_free_all( uri_load_dsc );
+                uri_load_dsc = NULL;
+            }
+        }
+        osm_map_mbtiles_stats.hits++;
+    }
+    else if ( rc == SQLITE_ROW || rc == SQLITE_DONE ) {
+        osm_map_mbtiles_stats.misses++;
+    }
+    else {
+        OSM_MAP_MBTILES_ERROR_LOG("tile query failed: %s", sqlite3_errmsg( osm_map_mbtiles_db ) );
+        osm_map_mbtiles_stats.errors++;
+    }
+    /**
+     * release the read lock on the file
+     */
+    sqlite3_reset( osm_map_mbtiles_stmt );
+    osm_map_mbtiles_stats.query_time += osm_map_mbtiles_now() - start;
+    osm_map_mbtiles_unlock();
+
+    return( uri_load_dsc );
+}
+
+void osm_map_mbtiles_close( void ) {
+    osm_map_mbtiles_lock();
+    osm_map_mbtiles_close_locked();
+    osm_map_mbtiles_unlock();
+}
+
+osm_map_mbtiles_stats_t *osm_map_mbtiles_get_stats( void ) {
+    return( &osm_map_mbtiles_stats );
+}
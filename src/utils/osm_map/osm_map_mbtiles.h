@@ -0,0 +1,74 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _OSM_MAP_MBTILES_H
+    #define _OSM_MAP_MBTILES_H
+
+    #include "utils/uri_load/uri_load.h"
+
+    #define OSM_MAP_MBTILES_INFO_LOG        log_i
+    #define OSM_MAP_MBTILES_LOG             log_d
+    #define OSM_MAP_MBTILES_ERROR_LOG       log_e
+
+    #define OSM_MAP_MBTILES_SCHEME          "mbtiles://"        /** @brief tile server scheme, e.g. mbtiles:///sd/osmmap.mbtiles */
+    #define OSM_MAP_MBTILES_PATH_LEN        256                 /** @brief max mbtiles file path length */
+    /**
+     * @brief mbtiles statistics
+     */
+    typedef struct {
+        uint32_t opens = 0;                     /** @brief database opens */
+        uint32_t hits = 0;                      /** @brief tiles found */
+        uint32_t misses = 0;                    /** @brief tiles not in the database */
+        uint32_t errors = 0;                    /** @brief failed opens and queries */
+        uint64_t query_time = 0;                /** @brief sum of the query times in us */
+    } osm_map_mbtiles_stats_t;
+    /**
+     * @brief check if a tile server uri is a mbtiles file
+     *
+     * @param   tile_server tile server uri
+     *
+     * @return  true if mbtiles
+     */
+    bool osm_map_mbtiles_is_source( const char *tile_server );
+    /**
+     * @brief load a tile from a mbtiles file, the database stays open for the next tile
+     *
+     * @param   tile_server tile server uri, mbtiles://<path>
+     * @param   zoom        zoom level
+     * @param   x           tile x
+     * @param   y           tile y in xyz order, flipped into the mbtiles tms order
+     * @param   uri         tile uri for the uri_load_dsc
+     *
+     * @return  uri_load_dsc structure, NULL if not found
+     */
+    uri_load_dsc_t *osm_map_mbtiles_load( const char *tile_server, uint32_t zoom, uint32_t x, uint32_t y, const char *uri );
+    /**
+     * @brief close the open mbtiles file and free the statement and page cache
+     */
+    void osm_map_mbtiles_close( void );
+    /**
+     * @brief get the mbtiles statistics
+     *
+     * @return  pointer to a osm_map_mbtiles_stats_t structure
+     */
+    osm_map_mbtiles_stats_t *osm_map_mbtiles_get_stats( void );
+
+#endif // _OSM_MAP_MBTILES_H
@@ -0,0 +1,842 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "osm_map_overlay.h"
+#include "utils/alloc.h"
+#include "utils/lock.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef NATIVE_64BIT
+    #include <stdio.h>
+    #include <time.h>
+    #include "utils/logging.h"
+#else
+    #include <Arduino.h>
+    #include <esp_timer.h>
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/semphr.h>
+#endif
+static lock_mutex_t osm_map_overlay_mutex = LOCK_MUTEX_INITIALIZER;    /** @brief points from the gpsctl task, drawing from the update task */
+
+#define OSM_MAP_OVERLAY_NONE        0xffffffff
+
+static void osm_map_overlay_lonlat2world( double lon, double lat, osm_map_overlay_point_t *point );
+static bool osm_map_overlay_draw( osm_map_overlay_t *overlay, uint32_t zoom, int32_t tilex, int32_t tiley, uint16_t img_zoom );
+static bool osm_map_overlay_rebuild( osm_map_overlay_t *overlay );
+static bool osm_map_overlay_append( osm_map_overlay_t *overlay, uint32_t n );
+static bool osm_map_overlay_emit( osm_map_overlay_t *overlay, uint32_t first_point, int32_t max );
+static void osm_map_overlay_simplify( osm_map_overlay_t *overlay, uint32_t first, uint32_t last );
+static bool osm_map_overlay_push( osm_map_overlay_t *overlay, lv_point_t point, bool new_run );
+static bool osm_map_overlay_apply( osm_map_overlay_t *overlay );
+static void osm_map_overlay_free( osm_map_overlay_t *overlay );
+
+static void osm_map_overlay_lock( void ) {
+    lock_mutex_take( &osm_map_overlay_mutex );
+}
+
+static void osm_map_overlay_unlock( void ) {
+    lock_mutex_give( &osm_map_overlay_mutex );
+}
+
+static uint64_t osm_map_overlay_now( void ) {
+#ifdef NATIVE_64BIT
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000 );
+#else
+    return( esp_timer_get_time() );
+#endif
+}
+
+osm_map_overlay_t *osm_map_overlay_create( osm_map_view_t *view, lv_color_t color, lv_coord_t width ) {
+    if ( !view ) {
+        return( NULL );
+    }
+
+    osm_map_overlay_t *overlay = (osm_map_overlay_t*)CALLOC( 1, sizeof( osm_map_overlay_t ) );
+    if ( !overlay ) {
+        OSM_MAP_OVERLAY_ERROR_LOG("osm map overlay alloc failed");
+        return( NULL );
+    }
+    overlay->view = view;
+    overlay->dirty = OSM_MAP_OVERLAY_NONE;
+    overlay->stats = osm_map_overlay_stats_t();
+
+    lv_style_init( &overlay->style );
+    lv_style_set_line_color( &overlay->style, LV_STATE_DEFAULT, color );
+    lv_style_set_line_width( &overlay->style, LV_STATE_DEFAULT, width );
+    lv_style_set_line_rounded( &overlay->style, LV_STATE_DEFAULT, true );
+    /**
+     * all line objs are created now, lines of a later overlay stay on top
+     */
+    for( int i = 0 ; i < OSM_MAP_OVERLAY_LINES ; i++ ) {
+        overlay->line[ i ] = lv_line_create( view->plane, NULL );
+        lv_obj_add_style( overlay->line[ i ], LV_LINE_PART_MAIN, &overlay->style );
+        lv_obj_set_click( overlay->line[ i ], false );
+        lv_obj_set_pos( overlay->line[ i ], 0, 0 );
+        lv_obj_set_hidden( overlay->line[ i ], true );
+        overlay->line_points[ i ] = NULL;
+        overlay->line_count[ i ] = 0;
+    }
+    return( overlay );
+}
+
+/**
+ * @brief convert a lon/lat into world coords, this is the only trig per point
+ *
+ * https://wiki.openstreetmap.org/wiki/Slippy_map_tilenames#C.2FC.2B.2B
+ */
+static void osm_map_overlay_lonlat2world( double lon, double lat, osm_map_overlay_point_t *point ) {
+    double x = ( lon + 180.0 ) / 360.0;
+    double y = ( 1.0 - asinh( tan( lat * M_PI / 180.0 ) ) / M_PI ) / 2.0;
+
+    x = x < 0.0 ? 0.0 : x * 4294967296.0;
+    y = y < 0.0 ? 0.0 : y * 4294967296.0;
+    point->x = x >= 4294967295.0 ? 0xffffffff : (uint32_t)x;
+    point->y = y >= 4294967295.0 ? 0xffffffff : (uint32_t)y;
+}
+
+bool osm_map_overlay_add_point( osm_map_overlay_t *overlay, double lon, double lat ) {
+    osm_map_overlay_point_t point;
+
+    if ( !overlay ) {
+        return( false );
+    }
+    osm_map_overlay_lonlat2world( lon, lat, &point );
+
+    osm_map_overlay_lock();
+    if ( overlay->count && overlay->point[ overlay->count - 1 ].x == point.x && overlay->point[ overlay->count - 1 ].y == point.y ) {
+        osm_map_overlay_unlock();
+        return( true );
+    }
+    if ( overlay->count >= overlay->size ) {
+        uint32_t size = overlay->size ? overlay->size * 2 : 256;
+        osm_map_overlay_point_t *points = (osm_map_overlay_point_t*)REALLOC( overlay->point, size * sizeof( osm_map_overlay_point_t ) );
+        if ( !points ) {
+            OSM_MAP_OVERLAY_ERROR_LOG("overlay point alloc failed");
+            osm_map_overlay_unlock();
+            return( false );
+        }
+        overlay->point = points;
+        overlay->size = size;
+    }
+    overlay->point[ overlay->count++ ] = point;
+    osm_map_overlay_unlock();
+
+    return( true );
+}
+
+void osm_map_overlay_clear( osm_map_overlay_t *overlay ) {
+    if ( !overlay ) {
+        return;
+    }
+    osm_map_overlay_lock();
+    osm_map_overlay_free( overlay );
+    osm_map_overlay_unlock();
+}
+
+/**
+ * @brief free the polyline and all scratch buffers, the line objs are hidden on the next update
+ */
+static void osm_map_overlay_free( osm_map_overlay_t *overlay ) {
+    free( overlay->point );
+    free( overlay->px );
+    free( overlay->stack );
+    free( overlay->keep );
+    overlay->point = NULL;
+    overlay->px = NULL;
+    overlay->stack = NULL;
+    overlay->keep = NULL;
+    overlay->count = 0;
+    overlay->size = 0;
+    overlay->scratch_size = 0;
+    /**
+     * out stays allocated while a line obj may point into it
+     */
+    overlay->out_count = 0;
+    overlay->runs = 0;
+    overlay->valid = false;
+    overlay->open = false;
+    overlay->drawn_count = 0;
+}
+
+bool osm_map_overlay_update( osm_map_overlay_t *overlay ) {
+    bool changed = false;
+
+    if ( !overlay || !overlay->view ) {
+        return( false );
+    }
+    osm_map_view_t *view = overlay->view;
+
+    osm_map_overlay_lock();
+    if ( !view->valid || view->zoom > OSM_MAP_OVERLAY_MAX_ZOOM ) {
+        overlay->runs = 0;
+        overlay->valid = false;
+    }
+    else {
+        osm_map_overlay_draw( overlay, view->zoom, view->tilex, view->tiley, view->img_zoom );
+    }
+    changed = osm_map_overlay_apply( overlay );
+    osm_map_overlay_unlock();
+
+    return( changed );
+}
+
+/**
+ * @brief bring out up to date with the points and the projection, new points
+ * are appended if possible
+ *
+ * @return  true if rebuilt
+ */
+static bool osm_map_overlay_draw( osm_map_overlay_t *overlay, uint32_t zoom, int32_t tilex, int32_t tiley, uint16_t img_zoom ) {
+    if ( !overlay->valid || zoom != overlay->zoom || tilex != overlay->tilex || tiley != overlay->tiley || img_zoom != overlay->img_zoom || overlay->count < overlay->drawn_count ) {
+        overlay->zoom = zoom;
+        overlay->tilex = tilex;
+        overlay->tiley = tiley;
+        overlay->img_zoom = img_zoom;
+        return( osm_map_overlay_rebuild( overlay ) );
+    }
+    if ( overlay->count == overlay->drawn_count ) {
+        return( false );
+    }
+    if ( overlay->count - overlay->drawn_count > OSM_MAP_OVERLAY_WINDOW ) {
+        return( osm_map_overlay_rebuild( overlay ) );
+    }
+    /**
+     * new points, a point that leaves the grid needs a rebuild
+     */
+    for( uint32_t n = overlay->drawn_count ; n < overlay->count ; n++ ) {
+        if ( !osm_map_overlay_append( overlay, n ) ) {
+            return( osm_map_overlay_rebuild( overlay ) );
+        }
+    }
+    return( false );
+}
+
+/**
+ * @brief world coords to px in the grid container, a shift and the image zoom, no trig
+ */
+static inline int32_t osm_map_overlay_project( uint32_t world, uint32_t shift, int64_t origin, uint16_t img_zoom ) {
+    return( (int32_t)( ( ( (int64_t)world - origin ) * img_zoom ) >> ( shift + 8 ) ) );
+}
+
+/**
+ * @brief world coords of the top left grid corner
+ */
+static inline int64_t osm_map_overlay_origin( int32_t tile, uint32_t shift ) {
+    return( (int64_t)tile * OSM_MAP_VIEW_TILE_SIZE << shift );
+}
+
+static inline bool osm_map_overlay_is_inside( int32_t x, int32_t y, int32_t max ) {
+    return( x >= 0 && x <= max && y >= 0 && y <= max );
+}
+
+/**
+ * @brief squared distance of a point to a segment, all relative to the segment start
+ *
+ * @param   x       point x
+ * @param   y       point y
+ * @param   dx      segment end x
+ * @param   dy      segment end y
+ * @param   len     squared segment length
+ */
+static inline double osm_map_overlay_dist( double x, double y, double dx, double dy, double len ) {
+    double dot = x * dx + y * dy;
+
+    if ( len <= 0.0 || dot <= 0.0 ) {
+        return( x * x + y * y );
+    }
+    if ( dot >= len ) {
+        x -= dx;
+        y -= dy;
+        return( x * x + y * y );
+    }
+    double cross = x * dy - y * dx;
+    return( cross * cross / len );
+}
+
+/**
+ * @brief clip a segment into the grid, Liang-Barsky
+ *
+ * @return  false if the segment is outside
+ */
+static bool osm_map_overlay_clip( const int32_t *from, const int32_t *to, int32_t max, lv_point_t *a, lv_point_t *b ) {
+    double t0 = 0.0, t1 = 1.0;
+    double dx = (double)to[ 0 ] - from[ 0 ];
+    double dy = (double)to[ 1 ] - from[ 1 ];
+    double p[ 4 ] = { -dx, dx, -dy, dy };
+    double q[ 4 ] = { (double)from[ 0 ], (double)max - from[ 0 ], (double)from[ 1 ], (double)max - from[ 1 ] };
+
+    for( int i = 0 ; i < 4 ; i++ ) {
+        if ( p[ i ] == 0.0 ) {
+            if ( q[ i ] < 0.0 ) {
+                return( false );
+            }
+            continue;
+        }
+        double r = q[ i ] / p[ i ];
+        if ( p[ i ] < 0.0 ) {
+            if ( r > t1 ) {
+                return( false );
+            }
+            if ( r > t0 ) {
+                t0 = r;
+            }
+        }
+        else {
+            if ( r < t0 ) {
+                return( false );
+            }
+            if ( r < t1 ) {
+                t1 = r;
+            }
+        }
+    }
+    a->x = (lv_coord_t)lround( from[ 0 ] + t0 * dx );
+    a->y = (lv_coord_t)lround( from[ 1 ] + t0 * dy );
+    b->x = (lv_coord_t)lround( from[ 0 ] + t1 * dx );
+    b->y = (lv_coord_t)lround( from[ 1 ] + t1 * dy );
+    return( true );
+}
+
+/**
+ * @brief reproject all points, simplify the runs that cross the grid and clip them into out
+ *
+ * @return  true
+ */
+static bool osm_map_overlay_rebuild( osm_map_overlay_t *overlay ) {
+    uint64_t start = osm_map_overlay_now();
+    uint32_t shift = OSM_MAP_OVERLAY_WORLD_SHIFT - overlay->zoom;
+    int64_t origin_x = osm_map_overlay_origin( overlay->tilex, shift );
+    int64_t origin_y = osm_map_overlay_origin( overlay->tiley, shift );
+    int32_t max = OSM_MAP_VIEW_GRID * overlay->img_zoom - 1;
+    uint32_t count = overlay->count;
+
+    overlay->out_count = 0;
+    overlay->runs = 0;
+    overlay->open = false;
+    overlay->dirty = OSM_MAP_OVERLAY_NONE;
+    overlay->valid = true;
+    overlay->drawn_count = count;
+    overlay->stats.visible = 0;
+    overlay->stats.rebuilds++;
+    /**
+     * scratch for the projected points and the simplify
+     */
+    if ( count > overlay->scratch_size ) {
+        free( overlay->px );
+        free( overlay->stack );
+        free( overlay->keep );
+        overlay->px = (int32_t*)MALLOC( count * 2 * sizeof( int32_t ) );
+        overlay->stack = (uint32_t*)MALLOC( count * sizeof( uint32_t ) );
+        overlay->keep = (uint8_t*)MALLOC( count );
+        overlay->scratch_size = count;
+        if ( !overlay->px || !overlay->stack || !overlay->keep ) {
+            OSM_MAP_OVERLAY_ERROR_LOG("overlay scratch alloc failed");
+            free( overlay->px );
+            free( overlay->stack );
+            free( overlay->keep );
+            overlay->px = NULL;
+            overlay->stack = NULL;
+            overlay->keep = NULL;
+            overlay->scratch_size = 0;
+            return( true );
+        }
+    }
+    if ( count < 2 ) {
+        return( true );
+    }
+    int32_t *px = overlay->px;
+    for( uint32_t i = 0 ; i < count ; i++ ) {
+        px[ i * 2 ] = osm_map_overlay_project( overlay->point[ i ].x, shift, origin_x, overlay->img_zoom );
+        px[ i * 2 + 1 ] = osm_map_overlay_project( overlay->point[ i ].y, shift, origin_y, overlay->img_zoom );
+    }
+    /**
+     * too many points for the line objs, simplify coarser and at last drop the oldest points
+     */
+    uint32_t from = 0;
+    overlay->tolerance = OSM_MAP_OVERLAY_TOLERANCE;
+    while( !osm_map_overlay_emit( overlay, from, max ) ) {
+        if ( overlay->tolerance < OSM_MAP_OVERLAY_MAX_TOLERANCE ) {
+            overlay->tolerance *= 2;
+        }
+        else {
+            from += ( count - from ) / 2;
+        }
+        overlay->stats.coarser++;
+    }
+
+    uint32_t rebuild_time = osm_map_overlay_now() - start;
+    overlay->stats.drawn = overlay->out_count;
+    overlay->stats.runs = overlay->runs;
+    overlay->stats.rebuild_time += rebuild_time;
+    if ( rebuild_time > overlay->stats.max_rebuild_time )
+        overlay->stats.max_rebuild_time = rebuild_time;
+
+    return( true );
+}
+
+/**
+ * @brief simplify the runs of segments that touch the grid and clip them into out,
+ * only points from first on are drawn
+ *
+ * @return  false if out of line objs
+ */
+static bool osm_map_overlay_emit( osm_map_overlay_t *overlay, uint32_t first_point, int32_t max ) {
+    const int32_t *px = overlay->px;
+    uint8_t *keep = overlay->keep;
+    uint32_t count = overlay->count;
+    uint32_t first = OSM_MAP_OVERLAY_NONE;
+
+    overlay->out_count = 0;
+    overlay->runs = 0;
+    overlay->open = false;
+    overlay->stats.visible = 0;
+    memset( keep, 0, count );
+    /**
+     * find the runs of segments that touch the grid, only these are simplified
+     */
+    for( uint32_t i = first_point + 1 ; i < count ; i++ ) {
+        const int32_t *a = &px[ ( i - 1 ) * 2 ];
+        const int32_t *b = &px[ i * 2 ];
+        bool visible = !( ( a[ 0 ] < 0 && b[ 0 ] < 0 ) || ( a[ 0 ] > max && b[ 0 ] > max ) || ( a[ 1 ] < 0 && b[ 1 ] < 0 ) || ( a[ 1 ] > max && b[ 1 ] > max ) );
+
+        if ( visible && first == OSM_MAP_OVERLAY_NONE ) {
+            first = i - 1;
+        }
+        else if ( !visible && first != OSM_MAP_OVERLAY_NONE ) {
+            osm_map_overlay_simplify( overlay, first, i - 1 );
+            first = OSM_MAP_OVERLAY_NONE;
+        }
+    }
+    if ( first != OSM_MAP_OVERLAY_NONE ) {
+        osm_map_overlay_simplify( overlay, first, count - 1 );
+        /**
+         * the last segment is short, so a new point can extend or follow it
+         */
+        if ( count - 2 > first ) {
+            keep[ count - 2 ] = 1;
+        }
+    }
+    /**
+     * clip the kept segments into out, a gap or a clipped end starts a new run
+     */
+    uint32_t prev = OSM_MAP_OVERLAY_NONE;
+    bool in_run = false;
+    bool open = false;
+    for( uint32_t i = first_point ; i < count ; i++ ) {
+        if ( !keep[ i ] ) {
+            continue;
+        }
+        if ( keep[ i ] == 2 || prev == OSM_MAP_OVERLAY_NONE ) {
+            prev = i;
+            in_run = false;
+            continue;
+        }
+        const int32_t *from = &px[ prev * 2 ];
+        const int32_t *to = &px[ i * 2 ];
+        lv_point_t a, b;
+        bool clipped = false;
+
+        if ( osm_map_overlay_is_inside( from[ 0 ], from[ 1 ], max ) && osm_map_overlay_is_inside( to[ 0 ], to[ 1 ], max ) ) {
+            a.x = from[ 0 ];
+            a.y = from[ 1 ];
+            b.x = to[ 0 ];
+            b.y = to[ 1 ];
+        }
+        else if ( osm_map_overlay_clip( from, to, max, &a, &b ) ) {
+            clipped = true;
+        }
+        else {
+            prev = i;
+            in_run = false;
+            open = false;
+            continue;
+        }
+        if ( !in_run || overlay->out[ overlay->out_count - 1 ].x != a.x || overlay->out[ overlay->out_count - 1 ].y != a.y ) {
+            if ( !osm_map_overlay_push( overlay, a, true ) ) {
+                return( false );
+            }
+        }
+        if ( !osm_map_overlay_push( overlay, b, false ) ) {
+            return( false );
+        }
+        in_run = !clipped || osm_map_overlay_is_inside( to[ 0 ], to[ 1 ], max );
+        open = !clipped;
+        overlay->anchor = prev;
+        prev = i;
+    }
+    overlay->open = open && prev == count - 1;
+    return( true );
+}
+
+/**
+ * @brief Douglas-Peucker on the projected points first to last, iterative, the
+ * stack holds segment ends and the segment start is the last finished end
+ */
+static void osm_map_overlay_simplify( osm_map_overlay_t *overlay, uint32_t first, uint32_t last ) {
+    const int32_t *px = overlay->px;
+    uint32_t *stack = overlay->stack;
+    uint8_t *keep = overlay->keep;
+    double tolerance = (double)overlay->tolerance * overlay->tolerance;
+    uint32_t top = 0;
+    uint32_t anchor = first;
+
+    overlay->stats.visible += last - first + 1;
+    keep[ last ] = 1;
+    keep[ first ] = 2;
+    stack[ top++ ] = last;
+
+    while( top ) {
+        uint32_t end = stack[ top - 1 ];
+        double ax = px[ anchor * 2 ], ay = px[ anchor * 2 + 1 ];
+        double dx = px[ end * 2 ] - ax, dy = px[ end * 2 + 1 ] - ay;
+        double len = dx * dx + dy * dy;
+        double limit = tolerance;
+        uint32_t index = 0;
+        /**
+         * distance to the segment, not to the line, a track can turn back
+         */
+        for( uint32_t i = anchor + 1 ; i < end ; i++ ) {
+            double dist = osm_map_overlay_dist( px[ i * 2 ] - ax, px[ i * 2 + 1 ] - ay, dx, dy, len );
+            if ( dist > limit ) {
+                limit = dist;
+                index = i;
+            }
+        }
+        if ( index ) {
+            keep[ index ] = 1;
+            stack[ top++ ] = index;
+        }
+        else {
+            anchor = end;
+            top--;
+        }
+    }
+}
+
+/**
+ * @brief add a point to out, a new run takes the next line obj and a full chunk
+ * continues in the next line obj
+ *
+ * @return  false if out of line objs or memory
+ */
+static bool osm_map_overlay_push( osm_map_overlay_t *overlay, lv_point_t point, bool new_run ) {
+    lv_point_t last;
+    bool chunk = !new_run && overlay->runs && overlay->out_count - overlay->run_start[ overlay->runs - 1 ] >= OSM_MAP_OVERLAY_CHUNK;
+    uint32_t need = overlay->out_count + ( chunk ? 2 : 1 );
+
+    if ( ( new_run || chunk ) && overlay->runs >= OSM_MAP_OVERLAY_LINES ) {
+        return( false );
+    }
+    if ( need > overlay->out_size ) {
+        /**
+         * the line objs draw from out until the next apply, the old out is freed there,
+         * on a second grow before the apply the line objs still draw from out_old
+         */
+        uint32_t size = overlay->out_size ? overlay->out_size * 2 : OSM_MAP_OVERLAY_CHUNK * 2;
+        lv_point_t *out = (lv_point_t*)MALLOC( size * sizeof( lv_point_t ) );
+        if ( !out ) {
+            OSM_MAP_OVERLAY_ERROR_LOG("overlay out alloc failed");
+            return( false );
+        }
+        if ( overlay->out ) {
+            memcpy( out, overlay->out, overlay->out_count * sizeof( lv_point_t ) );
+        }
+        if ( overlay->out_old ) {
+            free( overlay->out );
+        }
+        else {
+            overlay->out_old = overlay->out;
+        }
+        overlay->out = out;
+        overlay->out_size = size;
+    }
+    if ( chunk ) {
+        /**
+         * the next chunk starts where the last ends
+         */
+        last = overlay->out[ overlay->out_count - 1 ];
+        overlay->run_start[ overlay->runs++ ] = overlay->out_count;
+        overlay->out[ overlay->out_count++ ] = last;
+    }
+    else if ( new_run ) {
+        overlay->run_start[ overlay->runs++ ] = overlay->out_count;
+    }
+    overlay->out[ overlay->out_count++ ] = point;
+    return( true );
+}
+
+/**
+ * @brief draw point n after the drawn polyline, the last out point is moved if the
+ * points since the anchor stay within the tolerance, otherwise it is fixed and n follows
+ *
+ * @return  false if a rebuild is needed
+ */
+static bool osm_map_overlay_append( osm_map_overlay_t *overlay, uint32_t n ) {
+    uint32_t shift = OSM_MAP_OVERLAY_WORLD_SHIFT - overlay->zoom;
+    int64_t origin_x = osm_map_overlay_origin( overlay->tilex, shift );
+    int64_t origin_y = osm_map_overlay_origin( overlay->tiley, shift );
+    int32_t max = OSM_MAP_VIEW_GRID * overlay->img_zoom - 1;
+    double tolerance = (double)overlay->tolerance * overlay->tolerance;
+
+    if ( n != overlay->drawn_count || n == 0 ) {
+        return( false );
+    }
+    int32_t x = osm_map_overlay_project( overlay->point[ n ].x, shift, origin_x, overlay->img_zoom );
+    int32_t y = osm_map_overlay_project( overlay->point[ n ].y, shift, origin_y, overlay->img_zoom );
+    if ( !overlay->open || overlay->out_count < 2 ) {
+        /**
+         * a segment outside the grid changes nothing
+         */
+        int32_t prev_x = osm_map_overlay_project( overlay->point[ n - 1 ].x, shift, origin_x, overlay->img_zoom );
+        int32_t prev_y = osm_map_overlay_project( overlay->point[ n - 1 ].y, shift, origin_y, overlay->img_zoom );
+        if ( ( x < 0 && prev_x < 0 ) || ( x > max && prev_x > max ) || ( y < 0 && prev_y < 0 ) || ( y > max && prev_y > max ) ) {
+            overlay->drawn_count = n + 1;
+            return( true );
+        }
+        return( false );
+    }
+    if ( !osm_map_overlay_is_inside( x, y, max ) ) {
+        return( false );
+    }
+    lv_point_t point;
+    point.x = x;
+    point.y = y;
+    /**
+     * opening window, check the points between anchor and n against anchor - n
+     */
+    uint32_t anchor = overlay->anchor;
+    bool extend = n - anchor <= OSM_MAP_OVERLAY_WINDOW;
+    if ( extend ) {
+        double ax = overlay->out[ overlay->out_count - 2 ].x, ay = overlay->out[ overlay->out_count - 2 ].y;
+        double dx = x - ax, dy = y - ay;
+        double len = dx * dx + dy * dy;
+
+        for( uint32_t i = anchor + 1 ; i < n && extend ; i++ ) {
+            double px = osm_map_overlay_project( overlay->point[ i ].x, shift, origin_x, overlay->img_zoom ) - ax;
+            double py = osm_map_overlay_project( overlay->point[ i ].y, shift, origin_y, overlay->img_zoom ) - ay;
+            extend = osm_map_overlay_dist( px, py, dx, dy, len ) <= tolerance;
+        }
+    }
+    if ( overlay->dirty > overlay->runs - 1 ) {
+        overlay->dirty = overlay->runs - 1;
+    }
+    if ( extend ) {
+        overlay->out[ overlay->out_count - 1 ] = point;
+        overlay->stats.extends++;
+    }
+    else {
+        if ( !osm_map_overlay_push( overlay, point, false ) ) {
+            return( false );
+        }
+        overlay->anchor = n - 1;
+    }
+    overlay->drawn_count = n + 1;
+    overlay->stats.appends++;
+    return( true );
+}
+
+/**
+ * @brief set the runs of out into the line objs, only changed lines are set
+ *
+ * @return  true if a line obj changed
+ */
+static bool osm_map_overlay_apply( osm_map_overlay_t *overlay ) {
+    bool changed = false;
+
+    for( uint32_t i = 0 ; i < OSM_MAP_OVERLAY_LINES ; i++ ) {
+        if ( i < overlay->runs ) {
+            const lv_point_t *points = overlay->out + overlay->run_start[ i ];
+            uint32_t end = i + 1 < overlay->runs ? overlay->run_start[ i + 1 ] : overlay->out_count;
+            uint16_t count = end - overlay->run_start[ i ];
+            bool dirty = i >= overlay->dirty;
+
+            if ( points != overlay->line_points[ i ] || count != overlay->line_count[ i ] || dirty ) {
+                if ( !overlay->line_count[ i ] ) {
+                    lv_obj_set_hidden( overlay->line[ i ], false );
+                }
+                lv_line_set_points( overlay->line[ i ], points, count );
+                overlay->line_points[ i ] = points;
+                overlay->line_count[ i ] = count;
+                changed = true;
+            }
+        }
+        else if ( overlay->line_count[ i ] ) {
+            lv_obj_set_hidden( overlay->line[ i ], true );
+            overlay->line_points[ i ] = NULL;
+            overlay->line_count[ i ] = 0;
+            changed = true;
+        }
+    }
+    overlay->dirty = OSM_MAP_OVERLAY_NONE;
+    /**
+     * no line obj points into the old out any more
+     */
+    free( overlay->out_old );
+    overlay->out_old = NULL;
+    return( changed );
+}
+
+osm_map_overlay_stats_t *osm_map_overlay_get_stats( osm_map_overlay_t *overlay ) {
+    return( overlay ? &overlay->stats : NULL );
+}
+
+void osm_map_overlay_bench( void ) {
+#ifdef NATIVE_64BIT
+    static bool bench_done = false;
+    const char *file_name = getenv( OSM_MAP_OVERLAY_BENCH_ENV );
+    char line[ 128 ];
+
+    if ( bench_done || !file_name || !*file_name ) {
+        return;
+    }
+    bench_done = true;
+
+    FILE *file = fopen( file_name, "r" );
+    if ( !file ) {
+        OSM_MAP_OVERLAY_ERROR_LOG("can't open bench track %s", file_name );
+        return;
+    }
+    /**
+     * a overlay without a view and line objs, only out is build
+     */
+    osm_map_overlay_t *overlay = (osm_map_overlay_t*)CALLOC( 1, sizeof( osm_map_overlay_t ) );
+    double *lonlat = NULL;
+    uint32_t lonlat_size = 0;
+    while( overlay && fgets( line, sizeof( line ), file ) ) {
+        double lat, lon;
+        if ( line[ 0 ] == '#' || sscanf( line, "%lf %lf", &lat, &lon ) != 2 ) {
+            continue;
+        }
+        if ( overlay->count >= lonlat_size ) {
+            lonlat_size = lonlat_size ? lonlat_size * 2 : 1024;
+            lonlat = (double*)REALLOC( lonlat, lonlat_size * 2 * sizeof( double ) );
+        }
+        lonlat[ overlay->count * 2 ] = lon;
+        lonlat[ overlay->count * 2 + 1 ] = lat;
+        osm_map_overlay_add_point( overlay, lon, lat );
+    }
+    fclose( file );
+    if ( !overlay || overlay->count < 2 ) {
+        OSM_MAP_OVERLAY_ERROR_LOG("no bench track in %s", file_name );
+        if ( overlay ) {
+            osm_map_overlay_free( overlay );
+            free( overlay->out );
+            free( overlay->out_old );
+            free( overlay );
+        }
+        free( lonlat );
+        return;
+    }
+    uint32_t count = overlay->count;
+    /**
+     * projection per point, double trig like the tile math against the world coords shift
+     */
+    volatile int64_t sink = 0;
+    uint64_t start = osm_map_overlay_now();
+    for( int round = 0 ; round < OSM_MAP_OVERLAY_BENCH_ROUNDS ; round++ ) {
+        double size = (double)OSM_MAP_VIEW_TILE_SIZE * ( 1 << 16 );
+        for( uint32_t i = 0 ; i < count ; i++ ) {
+            double x = ( lonlat[ i * 2 ] + 180.0 ) / 360.0 * size;
+            double y = ( 1.0 - asinh( tan( lonlat[ i * 2 + 1 ] * M_PI / 180.0 ) ) / M_PI ) / 2.0 * size;
+            sink += (int64_t)x + (int64_t)y;
+        }
+    }
+    uint64_t trig_time = osm_map_overlay_now() - start;
+    start = osm_map_overlay_now();
+    for( int round = 0 ; round < OSM_MAP_OVERLAY_BENCH_ROUNDS ; round++ ) {
+        for( uint32_t i = 0 ; i < count ; i++ ) {
+            sink += osm_map_overlay_project( overlay->point[ i ].x, OSM_MAP_OVERLAY_WORLD_SHIFT - 16, 0, LV_IMG_ZOOM_NONE ) + osm_map_overlay_project( overlay->point[ i ].y, OSM_MAP_OVERLAY_WORLD_SHIFT - 16, 0, LV_IMG_ZOOM_NONE );
+        }
+    }
+    uint64_t shift_time = osm_map_overlay_now() - start;
+    OSM_MAP_OVERLAY_INFO_LOG("overlay bench: %d points, projection double trig %.1fns, fixed point %.1fns per point",
+                                count,
+                                trig_time * 1000.0 / count / OSM_MAP_OVERLAY_BENCH_ROUNDS,
+                                shift_time * 1000.0 / count / OSM_MAP_OVERLAY_BENCH_ROUNDS );
+    /**
+     * rebuild with the grid around the middle point at all zoom levels
+     */
+    osm_map_overlay_point_t center = overlay->point[ count / 2 ];
+    for( uint32_t zoom = 10 ; zoom <= 18 ; zoom++ ) {
+        uint32_t shift = OSM_MAP_OVERLAY_WORLD_SHIFT - zoom;
+        int32_t tilex = ( center.x >> shift ) / OSM_MAP_VIEW_TILE_SIZE - OSM_MAP_VIEW_GRID / 2;
+        int32_t tiley = ( center.y >> shift ) / OSM_MAP_VIEW_TILE_SIZE - OSM_MAP_VIEW_GRID / 2;
+        overlay->stats = osm_map_overlay_stats_t();
+        overlay->valid = false;
+        osm_map_overlay_draw( overlay, zoom, tilex, tiley, LV_IMG_ZOOM_NONE );
+        OSM_MAP_OVERLAY_INFO_LOG("overlay bench: zoom %2d, %5d visible points, %4d drawn in %2d lines with %dpx tolerance, rebuild %.2fms",
+                                    zoom,
+                                    overlay->stats.visible,
+                                    overlay->stats.drawn,
+                                    overlay->stats.runs,
+                                    overlay->tolerance,
+                                    overlay->stats.rebuild_time / 1000.0 );
+    }
+    /**
+     * point by point at zoom 16 with the grid around the last point like the view,
+     * append against a rebuild for every point
+     */
+    uint32_t zoom = 16;
+    uint32_t shift = OSM_MAP_OVERLAY_WORLD_SHIFT - zoom;
+    uint32_t points = count < OSM_MAP_OVERLAY_BENCH_POINTS ? count : OSM_MAP_OVERLAY_BENCH_POINTS;
+    uint64_t time[ 2 ] = { 0, 0 };
+    uint32_t drawn[ 2 ] = { 0, 0 };
+    uint32_t rebuilds = 0, extends = 0;
+    for( int mode = 0 ; mode < 2 ; mode++ ) {
+        overlay->stats = osm_map_overlay_stats_t();
+        overlay->valid = false;
+        start = osm_map_overlay_now();
+        for( uint32_t n = 2 ; n <= points ; n++ ) {
+            int32_t tilex = ( overlay->point[ n - 1 ].x >> shift ) / OSM_MAP_VIEW_TILE_SIZE - OSM_MAP_VIEW_GRID / 2;
+            int32_t tiley = ( overlay->point[ n - 1 ].y >> shift ) / OSM_MAP_VIEW_TILE_SIZE - OSM_MAP_VIEW_GRID / 2;
+            overlay->count = n;
+            if ( mode ) {
+                overlay->valid = false;
+            }
+            osm_map_overlay_draw( overlay, zoom, tilex, tiley, LV_IMG_ZOOM_NONE );
+        }
+        time[ mode ] = osm_map_overlay_now() - start;
+        drawn[ mode ] = overlay->out_count;
+        if ( !mode ) {
+            rebuilds = overlay->stats.rebuilds;
+            extends = overlay->stats.extends;
+        }
+    }
+    overlay->count = count;
+    OSM_MAP_OVERLAY_INFO_LOG("overlay bench: %d points one by one at zoom %d, append %.2fms (%d rebuilds, %d extends, %d drawn), rebuild every point %.2fms (%d drawn)",
+                                points,
+                                zoom,
+                                time[ 0 ] / 1000.0, rebuilds, extends, drawn[ 0 ],
+                                time[ 1 ] / 1000.0, drawn[ 1 ] );
+    (void)sink;
+    osm_map_overlay_free( overlay );
+    free( overlay->out );
+    free( overlay->out_old );
+    free( overlay );
+    free( lonlat );
+#endif
+}
@@ -0,0 +1,147 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _OSM_MAP_OVERLAY_H
+    #define _OSM_MAP_OVERLAY_H
+
+    #include "lvgl.h"
+    #include "osm_map_view.h"
+
+    #define OSM_MAP_OVERLAY_INFO_LOG        log_i
+    #define OSM_MAP_OVERLAY_LOG             log_d
+    #define OSM_MAP_OVERLAY_ERROR_LOG       log_e
+
+    #define OSM_MAP_OVERLAY_LINES           32                  /** @brief lv_line objs per overlay, one per visible run or chunk of the polyline */
+    #define OSM_MAP_OVERLAY_CHUNK           128                 /** @brief max points per line obj, a append only invalidates the last chunk */
+    #define OSM_MAP_OVERLAY_MAX_ZOOM        20                  /** @brief no overlay above this zoom, grid px have to fit into 32 bit */
+    #define OSM_MAP_OVERLAY_TOLERANCE       1                   /** @brief simplify tolerance in px at the current zoom */
+    #define OSM_MAP_OVERLAY_MAX_TOLERANCE   8                   /** @brief max tolerance in px if the line objs are not enough, then the oldest points are dropped */
+    #define OSM_MAP_OVERLAY_WINDOW          64                  /** @brief max points one appended segment stands for */
+    #define OSM_MAP_OVERLAY_WORLD_SHIFT     24                  /** @brief world coords have 32 bit, tile px at zoom z are world >> ( 24 - z ) */
+    #define OSM_MAP_OVERLAY_BENCH_ENV       "HEDGE_OSM_MAP_OVERLAY_BENCH"   /** @brief env var with a "lat lon" per line track file for the native bench */
+    #define OSM_MAP_OVERLAY_BENCH_ROUNDS    20                  /** @brief projection rounds in the native bench */
+    #define OSM_MAP_OVERLAY_BENCH_POINTS    4000                /** @brief max points for the point by point bench, a rebuild per point is quadratic */
+    /**
+     * @brief a point in web mercator world coords, the whole world is 2^32 in both directions
+     */
+    typedef struct {
+        uint32_t x;                             /** @brief world x, 0 is 180 degree west */
+        uint32_t y;                             /** @brief world y, 0 is the north end of the map */
+    } osm_map_overlay_point_t;
+    /**
+     * @brief overlay statistics, all times in us
+     */
+    typedef struct {
+        uint32_t rebuilds = 0;                  /** @brief full reprojections with simplify */
+        uint32_t appends = 0;                   /** @brief points drawn without a rebuild */
+        uint32_t extends = 0;                   /** @brief appended points that moved the last segment end */
+        uint32_t drawn = 0;                     /** @brief polyline points of the last rebuild after simplify and clip */
+        uint32_t runs = 0;                      /** @brief line objs used by the last rebuild */
+        uint32_t visible = 0;                   /** @brief points in visible runs of the last rebuild */
+        uint32_t coarser = 0;                   /** @brief simplify rounds repeated with a doubled tolerance or less points */
+        uint64_t rebuild_time = 0;              /** @brief sum of rebuild times */
+        uint32_t max_rebuild_time = 0;          /** @brief max rebuild time */
+    } osm_map_overlay_stats_t;
+    /**
+     * @brief a polyline on top of the tiles of a map view, the line objs are children
+     * of the grid container and move with it, only a grid shift or a new zoom reprojects
+     */
+    typedef struct {
+        osm_map_view_t *view = NULL;            /** @brief map view */
+        lv_style_t style;                       /** @brief line style */
+        lv_obj_t *line[ OSM_MAP_OVERLAY_LINES ];    /** @brief line objs */
+        const lv_point_t *line_points[ OSM_MAP_OVERLAY_LINES ]; /** @brief points set into the line obj */
+        uint16_t line_count[ OSM_MAP_OVERLAY_LINES ];           /** @brief point count set into the line obj */
+        osm_map_overlay_point_t *point = NULL;  /** @brief polyline in world coords */
+        uint32_t count = 0;                     /** @brief points in the polyline */
+        uint32_t size = 0;                      /** @brief allocated points */
+        lv_point_t *out = NULL;                 /** @brief simplified and clipped runs in grid px */
+        uint32_t out_count = 0;                 /** @brief points in out */
+        uint32_t out_size = 0;                  /** @brief allocated out points */
+        lv_point_t *out_old = NULL;             /** @brief out before it grew, line objs may still point into it */
+        uint32_t run_start[ OSM_MAP_OVERLAY_LINES ];    /** @brief first out point of a run */
+        uint32_t runs = 0;                      /** @brief runs in out */
+        int32_t *px = NULL;                     /** @brief rebuild scratch, projected points */
+        uint32_t *stack = NULL;                 /** @brief rebuild scratch, simplify stack */
+        uint8_t *keep = NULL;                   /** @brief rebuild scratch, 1 for a kept point, 2 for the first point of a run */
+        uint32_t scratch_size = 0;              /** @brief allocated scratch points */
+        bool valid = false;                     /** @brief out matches the projection below */
+        bool open = false;                      /** @brief the last run ends with the last point and can be extended */
+        uint32_t dirty = 0xffffffff;            /** @brief first run with moved points since the last apply */
+        uint32_t drawn_count = 0;               /** @brief points in out */
+        uint32_t anchor = 0;                    /** @brief point of the second last out point of a open run */
+        uint32_t tolerance = OSM_MAP_OVERLAY_TOLERANCE; /** @brief simplify tolerance in px of the last rebuild */
+        uint32_t zoom = 0;                      /** @brief projection zoom */
+        int32_t tilex = 0;                      /** @brief projection top left tile x */
+        int32_t tiley = 0;                      /** @brief projection top left tile y */
+        uint16_t img_zoom = 256;                /** @brief projection lvgl image zoom, 256 is 1:1 */
+        osm_map_overlay_stats_t stats;          /** @brief statistics */
+    } osm_map_overlay_t;
+    /**
+     * @brief create a polyline overlay on a map view, overlays created later are on top
+     *
+     * @param   view    pointer to the map view
+     * @param   color   line color
+     * @param   width   line width in px
+     *
+     * @return  pointer to the overlay, NULL if failed
+     */
+    osm_map_overlay_t *osm_map_overlay_create( osm_map_view_t *view, lv_color_t color, lv_coord_t width );
+    /**
+     * @brief add a point to the end of the polyline, drawn on the next update
+     *
+     * @param   overlay pointer to the overlay
+     * @param   lon     longitude
+     * @param   lat     latitude
+     *
+     * @return  true if added
+     */
+    bool osm_map_overlay_add_point( osm_map_overlay_t *overlay, double lon, double lat );
+    /**
+     * @brief remove all points and free the polyline
+     *
+     * @param   overlay pointer to the overlay
+     */
+    void osm_map_overlay_clear( osm_map_overlay_t *overlay );
+    /**
+     * @brief redraw the overlay after a view update, new points are appended
+     * to the drawn polyline, a new grid or zoom reprojects and simplifies
+     *
+     * @param   overlay pointer to the overlay
+     *
+     * @return  true if the line objs changed
+     */
+    bool osm_map_overlay_update( osm_map_overlay_t *overlay );
+    /**
+     * @brief get the overlay statistics
+     *
+     * @param   overlay pointer to the overlay
+     *
+     * @return  pointer to a osm_map_overlay_stats_t structure, NULL if overlay not set
+     */
+    osm_map_overlay_stats_t *osm_map_overlay_get_stats( osm_map_overlay_t *overlay );
+    /**
+     * @brief project and simplify the track file given by HEDGE_OSM_MAP_OVERLAY_BENCH
+     * at all zoom levels and log the times, only on native
+     */
+    void osm_map_overlay_bench( void );
+
+#endif // _OSM_MAP_OVERLAY_H
@@ -0,0 +1,505 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "osm_map_prefetch.h"
+#include "osm_map_store.h"
+#include "utils/lock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef NATIVE_64BIT
+    #include <time.h>
+    #include "utils/logging.h"
+#else
+    #include <Arduino.h>
+    #include <esp_timer.h>
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/semphr.h>
+#endif
+static lock_mutex_t osm_map_prefetch_mutex = LOCK_MUTEX_INITIALIZER;   /** @brief motion from the gps callback, steps from the load ahead task */
+
+#define OSM_MAP_PREFETCH_CANDIDATES     64                          /** @brief max candidate tiles per plan */
+#define OSM_MAP_PREFETCH_EARTH          40075016.686                /** @brief earth circumference in m */
+/**
+ * @brief motion in world units, the whole mercator map is 1.0 x 1.0
+ */
+typedef struct {
+    bool valid = false;                                             /** @brief a position is known */
+    bool moving = false;                                            /** @brief velocity is valid */
+    double x = 0;                                                   /** @brief last position */
+    double y = 0;                                                   /** @brief last position */
+    double vx = 0;                                                  /** @brief velocity per s */
+    double vy = 0;                                                  /** @brief velocity per s */
+    uint64_t time = 0;                                              /** @brief last position time in us */
+} osm_map_prefetch_motion_t;
+/**
+ * @brief what a plan was built for, a other key is a new plan
+ */
+typedef struct {
+    uint32_t zoom = 0;                                              /** @brief zoom level */
+    int32_t x = 0;                                                  /** @brief center tile x */
+    int32_t y = 0;                                                  /** @brief center tile y */
+    int32_t heading = -1;                                           /** @brief heading octant, -1 if not moving */
+    int32_t speed = 0;                                              /** @brief log2 of the speed in px/s */
+    osm_map_prefetch_mode_t mode = OSM_MAP_PREFETCH_PREDICTIVE;     /** @brief strategy */
+} osm_map_prefetch_key_t;
+
+static osm_map_prefetch_mode_t osm_map_prefetch_mode = OSM_MAP_PREFETCH_PREDICTIVE;
+static osm_map_prefetch_motion_t osm_map_prefetch_motion;
+static osm_map_prefetch_stats_t osm_map_prefetch_stats;
+
+static osm_map_prefetch_tile_t osm_map_prefetch_plan_tile[ OSM_MAP_PREFETCH_MAX_TILES ];
+static uri_load_job_t *osm_map_prefetch_plan_job[ OSM_MAP_PREFETCH_MAX_TILES ];
+static uint32_t osm_map_prefetch_plan_count = 0;
+static uint32_t osm_map_prefetch_plan_progress = 0;
+static bool osm_map_prefetch_plan_valid = false;
+static bool osm_map_prefetch_plan_throttled = false;               /** @brief the plan was cut by the bandwidth window */
+static osm_map_prefetch_key_t osm_map_prefetch_plan_key;
+static uint64_t osm_map_prefetch_window_start = 0;                  /** @brief bandwidth window start in us */
+
+static void osm_map_prefetch_get_key( osm_location_t *osm_location, osm_map_prefetch_key_t *key, double *center_x, double *center_y );
+static void osm_map_prefetch_cancel( void );
+#ifdef NATIVE_64BIT
+    static void osm_map_prefetch_replay( const char *track, osm_map_prefetch_mode_t mode );
+#endif
+
+static void osm_map_prefetch_lock( void ) {
+    lock_mutex_take( &osm_map_prefetch_mutex );
+}
+
+static void osm_map_prefetch_unlock( void ) {
+    lock_mutex_give( &osm_map_prefetch_mutex );
+}
+
+/**
+ * @brief get the prefetch clock in us, a replayed motion runs ahead of the real time
+ */
+static uint64_t osm_map_prefetch_now( void ) {
+#ifdef NATIVE_64BIT
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    uint64_t now = (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+#else
+    uint64_t now = esp_timer_get_time();
+#endif
+    return( now > osm_map_prefetch_motion.time ? now : osm_map_prefetch_motion.time );
+}
+
+void osm_map_prefetch_setup( void ) {
+#ifdef NATIVE_64BIT
+    const char *track = getenv( OSM_MAP_PREFETCH_REPLAY_ENV );
+    if ( track && *track ) {
+        osm_map_prefetch_replay( track, OSM_MAP_PREFETCH_NEIGHBOURS );
+        osm_map_prefetch_replay( track, OSM_MAP_PREFETCH_PREDICTIVE );
+        osm_map_prefetch_set_mode( OSM_MAP_PREFETCH_PREDICTIVE );
+    }
+#endif
+}
+
+void osm_map_prefetch_set_mode( osm_map_prefetch_mode_t mode ) {
+    osm_map_prefetch_lock();
+    osm_map_prefetch_mode = mode;
+    osm_map_prefetch_unlock();
+}
+
+osm_map_prefetch_mode_t osm_map_prefetch_get_mode( void ) {
+    return( osm_map_prefetch_mode );
+}
+
+osm_map_prefetch_stats_t *osm_map_prefetch_get_stats( void ) {
+    return( &osm_map_prefetch_stats );
+}
+
+void osm_map_prefetch_set_motion( double lon, double lat, double course, double speed, uint64_t time ) {
+    osm_map_prefetch_motion_t *motion = &osm_map_prefetch_motion;
+    double latrad = lat * M_PI / 180.0;
+    double x = ( lon + 180.0 ) / 360.0;
+    double y = ( 1.0 - asinh( tan( latrad ) ) / M_PI ) / 2.0;
+    /**
+     * meters per world unit at this latitude, the same in x and y
+     */
+    double meters = OSM_MAP_PREFETCH_EARTH * cos( latrad );
+
+    osm_map_prefetch_lock();
+    if ( !time ) {
+        time = osm_map_prefetch_now();
+    }
+    if ( course >= 0 && speed >= 0 && meters > 1 ) {
+        /**
+         * course and speed from the gps
+         */
+        motion->vx = speed * sin( course * M_PI / 180.0 ) / meters;
+        motion->vy = -speed * cos( course * M_PI / 180.0 ) / meters;
+        motion->moving = speed >= OSM_MAP_PREFETCH_MIN_SPEED;
+    }
+    else if ( motion->valid && time > motion->time && meters > 1 ) {
+        /**
+         * velocity from the last position, smoothed over two positions
+         */
+        double dt = ( time - motion->time ) / 1000000.0;
+        double dx = x - motion->x;
+        double dy = y - motion->y;
+        if ( dx > 0.5 ) dx -= 1.0;
+        if ( dx < -0.5 ) dx += 1.0;
+        double vx = dx / dt;
+        double vy = dy / dt;
+        double speed_mps = hypot( vx, vy ) * meters;
+
+        if ( dt > OSM_MAP_PREFETCH_MAX_AGE || speed_mps > OSM_MAP_PREFETCH_MAX_SPEED ) {
+            motion->vx = 0;
+            motion->vy = 0;
+            motion->moving = false;
+        }
+        else {
+            motion->vx = motion->moving ? ( motion->vx + vx ) / 2 : vx;
+            motion->vy = motion->moving ? ( motion->vy + vy ) / 2 : vy;
+            motion->moving = hypot( motion->vx, motion->vy ) * meters >= OSM_MAP_PREFETCH_MIN_SPEED;
+        }
+    }
+    motion->x = x;
+    motion->y = y;
+    motion->time = time;
+    motion->valid = true;
+    osm_map_prefetch_unlock();
+}
+
+/**
+ * @brief get the plan key and the view center in px, call with lock held
+ */
+static void osm_map_prefetch_get_key( osm_location_t *osm_location, osm_map_prefetch_key_t *key, double *center_x, double *center_y ) {
+    osm_map_prefetch_motion_t *motion = &osm_map_prefetch_motion;
+    uint32_t zoom = osm_map_get_zoom( osm_location );
+    double size = 256.0 * ( 1 << zoom );
+    /**
+     * the view center, the location or the middle of the manual nav tile
+     */
+    if ( osm_location->manual_nav ) {
+        *center_x = ( osm_location->tilex_manual_nav + 0.5 ) * 256.0;
+        *center_y = ( osm_location->tiley_manual_nav + 0.5 ) * 256.0;
+    }
+    else {
+        double latrad = osm_location->lat * M_PI / 180.0;
+        *center_x = ( osm_location->lon + 180.0 ) / 360.0 * size;
+        *center_y = ( 1.0 - asinh( tan( latrad ) ) / M_PI ) / 2.0 * size;
+    }
+    key->zoom = zoom;
+    key->x = (int32_t)floor( *center_x / 256.0 );
+    key->y = (int32_t)floor( *center_y / 256.0 );
+    key->mode = osm_map_prefetch_mode;
+    key->heading = -1;
+    key->speed = 0;
+    /**
+     * a manual nav view does not follow the motion
+     */
+    bool fresh = motion->valid && osm_map_prefetch_now() - motion->time < OSM_MAP_PREFETCH_MAX_AGE * 1000000ULL;
+    if ( motion->moving && fresh && !osm_location->manual_nav ) {
+        double speed = hypot( motion->vx, motion->vy ) * size;
+        key->heading = (int32_t)floor( ( atan2( motion->vy, motion->vx ) + M_PI ) / ( M_PI / 4 ) + 0.5 ) & 7;
+        key->speed = (int32_t)log2( speed > 1 ? speed : 1 );
+    }
+}
+
+uint32_t osm_map_prefetch_plan( osm_location_t *osm_location, osm_map_prefetch_tile_t *plan, uint32_t size ) {
+    static const int32_t neighbour_offset[ OSM_MAP_LOAD_AHEAD_TILES ][ 2 ] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+    osm_map_prefetch_tile_t candidate[ OSM_MAP_PREFETCH_CANDIDATES ];
+    uint32_t count = 0;
+    osm_map_prefetch_key_t key;
+    double center_x, center_y;
+    /**
+     * check if osm_location set
+     */
+    if ( !osm_location || !plan || !size ) {
+        return( 0 );
+    }
+    osm_map_prefetch_get_key( osm_location, &key, &center_x, &center_y );
+    /**
+     * add a candidate or lower the time of a known one, cached tiles are skipped
+     */
+    auto add = [&]( uint32_t zoom, int32_t x, int32_t y, uint32_t time ) {
+        if ( y < 0 || y >= ( 1 << zoom ) ) {
+            return;
+        }
+        for( uint32_t i = 0 ; i < count ; i++ ) {
+            if ( candidate[ i ].zoom == zoom && candidate[ i ].x == x && candidate[ i ].y == y ) {
+                if ( time < candidate[ i ].time )
+                    candidate[ i ].time = time;
+                return;
+            }
+        }
+        if ( count >= OSM_MAP_PREFETCH_CANDIDATES || osm_map_is_tile_cached( osm_location, zoom, x, y ) ) {
+            return;
+        }
+        candidate[ count ].zoom = zoom;
+        candidate[ count ].x = x;
+        candidate[ count ].y = y;
+        candidate[ count ].time = time;
+        count++;
+    };
+
+    if ( key.mode == OSM_MAP_PREFETCH_NEIGHBOURS ) {
+        for( int i = 0 ; i < OSM_MAP_LOAD_AHEAD_TILES ; i++ ) {
+            add( key.zoom, key.x + neighbour_offset[ i ][ 0 ], key.y + neighbour_offset[ i ][ 1 ], 0 );
+        }
+    }
+    else {
+        /**
+         * walk the projected track, every tile the view grid needs on
+         * the way is a candidate, ranked by the time it comes into view
+         */
+        if ( key.heading >= 0 ) {
+            double size_px = 256.0 * ( 1 << key.zoom );
+            double vx = osm_map_prefetch_motion.vx * size_px;
+            double vy = osm_map_prefetch_motion.vy * size_px;
+            double dt = OSM_MAP_PREFETCH_MAX_STEP_PX / hypot( vx, vy );
+            if ( dt > OSM_MAP_PREFETCH_STEP )
+                dt = OSM_MAP_PREFETCH_STEP;
+
+            for( double t = dt ; t <= OSM_MAP_PREFETCH_HORIZON && count < OSM_MAP_PREFETCH_CANDIDATES ; t += dt ) {
+                int32_t tilex = (int32_t)floor( ( center_x + vx * t ) / 256.0 );
+                int32_t tiley = (int32_t)floor( ( center_y + vy * t ) / 256.0 );
+                for( int32_t y = -OSM_MAP_PREFETCH_GRID / 2 ; y <= OSM_MAP_PREFETCH_GRID / 2 ; y++ ) {
+                    for( int32_t x = -OSM_MAP_PREFETCH_GRID / 2 ; x <= OSM_MAP_PREFETCH_GRID / 2 ; x++ ) {
+                        add( key.zoom, tilex + x, tiley + y, (uint32_t)ceil( t ) );
+                    }
+                }
+            }
+        }
+        /**
+         * the tiles under the center one zoom level up and down
+         */
+        if ( key.zoom < 18 ) {
+            add( key.zoom + 1, (int32_t)floor( center_x * 2 / 256.0 ), (int32_t)floor( center_y * 2 / 256.0 ), OSM_MAP_PREFETCH_ZOOM_TIME );
+        }
+        if ( key.zoom > 2 ) {
+            add( key.zoom - 1, (int32_t)floor( center_x / 2 / 256.0 ), (int32_t)floor( center_y / 2 / 256.0 ), OSM_MAP_PREFETCH_ZOOM_TIME );
+        }
+    }
+    /**
+     * sort by time to visible, insertion sort keeps the track order for equal times
+     */
+    for( uint32_t i = 1 ; i < count ; i++ ) {
+        osm_map_prefetch_tile_t tile = candidate[ i ];
+        uint32_t j = i;
+        while( j > 0 && candidate[ j - 1 ].time > tile.time ) {
+            candidate[ j ] = candidate[ j - 1 ];
+            j--;
+        }
+        candidate[ j ] = tile;
+    }
+    if ( count > size )
+        count = size;
+    for( uint32_t i = 0 ; i < count ; i++ ) {
+        plan[ i ] = candidate[ i ];
+    }
+    return( count );
+}
+
+/**
+ * @brief cancel the downloads of the current plan, call with lock held
+ */
+static void osm_map_prefetch_cancel( void ) {
+    for( uint32_t i = 0 ; i < OSM_MAP_PREFETCH_MAX_TILES ; i++ ) {
+        uri_load_sched_cancel( osm_map_prefetch_plan_job[ i ] );
+        osm_map_prefetch_plan_job[ i ] = NULL;
+    }
+    osm_map_prefetch_plan_count = 0;
+    osm_map_prefetch_plan_progress = 0;
+}
+
+void osm_map_prefetch_reset( void ) {
+    osm_map_prefetch_lock();
+    osm_map_prefetch_cancel();
+    osm_map_prefetch_plan_valid = false;
+    osm_map_prefetch_unlock();
+}
+
+bool osm_map_prefetch_step( osm_location_t *osm_location ) {
+    osm_map_prefetch_key_t key;
+    double center_x, center_y;
+    /**
+     * check if osm_location set
+     */
+    if ( !osm_location ) {
+        return( false );
+    }
+    osm_map_prefetch_lock();
+    /**
+     * a new bandwidth window
+     */
+    uint64_t now = osm_map_prefetch_now();
+    bool new_window = now - osm_map_prefetch_window_start >= OSM_MAP_PREFETCH_WINDOW * 1000000ULL;
+    if ( new_window ) {
+        osm_map_prefetch_window_start = now;
+        osm_map_prefetch_stats.window_bytes = 0;
+    }
+    /**
+     * replan on a new center tile, zoom, heading or speed, or when a cut plan can go on
+     */
+    osm_map_prefetch_get_key( osm_location, &key, &center_x, &center_y );
+    if ( !osm_map_prefetch_plan_valid || memcmp( &key, &osm_map_prefetch_plan_key, sizeof( key ) ) || ( osm_map_prefetch_plan_throttled && new_window ) ) {
+        osm_map_prefetch_cancel();
+        osm_map_prefetch_plan_key = key;
+        osm_map_prefetch_plan_valid = true;
+        osm_map_prefetch_plan_throttled = false;
+        osm_map_prefetch_plan_count = osm_map_prefetch_plan( osm_location, osm_map_prefetch_plan_tile, OSM_MAP_PREFETCH_MAX_TILES );
+        osm_map_prefetch_stats.plans++;
+        /**
+         * queue the downloads at once in rank order, the bandwidth window
+         * cuts the plan, the tile size is estimated from the cache
+         */
+        osm_map_cache_stats_t *cache = osm_map_get_cache_stats( osm_location );
+        uint32_t estimate = cache->entries ? cache->bytes / cache->entries : OSM_MAP_PREFETCH_TILE_BYTES;
+        for( uint32_t i = 0 ; i < osm_map_prefetch_plan_count ; i++ ) {
+            osm_map_prefetch_tile_t *tile = &osm_map_prefetch_plan_tile[ i ];
+            if ( osm_map_prefetch_stats.window_bytes + estimate > OSM_MAP_PREFETCH_WINDOW_BYTES ) {
+                osm_map_prefetch_stats.throttled += osm_map_prefetch_plan_count - i;
+                osm_map_prefetch_plan_count = i;
+                osm_map_prefetch_plan_throttled = true;
+                break;
+            }
+            osm_map_prefetch_plan_job[ i ] = osm_map_request_tile( osm_location, tile->zoom, tile->x, tile->y, URI_LOAD_PRIO_PREFETCH );
+            if ( osm_map_prefetch_plan_job[ i ] ) {
+                osm_map_prefetch_stats.requested++;
+                osm_map_prefetch_stats.window_bytes += estimate;
+            }
+        }
+        OSM_MAP_PREFETCH_LOG("plan %d tiles at %d/%d/%d, heading %d", osm_map_prefetch_plan_count, key.zoom, key.x, key.y, key.heading );
+    }
+    /**
+     * load one planned tile, the queued downloads run meanwhile
+     */
+    if ( osm_map_prefetch_plan_progress >= osm_map_prefetch_plan_count ) {
+        osm_map_prefetch_unlock();
+        return( false );
+    }
+    uint32_t progress = osm_map_prefetch_plan_progress++;
+    osm_map_prefetch_tile_t tile = osm_map_prefetch_plan_tile[ progress ];
+    uri_load_job_t *job = osm_map_prefetch_plan_job[ progress ];
+    osm_map_prefetch_plan_job[ progress ] = NULL;
+    osm_map_prefetch_unlock();
+
+    uri_load_dsc_t *uri_load_dsc = osm_map_get_tile( osm_location, tile.zoom, tile.x, tile.y, URI_LOAD_PRIO_PREFETCH, NULL );
+    uri_load_sched_cancel( job );
+
+    osm_map_prefetch_lock();
+    if ( uri_load_dsc ) {
+        osm_map_prefetch_stats.loaded++;
+        osm_map_prefetch_stats.bytes += uri_load_dsc->size;
+    }
+    osm_map_prefetch_unlock();
+
+    return( true );
+}
+
+#ifdef NATIVE_64BIT
+/**
+ * @brief replay a track with one position per second, the tiles the view grid
+ * needs on a new center tile are hits if the prefetch has loaded them before
+ */
+static void osm_map_prefetch_replay( const char *track, osm_map_prefetch_mode_t mode ) {
+    static const char *mode_name[] = { "neighbours", "predictive" };
+    char line[ 128 ] = "";
+
+    FILE *file = fopen( track, "r" );
+    if ( !file ) {
+        OSM_MAP_PREFETCH_ERROR_LOG("can't open track %s", track );
+        return;
+    }
+    osm_location_t *osm_location = osm_map_create_location_obj();
+    if ( !osm_location ) {
+        fclose( file );
+        return;
+    }
+    if ( getenv( OSM_MAP_STORE_SERVER_ENV ) ) {
+        osm_map_set_tile_server( osm_location, getenv( OSM_MAP_STORE_SERVER_ENV ) );
+    }
+    /**
+     * the tile store would turn the misses of the second run into fast loads
+     */
+    bool store_enable = osm_map_store_get_enable();
+    osm_map_store_set_enable( false );
+    osm_map_prefetch_set_mode( mode );
+    osm_map_prefetch_reset();
+    osm_map_prefetch_stats_t start_stats = osm_map_prefetch_stats;
+
+    uint64_t time = osm_map_prefetch_now();
+    uint32_t points = 0, needed = 0, hits = 0;
+    int32_t last_x = INT32_MIN, last_y = INT32_MIN;
+    uint32_t zoom = osm_map_get_zoom( osm_location );
+
+    while( fgets( line, sizeof( line ), file ) ) {
+        double lat = 0, lon = 0;
+        if ( *line == '#' || sscanf( line, "%lf %lf", &lat, &lon ) != 2 ) {
+            continue;
+        }
+        time += 1000000ULL;
+        points++;
+        osm_map_set_lon_lat( osm_location, lon, lat );
+        osm_map_prefetch_set_motion( lon, lat, -1, -1, time );
+        /**
+         * the view grid around the center tile, count the tiles that come into the grid
+         */
+        double latrad = lat * M_PI / 180.0;
+        int32_t center_x = (int32_t)floor( ( lon + 180.0 ) / 360.0 * ( 1 << zoom ) );
+        int32_t center_y = (int32_t)floor( ( 1.0 - asinh( tan( latrad ) ) / M_PI ) / 2.0 * ( 1 << zoom ) );
+        if ( center_x != last_x || center_y != last_y ) {
+            for( int32_t y = center_y - OSM_MAP_PREFETCH_GRID / 2 ; y <= center_y + OSM_MAP_PREFETCH_GRID / 2 ; y++ ) {
+                for( int32_t x = center_x - OSM_MAP_PREFETCH_GRID / 2 ; x <= center_x + OSM_MAP_PREFETCH_GRID / 2 ; x++ ) {
+                    if ( abs( x - last_x ) <= OSM_MAP_PREFETCH_GRID / 2 && abs( y - last_y ) <= OSM_MAP_PREFETCH_GRID / 2 ) {
+                        continue;
+                    }
+                    needed++;
+                    if ( osm_map_is_tile_cached( osm_location, zoom, x, y ) ) {
+                        hits++;
+                    }
+                    else {
+                        osm_map_get_tile( osm_location, zoom, x, y, URI_LOAD_PRIO_VISIBLE, NULL );
+                    }
+                }
+            }
+            last_x = center_x;
+            last_y = center_y;
+        }
+        /**
+         * the prefetch has a second until the next position
+         */
+        while( osm_map_prefetch_step( osm_location ) );
+    }
+    fclose( file );
+
+    osm_map_prefetch_stats_t *stats = &osm_map_prefetch_stats;
+    OSM_MAP_PREFETCH_INFO_LOG("%s prefetch replay: %u points, %u tiles came into view, %u prefetched (%u%%)", mode_name[ mode ], points, needed, hits, needed ? hits * 100 / needed : 0 );
+    OSM_MAP_PREFETCH_INFO_LOG("  %u plans, %u requested, %u loaded, %llu bytes, %u throttled",
+                                stats->plans - start_stats.plans,
+                                stats->requested - start_stats.requested,
+                                stats->loaded - start_stats.loaded,
+                                (unsigned long long)( stats->bytes - start_stats.bytes ),
+                                stats->throttled - start_stats.throttled );
+
+    osm_map_prefetch_reset();
+    osm_map_clear_cache( osm_location );
+    osm_map_store_set_enable( store_enable );
+}
+#endif
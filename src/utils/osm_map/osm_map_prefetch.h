@@ -0,0 +1,127 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _OSM_MAP_PREFETCH_H
+    #define _OSM_MAP_PREFETCH_H
+
+    #include "osm_map.h"
+
+    #define OSM_MAP_PREFETCH_INFO_LOG       log_i
+    #define OSM_MAP_PREFETCH_LOG            log_d
+    #define OSM_MAP_PREFETCH_ERROR_LOG      log_e
+
+    #define OSM_MAP_PREFETCH_GRID           3               /** @brief tiles per row and column the view needs around the center tile */
+    #define OSM_MAP_PREFETCH_HORIZON        60              /** @brief project the position up to s ahead */
+    #define OSM_MAP_PREFETCH_STEP           2               /** @brief max s between two projected positions */
+    #define OSM_MAP_PREFETCH_MAX_STEP_PX    64              /** @brief max movement in px between two projected positions */
+    #define OSM_MAP_PREFETCH_MIN_SPEED      0.5             /** @brief below m/s the direction is unknown */
+    #define OSM_MAP_PREFETCH_MAX_SPEED      120             /** @brief above m/s two positions are a jump, not a motion */
+    #define OSM_MAP_PREFETCH_MAX_AGE        10              /** @brief a motion older than s is stale */
+    #define OSM_MAP_PREFETCH_ZOOM_TIME      20              /** @brief time to visible in s of tiles on the adjacent zoom levels */
+    #define OSM_MAP_PREFETCH_MAX_TILES      12              /** @brief max planned tiles */
+    #define OSM_MAP_PREFETCH_WINDOW         10              /** @brief bandwidth window in s */
+    #define OSM_MAP_PREFETCH_WINDOW_BYTES   ( 160 * 1024 )  /** @brief max prefetch bytes per window */
+    #define OSM_MAP_PREFETCH_TILE_BYTES     ( 16 * 1024 )   /** @brief estimated tile size without cached tiles */
+    #define OSM_MAP_PREFETCH_REPLAY_ENV     "HEDGE_OSM_MAP_PREFETCH_REPLAY"     /** @brief env var with a "lat lon" per line and second track file on native */
+    /**
+     * @brief prefetch strategy
+     */
+    typedef enum {
+        OSM_MAP_PREFETCH_NEIGHBOURS = 0,            /** @brief the four direct neighbours of the center tile */
+        OSM_MAP_PREFETCH_PREDICTIVE                 /** @brief tiles along the projected track and the adjacent zoom levels */
+    } osm_map_prefetch_mode_t;
+    /**
+     * @brief a planned tile
+     */
+    typedef struct {
+        uint32_t zoom = 0;                          /** @brief zoom level */
+        int32_t x = 0;                              /** @brief tile x */
+        int32_t y = 0;                              /** @brief tile y */
+        uint32_t time = 0;                          /** @brief time to visible in s, the rank */
+    } osm_map_prefetch_tile_t;
+    /**
+     * @brief prefetch statistics
+     */
+    typedef struct {
+        uint32_t plans = 0;                         /** @brief built plans */
+        uint32_t requested = 0;                     /** @brief tile downloads started */
+        uint32_t loaded = 0;                        /** @brief tiles loaded into the cache */
+        uint32_t throttled = 0;                     /** @brief tiles skipped by the bandwidth window */
+        uint32_t window_bytes = 0;                  /** @brief bytes in the current window */
+        uint64_t bytes = 0;                         /** @brief loaded bytes */
+    } osm_map_prefetch_stats_t;
+    /**
+     * @brief setup prefetch, on native a track given by HEDGE_OSM_MAP_PREFETCH_REPLAY is replayed
+     */
+    void osm_map_prefetch_setup( void );
+    /**
+     * @brief set the prefetch strategy
+     *
+     * @param   mode    OSM_MAP_PREFETCH_NEIGHBOURS or OSM_MAP_PREFETCH_PREDICTIVE
+     */
+    void osm_map_prefetch_set_mode( osm_map_prefetch_mode_t mode );
+    /**
+     * @brief get the prefetch strategy
+     *
+     * @return  current osm_map_prefetch_mode_t
+     */
+    osm_map_prefetch_mode_t osm_map_prefetch_get_mode( void );
+    /**
+     * @brief feed a new position, the velocity is taken from course and speed or from the last position
+     *
+     * @param   lon     longitude
+     * @param   lat     latitude
+     * @param   course  course over ground in degree, negative if unknown
+     * @param   speed   speed in m/s, negative if unknown
+     * @param   time    position time in us, 0 for now
+     */
+    void osm_map_prefetch_set_motion( double lon, double lat, double course, double speed, uint64_t time );
+    /**
+     * @brief build the ranked tile plan around the current view center
+     *
+     * @param   osm_location    pointer to the osm_location structure
+     * @param   plan            pointer to a tile array, OSM_MAP_PREFETCH_MAX_TILES fits all
+     * @param   size            array size
+     *
+     * @return  number of planned tiles, not cached tiles first by time to visible
+     */
+    uint32_t osm_map_prefetch_plan( osm_location_t *osm_location, osm_map_prefetch_tile_t *plan, uint32_t size );
+    /**
+     * @brief prefetch step, replans when the view or the motion has changed
+     * and loads one planned tile per call
+     *
+     * @param   osm_location    pointer to the osm_location structure
+     *
+     * @return  true if further steps are needed
+     */
+    bool osm_map_prefetch_step( osm_location_t *osm_location );
+    /**
+     * @brief drop the current plan and cancel its downloads
+     */
+    void osm_map_prefetch_reset( void );
+    /**
+     * @brief get the prefetch statistics
+     *
+     * @return  pointer to a osm_map_prefetch_stats_t structure
+     */
+    osm_map_prefetch_stats_t *osm_map_prefetch_get_stats( void );
+
+#endif // _OSM_MAP_PREFETCH_H
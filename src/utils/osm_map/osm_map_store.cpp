@@ -0,0 +1,724 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "osm_map.h"
+#include "osm_map_store.h"
+#include "utils/alloc.h"
+#include "utils/filepath_convert.h"
+#include "utils/lock.h"
+#include "utils/uri_load/uri_load_sched.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef NATIVE_64BIT
+    #include "utils/logging.h"
+    #include "utils/millis.h"
+#else
+    #include <Arduino.h>
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/semphr.h>
+#endif
+static lock_mutex_t osm_map_store_mutex = LOCK_MUTEX_INITIALIZER;      /** @brief tiles are loaded from the ui and the load ahead task */
+
+/**
+ * @brief in memory index of the store dir, built at first use
+ */
+typedef struct {
+    uint8_t ns;                                                     /** @brief namespace slot */
+    uint8_t zoom;                                                   /** @brief zoom level */
+    uint32_t x;                                                     /** @brief tile x */
+    uint32_t y;                                                     /** @brief tile y */
+    uint32_t size;                                                  /** @brief file size */
+    uint32_t last_used;                                             /** @brief use counter for lru eviction, starts with the newest file time */
+    uint32_t mtime;                                                 /** @brief fetch time in s, the file time */
+    int16_t hash_next;                                              /** @brief next slot in the hash chain, -1 for the end */
+} osm_map_store_entry_t;
+
+/**
+ * @brief a stale tile that is refetched in the background
+ */
+typedef struct {
+    uri_load_job_t *job;                                            /** @brief scheduler job, NULL if unused */
+    uint8_t ns;                                                     /** @brief namespace slot */
+    uint8_t zoom;                                                   /** @brief zoom level */
+    uint32_t x;                                                     /** @brief tile x */
+    uint32_t y;                                                     /** @brief tile y */
+} osm_map_store_refresh_t;
+
+static osm_map_store_entry_t *osm_map_store_index = NULL;
+static int16_t *osm_map_store_bucket = NULL;                        /** @brief first slot of every hash chain, -1 if empty */
+static osm_map_store_refresh_t osm_map_store_refresh[ OSM_MAP_STORE_REFRESH_JOBS ];
+static time_t osm_map_store_refresh_after = 0;                      /** @brief no refetches before, set after a failed one */
+static char osm_map_store_ns[ OSM_MAP_STORE_MAX_NS ][ OSM_MAP_STORE_NS_LEN ];
+static uint32_t osm_map_store_ns_count = 0;
+static osm_map_store_stats_t osm_map_store_stats;
+static uint32_t osm_map_store_use_counter = 0;
+static char osm_map_store_dir[ 128 ] = "";                          /** @brief empty until the index is built */
+static bool osm_map_store_available = true;                         /** @brief false if no sd card or the index alloc failed */
+static bool osm_map_store_enable = true;
+
+static bool osm_map_store_put( int ns_slot, uint32_t zoom, uint32_t x, uint32_t y, uri_load_dsc_t *uri_load_dsc, bool replace );
+#ifdef NATIVE_64BIT
+    static void osm_map_store_replay( const char *track );
+#endif
+
+static void osm_map_store_lock( void ) {
+    lock_mutex_take( &osm_map_store_mutex );
+}
+
+static void osm_map_store_unlock( void ) {
+    lock_mutex_give( &osm_map_store_mutex );
+}
+
+void osm_map_store_setup( void ) {
+#ifdef NATIVE_64BIT
+    const char *track = getenv( OSM_MAP_STORE_REPLAY_ENV );
+    if ( track && *track ) {
+        osm_map_store_replay( track );
+    }
+#endif
+}
+
+void osm_map_store_namespace( char *ns, size_t size, const char *name ) {
+    size_t len = 0;
+
+    if ( !ns || !size ) {
+        return;
+    }
+    /**
+     * lower case alnum, everything else is a single '_'
+     */
+    for( ; name && *name && len + 1 < size ; name++ ) {
+        char c = *name;
+        if ( c >= 'A' && c <= 'Z' )
+            c = c - 'A' + 'a';
+        if ( ( c >= 'a' && c <= 'z' ) || ( c >= '0' && c <= '9' ) )
+            ns[ len++ ] = c;
+        else if ( len && ns[ len - 1 ] != '_' )
+            ns[ len++ ] = '_';
+    }
+    ns[ len ] = '\0';
+}
+
+static void osm_map_store_path( char *path, size_t size, uint8_t ns, uint32_t zoom, uint32_t x, uint32_t y, bool tmp ) {
+    snprintf( path, size, "%s/%s/%u/%u/%u.png%s", osm_map_store_dir, osm_map_store_ns[ ns ], zoom, x, y, tmp ? ".tmp" : "" );
+}
+
+/**
+ * @brief find or add a namespace slot, -1 if the table is full
+ */
+static int osm_map_store_ns_slot( const char *ns, bool add ) {
+    for( uint32_t i = 0 ; i < osm_map_store_ns_count ; i++ ) {
+        if ( !strcmp( osm_map_store_ns[ i ], ns ) ) {
+            return( i );
+        }
+    }
+    if ( !add || osm_map_store_ns_count >= OSM_MAP_STORE_MAX_NS || strlen( ns ) >= OSM_MAP_STORE_NS_LEN ) {
+        return( -1 );
+    }
+    strcpy( osm_map_store_ns[ osm_map_store_ns_count ], ns );
+    return( osm_map_store_ns_count++ );
+}
+
+static uint32_t osm_map_store_hash( int ns, uint32_t zoom, uint32_t x, uint32_t y ) {
+    /**
+     * the same mix as the ram cache, neighbour tiles differ only in the low bits of x/y
+     */
+    uint32_t hash = ns ^ ( zoom * 0x9e3779b1u ) ^ ( x * 0x85ebca6bu ) ^ ( y * 0xc2b2ae35u );
+    hash ^= hash >> 16;
+    hash *= 0x7feb352du;
+    hash ^= hash >> 15;
+
+    return( hash & ( OSM_MAP_STORE_BUCKETS - 1 ) );
+}
+
+/**
+ * @brief find the index slot of a tile, -1 if not stored
+ */
+static int osm_map_store_find( int ns, uint32_t zoom, uint32_t x, uint32_t y ) {
+    int slot = osm_map_store_bucket[ osm_map_store_hash( ns, zoom, x, y ) ];
+
+    while( slot >= 0 ) {
+        osm_map_store_entry_t *entry = &osm_map_store_index[ slot ];
+        if ( entry->x == x && entry->y == y && entry->zoom == zoom && entry->ns == ns )
+            break;
+        slot = entry->hash_next;
+    }
+    return( slot );
+}
+
+static void osm_map_store_link( int slot ) {
+    osm_map_store_entry_t *entry = &osm_map_store_index[ slot ];
+    int16_t *bucket = &osm_map_store_bucket[ osm_map_store_hash( entry->ns, entry->zoom, entry->x, entry->y ) ];
+
+    entry->hash_next = *bucket;
+    *bucket = slot;
+}
+
+static void osm_map_store_unlink( int slot ) {
+    osm_map_store_entry_t *entry = &osm_map_store_index[ slot ];
+    int16_t *link = &osm_map_store_bucket[ osm_map_store_hash( entry->ns, entry->zoom, entry->x, entry->y ) ];
+
+    while( *link != slot ) {
+        link = &osm_map_store_index[ *link ].hash_next;
+    }
+    *link = entry->hash_next;
+}
+
+/**
+ * @brief add a index entry, the caller checked for a free slot
+ */
+static osm_map_store_entry_t *osm_map_store_add( int ns, uint32_t zoom, uint32_t x, uint32_t y, uint32_t size, uint32_t mtime ) {
+    int slot = osm_map_store_stats.entries++;
+    osm_map_store_entry_t *entry = &osm_map_store_index[ slot ];
+
+    entry->ns = ns;
+    entry->zoom = zoom;
+    entry->x = x;
+    entry->y = y;
+    entry->size = size;
+    entry->mtime = mtime;
+    entry->last_used = mtime;
+    osm_map_store_link( slot );
+    osm_map_store_stats.size += size;
+    return( entry );
+}
+
+static void osm_map_store_remove( int slot ) {
+    char path[ 192 ] = "";
+    osm_map_store_entry_t *entry = &osm_map_store_index[ slot ];
+
+    osm_map_store_path( path, sizeof( path ), entry->ns, entry->zoom, entry->x, entry->y, false );
+    remove( path );
+    /**
+     * drop the x dir if it was the last tile in it
+     */
+    *strrchr( path, '/' ) = '\0';
+    rmdir( path );
+
+    /**
+     * the last entry moves into the free slot
+     */
+    int last = osm_map_store_stats.entries - 1;
+    osm_map_store_unlink( slot );
+    osm_map_store_stats.size -= entry->size;
+    osm_map_store_stats.entries--;
+    if ( slot != last ) {
+        osm_map_store_unlink( last );
+        osm_map_store_index[ slot ] = osm_map_store_index[ last ];
+        osm_map_store_link( slot );
+    }
+}
+
+/**
+ * @brief add the tiles of one namespace dir, <ns>/<z>/<x>/<y>.png
+ */
+static void osm_map_store_scan_ns( int ns ) {
+    char path[ 192 ] = "";
+    struct dirent *z_entry = NULL, *x_entry = NULL, *y_entry = NULL;
+
+    snprintf( path, sizeof( path ), "%s/%s", osm_map_store_dir, osm_map_store_ns[ ns ] );
+    DIR *z_dir = opendir( path );
+    while( z_dir && ( z_entry = readdir( z_dir ) ) ) {
+        uint32_t zoom = atoi( z_entry->d_name );
+        if ( *z_entry->d_name < '0' || *z_entry->d_name > '9' ) {
+            continue;
+        }
+        snprintf( path, sizeof( path ), "%s/%s/%u", osm_map_store_dir, osm_map_store_ns[ ns ], zoom );
+        DIR *x_dir = opendir( path );
+        while( x_dir && ( x_entry = readdir( x_dir ) ) ) {
+            uint32_t x = atoi( x_entry->d_name );
+            if ( *x_entry->d_name < '0' || *x_entry->d_name > '9' ) {
+                continue;
+            }
+            snprintf( path, sizeof( path ), "%s/%s/%u/%u", osm_map_store_dir, osm_map_store_ns[ ns ], zoom, x );
+            DIR *y_dir = opendir( path );
+            while( y_dir && ( y_entry = readdir( y_dir ) ) ) {
+                char *end = NULL;
+                struct stat st;
+
+                uint32_t y = strtoul( y_entry->d_name, &end, 10 );
+                if ( end == y_entry->d_name || strncmp( end, ".png", 4 ) ) {
+                    continue;
+                }
+                /**
+                 * remove unfinished tiles
+                 */
+                osm_map_store_path( path, sizeof( path ), ns, zoom, x, y, end[ 4 ] != '\0' );
+                if ( end[ 4 ] ) {
+                    if ( !strcmp( end + 4, ".tmp" ) ) {
+                        remove( path );
+                    }
+                    continue;
+                }
+                if ( stat( path, &st ) ) {
+                    continue;
+                }
+                if ( osm_map_store_stats.entries >= OSM_MAP_STORE_MAX_ENTRIES ) {
+                    remove( path );
+                    continue;
+                }
+                osm_map_store_entry_t *entry = osm_map_store_add( ns, zoom, x, y, st.st_size, st.st_mtime );
+                if ( entry->last_used > osm_map_store_use_counter ) {
+                    osm_map_store_use_counter = entry->last_used;
+                }
+            }
+            if ( y_dir ) {
+                closedir( y_dir );
+            }
+        }
+        if ( x_dir ) {
+            closedir( x_dir );
+        }
+    }
+    if ( z_dir ) {
+        closedir( z_dir );
+    }
+}
+
+/**
+ * @brief choose the store dir and build the index from the files in it,
+ * call with lock held
+ */
+static bool osm_map_store_init( void ) {
+    if ( *osm_map_store_dir ) {
+        return( true );
+    }
+    if ( !osm_map_store_available ) {
+        return( false );
+    }
+#ifdef NATIVE_64BIT
+    filepath_convert( osm_map_store_dir, sizeof( osm_map_store_dir ), OSM_MAP_STORE_DIR );
+#else
+    /**
+     * tiles need room, spiffs is left to the uri_load cache
+     */
+    DIR *sd = opendir( "/sd" );
+    if ( !sd ) {
+        OSM_MAP_STORE_INFO_LOG("no sd card, tile store disabled");
+        osm_map_store_available = false;
+        return( false );
+    }
+    closedir( sd );
+    snprintf( osm_map_store_dir, sizeof( osm_map_store_dir ), "/" OSM_MAP_STORE_DIR );
+#endif
+    osm_map_store_index = (osm_map_store_entry_t*)MALLOC( sizeof( osm_map_store_entry_t ) * OSM_MAP_STORE_MAX_ENTRIES );
+    osm_map_store_bucket = (int16_t*)MALLOC( sizeof( int16_t ) * OSM_MAP_STORE_BUCKETS );
+    if ( !osm_map_store_index || !osm_map_store_bucket ) {
+        OSM_MAP_STORE_ERROR_LOG("tile store index alloc failed");
+        free( osm_map_store_index );
+        free( osm_map_store_bucket );
+        osm_map_store_index = NULL;
+        osm_map_store_bucket = NULL;
+        osm_map_store_available = false;
+        *osm_map_store_dir = '\0';
+        return( false );
+    }
+    for( int i = 0 ; i < OSM_MAP_STORE_BUCKETS ; i++ ) {
+        osm_map_store_bucket[ i ] = -1;
+    }
+    mkdir( osm_map_store_dir, 0700 );
+
+    DIR *dir = opendir( osm_map_store_dir );
+    if ( !dir ) {
+        OSM_MAP_STORE_ERROR_LOG("can't open tile store dir %s", osm_map_store_dir );
+        osm_map_store_available = false;
+        *osm_map_store_dir = '\0';
+        return( false );
+    }
+    /**
+     * every dir is a tile server namespace
+     */
+    struct dirent *entry = NULL;
+    while( ( entry = readdir( dir ) ) ) {
+        if ( *entry->d_name == '.' ) {
+            continue;
+        }
+        int ns = osm_map_store_ns_slot( entry->d_name, true );
+        if ( ns >= 0 ) {
+            osm_map_store_scan_ns( ns );
+        }
+    }
+    closedir( dir );
+    /**
+     * the newest file is used last, the clock may not be set yet
+     */
+    if ( time( NULL ) > (time_t)osm_map_store_use_counter ) {
+        osm_map_store_use_counter = time( NULL );
+    }
+    OSM_MAP_STORE_INFO_LOG("tile store %s: %d namespaces, %d tiles, %d bytes", osm_map_store_dir, osm_map_store_ns_count, osm_map_store_stats.entries, osm_map_store_stats.size );
+    return( true );
+}
+
+bool osm_map_store_contains( const char *ns, uint32_t zoom, uint32_t x, uint32_t y ) {
+    bool retval = false;
+
+    if ( !osm_map_store_enable || !ns || !*ns ) {
+        return( false );
+    }
+    osm_map_store_lock();
+    if ( osm_map_store_init() ) {
+        int slot = osm_map_store_ns_slot( ns, false );
+        retval = slot >= 0 && osm_map_store_find( slot, zoom, x, y ) >= 0;
+    }
+    osm_map_store_unlock();
+    return( retval );
+}
+
+/**
+ * @brief check if a tile is older than OSM_MAP_STORE_MAX_AGE, a unset clock
+ * makes no tile stale, call with lock held
+ */
+static bool osm_map_store_is_stale( osm_map_store_entry_t *entry ) {
+    time_t now = time( NULL );
+
+    return( now > (time_t)entry->mtime + OSM_MAP_STORE_MAX_AGE && now >= osm_map_store_refresh_after );
+}
+
+/**
+ * @brief refetch a stale tile in the background, the tile is replaced when
+ * the job is collected, call with lock held
+ */
+static void osm_map_store_refresh_start( int ns_slot, uint32_t zoom, uint32_t x, uint32_t y, const char *uri ) {
+    osm_map_store_refresh_t *refresh = NULL;
+
+    for( int i = 0 ; i < OSM_MAP_STORE_REFRESH_JOBS ; i++ ) {
+        osm_map_store_refresh_t *r = &osm_map_store_refresh[ i ];
+        if ( r->job && r->x == x && r->y == y && r->zoom == zoom && r->ns == ns_slot ) {
+            return;
+        }
+        if ( !r->job && !refresh ) {
+            refresh = r;
+        }
+    }
+    if ( !refresh ) {
+        return;
+    }
+    refresh->job = uri_load_sched_submit( uri, URI_LOAD_PRIO_BACKGROUND );
+    refresh->ns = ns_slot;
+    refresh->zoom = zoom;
+    refresh->x = x;
+    refresh->y = y;
+}
+
+/**
+ * @brief write finished refetches into the store, a failed one stops
+ * refetches for OSM_MAP_STORE_REFRESH_RETRY, call without lock
+ */
+static void osm_map_store_refresh_collect( void ) {
+    for( int i = 0 ; i < OSM_MAP_STORE_REFRESH_JOBS ; i++ ) {
+        osm_map_store_lock();
+        osm_map_store_refresh_t refresh = osm_map_store_refresh[ i ];
+        if ( !refresh.job || !uri_load_sched_is_done( refresh.job ) ) {
+            osm_map_store_unlock();
+            continue;
+        }
+        osm_map_store_refresh[ i ].job = NULL;
+        osm_map_store_unlock();
+        /**
+         * the job is done, this does not block
+         */
+        uri_load_dsc_t *uri_load_dsc = uri_load_sched_wait( refresh.job );
+        if ( !uri_load_dsc || !osm_map_store_put( refresh.ns, refresh.zoom, refresh.x, refresh.y, uri_load_dsc, true ) ) {
+            OSM_MAP_STORE_LOG("refetch of %s/%u/%u/%u failed", osm_map_store_ns[ refresh.ns ], refresh.zoom, refresh.x, refresh.y );
+            osm_map_store_lock();
+            osm_map_store_refresh_after = time( NULL ) + OSM_MAP_STORE_REFRESH_RETRY;
+            osm_map_store_unlock();
+        }
+        uri_load_free_all( uri_load_dsc );
+    }
+}
+
+uri_load_dsc_t *osm_map_store_load( const char *ns, uint32_t zoom, uint32_t x, uint32_t y, const char *uri ) {
+    char path[ 192 ] = "";
+    int slot = -1;
+    bool stale = false;
+
+    if ( !osm_map_store_enable || !ns || !*ns || !uri ) {
+        return( NULL );
+    }
+    osm_map_store_refresh_collect();
+    /**
+     * look up and touch the tile
+     */
+    osm_map_store_lock();
+    if ( !osm_map_store_init() ) {
+        osm_map_store_unlock();
+        return( NULL );
+    }
+    osm_map_store_stats.requests++;
+    int ns_slot = osm_map_store_ns_slot( ns, false );
+    if ( ns_slot >= 0 ) {
+        slot = osm_map_store_find( ns_slot, zoom, x, y );
+    }
+    if ( slot < 0 ) {
+        osm_map_store_stats.misses++;
+        osm_map_store_unlock();
+        return( NULL );
+    }
+    osm_map_store_index[ slot ].last_used = ++osm_map_store_use_counter;
+    stale = osm_map_store_is_stale( &osm_map_store_index[ slot ] );
+    osm_map_store_path( path, sizeof( path ), ns_slot, zoom, x, y, false );
+    osm_map_store_unlock();
+    /**
+     * read the tile outside the lock
+     */
+    uri_load_dsc_t *uri_load_dsc = (uri_load_dsc_t*)CALLOC( 1, sizeof( uri_load_dsc_t ) );
+    FILE *file = fopen( path, "rb" );
+    if ( uri_load_dsc && file ) {
+        fseek( file, 0, SEEK_END );
+        uri_load_dsc->size = ftell( file );
+        fseek( file, 0, SEEK_SET );
+        uri_load_dsc->data = (uint8_t*)MALLOC( uri_load_dsc->size + 1 );
+        uri_load_dsc->uri = (char*)MALLOC( strlen( uri ) + 1 );
+        uri_load_dsc->timestamp = millis();
+        if ( uri_load_dsc->size && uri_load_dsc->data && uri_load_dsc->uri && fread( uri_load_dsc->data, uri_load_dsc->size, 1, file ) == 1 ) {
+            strcpy( uri_load_dsc->uri, uri );
+        }
+        else {
+            uri_load_free_all( uri_load_dsc );
+            uri_load_dsc = NULL;
+        }
+    }
+    else if ( uri_load_dsc ) {
+        free( uri_load_dsc );
+        uri_load_dsc = NULL;
+    }
+    if ( file ) {
+        fclose( file );
+    }
+    /**
+     * count the hit or drop a broken tile, a stale tile is shown until the
+     * refetch replaced it
+     */
+    osm_map_store_lock();
+    if ( uri_load_dsc ) {
+        osm_map_store_stats.hits++;
+        if ( stale ) {
+            osm_map_store_refresh_start( ns_slot, zoom, x, y, uri );
+        }
+    }
+    else {
+        OSM_MAP_STORE_ERROR_LOG("can't read stored tile %s", path );
+        osm_map_store_stats.misses++;
+        slot = osm_map_store_find( ns_slot, zoom, x, y );
+        if ( slot >= 0 ) {
+            osm_map_store_remove( slot );
+        }
+    }
+    osm_map_store_unlock();
+    return( uri_load_dsc );
+}
+
+bool osm_map_store_save( const char *ns, uint32_t zoom, uint32_t x, uint32_t y, uri_load_dsc_t *uri_load_dsc ) {
+    if ( !osm_map_store_enable || !ns || !*ns || !uri_load_dsc || !uri_load_dsc->data || !uri_load_dsc->size ) {
+        return( false );
+    }
+    osm_map_store_lock();
+    int ns_slot = osm_map_store_init() ? osm_map_store_ns_slot( ns, true ) : -1;
+    osm_map_store_unlock();
+    if ( ns_slot < 0 ) {
+        return( false );
+    }
+    return( osm_map_store_put( ns_slot, zoom, x, y, uri_load_dsc, false ) );
+}
+
+/**
+ * @brief write a tile into the store, a stored tile is kept or replaced,
+ * call without lock
+ */
+static bool osm_map_store_put( int ns_slot, uint32_t zoom, uint32_t x, uint32_t y, uri_load_dsc_t *uri_load_dsc, bool replace ) {
+    char tmp_path[ 192 ] = "";
+    char path[ 192 ] = "";
+
+    osm_map_store_lock();
+    if ( !replace && osm_map_store_find( ns_slot, zoom, x, y ) >= 0 ) {
+        osm_map_store_unlock();
+        return( false );
+    }
+    /**
+     * create the <ns>/<z>/<x> dirs
+     */
+    osm_map_store_path( path, sizeof( path ), ns_slot, zoom, x, y, false );
+    osm_map_store_path( tmp_path, sizeof( tmp_path ), ns_slot, zoom, x, y, true );
+    for( char *slash = strchr( path + strlen( osm_map_store_dir ) + 1, '/' ) ; slash ; slash = strchr( slash + 1, '/' ) ) {
+        *slash = '\0';
+        mkdir( path, 0700 );
+        *slash = '/';
+    }
+    osm_map_store_unlock();
+    /**
+     * write the tile outside the lock
+     */
+    FILE *file = fopen( tmp_path, "wb" );
+    if ( !file ) {
+        OSM_MAP_STORE_ERROR_LOG("can't create stored tile %s", tmp_path );
+        return( false );
+    }
+    bool success = fwrite( uri_load_dsc->data, uri_load_dsc->size, 1, file ) == 1;
+    success = fclose( file ) == 0 && success;
+
+    osm_map_store_lock();
+    int slot = osm_map_store_find( ns_slot, zoom, x, y );
+    if ( !success || ( slot >= 0 && !replace ) ) {
+        remove( tmp_path );
+        osm_map_store_unlock();
+        return( false );
+    }
+    /**
+     * a refetched tile replaces the stored one, the x dir stays with the tmp file in it
+     */
+    if ( slot >= 0 ) {
+        osm_map_store_remove( slot );
+    }
+    if ( rename( tmp_path, path ) ) {
+        remove( tmp_path );
+        osm_map_store_unlock();
+        return( false );
+    }
+    /**
+     * evict least recently used tiles until the new one fits
+     */
+    while( osm_map_store_stats.entries && ( osm_map_store_stats.entries >= OSM_MAP_STORE_MAX_ENTRIES || osm_map_store_stats.size + uri_load_dsc->size > OSM_MAP_STORE_MAX_SIZE ) ) {
+        int lru = 0;
+        for( int i = 1 ; i < (int)osm_map_store_stats.entries ; i++ ) {
+            if ( osm_map_store_index[ i ].last_used < osm_map_store_index[ lru ].last_used ) {
+                lru = i;
+            }
+        }
+        osm_map_store_remove( lru );
+        osm_map_store_stats.evicted++;
+    }
+    osm_map_store_entry_t *entry = osm_map_store_add( ns_slot, zoom, x, y, uri_load_dsc->size, time( NULL ) );
+    entry->last_used = ++osm_map_store_use_counter;
+    if ( replace ) {
+        osm_map_store_stats.refreshed++;
+    }
+    else {
+        osm_map_store_stats.stored++;
+    }
+    osm_map_store_unlock();
+    return( true );
+}
+
+void osm_map_store_set_enable( bool enable ) {
+    osm_map_store_enable = enable;
+}
+
+bool osm_map_store_get_enable( void ) {
+    return( osm_map_store_enable );
+}
+
+void osm_map_store_clear( void ) {
+    osm_map_store_lock();
+    for( int i = 0 ; i < OSM_MAP_STORE_REFRESH_JOBS ; i++ ) {
+        uri_load_sched_cancel( osm_map_store_refresh[ i ].job );
+        osm_map_store_refresh[ i ].job = NULL;
+    }
+    if ( osm_map_store_init() ) {
+        while( osm_map_store_stats.entries ) {
+            osm_map_store_remove( 0 );
+        }
+    }
+    osm_map_store_unlock();
+}
+
+osm_map_store_stats_t *osm_map_store_get_stats( void ) {
+    return( &osm_map_store_stats );
+}
+
+#ifdef NATIVE_64BIT
+/**
+ * @brief replay a track twice, the second pass after clearing the ram cache
+ * like after a reboot, and log the cache, store and mbtiles hit rates
+ */
+static void osm_map_store_replay( const char *track ) {
+    char line[ 128 ] = "";
+
+    osm_location_t *osm_location = osm_map_create_location_obj();
+    if ( !osm_location ) {
+        return;
+    }
+    if ( getenv( OSM_MAP_STORE_SERVER_ENV ) ) {
+        osm_map_set_tile_server( osm_location, getenv( OSM_MAP_STORE_SERVER_ENV ) );
+    }
+
+    for( int pass = 1 ; pass <= 2 ; pass++ ) {
+        FILE *file = fopen( track, "r" );
+        if ( !file ) {
+            OSM_MAP_STORE_ERROR_LOG("can't open track %s", track );
+            return;
+        }
+        osm_map_cache_stats_t cache_stats = *osm_map_get_cache_stats( osm_location );
+        osm_map_store_stats_t store_stats = osm_map_store_stats;
+        osm_map_mbtiles_stats_t mbtiles_stats = *osm_map_mbtiles_get_stats();
+        uint32_t points = 0, tiles = 0;
+        uint64_t start = millis();
+
+        while( fgets( line, sizeof( line ), file ) ) {
+            double lat = 0, lon = 0;
+            if ( *line == '#' || sscanf( line, "%lf %lf", &lat, &lon ) != 2 ) {
+                continue;
+            }
+            osm_map_set_lon_lat( osm_location, lon, lat );
+            if ( osm_map_update( osm_location ) ) {
+                tiles++;
+            }
+            points++;
+        }
+        fclose( file );
+
+        osm_map_cache_stats_t *cache = osm_map_get_cache_stats( osm_location );
+        uint32_t cache_requests = cache->hits + cache->misses - cache_stats.hits - cache_stats.misses;
+        uint32_t store_requests = osm_map_store_stats.requests - store_stats.requests;
+        OSM_MAP_STORE_INFO_LOG("replay pass %d: %u points, %u tile changes in %llus", pass, points, tiles, (unsigned long long)( millis() - start ) );
+        OSM_MAP_STORE_INFO_LOG("  ram cache: %u/%u hits (%u%%)", cache->hits - cache_stats.hits, cache_requests, cache_requests ? ( cache->hits - cache_stats.hits ) * 100 / cache_requests : 0 );
+        OSM_MAP_STORE_INFO_LOG("  tile store: %u/%u hits (%u%%), %u stored, %u evicted, %u tiles, %u bytes",
+                                osm_map_store_stats.hits - store_stats.hits,
+                                store_requests,
+                                store_requests ? ( osm_map_store_stats.hits - store_stats.hits ) * 100 / store_requests : 0,
+                                osm_map_store_stats.stored - store_stats.stored,
+                                osm_map_store_stats.evicted - store_stats.evicted,
+                                osm_map_store_stats.entries,
+                                osm_map_store_stats.size );
+        osm_map_mbtiles_stats_t *mbtiles = osm_map_mbtiles_get_stats();
+        if ( mbtiles->hits + mbtiles->misses + mbtiles->errors != mbtiles_stats.hits + mbtiles_stats.misses + mbtiles_stats.errors ) {
+            uint32_t queries = mbtiles->hits + mbtiles->misses - mbtiles_stats.hits - mbtiles_stats.misses;
+            OSM_MAP_STORE_INFO_LOG("  mbtiles: %u hits, %u misses, %u errors, avg query %lluus",
+                                    mbtiles->hits - mbtiles_stats.hits,
+                                    mbtiles->misses - mbtiles_stats.misses,
+                                    mbtiles->errors - mbtiles_stats.errors,
+                                    queries ? (unsigned long long)( ( mbtiles->query_time - mbtiles_stats.query_time ) / queries ) : 0ULL );
+        }
+        /**
+         * a reboot starts with a empty ram cache
+         */
+        osm_map_clear_cache( osm_location );
+    }
+}
+#endif
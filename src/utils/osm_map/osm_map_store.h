@@ -0,0 +1,126 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _OSM_MAP_STORE_H
+    #define _OSM_MAP_STORE_H
+
+    #include "utils/uri_load/uri_load.h"
+
+    #define OSM_MAP_STORE_INFO_LOG          log_i
+    #define OSM_MAP_STORE_LOG               log_d
+    #define OSM_MAP_STORE_ERROR_LOG         log_e
+
+    #define OSM_MAP_STORE_DIR               "sd/osmstore"       /** @brief store dir, /sd/osmstore or ~/.hedge/sd/osmstore */
+    #define OSM_MAP_STORE_MAX_ENTRIES       4096                /** @brief max stored tiles */
+    #define OSM_MAP_STORE_MAX_SIZE          ( 64 * 1024 * 1024 )    /** @brief max store size in bytes */
+    #define OSM_MAP_STORE_MAX_NS            16                  /** @brief max tile server namespaces */
+    #define OSM_MAP_STORE_NS_LEN            24                  /** @brief max namespace length */
+    #define OSM_MAP_STORE_BUCKETS           1024                /** @brief index hash buckets, power of two */
+    #define OSM_MAP_STORE_MAX_AGE           ( 30 * 24 * 60 * 60 )   /** @brief age in s after a stored tile is refetched in the background */
+    #define OSM_MAP_STORE_REFRESH_JOBS      4                   /** @brief max concurrent background refetches */
+    #define OSM_MAP_STORE_REFRESH_RETRY     ( 10 * 60 )         /** @brief s without refetches after a failed one */
+    #define OSM_MAP_STORE_REPLAY_ENV        "HEDGE_OSM_MAP_STORE_REPLAY"    /** @brief env var with a "lat lon" per line track file on native */
+    #define OSM_MAP_STORE_SERVER_ENV        "HEDGE_OSM_MAP_TILE_SERVER"     /** @brief env var with a tile server for the replay on native */
+    /**
+     * @brief tile store statistics
+     */
+    typedef struct {
+        uint32_t requests = 0;                  /** @brief tile lookups */
+        uint32_t hits = 0;                      /** @brief tiles loaded from the store */
+        uint32_t misses = 0;                    /** @brief tiles not in the store */
+        uint32_t stored = 0;                    /** @brief tiles written into the store */
+        uint32_t evicted = 0;                   /** @brief tiles removed to stay in the size limit */
+        uint32_t refreshed = 0;                 /** @brief tiles refetched after OSM_MAP_STORE_MAX_AGE */
+        uint32_t entries = 0;                   /** @brief current tiles */
+        uint32_t size = 0;                      /** @brief current size in bytes */
+    } osm_map_store_stats_t;
+    /**
+     * @brief setup the tile store, on native a track given by HEDGE_OSM_MAP_STORE_REPLAY is replayed
+     */
+    void osm_map_store_setup( void );
+    /**
+     * @brief make a namespace from a tile server name, e.g. "OSM Standard" -> "osm_standard"
+     *
+     * @param   ns      pointer to a char buffer, OSM_MAP_STORE_NS_LEN fits all
+     * @param   size    buffer size
+     * @param   name    tile server name from osmtileserver.json
+     */
+    void osm_map_store_namespace( char *ns, size_t size, const char *name );
+    /**
+     * @brief check if a tile is stored
+     *
+     * @param   ns      tile server namespace
+     * @param   zoom    zoom level
+     * @param   x       tile x
+     * @param   y       tile y
+     *
+     * @return  true if stored
+     */
+    bool osm_map_store_contains( const char *ns, uint32_t zoom, uint32_t x, uint32_t y );
+    /**
+     * @brief load a tile from the store into ram, a tile older than OSM_MAP_STORE_MAX_AGE
+     * is returned and refetched in the background
+     *
+     * @param   ns      tile server namespace
+     * @param   zoom    zoom level
+     * @param   x       tile x
+     * @param   y       tile y
+     * @param   uri     tile uri for the uri_load_dsc
+     *
+     * @return  uri_load_dsc structure, NULL if not stored
+     */
+    uri_load_dsc_t *osm_map_store_load( const char *ns, uint32_t zoom, uint32_t x, uint32_t y, const char *uri );
+    /**
+     * @brief write a tile into the store, evicts least recently used tiles until it fits
+     *
+     * @param   ns      tile server namespace
+     * @param   zoom    zoom level
+     * @param   x       tile x
+     * @param   y       tile y
+     * @param   uri_load_dsc    tile image
+     *
+     * @return  true if success
+     */
+    bool osm_map_store_save( const char *ns, uint32_t zoom, uint32_t x, uint32_t y, uri_load_dsc_t *uri_load_dsc );
+    /**
+     * @brief enable or disable the tile store
+     *
+     * @param   enable  true to enable
+     */
+    void osm_map_store_set_enable( bool enable );
+    /**
+     * @brief check if the tile store is enabled
+     *
+     * @return  true if enabled
+     */
+    bool osm_map_store_get_enable( void );
+    /**
+     * @brief remove all stored tiles
+     */
+    void osm_map_store_clear( void );
+    /**
+     * @brief get the tile store statistics
+     *
+     * @return  pointer to a osm_map_store_stats_t structure
+     */
+    osm_map_store_stats_t *osm_map_store_get_stats( void );
+
+#endif // _OSM_MAP_STORE_H
@@ -0,0 +1,535 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "osm_map_view.h"
+#include "osm_map_fallback.h"
+#include "utils/alloc.h"
+
+#ifdef NATIVE_64BIT
+    #include <stdlib.h>
+    #include <math.h>
+    #include <time.h>
+    #include "utils/logging.h"
+#else
+    #include <Arduino.h>
+    #include <esp_timer.h>
+#endif
+
+static lv_style_t osm_map_view_style;
+static bool osm_map_view_style_init = false;
+
+static void osm_map_view_lonlat2px( double lon, double lat, uint32_t zoom, double *x, double *y );
+static void osm_map_view_get_center( osm_location_t *osm_location, uint32_t zoom, double *x, double *y );
+static void osm_map_view_load_grid( osm_map_view_t *view, osm_location_t *osm_location, int32_t dx, int32_t dy, bool reuse );
+static void osm_map_view_release_tile( osm_map_view_t *view, osm_location_t *osm_location, osm_map_view_tile_t *tile );
+static void osm_map_view_release_fallback( osm_map_view_tile_t *tile );
+static bool osm_map_view_collect( osm_map_view_t *view, osm_location_t *osm_location );
+static void osm_map_view_set_tile( osm_map_view_t *view, osm_map_view_tile_t *tile, uri_load_dsc_t *uri_load_dsc );
+static void osm_map_view_loaded_cb( void *arg );
+static bool osm_map_view_is_visible( osm_map_view_t *view, int pos );
+static void osm_map_view_set_plane_pos( osm_map_view_t *view );
+
+static uint64_t osm_map_view_now( void ) {
+#ifdef NATIVE_64BIT
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000 );
+#else
+    return( esp_timer_get_time() );
+#endif
+}
+
+osm_map_view_t *osm_map_view_create( lv_obj_t *parent, lv_coord_t width, lv_coord_t height, uint16_t img_zoom ) {
+    osm_map_view_t *view = (osm_map_view_t*)CALLOC( 1, sizeof( osm_map_view_t ) );
+
+    if ( !view ) {
+        OSM_MAP_VIEW_ERROR_LOG("osm map view alloc failed");
+        return( NULL );
+    }
+    view->width = width;
+    view->height = height;
+    view->img_zoom = img_zoom ? img_zoom : LV_IMG_ZOOM_NONE;
+    view->valid = false;
+    view->loaded_cb = NULL;
+    view->stats = osm_map_view_stats_t();
+    /**
+     * a plain style without background, border and padding for both container
+     */
+    if ( !osm_map_view_style_init ) {
+        lv_style_init( &osm_map_view_style );
+        lv_style_set_bg_opa( &osm_map_view_style, LV_OBJ_PART_MAIN, LV_OPA_TRANSP );
+        lv_style_set_border_width( &osm_map_view_style, LV_OBJ_PART_MAIN, 0 );
+        lv_style_set_radius( &osm_map_view_style, LV_OBJ_PART_MAIN, 0 );
+        lv_style_set_pad_all( &osm_map_view_style, LV_OBJ_PART_MAIN, 0 );
+        osm_map_view_style_init = true;
+    }
+
+    view->cont = lv_obj_create( parent, NULL );
+    lv_obj_reset_style_list( view->cont, LV_OBJ_PART_MAIN );
+    lv_obj_add_style( view->cont, LV_OBJ_PART_MAIN, &osm_map_view_style );
+    lv_obj_set_size( view->cont, width, height );
+    lv_obj_set_click( view->cont, false );
+    lv_obj_align( view->cont, parent, LV_ALIGN_CENTER, 0, 0 );
+
+    view->plane = lv_obj_create( view->cont, NULL );
+    lv_obj_reset_style_list( view->plane, LV_OBJ_PART_MAIN );
+    lv_obj_add_style( view->plane, LV_OBJ_PART_MAIN, &osm_map_view_style );
+    lv_obj_set_size( view->plane, OSM_MAP_VIEW_GRID * view->img_zoom, OSM_MAP_VIEW_GRID * view->img_zoom );
+    lv_obj_set_click( view->plane, false );
+    /**
+     * a zoomed tile is scaled around his top left corner, the displayed
+     * tile size in px is the same as the image zoom
+     */
+    for( int i = 0 ; i < OSM_MAP_VIEW_TILES ; i++ ) {
+        osm_map_view_tile_t *tile = &view->tile[ i ];
+
+        tile->dsc.header.always_zero = 0;
+        tile->dsc.header.cf = LV_IMG_CF_RAW_ALPHA;
+        tile->dsc.header.w = OSM_MAP_VIEW_TILE_SIZE;
+        tile->dsc.header.h = OSM_MAP_VIEW_TILE_SIZE;
+        tile->dsc.data = NULL;
+        tile->dsc.data_size = 0;
+        tile->pinned = false;
+        tile->fallback.data = NULL;
+        tile->fallback.data_size = 0;
+        tile->job = NULL;
+
+        tile->img = lv_img_create( view->plane, NULL );
+        lv_img_set_src( tile->img, osm_map_get_no_data_image() );
+        if ( view->img_zoom != LV_IMG_ZOOM_NONE ) {
+            lv_img_set_pivot( tile->img, 0, 0 );
+            lv_img_set_zoom( tile->img, view->img_zoom );
+        }
+        view->grid[ i ] = i;
+        lv_obj_set_pos( tile->img, ( i % OSM_MAP_VIEW_GRID ) * view->img_zoom, ( i / OSM_MAP_VIEW_GRID ) * view->img_zoom );
+    }
+    /**
+     * center tile in the middle of the view until the first update
+     */
+    view->center_x = OSM_MAP_VIEW_TILE_SIZE * ( OSM_MAP_VIEW_GRID / 2 ) + OSM_MAP_VIEW_TILE_SIZE / 2;
+    view->center_y = view->center_x;
+    osm_map_view_set_plane_pos( view );
+
+    return( view );
+}
+
+/**
+ * @brief convert a lon/lat into tile px at a zoom level, 256px per tile
+ *
+ * https://wiki.openstreetmap.org/wiki/Slippy_map_tilenames#C.2FC.2B.2B
+ */
+static void osm_map_view_lonlat2px( double lon, double lat, uint32_t zoom, double *x, double *y ) {
+    double size = (double)OSM_MAP_VIEW_TILE_SIZE * ( 1 << zoom );
+    double latrad = lat * M_PI / 180.0;
+
+    *x = ( lon + 180.0 ) / 360.0 * size;
+    *y = ( 1.0 - asinh( tan( latrad ) ) / M_PI ) / 2.0 * size;
+}
+
+/**
+ * @brief get the view center in tile px, the location or the middle of the manual nav tile
+ */
+static void osm_map_view_get_center( osm_location_t *osm_location, uint32_t zoom, double *x, double *y ) {
+    if ( osm_location->manual_nav ) {
+        *x = ( osm_location->tilex_manual_nav + 0.5 ) * OSM_MAP_VIEW_TILE_SIZE;
+        *y = ( osm_location->tiley_manual_nav + 0.5 ) * OSM_MAP_VIEW_TILE_SIZE;
+    }
+    else {
+        osm_map_view_lonlat2px( osm_location->lon, osm_location->lat, zoom, x, y );
+    }
+}
+
+void osm_map_view_set_loaded_cb( osm_map_view_t *view, osm_map_view_loaded_cb_t *loaded_cb ) {
+    if ( view ) {
+        view->loaded_cb = loaded_cb;
+    }
+}
+
+bool osm_map_view_update( osm_map_view_t *view, osm_location_t *osm_location ) {
+    bool tiles_loaded = false;
+    uint64_t start = osm_map_view_now();
+    /**
+     * check if view and osm_location set
+     */
+    if ( !view || !osm_location ) {
+        return( false );
+    }
+    uint32_t zoom = osm_map_get_zoom( osm_location );
+    uint32_t server = osm_map_get_tile_server_hash( osm_location );
+    osm_map_view_get_center( osm_location, zoom, &view->center_x, &view->center_y );
+    /**
+     * the grid starts one tile left and above the center tile
+     */
+    int32_t tilex = (int32_t)floor( view->center_x / OSM_MAP_VIEW_TILE_SIZE ) - OSM_MAP_VIEW_GRID / 2;
+    int32_t tiley = (int32_t)floor( view->center_y / OSM_MAP_VIEW_TILE_SIZE ) - OSM_MAP_VIEW_GRID / 2;
+    int32_t dx = tilex - view->tilex;
+    int32_t dy = tiley - view->tiley;
+
+    if ( !view->valid || zoom != view->zoom || server != view->server || abs( dx ) >= OSM_MAP_VIEW_GRID || abs( dy ) >= OSM_MAP_VIEW_GRID ) {
+        /**
+         * new zoom, new source or a jump, load all tiles
+         */
+        OSM_MAP_VIEW_LOG("reload grid at %d/%d/%d", zoom, tilex, tiley );
+        view->zoom = zoom;
+        view->server = server;
+        view->tilex = tilex;
+        view->tiley = tiley;
+        osm_map_view_load_grid( view, osm_location, 0, 0, false );
+        view->valid = true;
+        view->stats.reloads++;
+        tiles_loaded = true;
+    }
+    else if ( dx || dy ) {
+        /**
+         * moved over a tile border, keep the tiles that stay in the grid
+         */
+        OSM_MAP_VIEW_LOG("shift grid by %d/%d tiles", dx, dy );
+        view->tilex = tilex;
+        view->tiley = tiley;
+        osm_map_view_load_grid( view, osm_location, dx, dy, true );
+        view->stats.shifts++;
+        tiles_loaded = true;
+    }
+    else {
+        view->stats.moves++;
+    }
+    /**
+     * pick up downloads that are done in the meantime
+     */
+    if ( osm_map_view_collect( view, osm_location ) ) {
+        tiles_loaded = true;
+    }
+    osm_map_view_set_plane_pos( view );
+    /**
+     * update stats
+     */
+    uint32_t update_time = osm_map_view_now() - start;
+    view->stats.updates++;
+    view->stats.update_time += update_time;
+    if ( update_time > view->stats.max_update_time )
+        view->stats.max_update_time = update_time;
+
+    return( tiles_loaded );
+}
+
+/**
+ * @brief move the grid container by the sub tile offset, the view center is
+ * the middle of the view
+ */
+static void osm_map_view_set_plane_pos( osm_map_view_t *view ) {
+    double scale = (double)view->img_zoom / OSM_MAP_VIEW_TILE_SIZE;
+    lv_coord_t x = (lv_coord_t)lround( ( (double)view->tilex * OSM_MAP_VIEW_TILE_SIZE - view->center_x ) * scale + view->width / 2 );
+    lv_coord_t y = (lv_coord_t)lround( ( (double)view->tiley * OSM_MAP_VIEW_TILE_SIZE - view->center_y ) * scale + view->height / 2 );
+
+    if ( lv_obj_get_x( view->plane ) != x || lv_obj_get_y( view->plane ) != y ) {
+        lv_obj_set_pos( view->plane, x, y );
+    }
+}
+
+/**
+ * @brief fill the grid, tiles of the old grid are moved by dx/dy tiles and
+ * keep their image, all other tiles are loaded
+ */
+static void osm_map_view_load_grid( osm_map_view_t *view, osm_location_t *osm_location, int32_t dx, int32_t dy, bool reuse ) {
+    static const uint8_t load_order[ OSM_MAP_VIEW_TILES ] = { 4, 1, 3, 5, 7, 0, 2, 6, 8 };
+    uint8_t grid[ OSM_MAP_VIEW_TILES ];
+    bool used[ OSM_MAP_VIEW_TILES ];
+    bool load[ OSM_MAP_VIEW_TILES ];
+    /**
+     * pick up the tiles that stay in the grid
+     */
+    for( int i = 0 ; i < OSM_MAP_VIEW_TILES ; i++ ) {
+        used[ i ] = false;
+    }
+    for( int pos = 0 ; pos < OSM_MAP_VIEW_TILES ; pos++ ) {
+        int32_t old_x = pos % OSM_MAP_VIEW_GRID + dx;
+        int32_t old_y = pos / OSM_MAP_VIEW_GRID + dy;
+
+        if ( reuse && old_x >= 0 && old_x < OSM_MAP_VIEW_GRID && old_y >= 0 && old_y < OSM_MAP_VIEW_GRID ) {
+            grid[ pos ] = view->grid[ old_y * OSM_MAP_VIEW_GRID + old_x ];
+            used[ grid[ pos ] ] = true;
+            load[ pos ] = false;
+            view->stats.tiles_reused++;
+        }
+        else {
+            load[ pos ] = true;
+        }
+    }
+    /**
+     * hand out the left tiles to the new positions and release their images
+     */
+    for( int pos = 0, i = 0 ; pos < OSM_MAP_VIEW_TILES ; pos++ ) {
+        if ( !load[ pos ] ) {
+            continue;
+        }
+        while( used[ i ] ) {
+            i++;
+        }
+        grid[ pos ] = i;
+        used[ i ] = true;
+        lv_img_set_src( view->tile[ i ].img, osm_map_get_no_data_image() );
+        osm_map_view_release_tile( view, osm_location, &view->tile[ i ] );
+    }
+    for( int pos = 0 ; pos < OSM_MAP_VIEW_TILES ; pos++ ) {
+        view->grid[ pos ] = grid[ pos ];
+        lv_obj_set_pos( view->tile[ grid[ pos ] ].img, ( pos % OSM_MAP_VIEW_GRID ) * view->img_zoom, ( pos / OSM_MAP_VIEW_GRID ) * view->img_zoom );
+    }
+    /**
+     * queue all new tiles at once, they load in parallel and are picked up
+     * by a later update, cached and stored tiles are set at once center first
+     */
+    for( int pos = 0 ; pos < OSM_MAP_VIEW_TILES ; pos++ ) {
+        if ( load[ pos ] ) {
+            view->tile[ grid[ pos ] ].job = osm_map_request_tile( osm_location, view->zoom, view->tilex + pos % OSM_MAP_VIEW_GRID, view->tiley + pos / OSM_MAP_VIEW_GRID, URI_LOAD_PRIO_VISIBLE );
+        }
+    }
+    for( int i = 0 ; i < OSM_MAP_VIEW_TILES ; i++ ) {
+        int pos = load_order[ i ];
+        osm_map_view_tile_t *tile = &view->tile[ grid[ pos ] ];
+
+        if ( !load[ pos ] ) {
+            continue;
+        }
+        if ( tile->job ) {
+            uri_load_sched_notify( tile->job, osm_map_view_loaded_cb, view );
+            continue;
+        }
+        osm_map_view_set_tile( view, tile, osm_map_get_tile( osm_location, view->zoom, view->tilex + pos % OSM_MAP_VIEW_GRID, view->tiley + pos / OSM_MAP_VIEW_GRID, URI_LOAD_PRIO_VISIBLE, &tile->pin ) );
+    }
+    /**
+     * visible tiles that have to be downloaded show a scaled parent or
+     * children from the cache meanwhile
+     */
+    for( int pos = 0 ; pos < OSM_MAP_VIEW_TILES ; pos++ ) {
+        osm_map_view_tile_t *tile = &view->tile[ grid[ pos ] ];
+
+        if ( !tile->job || !osm_map_view_is_visible( view, pos ) ) {
+            continue;
+        }
+        if ( osm_map_fallback_create( osm_location, view->zoom, view->tilex + pos % OSM_MAP_VIEW_GRID, view->tiley + pos / OSM_MAP_VIEW_GRID, &tile->fallback ) ) {
+            lv_img_cache_invalidate_src( &tile->fallback );
+            lv_img_set_src( tile->img, &tile->fallback );
+            view->stats.tiles_fallback++;
+        }
+    }
+}
+
+/**
+ * @brief pick up the done downloads of the grid, nothing waits for a download
+ *
+ * @return  true if a tile was picked up
+ */
+static bool osm_map_view_collect( osm_map_view_t *view, osm_location_t *osm_location ) {
+    bool collected = false;
+
+    for( int pos = 0 ; pos < OSM_MAP_VIEW_TILES ; pos++ ) {
+        osm_map_view_tile_t *tile = &view->tile[ view->grid[ pos ] ];
+
+        if ( !tile->job || !uri_load_sched_is_done( tile->job ) ) {
+            continue;
+        }
+        uri_load_job_t *job = tile->job;
+        tile->job = NULL;
+        osm_map_view_set_tile( view, tile, osm_map_collect_tile( osm_location, view->zoom, view->tilex + pos % OSM_MAP_VIEW_GRID, view->tiley + pos / OSM_MAP_VIEW_GRID, job, &tile->pin ) );
+        collected = true;
+    }
+    return( collected );
+}
+
+/**
+ * @brief show a loaded and pinned tile image, a failed tile keeps his fallback
+ */
+static void osm_map_view_set_tile( osm_map_view_t *view, osm_map_view_tile_t *tile, uri_load_dsc_t *uri_load_dsc ) {
+    if ( !uri_load_dsc ) {
+        return;
+    }
+    tile->pinned = true;
+    tile->dsc.data = uri_load_dsc->data;
+    tile->dsc.data_size = uri_load_dsc->size;
+    lv_img_cache_invalidate_src( &tile->dsc );
+    lv_img_set_src( tile->img, &tile->dsc );
+    osm_map_view_release_fallback( tile );
+    view->stats.tiles_loaded++;
+}
+
+/**
+ * @brief scheduler done callback, runs in a download worker
+ */
+static void osm_map_view_loaded_cb( void *arg ) {
+    osm_map_view_t *view = (osm_map_view_t*)arg;
+
+    if ( view->loaded_cb ) {
+        view->loaded_cb();
+    }
+}
+
+/**
+ * @brief release the pinned image of a tile, the tile must not show it anymore
+ */
+static void osm_map_view_release_tile( osm_map_view_t *view, osm_location_t *osm_location, osm_map_view_tile_t *tile ) {
+    if ( tile->job ) {
+        uri_load_sched_cancel( tile->job );
+        tile->job = NULL;
+    }
+    osm_map_view_release_fallback( tile );
+    if ( !tile->pinned ) {
+        return;
+    }
+    lv_img_cache_invalidate_src( &tile->dsc );
+    tile->dsc.data = NULL;
+    tile->dsc.data_size = 0;
+    tile->pinned = false;
+    osm_map_release_tile( osm_location, &tile->pin );
+}
+
+/**
+ * @brief free the provisional image of a tile, the tile must not show it anymore
+ */
+static void osm_map_view_release_fallback( osm_map_view_tile_t *tile ) {
+    if ( !tile->fallback.data ) {
+        return;
+    }
+    lv_img_cache_invalidate_src( &tile->fallback );
+    osm_map_fallback_free( &tile->fallback );
+}
+
+/**
+ * @brief check if a grid position is in the view
+ */
+static bool osm_map_view_is_visible( osm_map_view_t *view, int pos ) {
+    double scale = (double)view->img_zoom / OSM_MAP_VIEW_TILE_SIZE;
+    double x = ( (double)( view->tilex + pos % OSM_MAP_VIEW_GRID ) * OSM_MAP_VIEW_TILE_SIZE - view->center_x ) * scale + view->width / 2;
+    double y = ( (double)( view->tiley + pos / OSM_MAP_VIEW_GRID ) * OSM_MAP_VIEW_TILE_SIZE - view->center_y ) * scale + view->height / 2;
+
+    return( x < view->width && x + view->img_zoom > 0 && y < view->height && y + view->img_zoom > 0 );
+}
+
+bool osm_map_view_get_pos( osm_map_view_t *view, osm_location_t *osm_location, lv_coord_t *x, lv_coord_t *y ) {
+    double pos_x, pos_y;
+    /**
+     * check if view and osm_location set
+     */
+    if ( !view || !osm_location || !view->valid ) {
+        return( false );
+    }
+    double scale = (double)view->img_zoom / OSM_MAP_VIEW_TILE_SIZE;
+    osm_map_view_lonlat2px( osm_location->lon, osm_location->lat, view->zoom, &pos_x, &pos_y );
+    pos_x = ( pos_x - view->center_x ) * scale + view->width / 2;
+    pos_y = ( pos_y - view->center_y ) * scale + view->height / 2;
+
+    if ( pos_x < 0 || pos_x >= view->width || pos_y < 0 || pos_y >= view->height ) {
+        return( false );
+    }
+    *x = (lv_coord_t)pos_x;
+    *y = (lv_coord_t)pos_y;
+
+    return( true );
+}
+
+void osm_map_view_set_antialias( osm_map_view_t *view, bool antialias ) {
+    if ( !view ) {
+        return;
+    }
+    for( int i = 0 ; i < OSM_MAP_VIEW_TILES ; i++ ) {
+        lv_img_set_antialias( view->tile[ i ].img, antialias );
+    }
+}
+
+void osm_map_view_release( osm_map_view_t *view, osm_location_t *osm_location ) {
+    if ( !view ) {
+        return;
+    }
+    for( int i = 0 ; i < OSM_MAP_VIEW_TILES ; i++ ) {
+        lv_img_set_src( view->tile[ i ].img, osm_map_get_no_data_image() );
+        osm_map_view_release_tile( view, osm_location, &view->tile[ i ] );
+    }
+    osm_map_fallback_flush();
+    view->valid = false;
+}
+
+osm_map_view_stats_t *osm_map_view_get_stats( osm_map_view_t *view ) {
+    return( view ? &view->stats : NULL );
+}
+
+void osm_map_view_bench( osm_map_view_t *view, osm_location_t *osm_location ) {
+#ifdef NATIVE_64BIT
+    static bool bench_done = false;
+    const char *frames_env = getenv( OSM_MAP_VIEW_BENCH_ENV );
+
+    if ( !view || !osm_location || bench_done || !frames_env || atoi( frames_env ) <= 0 ) {
+        return;
+    }
+    bench_done = true;
+
+    int frames = atoi( frames_env );
+    double lon = osm_location->lon;
+    double lat = osm_location->lat;
+    double size = (double)OSM_MAP_VIEW_TILE_SIZE * ( 1 << osm_location->zoom );
+    double x, y;
+    uint64_t sum_update = 0, sum_render = 0;
+    uint32_t max_frame = 0;
+    /**
+     * pan diagonal from the current location, every frame is one
+     * view update and one lvgl refresh
+     */
+    osm_map_center_location( osm_location );
+    osm_map_view_update( view, osm_location );
+    lv_refr_now( NULL );
+    osm_map_view_stats_t start_stats = view->stats;
+    osm_map_view_lonlat2px( lon, lat, osm_location->zoom, &x, &y );
+
+    OSM_MAP_VIEW_INFO_LOG("pan bench: %d frames, %dpx per frame at zoom %d", frames, OSM_MAP_VIEW_BENCH_STEP, osm_location->zoom );
+    for( int frame = 0 ; frame < frames ; frame++ ) {
+        x += OSM_MAP_VIEW_BENCH_STEP;
+        y += OSM_MAP_VIEW_BENCH_STEP / 2;
+        osm_map_set_lon_lat( osm_location, x / size * 360.0 - 180.0, atan( sinh( M_PI * ( 1.0 - 2.0 * y / size ) ) ) * 180.0 / M_PI );
+
+        uint64_t start = osm_map_view_now();
+        osm_map_view_update( view, osm_location );
+        uint64_t updated = osm_map_view_now();
+        lv_refr_now( NULL );
+        uint64_t rendered = osm_map_view_now();
+
+        sum_update += updated - start;
+        sum_render += rendered - updated;
+        if ( rendered - start > max_frame )
+            max_frame = rendered - start;
+    }
+    OSM_MAP_VIEW_INFO_LOG("pan bench: avg frame %.2fms (update %.2fms, render %.2fms), max frame %.2fms",
+                            ( sum_update + sum_render ) / 1000.0 / frames,
+                            sum_update / 1000.0 / frames,
+                            sum_render / 1000.0 / frames,
+                            max_frame / 1000.0 );
+    OSM_MAP_VIEW_INFO_LOG("pan bench: %d moves, %d shifts, %d reloads, %d tiles loaded, %d tiles reused, %d fallback tiles",
+                            view->stats.moves - start_stats.moves,
+                            view->stats.shifts - start_stats.shifts,
+                            view->stats.reloads - start_stats.reloads,
+                            view->stats.tiles_loaded - start_stats.tiles_loaded,
+                            view->stats.tiles_reused - start_stats.tiles_reused,
+                            view->stats.tiles_fallback - start_stats.tiles_fallback );
+    /**
+     * back to the location before the bench
+     */
+    osm_map_set_lon_lat( osm_location, lon, lat );
+    osm_map_view_update( view, osm_location );
+#endif
+}
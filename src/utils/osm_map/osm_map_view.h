@@ -0,0 +1,160 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _OSM_MAP_VIEW_H
+    #define _OSM_MAP_VIEW_H
+
+    #include "lvgl.h"
+    #include "osm_map.h"
+
+    #define OSM_MAP_VIEW_INFO_LOG           log_i
+    #define OSM_MAP_VIEW_LOG                log_d
+    #define OSM_MAP_VIEW_ERROR_LOG          log_e
+
+    #define OSM_MAP_VIEW_GRID               3                   /** @brief tiles per row and column, the view is smaller than two tiles */
+    #define OSM_MAP_VIEW_TILES              ( OSM_MAP_VIEW_GRID * OSM_MAP_VIEW_GRID )
+    #define OSM_MAP_VIEW_TILE_SIZE          256                 /** @brief tile image size in px */
+    #define OSM_MAP_VIEW_BENCH_ENV          "HEDGE_OSM_MAP_VIEW_BENCH"  /** @brief env var with a number of pan frames for the native bench */
+    #define OSM_MAP_VIEW_BENCH_STEP         6                   /** @brief pan step per bench frame in px */
+    /**
+     * @brief one tile of the grid
+     */
+    typedef struct {
+        lv_obj_t *img = NULL;                   /** @brief tile image obj */
+        lv_img_dsc_t dsc;                       /** @brief tile image dsc, his address is the lvgl image cache key */
+        bool pinned = false;                    /** @brief tile is pinned in the tile cache */
+        osm_map_cache_key_t pin;                /** @brief key of the pinned tile */
+        lv_img_dsc_t fallback;                  /** @brief provisional image until the tile is loaded, data is NULL if unused */
+        uri_load_job_t *job = NULL;             /** @brief pending download of the tile, NULL if none */
+    } osm_map_view_tile_t;
+    /**
+     * @brief called from a download worker when a tile download of the view
+     * is done, the next osm_map_view_update() picks it up, must not block
+     */
+    typedef void ( osm_map_view_loaded_cb_t ) ( void );
+    /**
+     * @brief view statistics, all times in us
+     */
+    typedef struct {
+        uint32_t updates = 0;                   /** @brief view updates */
+        uint32_t moves = 0;                     /** @brief updates that only moved the grid */
+        uint32_t shifts = 0;                    /** @brief updates that shifted the grid by a tile */
+        uint32_t reloads = 0;                   /** @brief updates that reloaded the whole grid */
+        uint32_t tiles_loaded = 0;              /** @brief tiles loaded into the grid */
+        uint32_t tiles_reused = 0;              /** @brief tiles kept on a shift */
+        uint32_t tiles_fallback = 0;            /** @brief tiles shown from a scaled parent or children until loaded */
+        uint64_t update_time = 0;               /** @brief sum of update times */
+        uint32_t max_update_time = 0;           /** @brief max update time */
+    } osm_map_view_stats_t;
+    /**
+     * @brief map view, a grid of tiles around the location that is moved by the sub tile offset
+     */
+    typedef struct {
+        lv_obj_t *cont = NULL;                  /** @brief view container, clips the grid */
+        lv_obj_t *plane = NULL;                 /** @brief grid container, moved inside the view */
+        osm_map_view_tile_t tile[ OSM_MAP_VIEW_TILES ];     /** @brief grid tiles */
+        uint8_t grid[ OSM_MAP_VIEW_TILES ];     /** @brief grid position, row by row, to tile index */
+        lv_coord_t width = 0;                   /** @brief view width in px */
+        lv_coord_t height = 0;                  /** @brief view height in px */
+        uint16_t img_zoom = 256;                /** @brief lvgl image zoom, 256 is 1:1 */
+        bool valid = false;                     /** @brief grid is loaded */
+        uint32_t zoom = 0;                      /** @brief zoom level of the grid */
+        uint32_t server = 0;                    /** @brief tile server hash of the grid */
+        int32_t tilex = 0;                      /** @brief tile x of the top left grid tile */
+        int32_t tiley = 0;                      /** @brief tile y of the top left grid tile */
+        double center_x = 0;                    /** @brief view center in tile px at zoom */
+        double center_y = 0;                    /** @brief view center in tile px at zoom */
+        osm_map_view_loaded_cb_t *loaded_cb = NULL;         /** @brief download done callback, NULL if unused */
+        osm_map_view_stats_t stats;             /** @brief statistics */
+    } osm_map_view_t;
+    /**
+     * @brief create a map view
+     *
+     * @param   parent      pointer to the parent obj
+     * @param   width       view width in px
+     * @param   height      view height in px
+     * @param   img_zoom    lvgl image zoom for the tiles, 256 is 1:1
+     *
+     * @return  pointer to the map view, NULL if failed
+     */
+    osm_map_view_t *osm_map_view_create( lv_obj_t *parent, lv_coord_t width, lv_coord_t height, uint16_t img_zoom );
+    /**
+     * @brief set the callback for done tile downloads, the view never waits
+     * for a download, a done one is picked up by the next update
+     *
+     * @param   view        pointer to the map view
+     * @param   loaded_cb   callback that requests a view update
+     */
+    void osm_map_view_set_loaded_cb( osm_map_view_t *view, osm_map_view_loaded_cb_t *loaded_cb );
+    /**
+     * @brief center the view on the current location or the manual nav tile,
+     * reused tiles keep their image and only new tiles are loaded, tiles
+     * that have to be downloaded are picked up by a later update
+     *
+     * @param   view            pointer to the map view
+     * @param   osm_location    pointer to the osm_location structure
+     *
+     * @return  true if tiles were loaded or picked up
+     */
+    bool osm_map_view_update( osm_map_view_t *view, osm_location_t *osm_location );
+    /**
+     * @brief get the position of the current lon/lat in the view
+     *
+     * @param   view            pointer to the map view
+     * @param   osm_location    pointer to the osm_location structure
+     * @param   x               pointer to the x position in px
+     * @param   y               pointer to the y position in px
+     *
+     * @return  true if the position is in view
+     */
+    bool osm_map_view_get_pos( osm_map_view_t *view, osm_location_t *osm_location, lv_coord_t *x, lv_coord_t *y );
+    /**
+     * @brief set the antialias of the zoomed tile images
+     *
+     * @param   view        pointer to the map view
+     * @param   antialias   true to enable antialias
+     */
+    void osm_map_view_set_antialias( osm_map_view_t *view, bool antialias );
+    /**
+     * @brief release all tiles of the view, the next update reloads the grid
+     *
+     * @param   view            pointer to the map view
+     * @param   osm_location    pointer to the osm_location structure
+     */
+    void osm_map_view_release( osm_map_view_t *view, osm_location_t *osm_location );
+    /**
+     * @brief get the view statistics
+     *
+     * @param   view        pointer to the map view
+     *
+     * @return  pointer to a osm_map_view_stats_t structure, NULL if view not set
+     */
+    osm_map_view_stats_t *osm_map_view_get_stats( osm_map_view_t *view );
+    /**
+     * @brief pan the view a number of frames given by HEDGE_OSM_MAP_VIEW_BENCH and
+     * log the frame times, only on native
+     *
+     * @param   view            pointer to the map view
+     * @param   osm_location    pointer to the osm_location structure
+     */
+    void osm_map_view_bench( osm_map_view_t *view, osm_location_t *osm_location );
+
+#endif // _OSM_MAP_VIEW_H
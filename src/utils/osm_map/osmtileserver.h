@@ -44,6 +44,11 @@ unsigned char osmtileserver_json[] = {
   0x65, 0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x73, 0x64, 0x22, 0x3a, 0x22,
   0x66, 0x69, 0x6c, 0x65, 0x3a, 0x2f, 0x2f, 0x2f, 0x73, 0x64, 0x2f, 0x6f,
   0x73, 0x6d, 0x6d, 0x61, 0x70, 0x2f, 0x24, 0x7a, 0x2f, 0x24, 0x78, 0x2f,
-  0x24, 0x79, 0x2e, 0x70, 0x6e, 0x67, 0x22, 0x0a, 0x7d,0x00
+  0x24, 0x79, 0x2e, 0x70, 0x6e, 0x67, 0x22, 0x2c, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x22, 0x6f, 0x66, 0x66, 0x6c, 0x69, 0x6e, 0x65, 0x20, 0x6d, 0x62,
+  0x74, 0x69, 0x6c, 0x65, 0x73, 0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x73,
+  0x64, 0x22, 0x3a, 0x22, 0x6d, 0x62, 0x74, 0x69, 0x6c, 0x65, 0x73, 0x3a,
+  0x2f, 0x2f, 0x2f, 0x73, 0x64, 0x2f, 0x6f, 0x73, 0x6d, 0x6d, 0x61, 0x70,
+  0x2e, 0x6d, 0x62, 0x74, 0x69, 0x6c, 0x65, 0x73, 0x22, 0x0a, 0x7d,0x00
 };
-unsigned int osmtileserver_json_len = 550;
+unsigned int osmtileserver_json_len = 612;
@@ -0,0 +1,192 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "lvgl.h"
+#include "rendergov.h"
+#include "rendergovconfig.h"
+#include "hardware/framebuffer.h"
+#include "hardware/powermgm.h"
+
+#ifdef NATIVE_64BIT
+    #include "utils/logging.h"
+#else
+    #include <Arduino.h>
+#endif
+
+rendergov_config_t rendergov_config;
+callback_t *rendergov_callback = NULL;
+
+static rendergov_stats_t rendergov_stats;
+static volatile uint32_t rendergov_flushes = 0;                     /** @brief flushes since setup */
+static uint32_t rendergov_last_frame = 0;                           /** @brief lv tick of the last frame */
+static uint32_t rendergov_frames_in_row = 0;                        /** @brief frames with less than RENDERGOV_FRAME_GAP between */
+static uint32_t rendergov_reduced_since = 0;                        /** @brief lv tick when quality was reduced */
+
+static bool rendergov_framebuffer_event_cb( EventBits_t event, void *arg );
+static bool rendergov_powermgm_event_cb( EventBits_t event, void *arg );
+static bool rendergov_powermgm_loop_cb( EventBits_t event, void *arg );
+static bool rendergov_send_event_cb( EventBits_t event, void *arg );
+static void rendergov_set_quality( rendergov_quality_t quality );
+
+void rendergov_setup( void ) {
+    rendergov_config.load();
+
+    framebuffer_register_cb( FRAMEBUFFER_FLUSH, rendergov_framebuffer_event_cb, "rendergov" );
+    powermgm_register_cb( POWERMGM_STANDBY, rendergov_powermgm_event_cb, "rendergov" );
+    powermgm_register_loop_cb( POWERMGM_WAKEUP, rendergov_powermgm_loop_cb, "rendergov loop" );
+}
+
+bool rendergov_register_cb( EventBits_t event, CALLBACK_FUNC callback_func, const char *id ) {
+    /*
+     * check if an callback table exist, if not allocate a callback table
+     */
+    if ( rendergov_callback == NULL ) {
+        rendergov_callback = callback_init( "rendergov" );
+        if ( rendergov_callback == NULL ) {
+            log_e("rendergov callback alloc failed");
+            while(true);
+        }
+    }
+    /*
+     * register an callback entry and return them
+     */
+    return( callback_register( rendergov_callback, event, callback_func, id ) );
+}
+
+static bool rendergov_send_event_cb( EventBits_t event, void *arg ) {
+    /*
+     * call all callbacks with her event mask
+     */
+    return( callback_send( rendergov_callback, event, arg ) );
+}
+
+rendergov_quality_t rendergov_get_quality( void ) {
+    return( rendergov_stats.quality );
+}
+
+bool rendergov_is_reduced( void ) {
+    return( rendergov_stats.quality != RENDERGOV_QUALITY_FULL );
+}
+
+void rendergov_set_enable( bool enable ) {
+    rendergov_config.enable = enable;
+    rendergov_config.save();
+    if ( !enable ) {
+        rendergov_set_quality( RENDERGOV_QUALITY_FULL );
+    }
+}
+
+rendergov_stats_t *rendergov_get_stats( void ) {
+    return( &rendergov_stats );
+}
+
+static void rendergov_set_quality( rendergov_quality_t quality ) {
+    if ( rendergov_stats.quality == quality ) {
+        return;
+    }
+
+    if ( quality == RENDERGOV_QUALITY_FULL ) {
+        rendergov_stats.restored++;
+        rendergov_stats.reduced_time += lv_tick_elaps( rendergov_reduced_since );
+        RENDERGOV_INFO_LOG("restore full render quality after %dms", lv_tick_elaps( rendergov_reduced_since ) );
+    }
+    else {
+        rendergov_stats.reduced++;
+        rendergov_reduced_since = lv_tick_get();
+        RENDERGOV_INFO_LOG("reduce render quality, avg frame interval %dms, idle %d%%", rendergov_stats.avg_frame_interval, rendergov_stats.idle );
+    }
+    rendergov_stats.quality = quality;
+    /**
+     * inform all modules with expensive styles
+     */
+    if ( rendergov_callback ) {
+        rendergov_send_event_cb( RENDERGOV_QUALITY, (void*)&rendergov_stats.quality );
+    }
+}
+
+static bool rendergov_framebuffer_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case FRAMEBUFFER_FLUSH:
+            rendergov_flushes++;
+            break;
+    }
+    return( true );
+}
+
+static bool rendergov_powermgm_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case POWERMGM_STANDBY:
+            /**
+             * wakeup always with full quality
+             */
+            rendergov_frames_in_row = 0;
+            rendergov_set_quality( RENDERGOV_QUALITY_FULL );
+            break;
+    }
+    return( true );
+}
+
+static bool rendergov_powermgm_loop_cb( EventBits_t event, void *arg ) {
+    static uint32_t last_flushes = 0;
+
+    if ( !rendergov_config.enable ) {
+        return( true );
+    }
+    /**
+     * a loop round with flushes is a frame, frames in a row are an animation
+     */
+    uint32_t flushes = rendergov_flushes;
+    if ( flushes != last_flushes ) {
+        last_flushes = flushes;
+        uint32_t interval = lv_tick_elaps( rendergov_last_frame );
+        rendergov_last_frame = lv_tick_get();
+
+        if ( interval > RENDERGOV_FRAME_GAP ) {
+            rendergov_frames_in_row = 0;
+            return( true );
+        }
+        /**
+         * moving average over ~8 frames, idle from the lvgl task handler
+         */
+        if ( rendergov_frames_in_row == 0 )
+            rendergov_stats.avg_frame_interval = interval;
+        else
+            rendergov_stats.avg_frame_interval = ( rendergov_stats.avg_frame_interval * 7 + interval ) / 8;
+        rendergov_frames_in_row++;
+        rendergov_stats.frames++;
+        rendergov_stats.idle = lv_task_get_idle();
+
+        if ( rendergov_frames_in_row >= RENDERGOV_MIN_FRAMES ) {
+            if ( rendergov_stats.avg_frame_interval > (uint32_t)rendergov_config.frame_budget || rendergov_stats.idle < (uint32_t)rendergov_config.min_idle ) {
+                rendergov_set_quality( RENDERGOV_QUALITY_REDUCED );
+            }
+        }
+    }
+    /**
+     * restore full quality when the animation is over
+     */
+    else if ( rendergov_is_reduced() && lv_tick_elaps( rendergov_last_frame ) > (uint32_t)rendergov_config.restore_delay ) {
+        rendergov_frames_in_row = 0;
+        rendergov_set_quality( RENDERGOV_QUALITY_FULL );
+    }
+    return( true );
+}
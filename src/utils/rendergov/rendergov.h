@@ -0,0 +1,93 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _RENDERGOV_H
+    #define _RENDERGOV_H
+
+    #include "hardware/callback.h"
+    #include "utils/io.h"
+
+    #define RENDERGOV_INFO_LOG          log_i
+    #define RENDERGOV_DEBUG_LOG         log_d
+    #define RENDERGOV_ERROR_LOG         log_e
+
+    #define RENDERGOV_QUALITY           _BV(0)      /** @brief event mask for a render quality change, arg is a pointer to a rendergov_quality_t */
+    #define RENDERGOV_FRAME_GAP         200         /** @brief frames further apart in ms are not an animation */
+    #define RENDERGOV_MIN_FRAMES        4           /** @brief min frames in a row before the average counts */
+    /**
+     * @brief render quality level
+     */
+    typedef enum {
+        RENDERGOV_QUALITY_FULL = 0,                 /** @brief full quality, antialias and shadows */
+        RENDERGOV_QUALITY_REDUCED                   /** @brief reduced quality, skip expensive styles */
+    } rendergov_quality_t;
+    /**
+     * @brief render governor statistics
+     */
+    typedef struct {
+        rendergov_quality_t quality = RENDERGOV_QUALITY_FULL;   /** @brief current quality */
+        uint32_t frames = 0;                    /** @brief counted animation frames */
+        uint32_t avg_frame_interval = 0;        /** @brief moving average frame interval in ms */
+        uint32_t idle = 100;                    /** @brief last lvgl idle in percent */
+        uint32_t reduced = 0;                   /** @brief number of quality reductions */
+        uint32_t restored = 0;                  /** @brief number of quality restores */
+        uint64_t reduced_time = 0;              /** @brief total time in reduced quality in ms */
+    } rendergov_stats_t;
+    /**
+     * @brief setup render governor
+     */
+    void rendergov_setup( void );
+    /**
+     * @brief registers a callback function which is called on a corresponding event
+     *
+     * @param   event           possible values: RENDERGOV_QUALITY
+     * @param   callback_func   pointer to the callback function
+     * @param   id              program id
+     *
+     * @return  true if success, false if failed
+     */
+    bool rendergov_register_cb( EventBits_t event, CALLBACK_FUNC callback_func, const char *id );
+    /**
+     * @brief get the current render quality
+     *
+     * @return  current rendergov_quality_t
+     */
+    rendergov_quality_t rendergov_get_quality( void );
+    /**
+     * @brief check if expensive styles should be skipped
+     *
+     * @return  true if quality is reduced
+     */
+    bool rendergov_is_reduced( void );
+    /**
+     * @brief enable or disable the render governor, disable restores full quality
+     *
+     * @param   enable  true to enable
+     */
+    void rendergov_set_enable( bool enable );
+    /**
+     * @brief get the render governor statistics
+     *
+     * @return  pointer to a rendergov_stats_t structure
+     */
+    rendergov_stats_t *rendergov_get_stats( void );
+
+#endif // _RENDERGOV_H
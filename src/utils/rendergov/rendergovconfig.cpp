@@ -0,0 +1,52 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "rendergovconfig.h"
+
+rendergov_config_t::rendergov_config_t() : BaseJsonConfig( RENDERGOV_JSON_CONFIG_FILE ) {
+}
+
+bool rendergov_config_t::onSave(JsonDocument& doc) {
+    doc["enable"] = enable;
+    doc["frame_budget"] = frame_budget;
+    doc["min_idle"] = min_idle;
+    doc["restore_delay"] = restore_delay;
+
+    return true;
+}
+
+bool rendergov_config_t::onLoad(JsonDocument& doc) {
+    enable = doc["enable"] | true;
+    frame_budget = doc["frame_budget"] | 40;
+    min_idle = doc["min_idle"] | 10;
+    restore_delay = doc["restore_delay"] | 1000;
+
+    return true;
+}
+
+bool rendergov_config_t::onDefault( void ) {
+    enable = true;
+    frame_budget = 40;
+    min_idle = 10;
+    restore_delay = 1000;
+
+    return true;
+}
@@ -0,0 +1,48 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _RENDERGOV_CONFIG_H
+    #define _RENDERGOV_CONFIG_H
+
+    #include "utils/basejsonconfig.h"
+
+    #define RENDERGOV_JSON_CONFIG_FILE      "/rendergov.json"   /** @brief defines json config file name */
+
+    /**
+     * @brief render governor config structure in memory
+     */
+    class rendergov_config_t : public BaseJsonConfig {
+        public:
+        rendergov_config_t();
+        bool enable = true;                     /** @brief enable the render governor */
+        int32_t frame_budget = 40;              /** @brief max average frame interval in ms while animating */
+        int32_t min_idle = 10;                  /** @brief min lvgl idle in percent while animating */
+        int32_t restore_delay = 1000;           /** @brief time in ms without a frame to restore full quality */
+
+        protected:
+        ////////////// Available for overloading: //////////////
+        virtual bool onLoad(JsonDocument& document);
+        virtual bool onSave(JsonDocument& document);
+        virtual bool onDefault( void );
+        virtual size_t getJsonBufferSize() { return 1000; }
+    };
+
+#endif // _RENDERGOV_CONFIG_H
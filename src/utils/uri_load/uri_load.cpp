@@ -21,6 +21,7 @@
  */
 #include "config.h"
 #include "uri_load.h"
+#include "uri_load_stream.h"
 #include "utils/alloc.h"
 
 #ifdef NATIVE_64BIT
@@ -28,49 +29,11 @@
     #include "utils/millis.h"
     #include <stdio.h>
     #include <stdlib.h>
-    #include <iostream>
-    #include <fstream>
     #include <string.h>
     #include <unistd.h>
     #include <sys/types.h>
     #include <pwd.h>
-    #include <string.h>
-    #include <string>
-    #include <curl/curl.h>
-
-    /**
-     * @brief curl memory control structure
-     */
-    struct MemoryStruct {
-        char *memory;
-        size_t size;
-    };
-    /**
-     * @brief curl memory write callback function
-     */
-    static size_t WriteMemoryCallback(void *contents, size_t size, size_t nmemb, void *userp) {
-        size_t realsize = size * nmemb;
-        struct MemoryStruct *mem = (struct MemoryStruct *)userp;
-        
-        char *ptr = (char*)REALLOC(mem->memory, mem->size + realsize + 1);
-        if(!ptr) {
-            /* out of memory! */
-            log_e("not enough memory (realloc returned NULL)");
-            return 0;
-        }
-        
-        mem->memory = ptr;
-        memcpy(&(mem->memory[mem->size]), contents, realsize);
-        mem->size += realsize;
-        mem->memory[mem->size] = 0;
-        
-        return realsize;
-    }
-
-    using namespace std;
-    #define String string
 #else
-    #include <HTTPClient.h>
     #include <SPIFFS.h>
 #endif
 
@@ -78,10 +41,10 @@ uri_load_dsc_t *uri_load_create_dsc( void );
 void uri_load_set_filename_from_uri( uri_load_dsc_t *uri_load_dsc, const char *uri );
 void uri_load_set_url_from_uri( uri_load_dsc_t *uri_load_dsc, const char *uri );
 uri_load_dsc_t *uri_load_file_to_ram( uri_load_dsc_t *uri_load_dsc );
-uri_load_dsc_t *uri_load_http_to_ram( uri_load_dsc_t *uri_load_dsc );
-uri_load_dsc_t *uri_load_https_to_ram( uri_load_dsc_t *uri_load_dsc );
+uri_load_dsc_t *uri_load_http_to_ram( uri_load_dsc_t *uri_load_dsc, uint32_t flags );
+uri_load_dsc_t *uri_load_https_to_ram( uri_load_dsc_t *uri_load_dsc, uint32_t flags );
 
-uri_load_dsc_t *uri_load_to_ram( const char *uri, progress_cb_t *progresscb ) {
+uri_load_dsc_t *uri_load_to_ram( const char *uri, progress_cb_t *progresscb, uint32_t flags ) {
     /**
      * alloc uri_load_dsc structure
      */
@@ -115,11 +78,11 @@ uri_load_dsc_t *uri_load_to_ram( const char *uri, progress_cb_t *progresscb ) {
          */
         if ( strstr( uri, "http://" ) ) {
             URI_LOAD_LOG("http source");
-            uri_load_dsc = uri_load_http_to_ram( uri_load_dsc );
+            uri_load_dsc = uri_load_http_to_ram( uri_load_dsc, flags );
         }
         else if ( strstr( uri, "https://" ) ) {
             URI_LOAD_LOG("https source");
-            uri_load_dsc = uri_load_https_to_ram( uri_load_dsc );
+            uri_load_dsc = uri_load_https_to_ram( uri_load_dsc, flags );
         }
         else if ( strstr( uri, "file://" ) ) {
             URI_LOAD_LOG("local files source");
@@ -137,11 +100,289 @@ uri_load_dsc_t *uri_load_to_ram( const char *uri, progress_cb_t *progresscb ) {
     return( uri_load_dsc );
 }
 
+uri_load_dsc_t *uri_load_to_ram( const char *uri, progress_cb_t *progresscb ) {
+    return( uri_load_to_ram( uri, progresscb, 0 ) );
+}
+
 uri_load_dsc_t *uri_load_to_ram( const char *uri ) {
-    return( uri_load_to_ram( uri, NULL ) );
+    return( uri_load_to_ram( uri, NULL, 0 ) );
 }
 
-bool uri_load_to_file( const char *uri, const char *path, const char *dest_filename, progress_cb_t *progresscb ) {
+uri_load_dsc_t *uri_load_copy( uri_load_dsc_t *uri_load_dsc ) {
+    uri_load_dsc_t *copy = NULL;
+
+    if ( !uri_load_dsc || !uri_load_dsc->uri ) {
+        return( NULL );
+    }
+    copy = uri_load_create_dsc();
+    if ( !copy ) {
+        URI_LOAD_ERROR_LOG("uri_load_dsc: alloc failed");
+        return( NULL );
+    }
+    copy->timestamp = uri_load_dsc->timestamp;
+    copy->progresscb = uri_load_dsc->progresscb;
+    uri_load_set_filename_from_uri( copy, uri_load_dsc->uri );
+    uri_load_set_url_from_uri( copy, uri_load_dsc->uri );
+    /**
+     * data is zero terminated
+     */
+    if ( uri_load_dsc->data ) {
+        copy->data = (uint8_t*)MALLOC( uri_load_dsc->size + 1 );
+        if ( !copy->data ) {
+            URI_LOAD_ERROR_LOG("uri_load_dsc->data: alloc failed");
+            uri_load_free_all( copy );
+            return( NULL );
+        }
+        memcpy( copy->data, uri_load_dsc->data, uri_load_dsc->size + 1 );
+        copy->size = uri_load_dsc->size;
+    }
+    return( copy );
+}
+
+/**
+ * @brief read the resume state of a partial download, the full length is
+ * -1 if the server did not send it
+ */
+static bool uri_load_resume_read_state( const char *state, const char *uri, char *validator, size_t size, int32_t *length ) {
+    char line[ 512 ] = "";
+    bool retval = false;
+
+    *length = -1;
+    FILE *file = fopen( state, "r" );
+    if ( !file ) {
+        return( false );
+    }
+    if ( fgets( line, sizeof( line ), file ) ) {
+        line[ strcspn( line, "\r\n" ) ] = '\0';
+        if ( !strcmp( line, uri ) && fgets( validator, size, file ) ) {
+            validator[ strcspn( validator, "\r\n" ) ] = '\0';
+            retval = *validator != '\0';
+            if ( fgets( line, sizeof( line ), file ) ) {
+                *length = atol( line );
+            }
+        }
+    }
+    fclose( file );
+    return( retval );
+}
+
+/**
+ * @brief write the resume state of a partial download
+ */
+static void uri_load_resume_write_state( const char *state, const char *uri, const char *validator, int32_t length ) {
+    FILE *file = fopen( state, "w" );
+    if ( file ) {
+        fprintf( file, "%s\n%s\n%d\n", uri, validator, length );
+        fclose( file );
+    }
+}
+
+/**
+ * @brief hash the already downloaded part of a resumed download
+ */
+static bool uri_load_resume_hash_part( const char *part, uint32_t offset, uri_load_hash_t *hash, uint8_t *block ) {
+    FILE *file = fopen( part, "rb" );
+    uint32_t done = 0;
+
+    if ( !file ) {
+        return( false );
+    }
+    while( done < offset ) {
+        size_t len = fread( block, 1, offset - done < URI_BLOCK_SIZE ? offset - done : URI_BLOCK_SIZE, file );
+        if ( !len ) {
+            break;
+        }
+        uri_load_hash_update( hash, block, len );
+        done += len;
+    }
+    fclose( file );
+    return( done == offset );
+}
+
+/**
+ * @brief check a partial file that has nothing left to download, a file of
+ * the known length or one that matches the digest is complete, otherwise the
+ * partial file and the state are removed for a restart from 0
+ *
+ * @return  true if complete, hex holds the hash of the partial file
+ */
+static bool uri_load_resume_finish_part( const char *part, const char *state, uint32_t offset, int32_t length, uri_load_hash_type_t hash_type, const char *digest, uint8_t *block, char *hex ) {
+    uri_load_hash_t hash;
+    bool hashed = false;
+
+    if ( hash_type != URI_LOAD_HASH_NONE ) {
+        uri_load_hash_begin( &hash, hash_type );
+        hashed = uri_load_resume_hash_part( part, offset, &hash, block );
+        uri_load_hash_end( &hash, hex, URI_LOAD_HASH_HEX_LEN );
+    }
+    if ( length >= 0 && offset == (uint32_t)length && ( hash_type == URI_LOAD_HASH_NONE || hashed ) ) {
+        URI_LOAD_INFO_LOG("partial file complete: %s", part );
+        return( true );
+    }
+    if ( hashed && digest && uri_load_hash_match( hex, digest ) ) {
+        URI_LOAD_INFO_LOG("partial file matches the digest: %s", part );
+        return( true );
+    }
+    URI_LOAD_INFO_LOG("partial file broken, restart: %s", part );
+    remove( part );
+    remove( state );
+    return( false );
+}
+
+/**
+ * @brief download a uri into a partial file with resume and verify, rename it when complete
+ */
+static bool uri_load_resume_to_file( const char *uri, const char *filename, progress_cb_t *progresscb, uri_load_hash_type_t hash_type, const char *digest ) {
+    char validator[ URI_LOAD_CACHE_TAG_LEN ] = "";
+    char hex[ URI_LOAD_HASH_HEX_LEN ] = "";
+    uint32_t offset = 0;
+    int32_t length = -1;
+    bool complete = false;
+    bool range_end = false;
+    bool retval = false;
+
+    size_t len = strlen( filename ) + strlen( URI_LOAD_STATE_SUFFIX ) + 1;
+    char *part = (char*)MALLOC( len );
+    char *state = (char*)MALLOC( len );
+    uint8_t *block = (uint8_t*)MALLOC( URI_BLOCK_SIZE );
+    if ( !part || !state || !block ) {
+        URI_LOAD_ERROR_LOG("resume alloc failed");
+        free( part );
+        free( state );
+        free( block );
+        return( false );
+    }
+    snprintf( part, len, "%s" URI_LOAD_PART_SUFFIX, filename );
+    snprintf( state, len, "%s" URI_LOAD_STATE_SUFFIX, filename );
+    /**
+     * a partial file from an earlier call is resumed only if the server can tell it is unchanged
+     */
+    if ( uri_load_resume_read_state( state, uri, validator, sizeof( validator ), &length ) ) {
+        FILE *file = fopen( part, "rb" );
+        if ( file ) {
+            fseek( file, 0, SEEK_END );
+            offset = ftell( file );
+            fclose( file );
+        }
+    }
+    /**
+     * a crash between the last block and the rename leaves a complete
+     * partial file, there is nothing left to request
+     */
+    if ( offset && length >= 0 && offset >= (uint32_t)length ) {
+        complete = uri_load_resume_finish_part( part, state, offset, length, hash_type, digest, block, hex );
+        offset = 0;
+    }
+
+    for( int attempt = 0 ; attempt < URI_LOAD_RESUME_RETRY && !complete ; attempt++ ) {
+        uri_load_hash_t hash;
+        FILE *file = NULL;
+
+        if ( attempt ) {
+            URI_LOAD_INFO_LOG("resume %s at %d bytes, attempt %d", uri, offset, attempt + 1 );
+#ifdef NATIVE_64BIT
+            usleep( URI_LOAD_RESUME_DELAY * 1000 );
+#else
+            delay( URI_LOAD_RESUME_DELAY );
+#endif
+        }
+        /**
+         * the validator and the length only fit a range of the identity body,
+         * a partial file is no cache entry
+         */
+        uri_load_stream_t *stream = uri_load_stream_open( uri, offset, validator, URI_LOAD_NO_CACHE | URI_LOAD_IDENTITY );
+        if ( !stream ) {
+            continue;
+        }
+        /**
+         * the range starts at the end, the partial file is complete or broken,
+         * the restart costs no attempt, but only once
+         */
+        if ( stream->code == 416 ) {
+            uri_load_stream_close( stream );
+            complete = uri_load_resume_finish_part( part, state, offset, length, hash_type, digest, block, hex );
+            offset = 0;
+            if ( !range_end ) {
+                range_end = true;
+                attempt--;
+            }
+            continue;
+        }
+        /**
+         * a 200 instead of a 206 starts over
+         */
+        if ( stream->offset != offset ) {
+            URI_LOAD_INFO_LOG("no resume possible, restart %s", uri );
+            offset = 0;
+        }
+        if ( *stream->meta.etag ) {
+            strncpy( validator, stream->meta.etag, sizeof( validator ) - 1 );
+        }
+        else if ( *stream->meta.last_modified ) {
+            strncpy( validator, stream->meta.last_modified, sizeof( validator ) - 1 );
+        }
+        /**
+         * the full length of the identity body, a compressed one is unknown
+         */
+        length = stream->size >= 0 ? offset + stream->size : -1;
+        uri_load_resume_write_state( state, uri, validator, length );
+
+        file = fopen( part, offset ? "ab" : "wb" );
+        if ( !file ) {
+            URI_LOAD_ERROR_LOG("error open file: %s", part );
+            uri_load_stream_close( stream );
+            break;
+        }
+        uri_load_hash_begin( &hash, hash_type );
+        if ( offset && hash_type != URI_LOAD_HASH_NONE && !uri_load_resume_hash_part( part, offset, &hash, block ) ) {
+            URI_LOAD_ERROR_LOG("can't hash %s", part );
+        }
+        int32_t total = stream->wire_size >= 0 ? offset + stream->wire_size : -1;
+        /**
+         * stream the body into the file, flush every block to keep it on a power loss
+         */
+        while( true ) {
+            int32_t read = uri_load_stream_read( stream, block, URI_BLOCK_SIZE );
+            if ( read <= 0 ) {
+                complete = read == 0;
+                break;
+            }
+            if ( fwrite( block, 1, read, file ) != (size_t)read ) {
+                URI_LOAD_ERROR_LOG("error while write");
+                break;
+            }
+            fflush( file );
+            uri_load_hash_update( &hash, block, read );
+            if ( progresscb && total > 0 ) {
+                progresscb( ( 100 * (uint64_t)( offset + stream->wire ) ) / total );
+            }
+        }
+        offset = ftell( file );
+        fclose( file );
+        uri_load_stream_close( stream );
+        uri_load_hash_end( &hash, hex, sizeof( hex ) );
+    }
+    /**
+     * verify and replace the old file
+     */
+    if ( complete ) {
+        if ( hash_type != URI_LOAD_HASH_NONE && digest && !uri_load_hash_match( hex, digest ) ) {
+            URI_LOAD_ERROR_LOG("hash mismatch: %s, expected %s", hex, digest );
+            remove( part );
+        }
+        else {
+            remove( filename );
+            retval = rename( part, filename ) == 0;
+        }
+        remove( state );
+    }
+    free( part );
+    free( state );
+    free( block );
+    return( retval );
+}
+
+bool uri_load_to_file( const char *uri, const char *path, const char *dest_filename, progress_cb_t *progresscb, uri_load_hash_type_t hash_type, const char *digest ) {
     bool retval = false;
     /**
      * alloc uri_load_dsc structure
@@ -173,106 +414,29 @@ bool uri_load_to_file( const char *uri, const char *path, const char *dest_filen
          */
         uri_load_set_url_from_uri( uri_load_dsc, uri );
         /**
-         * check for uri file source
+         * alloc memory for filename
          */
-        if ( strstr( uri, "http://" ) ) {
-            URI_LOAD_LOG("http source");
-            uri_load_dsc = uri_load_http_to_ram( uri_load_dsc );
-        }
-        else if ( strstr( uri, "https://" ) ) {
-            URI_LOAD_LOG("https source");
-            uri_load_dsc = uri_load_https_to_ram( uri_load_dsc );
-        }
-        else if ( strstr( uri, "file://" ) ) {
-            URI_LOAD_LOG("local files source");
-            uri_load_dsc = uri_load_file_to_ram( uri_load_dsc );
-        }
-        else {
-            URI_LOAD_ERROR_LOG("uri not supported");
-            uri_load_free_all( uri_load_dsc );
-            uri_load_dsc = NULL;
-        }
+        const char *name = dest_filename ? dest_filename : uri_load_dsc->filename;
+        char *filename = name ? (char*)MALLOC( strlen( path ) + strlen( name ) + 1 ) : NULL;
         /**
-         * store to path if download was success
+         * check if alloc failed
          */
-        if ( uri_load_dsc ) {
+        if ( filename ) {
             /**
-             * alloc memory for filename
+             * copy path and filename into a file location string
              */
-            char *filename = NULL;
-            if ( dest_filename ) {
-                filename = (char*)MALLOC( strlen( path ) + strlen( dest_filename ) + 1 );
-            }
-            else {
-                filename = (char*)MALLOC( strlen( path ) + strlen( uri_load_dsc->filename ) + 1 );
-            }
+            strncpy( filename, path, strlen( path ) + strlen( name ) + 1 );
+            strncat( filename, name, strlen( path ) + strlen( name ) + 1 );
             /**
-             * check if alloc failed
+             * download into a partial file, the old file stays until the new one is complete
              */
-            if ( !filename ) {
-                /**
-                 * free uri_load_dsc
-                 */
-                uri_load_free_all( uri_load_dsc );
-            }
-            else {
-                /**
-                 * copy path and filename into a file location string
-                 */
-                if ( dest_filename ) {
-                    strncpy( filename, path, strlen( path ) + strlen( dest_filename ) + 1 );
-                    strncat( filename, dest_filename, strlen( path ) + strlen( dest_filename ) + 1 );
-                }
-                else {
-                    strncpy( filename, path, strlen( path ) + strlen( uri_load_dsc->filename ) + 1 );
-                    strncat( filename, uri_load_dsc->filename, strlen( path ) + strlen( uri_load_dsc->filename ) + 1 );
-                }
-                /**
-                 * open file
-                 */
-                FILE *file = fopen( filename, "wb" );
-                /**
-                 * check if create was successfull
-                 */
-                if ( file ) {
-                    URI_LOAD_LOG("open file: %s", filename );
-                    size_t size = uri_load_dsc->size;
-                    unsigned char *data_p = uri_load_dsc->data;
-                    /**
-                     * write all chunks out
-                     */
-                    while( size ) {
-                        if ( size < URI_BLOCK_SIZE ) {
-                            if ( fwrite( data_p, 1, size, file ) == size ) {
-                                size = 0;
-                            }
-                            break;
-                        }
-                        if ( fwrite( data_p, 1, URI_BLOCK_SIZE, file ) == URI_BLOCK_SIZE ) {
-                            data_p = data_p + URI_BLOCK_SIZE;
-                            size = size - URI_BLOCK_SIZE;
-                        }
-                        else {
-                            break;
-                        }
-                    }
-                    /**
-                     * all bytes written?
-                     */
-                    if ( size ) {
-                        URI_LOAD_ERROR_LOG("error while write %s", filename );
-                    }
-                    else {
-                        retval = true;
-                    }
-                }
-                else {
-                    URI_LOAD_LOG("error open file: %s", filename );
-                }
-                fclose( file );
+            retval = uri_load_resume_to_file( uri, filename, progresscb, hash_type, digest );
+            if ( !retval ) {
+                URI_LOAD_ERROR_LOG("error while load %s", filename );
             }
             free( filename );
         }
+        uri_load_free_all( uri_load_dsc );
     }
     else {
         URI_LOAD_ERROR_LOG("uri_load_dsc: alloc failed");
@@ -280,6 +444,10 @@ bool uri_load_to_file( const char *uri, const char *path, const char *dest_filen
     return( retval );
 }
 
+bool uri_load_to_file( const char *uri, const char *path, const char *dest_filename, progress_cb_t *progresscb ) {
+    return( uri_load_to_file( uri, path, dest_filename, progresscb, URI_LOAD_HASH_NONE, NULL ) );
+}
+
 bool uri_load_to_file( const char *uri, const char *path ) {
     return( uri_load_to_file( uri, path, NULL, NULL ) );
 }
@@ -288,435 +456,70 @@ bool uri_load_to_file( const char *uri, const char *path, const char *dest_filen
     return( uri_load_to_file( uri, path, dest_filename, NULL ) );
 }
 
-uri_load_dsc_t *uri_load_http_to_ram( uri_load_dsc_t *uri_load_dsc ) {
-#ifdef NATIVE_64BIT
-    if ( uri_load_dsc ) {
-        CURL *curl_handle;
-        CURLcode res;
-        struct MemoryStruct chunk;
-
-        chunk.memory = (char*)malloc(1);  /* will be grown as needed by the realloc above */
-        chunk.size = 0;    /* no data at this point */
+/**
+ * @brief load a http/https uri into ram over a pooled connection
+ */
+static uri_load_dsc_t *uri_load_stream_to_ram( uri_load_dsc_t *uri_load_dsc, uint32_t flags ) {
+    uri_load_ram_sink_t ram;
 
-        curl_global_init(CURL_GLOBAL_ALL);
-        /**
-         * init the curl session
-         */
-        curl_handle = curl_easy_init();
-        /**
-         * specify URL to get
-         */
-        curl_easy_setopt( curl_handle, CURLOPT_URL, uri_load_dsc->uri );
-        /**
-         * send all data to this function 
-         */
-        curl_easy_setopt( curl_handle, CURLOPT_WRITEFUNCTION, WriteMemoryCallback );
-        /**
-         * we pass our 'chunk' struct to the callback function
-         */
-        curl_easy_setopt( curl_handle, CURLOPT_WRITEDATA, (void *)&chunk );
-        /**
-         * some servers don't like requests that are made without a user-agent
-         * field, so we provide one
-         */
-        curl_easy_setopt( curl_handle, CURLOPT_USERAGENT, HARDWARE_NAME "-" __FIRMWARE__ );
-        /**
-         * get it!
-         */
-        res = curl_easy_perform( curl_handle );
-        /*
-        * check for errors
-        */
-        if( res != CURLE_OK ) {
-            log_e( "curl_easy_perform() failed: %s\n", curl_easy_strerror( res ) );
-            uri_load_free_all( uri_load_dsc );
-            uri_load_dsc = NULL;
-        }
-        else {
-            /*
-             * Do something nice with it!
-             */
-            uri_load_dsc->data = (uint8_t *)chunk.memory;
-            uri_load_dsc->size = chunk.size;
-        }
-        /**
-         * cleanup curl stuff
-         */
-        curl_easy_cleanup( curl_handle );
-        /**
-         * we're done with libcurl, so clean it up
-         */
-        curl_global_cleanup();
+    if ( !uri_load_dsc ) {
+        URI_LOAD_ERROR_LOG("uri_load_dsc: alloc failed");
+        return( NULL );
     }
+    URI_LOAD_LOG("load file from: %s", uri_load_dsc->uri );
 
-    if ( uri_load_dsc ) {
-        /**
-         * add a char to terminate strings
-         */
-        uint8_t *ptr = (uint8_t*)REALLOC( uri_load_dsc->data , uri_load_dsc->size + 1 );
-        if( !ptr ) {
-            log_e("no memory left");
-            while( 1 );
-        }
-        uri_load_dsc->data = ptr;
-        ptr += uri_load_dsc->size;
-        *ptr = '\0';
+    uri_load_stream_t *stream = uri_load_stream_open( uri_load_dsc->uri, 0, NULL, flags );
+    if ( !stream ) {
+        uri_load_free_all( uri_load_dsc );
+        return( NULL );
     }
-
-#else
-    const char * headerKeys[] = {"location", "redirect", "Content-Type", "Content-Length", "Content-Disposition" };
-    const size_t numberOfHeaders = 5;
     /**
-     * check if alloc was failed
+     * with a content length the data is allocated at once
      */
-    if ( uri_load_dsc ) {
-        URI_LOAD_LOG("load file from: %s", uri_load_dsc->uri );
-        /**
-         * open http connection
-         */
-        HTTPClient download_client;                     /** @brief http download client */
-        download_client.setTimeout( 1500 );
-        download_client.begin( uri_load_dsc->uri );
-        download_client.collectHeaders( headerKeys, numberOfHeaders );
-        download_client.setUserAgent( HARDWARE_NAME "-" __FIRMWARE__ );
-        int httpCode = download_client.GET();
-        /**
-         * request successfull?
-         */
-        if ( httpCode > 0 && httpCode == HTTP_CODE_OK  ) {
-            /**
-             * get file size and alloc memory for the file
-             */
-            uri_load_dsc->size = download_client.getSize();
-            uri_load_dsc->data = (uint8_t*)CALLOC( 1, uri_load_dsc->size + 1 );
-            URI_LOAD_LOG("uri_load_dsc->data: alloc %d bytes at %p", uri_load_dsc->size, uri_load_dsc->data );
-            /**
-             * check if alloc success
-             */
-            if ( uri_load_dsc->data ) {
-                /**
-                 * setup data write counter/pointer/buffer and data stream
-                 */
-                uint32_t bytes_left = uri_load_dsc->size;                           /** @brief download left byte counter */
-                uint8_t *data_write_p = uri_load_dsc->data;                         /** @brief write pointer for the raw file download */
-                WiFiClient *download_stream = download_client.getStreamPtr();       /** @brief get streampointer */
-                /**
-                 * get download data
-                 */
-                while( download_client.connected() && ( bytes_left > 0 ) ) {
-                    /**
-                     * get bytes in buffer and store them
-                     */
-                    size_t size = download_stream->available();
-                    if ( size > 0 ) {
-                        size_t c = download_stream->readBytes( data_write_p, size < bytes_left ? size : bytes_left );
-                        bytes_left -= c;
-                        data_write_p = data_write_p + c;
-                        if ( uri_load_dsc->progresscb ) {
-                            uri_load_dsc->progresscb( ( 100 * ( uri_load_dsc->size - bytes_left ) ) / uri_load_dsc->size );
-                        }
-                    }
-                }
-                if ( bytes_left != 0 ) {
-                    URI_LOAD_ERROR_LOG("download failed");
-                    download_client.end();
-                    uri_load_free_all( uri_load_dsc );
-                    return( NULL );
-                }
-            }
-            else {
-                URI_LOAD_ERROR_LOG("data alloc failed, %d bytes", uri_load_dsc->size );
-                download_client.end();
-                uri_load_free_all( uri_load_dsc );
-                return( NULL );
-            }
-        }
-        else {
-            String location = "";
-            /**
-             * check for a 301/302 redirect
-             */
-            if ( httpCode == 301 || httpCode == 302 ) {
-                if ( download_client.header("location") != "" ) {
-                    location = download_client.header("location");    
-                }
-                else {
-                    location = download_client.header("redirect");    
-                }
-                URI_LOAD_INFO_LOG("301/302 redirect to: %s", location.c_str() );
-            }
-            /**
-             * clean old connection
-             */
-            download_client.end();
-            /**
-             * if we have a new location, try it
-             */
-            if ( location ) {
-                /**
-                 * get new location data
-                 */
-                uri_load_dsc_t *_uri_load_dsc = uri_load_to_ram( location.c_str(), uri_load_dsc->progresscb );
-                /**
-                 * if was success, set data and file size to the old uri_load_dsc to save
-                 * old filename and uri to hide redirect
-                 */
-                if ( _uri_load_dsc ) {
-                    uri_load_dsc->data = _uri_load_dsc->data;
-                    uri_load_dsc->size = _uri_load_dsc->size;
-                    uri_load_free_without_data( _uri_load_dsc );
-                }
-                else {
-                    /**
-                     * clear old uri_load_dsc
-                     */
-                    uri_load_free_all( uri_load_dsc );
-                    uri_load_dsc = NULL;                    
-                    URI_LOAD_ERROR_LOG("redirect failed");
-                }
-            }
-            else {
-                uri_load_free_all( uri_load_dsc );
-                uri_load_dsc = NULL;
-                URI_LOAD_ERROR_LOG("http connection abort, code: %d", httpCode );
-            }
-            return( uri_load_dsc );
-        }
-        /**
-         * close http connection
-         */
-        download_client.end();
+    if ( stream->size >= 0 ) {
+        ram.capacity = stream->size + 1;
     }
-    else {
-        URI_LOAD_ERROR_LOG("uri_load_dsc: alloc failed");
-    }
-#endif
-    return( uri_load_dsc );
-}
-
-uri_load_dsc_t *uri_load_https_to_ram( uri_load_dsc_t *uri_load_dsc ) {
-#ifdef NATIVE_64BIT
-    if ( uri_load_dsc ) {
-        CURL *curl_handle;
-        CURLcode res;
-        struct MemoryStruct chunk;
-        /**
-         * will be grown as needed by the realloc above
-         * no data at this point
-         */
-        chunk.memory = (char*)malloc( 1 );  
-        chunk.size = 0;
-        /**
-         * global curl init
-         */
-        curl_global_init(CURL_GLOBAL_ALL);
-        /**
-         * init the curl session
-         */
-        curl_handle = curl_easy_init();
-        /**
-         * specify URL to get
-         */
-        curl_easy_setopt( curl_handle, CURLOPT_URL, uri_load_dsc->uri );
-        /**
-         * send all data to this function 
-         */
-        curl_easy_setopt( curl_handle, CURLOPT_WRITEFUNCTION, WriteMemoryCallback );
-        /**
-         * we pass our 'chunk' struct to the callback function
-         */
-        curl_easy_setopt( curl_handle, CURLOPT_WRITEDATA, (void *)&chunk );
-        /**
-         * some servers don't like requests that are made without a user-agent
-         * field, so we provide one
-         */
-        curl_easy_setopt( curl_handle, CURLOPT_USERAGENT, HARDWARE_NAME "-" __FIRMWARE__ );
-        /**
-         * get it!
-         */
-        res = curl_easy_perform( curl_handle );
-        /*
-        * check for errors
-        */
-        if( res != CURLE_OK ) {
-            URI_LOAD_ERROR_LOG( "curl_easy_perform() failed: %s\n", curl_easy_strerror( res ) );
-            uri_load_free_all( uri_load_dsc );
-            uri_load_dsc = NULL;
-        }
-        else {
-            /*
-            * Now, our chunk.memory points to a memory block that is chunk.size
-            * bytes big and contains the remote file.
-            *
-            * Do something nice with it!
-            */
-            uri_load_dsc->data = (uint8_t *)chunk.memory;
-            uri_load_dsc->size = chunk.size;
+    uint8_t *block = (uint8_t*)MALLOC( URI_BLOCK_SIZE );
+    bool success = block != NULL;
+    while( success ) {
+        int32_t len = uri_load_stream_read( stream, block, URI_BLOCK_SIZE );
+        if ( len <= 0 ) {
+            success = len == 0;
+            break;
         }
-        /**
-         * cleanup curl stuff
-         */
-        curl_easy_cleanup(curl_handle);
-        /**
-         * we're done with libcurl, so clean it up
-         */
-        curl_global_cleanup();
-    }
-
-    if ( uri_load_dsc ) {
-        /**
-         * add a char to terminate strings
-         */
-        uint8_t *ptr = (uint8_t*)REALLOC( uri_load_dsc->data , uri_load_dsc->size + 1 );
-        if( !ptr ) {
-            URI_LOAD_ERROR_LOG("no memory left");
-            while( 1 );
+        success = uri_load_sink_ram( block, len, &ram );
+        if ( success && uri_load_dsc->progresscb && stream->wire_size > 0 ) {
+            uri_load_dsc->progresscb( ( 100 * (uint64_t)stream->wire ) / stream->wire_size );
         }
-        uri_load_dsc->data = ptr;
-        ptr += uri_load_dsc->size;
-        *ptr = '\0';
     }
-
-#else
-    const char * headerKeys[] = {"location", "redirect", "Content-Type", "Content-Length", "Content-Disposition" };
-    const size_t numberOfHeaders = 5;
     /**
-     * check if alloc was failed
+     * empty body, add a char to terminate strings
      */
-    if ( uri_load_dsc ) {
-        URI_LOAD_LOG("load file from: %s", uri_load_dsc->uri );
-        /**
-         * open http connection
-         */
-        heap_caps_malloc_extmem_enable( 1 );
-        WiFiClientSecure *client = new WiFiClientSecure;                            /** @brief SSL/TLS client connection */
-        client->setInsecure();                                                      /** allow insecure connection */
-        HTTPClient download_client;                                                 /** @brief http download client */
-        download_client.begin( *client, uri_load_dsc->uri );
-        download_client.collectHeaders( headerKeys, numberOfHeaders );
-        download_client.setUserAgent( HARDWARE_NAME "-" __FIRMWARE__ );
-        int httpCode = download_client.GET();
-        /**
-         * request successfull?
-         */
-        if ( httpCode > 0 && httpCode == HTTP_CODE_OK  ) {
-            /**
-             * get file size and alloc memory for the file
-             */
-            uri_load_dsc->size = download_client.getSize();
-            uri_load_dsc->data = (uint8_t*)CALLOC( 1, uri_load_dsc->size + 1 );
-            URI_LOAD_LOG("uri_load_dsc->data: alloc %d bytes at %p", uri_load_dsc->size, uri_load_dsc->data );
-            /**
-             * check if alloc success
-             */
-            if ( uri_load_dsc->data ) {
-                /**
-                 * setup data write counter/pointer/buffer and data stream
-                 */
-                uint32_t bytes_left = uri_load_dsc->size;                           /** @brief download left byte counter */
-                uint8_t *data_write_p = uri_load_dsc->data;                         /** @brief write pointer for the raw file download */
-                WiFiClient *download_stream = download_client.getStreamPtr();       /** @brief get streampointer */
-                /**
-                 * get download data
-                 */
-                while( download_client.connected() && ( bytes_left > 0 ) ) {
-                    /**
-                     * get bytes in buffer and store them
-                     */
-                    size_t size = download_stream->available();
-                    if ( size > 0 ) {
-                        size_t c = download_stream->readBytes( data_write_p, size < bytes_left ? size : bytes_left );
-                        bytes_left -= c;
-                        data_write_p = data_write_p + c;
-                        if ( uri_load_dsc->progresscb ) {
-                            uri_load_dsc->progresscb( ( 100 * ( uri_load_dsc->size - bytes_left ) ) / uri_load_dsc->size );
-                        }
-                    }
-                }
-                if ( bytes_left != 0 ) {
-                    URI_LOAD_ERROR_LOG("download failed");
-                    download_client.end();
-                    client->stop();
-                    uri_load_free_all( uri_load_dsc );
-                    heap_caps_malloc_extmem_enable( 16 * 1024 );
-                    return( NULL );
-                }
-            }
-            else {
-                URI_LOAD_ERROR_LOG("data alloc failed, %d bytes", uri_load_dsc->size );
-                download_client.end();
-                client->stop();
-                uri_load_free_all( uri_load_dsc );
-                heap_caps_malloc_extmem_enable( 16 * 1024 );
-                return( NULL );
-            }
-        }
-        else {
-            String location = "";
-            /**
-             * check for a 301/302 redirect
-             */
-            if ( httpCode == 301 || httpCode == 302 ) {
-                if ( download_client.header("location") != "" ) {
-                    location = download_client.header("location");    
-                }
-                else {
-                    location = download_client.header("redirect");    
-                }
-                URI_LOAD_INFO_LOG("301/302 redirect to: %s", location.c_str() );
-            }
-            /**
-             * clean old connection
-             */
-            download_client.end();
-            client->stop();
-            /**
-             * if we have a new location, try it
-             */
-            if ( location ) {
-                /**
-                 * get new location data
-                 */
-                uri_load_dsc_t *_uri_load_dsc = uri_load_to_ram( location.c_str(), uri_load_dsc->progresscb );
-                /**
-                 * if was success, set data and file size to the old uri_load_dsc to save
-                 * old filename and uri to hide redirect
-                 */
-                if ( _uri_load_dsc ) {
-                    uri_load_dsc->data = _uri_load_dsc->data;
-                    uri_load_dsc->size = _uri_load_dsc->size;
-                    uri_load_free_without_data( _uri_load_dsc );
-                }
-                else {
-                    /**
-                     * clear old uri_load_dsc
-                     */
-                    uri_load_free_all( uri_load_dsc );
-                    uri_load_dsc = NULL;                    
-                    URI_LOAD_ERROR_LOG("redirect failed");
-                }
-            }
-            else {
-                uri_load_free_all( uri_load_dsc );
-                uri_load_dsc = NULL;
-                URI_LOAD_ERROR_LOG("http connection abort, code: %d", httpCode );
-            }
-            return( uri_load_dsc );
-        }
-        /**
-         * close http connection
-         */
-        download_client.end();
-        client->stop();
-        heap_caps_malloc_extmem_enable( 16 * 1024 );
+    if ( success && !ram.data ) {
+        success = uri_load_sink_ram( NULL, 0, &ram );
     }
-    else {
-        URI_LOAD_ERROR_LOG("uri_load_dsc: alloc failed");
+    free( block );
+    uri_load_stream_close( stream );
+
+    if ( !success ) {
+        URI_LOAD_ERROR_LOG("download failed");
+        free( ram.data );
+        uri_load_free_all( uri_load_dsc );
+        return( NULL );
     }
-#endif
+    uri_load_dsc->data = ram.data;
+    uri_load_dsc->size = ram.size;
     return( uri_load_dsc );
 }
 
+uri_load_dsc_t *uri_load_http_to_ram( uri_load_dsc_t *uri_load_dsc, uint32_t flags ) {
+    return( uri_load_stream_to_ram( uri_load_dsc, flags ) );
+}
+
+uri_load_dsc_t *uri_load_https_to_ram( uri_load_dsc_t *uri_load_dsc, uint32_t flags ) {
+    return( uri_load_stream_to_ram( uri_load_dsc, flags ) );
+}
+
 uri_load_dsc_t *uri_load_file_to_ram( uri_load_dsc_t *uri_load_dsc ) {
     /**
      * check if alloc was failed
@@ -23,6 +23,7 @@
     #define _URI_LOAD__H
 
     #include <stdint.h>
+    #include "uri_load_hash.h"
 
     #define URI_LOAD_INFO_LOG   log_i
     #define URI_LOAD_LOG        log_d
@@ -30,6 +31,14 @@
 
     #define URI_BLOCK_SIZE      4096
 
+    #define URI_LOAD_PART_SUFFIX        ".part"     /** @brief suffix of a partial download */
+    #define URI_LOAD_STATE_SUFFIX       ".state"    /** @brief suffix of the resume state sidecar */
+    #define URI_LOAD_RESUME_RETRY       3           /** @brief download attempts in one uri_load_to_file() call */
+    #define URI_LOAD_RESUME_DELAY       1000        /** @brief ms between attempts */
+
+    #define URI_LOAD_NO_CACHE           0x01        /** @brief bypass the response cache, e.g. for data with its own store */
+    #define URI_LOAD_IDENTITY           0x02        /** @brief request the body without content encoding */
+
     /**
      * @brief typedef for the callback function call
      * 
@@ -63,6 +72,24 @@
      * @return  uri_load_dsc structure
      */
     uri_load_dsc_t *uri_load_to_ram( const char *uri, progress_cb_t *progresscb );
+    /**
+     * @brief doenload a file from a webserver into ram
+     * 
+     * @param   uri requested url to get a file from
+     * @param   progresscb  pointer to a call back funtion or NULL
+     * @param   flags   URI_LOAD_NO_CACHE, URI_LOAD_IDENTITY or 0
+     * 
+     * @return  uri_load_dsc structure
+     */
+    uri_load_dsc_t *uri_load_to_ram( const char *uri, progress_cb_t *progresscb, uint32_t flags );
+    /**
+     * @brief duplicate a uri_load_dsc structure with all allocated memory
+     * 
+     * @param   uri_load_dsc pointer to a uri_load_dsc structure
+     * 
+     * @return  uri_load_dsc structure, NULL if alloc failed
+     */
+    uri_load_dsc_t *uri_load_copy( uri_load_dsc_t *uri_load_dsc );
     /**
      * @brief doenload a file from a webserver into a file
      * 
@@ -91,6 +118,23 @@
      * @return  true if success
      */
     bool uri_load_to_file( const char *uri, const char *path, const char *dest_filename, progress_cb_t *progresscb );
+    /**
+     * @brief download a file from a webserver into a file, resumable and verified
+     * 
+     * the body goes into a partial file with a resume state sidecar, a broken
+     * transfer is resumed with a range request, in the same call or the next
+     * call for the same uri, the hash is computed while the body arrives
+     * 
+     * @param   uri requested url to get a file from
+     * @param   path path to write the downloaded file, e.g.: "/spiffs/"
+     * @param   dest_filename   destination filename or NULL for the filename from the uri
+     * @param   progresscb  pointer to a call back funtion or NULL
+     * @param   hash_type   URI_LOAD_HASH_NONE, URI_LOAD_HASH_MD5 or URI_LOAD_HASH_SHA256
+     * @param   digest  expected hex digest or NULL
+     * 
+     * @return  true if success and the digest matches
+     */
+    bool uri_load_to_file( const char *uri, const char *path, const char *dest_filename, progress_cb_t *progresscb, uri_load_hash_type_t hash_type, const char *digest );
     /**
      * @brief delete the complete uri_load_dsc structure and free all allocated memory
      * 
@@ -0,0 +1,404 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "uri_load.h"
+#include "uri_load_cache.h"
+#include "utils/filepath_convert.h"
+#include "utils/lock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#ifdef NATIVE_64BIT
+    #include "utils/logging.h"
+#else
+    #include <Arduino.h>
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/semphr.h>
+#endif
+static lock_mutex_t uri_load_cache_mutex = LOCK_MUTEX_INITIALIZER;     /** @brief uri_load is called from different tasks */
+
+/**
+ * @brief in memory index of the cache dir, built at first use
+ */
+typedef struct {
+    uint32_t hash;                                                  /** @brief uri hash, also the file name */
+    uint32_t size;                                                  /** @brief file size */
+    uint32_t last_used;                                             /** @brief use counter for lru eviction */
+} uri_load_cache_entry_t;
+
+static uri_load_cache_entry_t uri_load_cache_index[ URI_LOAD_CACHE_MAX_ENTRIES ];
+static uri_load_cache_stats_t uri_load_cache_stats;
+static uint32_t uri_load_cache_use_counter = 0;
+static uint32_t uri_load_cache_max_size = URI_LOAD_CACHE_MAX_SIZE;
+static char uri_load_cache_dir[ 128 ] = "";                         /** @brief empty until the index is built */
+static bool uri_load_cache_enable = true;
+
+static void uri_load_cache_lock( void ) {
+    lock_mutex_take( &uri_load_cache_mutex );
+}
+
+static void uri_load_cache_unlock( void ) {
+    lock_mutex_give( &uri_load_cache_mutex );
+}
+
+/**
+ * @brief FNV-1a hash of the uri
+ */
+static uint32_t uri_load_cache_hash( const char *uri ) {
+    uint32_t hash = 2166136261UL;
+
+    while( *uri ) {
+        hash ^= (uint8_t)*uri++;
+        hash *= 16777619UL;
+    }
+    return( hash );
+}
+
+static void uri_load_cache_path( char *path, size_t size, uint32_t hash, bool tmp ) {
+    snprintf( path, size, "%s/%08x%s", uri_load_cache_dir, hash, tmp ? ".tmp" : "" );
+}
+
+/**
+ * @brief find the index slot of a hash, -1 if not cached
+ */
+static int uri_load_cache_find( uint32_t hash ) {
+    for( int i = 0 ; i < (int)uri_load_cache_stats.entries ; i++ ) {
+        if ( uri_load_cache_index[ i ].hash == hash ) {
+            return( i );
+        }
+    }
+    return( -1 );
+}
+
+static void uri_load_cache_remove( int slot ) {
+    char path[ 160 ] = "";
+
+    uri_load_cache_path( path, sizeof( path ), uri_load_cache_index[ slot ].hash, false );
+    remove( path );
+    uri_load_cache_stats.size -= uri_load_cache_index[ slot ].size;
+    uri_load_cache_stats.entries--;
+    uri_load_cache_index[ slot ] = uri_load_cache_index[ uri_load_cache_stats.entries ];
+}
+
+/**
+ * @brief choose the cache dir and build the index from the files in it,
+ * call with lock held
+ */
+static bool uri_load_cache_init( void ) {
+    char path[ 160 ] = "";
+
+    if ( *uri_load_cache_dir ) {
+        return( true );
+    }
+#ifdef NATIVE_64BIT
+    filepath_convert( uri_load_cache_dir, sizeof( uri_load_cache_dir ), "cache" );
+#else
+    /**
+     * sd card if mounted, spiffs has less room
+     */
+    DIR *sd = opendir( "/sd" );
+    if ( sd ) {
+        closedir( sd );
+        snprintf( uri_load_cache_dir, sizeof( uri_load_cache_dir ), "/sd" URI_LOAD_CACHE_DIR );
+    }
+    else {
+        snprintf( uri_load_cache_dir, sizeof( uri_load_cache_dir ), "/spiffs" URI_LOAD_CACHE_DIR );
+        uri_load_cache_max_size = URI_LOAD_CACHE_MAX_SIZE_SPIFFS;
+    }
+#endif
+    mkdir( uri_load_cache_dir, 0700 );
+
+    DIR *dir = opendir( uri_load_cache_dir );
+    if ( !dir ) {
+        URI_LOAD_ERROR_LOG("can't open cache dir %s", uri_load_cache_dir );
+        *uri_load_cache_dir = '\0';
+        return( false );
+    }
+    /**
+     * spiffs has no dirs, readdir can return the full path
+     */
+    struct dirent *entry = NULL;
+    while( ( entry = readdir( dir ) ) ) {
+        const char *name = strrchr( entry->d_name, '/' ) ? strrchr( entry->d_name, '/' ) + 1 : entry->d_name;
+        char *end = NULL;
+        struct stat st;
+
+        uint32_t hash = strtoul( name, &end, 16 );
+        if ( end - name != 8 ) {
+            continue;
+        }
+        /**
+         * remove unfinished entries
+         */
+        if ( *end ) {
+            if ( !strcmp( end, ".tmp" ) ) {
+                uri_load_cache_path( path, sizeof( path ), hash, true );
+                remove( path );
+            }
+            continue;
+        }
+        uri_load_cache_path( path, sizeof( path ), hash, false );
+        if ( stat( path, &st ) || uri_load_cache_stats.entries >= URI_LOAD_CACHE_MAX_ENTRIES ) {
+            continue;
+        }
+        uri_load_cache_entry_t *slot = &uri_load_cache_index[ uri_load_cache_stats.entries++ ];
+        slot->hash = hash;
+        slot->size = st.st_size;
+        slot->last_used = 0;
+        uri_load_cache_stats.size += st.st_size;
+    }
+    closedir( dir );
+    URI_LOAD_INFO_LOG("cache %s: %d entries, %d bytes", uri_load_cache_dir, uri_load_cache_stats.entries, uri_load_cache_stats.size );
+    return( true );
+}
+
+/**
+ * @brief read one header line without line end
+ */
+static bool uri_load_cache_read_line( FILE *file, char *line, size_t size ) {
+    if ( !fgets( line, size, file ) ) {
+        return( false );
+    }
+    line[ strcspn( line, "\r\n" ) ] = '\0';
+    return( true );
+}
+
+FILE *uri_load_cache_open( const char *uri, uri_load_cache_meta_t *meta ) {
+    char path[ 160 ] = "";
+    char line[ URI_LOAD_CACHE_URI_LEN + 2 ] = "";
+    uint32_t hash = uri_load_cache_hash( uri );
+    FILE *file = NULL;
+
+    if ( !uri_load_cache_enable || strlen( uri ) >= URI_LOAD_CACHE_URI_LEN ) {
+        return( NULL );
+    }
+
+    uri_load_cache_lock();
+    uri_load_cache_stats.requests++;
+    int slot = uri_load_cache_init() ? uri_load_cache_find( hash ) : -1;
+    if ( slot >= 0 ) {
+        uri_load_cache_index[ slot ].last_used = ++uri_load_cache_use_counter;
+        uri_load_cache_path( path, sizeof( path ), hash, false );
+    }
+    uri_load_cache_unlock();
+
+    if ( slot < 0 ) {
+        return( NULL );
+    }
+    file = fopen( path, "rb" );
+    if ( !file ) {
+        return( NULL );
+    }
+    /**
+     * magic, expires, uri, etag, last-modified and then the body
+     */
+    long long expires = 0;
+    bool valid = uri_load_cache_read_line( file, line, sizeof( line ) ) && !strcmp( line, URI_LOAD_CACHE_MAGIC );
+    valid = valid && uri_load_cache_read_line( file, line, sizeof( line ) ) && sscanf( line, "%lld", &expires ) == 1;
+    valid = valid && uri_load_cache_read_line( file, line, sizeof( line ) ) && !strcmp( line, uri );
+    valid = valid && uri_load_cache_read_line( file, meta->etag, sizeof( meta->etag ) );
+    valid = valid && uri_load_cache_read_line( file, meta->last_modified, sizeof( meta->last_modified ) );
+    if ( !valid ) {
+        URI_LOAD_LOG("cache entry %08x doesn't match %s", hash, uri );
+        fclose( file );
+        *meta = uri_load_cache_meta_t();
+        return( NULL );
+    }
+    meta->expires = expires;
+    /**
+     * the rest is the body
+     */
+    long body_pos = ftell( file );
+    fseek( file, 0, SEEK_END );
+    meta->size = ftell( file ) - body_pos;
+    fseek( file, body_pos, SEEK_SET );
+    return( file );
+}
+
+void uri_load_cache_refresh( const char *uri, uri_load_cache_meta_t *meta ) {
+    char path[ 160 ] = "";
+
+    uri_load_cache_lock();
+    uri_load_cache_path( path, sizeof( path ), uri_load_cache_hash( uri ), false );
+    uri_load_cache_unlock();
+    /**
+     * expires has a fixed width behind the magic, overwrite it in place
+     */
+    FILE *file = fopen( path, "r+b" );
+    if ( file ) {
+        fseek( file, strlen( URI_LOAD_CACHE_MAGIC "\n" ), SEEK_SET );
+        fprintf( file, "%020lld\n", (long long)meta->expires );
+        fclose( file );
+    }
+}
+
+void uri_load_cache_parse_header( uri_load_cache_meta_t *meta, const char *name, const char *value ) {
+    if ( !strcasecmp( name, "ETag" ) ) {
+        strncpy( meta->etag, value, sizeof( meta->etag ) - 1 );
+        meta->etag[ sizeof( meta->etag ) - 1 ] = '\0';
+    }
+    else if ( !strcasecmp( name, "Last-Modified" ) ) {
+        strncpy( meta->last_modified, value, sizeof( meta->last_modified ) - 1 );
+        meta->last_modified[ sizeof( meta->last_modified ) - 1 ] = '\0';
+    }
+    else if ( !strcasecmp( name, "Cache-Control" ) ) {
+        const char *max_age = strstr( value, "max-age=" );
+        time_t now = time( NULL );
+        /**
+         * no-cache means revalidate every time, without a set clock max-age is useless
+         */
+        if ( strstr( value, "no-store" ) ) {
+            meta->no_store = true;
+        }
+        if ( max_age && !strstr( value, "no-cache" ) && now > URI_LOAD_CACHE_MIN_TIME ) {
+            meta->expires = now + atol( max_age + 8 );
+        }
+    }
+}
+
+bool uri_load_cache_is_cacheable( uri_load_cache_meta_t *meta ) {
+    if ( !uri_load_cache_enable || meta->no_store ) {
+        return( false );
+    }
+    if ( meta->size > URI_LOAD_CACHE_MAX_ENTRY_SIZE ) {
+        return( false );
+    }
+    return( *meta->etag || *meta->last_modified || meta->expires > time( NULL ) );
+}
+
+FILE *uri_load_cache_create( const char *uri, uri_load_cache_meta_t *meta ) {
+    char path[ 160 ] = "";
+    FILE *file = NULL;
+
+    if ( strlen( uri ) >= URI_LOAD_CACHE_URI_LEN ) {
+        return( NULL );
+    }
+
+    uri_load_cache_lock();
+    if ( uri_load_cache_init() ) {
+        uri_load_cache_path( path, sizeof( path ), uri_load_cache_hash( uri ), true );
+    }
+    uri_load_cache_unlock();
+
+    if ( !*path ) {
+        return( NULL );
+    }
+    file = fopen( path, "wb" );
+    if ( !file ) {
+        URI_LOAD_ERROR_LOG("can't create cache entry %s", path );
+        return( NULL );
+    }
+    fprintf( file, URI_LOAD_CACHE_MAGIC "\n%020lld\n%s\n%s\n%s\n", (long long)meta->expires, uri, meta->etag, meta->last_modified );
+    return( file );
+}
+
+void uri_load_cache_commit( const char *uri, FILE *file, bool success ) {
+    char tmp_path[ 160 ] = "";
+    char path[ 160 ] = "";
+    uint32_t hash = uri_load_cache_hash( uri );
+
+    if ( !file ) {
+        return;
+    }
+    uri_load_cache_lock();
+    uri_load_cache_path( tmp_path, sizeof( tmp_path ), hash, true );
+    uri_load_cache_path( path, sizeof( path ), hash, false );
+    long file_size = success ? ftell( file ) : 0;
+    success = fclose( file ) == 0 && success;
+    /**
+     * replace the old entry
+     */
+    int slot = uri_load_cache_find( hash );
+    if ( slot >= 0 ) {
+        uri_load_cache_remove( slot );
+    }
+    if ( !success || rename( tmp_path, path ) ) {
+        remove( tmp_path );
+        uri_load_cache_unlock();
+        return;
+    }
+    /**
+     * evict least recently used entries until the new one fits
+     */
+    while( uri_load_cache_stats.entries && ( uri_load_cache_stats.entries >= URI_LOAD_CACHE_MAX_ENTRIES || uri_load_cache_stats.size + file_size > uri_load_cache_max_size ) ) {
+        int lru = 0;
+        for( int i = 1 ; i < (int)uri_load_cache_stats.entries ; i++ ) {
+            if ( uri_load_cache_index[ i ].last_used < uri_load_cache_index[ lru ].last_used ) {
+                lru = i;
+            }
+        }
+        uri_load_cache_remove( lru );
+        uri_load_cache_stats.evicted++;
+    }
+    uri_load_cache_entry_t *entry = &uri_load_cache_index[ uri_load_cache_stats.entries++ ];
+    entry->hash = hash;
+    entry->size = file_size;
+    entry->last_used = ++uri_load_cache_use_counter;
+    uri_load_cache_stats.size += file_size;
+    uri_load_cache_stats.stored++;
+    uri_load_cache_unlock();
+}
+
+void uri_load_cache_count( bool hit, bool revalidated, uint32_t size ) {
+    uri_load_cache_lock();
+    if ( revalidated ) {
+        uri_load_cache_stats.revalidated++;
+    }
+    else if ( hit ) {
+        uri_load_cache_stats.hits++;
+    }
+    else {
+        uri_load_cache_stats.misses++;
+    }
+    if ( hit || revalidated ) {
+        uri_load_cache_stats.bytes_saved += size;
+    }
+    uri_load_cache_unlock();
+}
+
+void uri_load_cache_set_enable( bool enable ) {
+    uri_load_cache_enable = enable;
+}
+
+bool uri_load_cache_get_enable( void ) {
+    return( uri_load_cache_enable );
+}
+
+void uri_load_cache_clear( void ) {
+    uri_load_cache_lock();
+    if ( uri_load_cache_init() ) {
+        while( uri_load_cache_stats.entries ) {
+            uri_load_cache_remove( 0 );
+        }
+    }
+    uri_load_cache_unlock();
+}
+
+uri_load_cache_stats_t *uri_load_cache_get_stats( void ) {
+    return( &uri_load_cache_stats );
+}
@@ -0,0 +1,141 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _URI_LOAD_CACHE_H
+    #define _URI_LOAD_CACHE_H
+
+    #include <stdio.h>
+    #include <stdint.h>
+
+    #define URI_LOAD_CACHE_DIR              "/cache"            /** @brief cache dir below /sd, /spiffs or ~/.hedge */
+    #define URI_LOAD_CACHE_MAGIC            "URICACHE1"         /** @brief first line of a cache entry */
+    #define URI_LOAD_CACHE_TAG_LEN          80                  /** @brief max etag/last-modified length */
+    #define URI_LOAD_CACHE_URI_LEN          512                 /** @brief don't cache longer uris */
+    #define URI_LOAD_CACHE_MAX_ENTRIES      256                 /** @brief max cached responses */
+    #define URI_LOAD_CACHE_MAX_SIZE         ( 4 * 1024 * 1024 ) /** @brief cache size on sd and native */
+    #define URI_LOAD_CACHE_MAX_SIZE_SPIFFS  ( 256 * 1024 )      /** @brief cache size on spiffs */
+    #define URI_LOAD_CACHE_MAX_ENTRY_SIZE   ( 128 * 1024 )      /** @brief don't cache bigger responses */
+    #define URI_LOAD_CACHE_MIN_TIME         1600000000          /** @brief unix time below means the clock is not set */
+    /**
+     * @brief cache validators and freshness of a response
+     */
+    typedef struct {
+        char etag[ URI_LOAD_CACHE_TAG_LEN ] = "";           /** @brief ETag header */
+        char last_modified[ URI_LOAD_CACHE_TAG_LEN ] = "";  /** @brief Last-Modified header */
+        int64_t expires = 0;                                /** @brief fresh without revalidation until this unix time */
+        bool no_store = false;                              /** @brief Cache-Control: no-store */
+        int32_t size = -1;                                  /** @brief body size */
+    } uri_load_cache_meta_t;
+    /**
+     * @brief cache statistics
+     */
+    typedef struct {
+        uint32_t requests = 0;                  /** @brief cacheable requests */
+        uint32_t hits = 0;                      /** @brief served from cache without a request */
+        uint32_t revalidated = 0;               /** @brief served from cache after a 304 */
+        uint32_t misses = 0;                    /** @brief loaded from the server */
+        uint32_t stored = 0;                    /** @brief responses written into the cache */
+        uint32_t evicted = 0;                   /** @brief entries removed to stay in the size limit */
+        uint64_t bytes_saved = 0;               /** @brief body bytes served from cache */
+        uint32_t entries = 0;                   /** @brief current entries */
+        uint32_t size = 0;                      /** @brief current size in bytes */
+    } uri_load_cache_stats_t;
+    /**
+     * @brief open a cached response
+     *
+     * @param   uri     requested url
+     * @param   meta    pointer to a uri_load_cache_meta_t, filled with the cached validators
+     *
+     * @return  FILE pointer positioned at the body, NULL if not cached
+     */
+    FILE *uri_load_cache_open( const char *uri, uri_load_cache_meta_t *meta );
+    /**
+     * @brief update the freshness of a cached response after a 304
+     *
+     * @param   uri     requested url
+     * @param   meta    pointer to the uri_load_cache_meta_t from the 304 response
+     */
+    void uri_load_cache_refresh( const char *uri, uri_load_cache_meta_t *meta );
+    /**
+     * @brief take a response header into a uri_load_cache_meta_t
+     *
+     * @param   meta    pointer to the response uri_load_cache_meta_t
+     * @param   name    header name
+     * @param   value   header value
+     */
+    void uri_load_cache_parse_header( uri_load_cache_meta_t *meta, const char *name, const char *value );
+    /**
+     * @brief check if a response can be cached
+     *
+     * @param   meta    pointer to the response uri_load_cache_meta_t
+     *
+     * @return  true if cacheable
+     */
+    bool uri_load_cache_is_cacheable( uri_load_cache_meta_t *meta );
+    /**
+     * @brief start a new cache entry, write the body into the returned file
+     *
+     * @param   uri     requested url
+     * @param   meta    pointer to the response uri_load_cache_meta_t
+     *
+     * @return  FILE pointer to a temporary entry, NULL if failed
+     */
+    FILE *uri_load_cache_create( const char *uri, uri_load_cache_meta_t *meta );
+    /**
+     * @brief finish a new cache entry
+     *
+     * @param   uri     requested url
+     * @param   file    FILE pointer from uri_load_cache_create()
+     * @param   success true to keep the entry, false to drop it
+     */
+    void uri_load_cache_commit( const char *uri, FILE *file, bool success );
+    /**
+     * @brief count a served response
+     *
+     * @param   hit         true if served from cache
+     * @param   revalidated true if served from cache after a 304
+     * @param   size        body size
+     */
+    void uri_load_cache_count( bool hit, bool revalidated, uint32_t size );
+    /**
+     * @brief enable or disable the cache
+     *
+     * @param   enable  true to enable
+     */
+    void uri_load_cache_set_enable( bool enable );
+    /**
+     * @brief check if the cache is enabled
+     *
+     * @return  true if enabled
+     */
+    bool uri_load_cache_get_enable( void );
+    /**
+     * @brief remove all cached responses
+     */
+    void uri_load_cache_clear( void );
+    /**
+     * @brief get the cache statistics
+     *
+     * @return  pointer to a uri_load_cache_stats_t structure
+     */
+    uri_load_cache_stats_t *uri_load_cache_get_stats( void );
+
+#endif // _URI_LOAD_CACHE_H
@@ -0,0 +1,251 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "uri_load.h"
+#include "uri_load_dns.h"
+#include "utils/lock.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+#ifdef NATIVE_64BIT
+    #include <time.h>
+    #include <netdb.h>
+    #include <arpa/inet.h>
+    #include <arpa/nameser.h>
+    #include <resolv.h>
+    #include "utils/logging.h"
+#else
+    #include <Arduino.h>
+    #include <WiFi.h>
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/semphr.h>
+#endif
+static lock_mutex_t uri_load_dns_mutex = LOCK_MUTEX_INITIALIZER;       /** @brief uri_load is called from different tasks */
+
+static uri_load_dns_entry_t uri_load_dns_cache[ URI_LOAD_DNS_SIZE ];
+static uri_load_dns_stats_t uri_load_dns_stats;
+static bool uri_load_dns_enable = true;
+
+static uint32_t uri_load_dns_now( void ) {
+#ifdef NATIVE_64BIT
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint64_t)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000 );
+#else
+    return( millis() );
+#endif
+}
+
+static void uri_load_dns_lock( void ) {
+    lock_mutex_take( &uri_load_dns_mutex );
+}
+
+static void uri_load_dns_unlock( void ) {
+    lock_mutex_give( &uri_load_dns_mutex );
+}
+
+#ifdef NATIVE_64BIT
+/**
+ * @brief get the ttl of the A record, getaddrinfo() doesn't tell it
+ */
+static uint32_t uri_load_dns_query_ttl( const char *host ) {
+    unsigned char answer[ NS_PACKETSZ ];
+    ns_msg msg;
+    /**
+     * no dot, a local name from the hosts file
+     */
+    if ( !strchr( host, '.' ) ) {
+        return( URI_LOAD_DNS_MAX_TTL );
+    }
+    int len = res_query( host, ns_c_in, ns_t_a, answer, sizeof( answer ) );
+    if ( len <= 0 || ns_initparse( answer, len, &msg ) ) {
+        return( URI_LOAD_DNS_DEFAULT_TTL );
+    }
+    /**
+     * the shortest ttl in the cname chain counts
+     */
+    uint32_t ttl = URI_LOAD_DNS_MAX_TTL;
+    for( int i = 0 ; i < ns_msg_count( msg, ns_s_an ) ; i++ ) {
+        ns_rr rr;
+        if ( !ns_parserr( &msg, ns_s_an, i, &rr ) && ns_rr_ttl( rr ) < ttl ) {
+            ttl = ns_rr_ttl( rr );
+        }
+    }
+    return( ttl );
+}
+#endif
+
+/**
+ * @brief resolve a host name, ipv4 first
+ */
+static bool uri_load_dns_query( const char *host, char *addr, size_t size, uint32_t *ttl ) {
+#ifdef NATIVE_64BIT
+    struct addrinfo hints;
+    struct addrinfo *result = NULL;
+    const int family[ 2 ] = { AF_INET, AF_INET6 };
+
+    for( int i = 0 ; i < 2 && !result ; i++ ) {
+        memset( &hints, 0, sizeof( hints ) );
+        hints.ai_family = family[ i ];
+        hints.ai_socktype = SOCK_STREAM;
+        if ( getaddrinfo( host, NULL, &hints, &result ) ) {
+            result = NULL;
+        }
+    }
+    if ( !result ) {
+        return( false );
+    }
+    if ( result->ai_family == AF_INET ) {
+        inet_ntop( AF_INET, &( (struct sockaddr_in *)result->ai_addr )->sin_addr, addr, size );
+    }
+    else {
+        inet_ntop( AF_INET6, &( (struct sockaddr_in6 *)result->ai_addr )->sin6_addr, addr, size );
+    }
+    freeaddrinfo( result );
+    /**
+     * a numeric address never expires
+     */
+    if ( !strcmp( addr, host ) ) {
+        *ttl = URI_LOAD_DNS_MAX_TTL;
+    }
+    else {
+        *ttl = uri_load_dns_query_ttl( host );
+    }
+    return( true );
+#else
+    /**
+     * lwip doesn't hand out the record ttl
+     */
+    IPAddress ip;
+    if ( !WiFi.hostByName( host, ip ) ) {
+        return( false );
+    }
+    strncpy( addr, ip.toString().c_str(), size - 1 );
+    addr[ size - 1 ] = '\0';
+    *ttl = URI_LOAD_DNS_DEFAULT_TTL;
+    return( true );
+#endif
+}
+
+bool uri_load_dns_resolve( const char *host, char *addr, size_t size ) {
+    uri_load_dns_entry_t *entry = NULL;
+    uint32_t now = uri_load_dns_now();
+    bool expired = false;
+
+    if ( !host || !addr || !size || strlen( host ) >= URI_LOAD_DNS_HOST_LEN ) {
+        return( false );
+    }
+
+    uri_load_dns_lock();
+    uri_load_dns_stats.lookups++;
+    for( int i = 0 ; i < URI_LOAD_DNS_SIZE && uri_load_dns_enable ; i++ ) {
+        if ( strcasecmp( uri_load_dns_cache[ i ].host, host ) ) {
+            continue;
+        }
+        entry = &uri_load_dns_cache[ i ];
+        if ( (int32_t)( entry->expires - now ) > 0 ) {
+            uri_load_dns_stats.hits++;
+            entry->last_used = now;
+            strncpy( addr, entry->addr, size - 1 );
+            addr[ size - 1 ] = '\0';
+            uri_load_dns_unlock();
+            return( true );
+        }
+        expired = true;
+        break;
+    }
+    uri_load_dns_stats.misses++;
+    if ( expired ) {
+        uri_load_dns_stats.expired++;
+    }
+    uri_load_dns_unlock();
+    /**
+     * resolve without the lock, a slow lookup doesn't block other hosts
+     */
+    char resolved[ URI_LOAD_DNS_ADDR_LEN ] = "";
+    uint32_t ttl = 0;
+    uint32_t start = uri_load_dns_now();
+    bool retval = uri_load_dns_query( host, resolved, sizeof( resolved ), &ttl );
+
+    uri_load_dns_lock();
+    uri_load_dns_stats.resolve_time += uri_load_dns_now() - start;
+    if ( !retval ) {
+        URI_LOAD_ERROR_LOG("can't resolve %s", host );
+        uri_load_dns_stats.failed++;
+        uri_load_dns_unlock();
+        return( false );
+    }
+    if ( ttl < URI_LOAD_DNS_MIN_TTL ) ttl = URI_LOAD_DNS_MIN_TTL;
+    if ( ttl > URI_LOAD_DNS_MAX_TTL ) ttl = URI_LOAD_DNS_MAX_TTL;
+    URI_LOAD_LOG("resolved %s to %s, ttl %ds", host, resolved, ttl );
+    /**
+     * store into the same, a free or the least recently used entry
+     */
+    if ( uri_load_dns_enable ) {
+        entry = NULL;
+        for( int i = 0 ; i < URI_LOAD_DNS_SIZE ; i++ ) {
+            uri_load_dns_entry_t *slot = &uri_load_dns_cache[ i ];
+            if ( !strcasecmp( slot->host, host ) || !*slot->host ) {
+                entry = slot;
+                break;
+            }
+            if ( !entry || slot->last_used < entry->last_used ) {
+                entry = slot;
+            }
+        }
+        strncpy( entry->host, host, sizeof( entry->host ) - 1 );
+        entry->host[ sizeof( entry->host ) - 1 ] = '\0';
+        strncpy( entry->addr, resolved, sizeof( entry->addr ) - 1 );
+        entry->expires = uri_load_dns_now() + ttl * 1000;
+        entry->last_used = uri_load_dns_now();
+    }
+    uri_load_dns_unlock();
+
+    strncpy( addr, resolved, size - 1 );
+    addr[ size - 1 ] = '\0';
+    return( true );
+}
+
+void uri_load_dns_flush( void ) {
+    uri_load_dns_lock();
+    for( int i = 0 ; i < URI_LOAD_DNS_SIZE ; i++ ) {
+        uri_load_dns_cache[ i ] = uri_load_dns_entry_t();
+    }
+    uri_load_dns_unlock();
+}
+
+void uri_load_dns_set_enable( bool enable ) {
+    uri_load_dns_enable = enable;
+    if ( !enable ) {
+        uri_load_dns_flush();
+    }
+}
+
+bool uri_load_dns_get_enable( void ) {
+    return( uri_load_dns_enable );
+}
+
+uri_load_dns_stats_t *uri_load_dns_get_stats( void ) {
+    return( &uri_load_dns_stats );
+}
@@ -0,0 +1,87 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _URI_LOAD_DNS_H
+    #define _URI_LOAD_DNS_H
+
+    #include <stddef.h>
+    #include <stdint.h>
+
+    #define URI_LOAD_DNS_SIZE           8           /** @brief cached host names */
+    #define URI_LOAD_DNS_HOST_LEN       64          /** @brief max host name length */
+    #define URI_LOAD_DNS_ADDR_LEN       48          /** @brief max address length, fits ipv6 */
+    #define URI_LOAD_DNS_MIN_TTL        30          /** @brief min lifetime of an entry in s */
+    #define URI_LOAD_DNS_MAX_TTL        3600        /** @brief max lifetime of an entry in s */
+    #define URI_LOAD_DNS_DEFAULT_TTL    300         /** @brief lifetime in s if the record ttl is unknown */
+    /**
+     * @brief cached host name
+     */
+    typedef struct {
+        char host[ URI_LOAD_DNS_HOST_LEN ] = "";    /** @brief host name, empty if unused */
+        char addr[ URI_LOAD_DNS_ADDR_LEN ] = "";    /** @brief numeric address */
+        uint32_t expires = 0;                       /** @brief expire time in ms */
+        uint32_t last_used = 0;                     /** @brief last lookup time in ms */
+    } uri_load_dns_entry_t;
+    /**
+     * @brief dns cache statistics
+     */
+    typedef struct {
+        uint32_t lookups = 0;                       /** @brief host name lookups */
+        uint32_t hits = 0;                          /** @brief lookups from the cache */
+        uint32_t misses = 0;                        /** @brief lookups that needed a resolve */
+        uint32_t expired = 0;                       /** @brief misses of an expired entry */
+        uint32_t failed = 0;                        /** @brief failed resolves */
+        uint64_t resolve_time = 0;                  /** @brief total resolve time in ms */
+    } uri_load_dns_stats_t;
+    /**
+     * @brief get the address of a host name, from the cache while the record ttl lasts
+     *
+     * @param   host    host name or numeric address
+     * @param   addr    pointer to a char buffer
+     * @param   size    buffer size, URI_LOAD_DNS_ADDR_LEN fits all
+     *
+     * @return  true if success
+     */
+    bool uri_load_dns_resolve( const char *host, char *addr, size_t size );
+    /**
+     * @brief drop all cached host names, e.g. after a network change
+     */
+    void uri_load_dns_flush( void );
+    /**
+     * @brief enable or disable the dns cache, disabled every lookup resolves
+     *
+     * @param   enable  true to enable
+     */
+    void uri_load_dns_set_enable( bool enable );
+    /**
+     * @brief get the dns cache state
+     *
+     * @return  true if enabled
+     */
+    bool uri_load_dns_get_enable( void );
+    /**
+     * @brief get the dns cache statistics
+     *
+     * @return  pointer to a uri_load_dns_stats_t structure
+     */
+    uri_load_dns_stats_t *uri_load_dns_get_stats( void );
+
+#endif // _URI_LOAD_DNS_H
@@ -0,0 +1,122 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "uri_load_hash.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+bool uri_load_hash_begin( uri_load_hash_t *hash, uri_load_hash_type_t type ) {
+    hash->type = type;
+
+    switch( type ) {
+#ifdef NATIVE_64BIT
+        case URI_LOAD_HASH_MD5:
+        case URI_LOAD_HASH_SHA256:
+            hash->ctx = EVP_MD_CTX_new();
+            if ( !hash->ctx ) {
+                hash->type = URI_LOAD_HASH_NONE;
+                return( false );
+            }
+            EVP_DigestInit_ex( hash->ctx, type == URI_LOAD_HASH_MD5 ? EVP_md5() : EVP_sha256(), NULL );
+            break;
+#else
+        case URI_LOAD_HASH_MD5:
+            mbedtls_md5_init( &hash->md5 );
+            mbedtls_md5_starts_ret( &hash->md5 );
+            break;
+        case URI_LOAD_HASH_SHA256:
+            mbedtls_sha256_init( &hash->sha256 );
+            mbedtls_sha256_starts_ret( &hash->sha256, 0 );
+            break;
+#endif
+        default:
+            break;
+    }
+    return( true );
+}
+
+void uri_load_hash_update( uri_load_hash_t *hash, const uint8_t *data, size_t len ) {
+    switch( hash->type ) {
+#ifdef NATIVE_64BIT
+        case URI_LOAD_HASH_MD5:
+        case URI_LOAD_HASH_SHA256:
+            EVP_DigestUpdate( hash->ctx, data, len );
+            break;
+#else
+        case URI_LOAD_HASH_MD5:
+            mbedtls_md5_update_ret( &hash->md5, data, len );
+            break;
+        case URI_LOAD_HASH_SHA256:
+            mbedtls_sha256_update_ret( &hash->sha256, data, len );
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
+void uri_load_hash_end( uri_load_hash_t *hash, char *hex, size_t size ) {
+    uint8_t digest[ 32 ];
+    size_t len = 0;
+
+    switch( hash->type ) {
+#ifdef NATIVE_64BIT
+        case URI_LOAD_HASH_MD5:
+        case URI_LOAD_HASH_SHA256: {
+            unsigned int digest_len = 0;
+            EVP_DigestFinal_ex( hash->ctx, digest, &digest_len );
+            EVP_MD_CTX_free( hash->ctx );
+            hash->ctx = NULL;
+            len = digest_len;
+            break;
+        }
+#else
+        case URI_LOAD_HASH_MD5:
+            mbedtls_md5_finish_ret( &hash->md5, digest );
+            mbedtls_md5_free( &hash->md5 );
+            len = 16;
+            break;
+        case URI_LOAD_HASH_SHA256:
+            mbedtls_sha256_finish_ret( &hash->sha256, digest );
+            mbedtls_sha256_free( &hash->sha256 );
+            len = 32;
+            break;
+#endif
+        default:
+            break;
+    }
+    hash->type = URI_LOAD_HASH_NONE;
+
+    if ( !hex || !size ) {
+        return;
+    }
+    hex[ 0 ] = '\0';
+    for( size_t i = 0 ; i < len && i * 2 + 2 < size ; i++ ) {
+        snprintf( hex + i * 2, 3, "%02x", digest[ i ] );
+    }
+}
+
+bool uri_load_hash_match( const char *hex, const char *digest ) {
+    return( hex && digest && *hex && !strcasecmp( hex, digest ) );
+}
@@ -0,0 +1,91 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _URI_LOAD_HASH_H
+    #define _URI_LOAD_HASH_H
+
+    #include <stddef.h>
+    #include <stdint.h>
+
+    #ifdef NATIVE_64BIT
+        #include <openssl/evp.h>
+    #else
+        #include <mbedtls/md5.h>
+        #include <mbedtls/sha256.h>
+    #endif
+
+    #define URI_LOAD_HASH_HEX_LEN   65      /** @brief hex digest buffer size, fits sha256 */
+    /**
+     * @brief hash types
+     */
+    typedef enum {
+        URI_LOAD_HASH_NONE = 0,             /** @brief no verification */
+        URI_LOAD_HASH_MD5,                  /** @brief md5, 32 hex chars */
+        URI_LOAD_HASH_SHA256                /** @brief sha256, 64 hex chars */
+    } uri_load_hash_type_t;
+    /**
+     * @brief streaming hash context
+     */
+    typedef struct {
+        uri_load_hash_type_t type = URI_LOAD_HASH_NONE;     /** @brief hash type */
+    #ifdef NATIVE_64BIT
+        EVP_MD_CTX *ctx = NULL;             /** @brief openssl digest context */
+    #else
+        mbedtls_md5_context md5;            /** @brief mbedtls md5 context */
+        mbedtls_sha256_context sha256;      /** @brief mbedtls sha256 context, hardware accelerated */
+    #endif
+    } uri_load_hash_t;
+    /**
+     * @brief start a hash
+     *
+     * @param   hash    pointer to a uri_load_hash_t
+     * @param   type    hash type, URI_LOAD_HASH_NONE does nothing
+     *
+     * @return  true if success
+     */
+    bool uri_load_hash_begin( uri_load_hash_t *hash, uri_load_hash_type_t type );
+    /**
+     * @brief hash data
+     *
+     * @param   hash    pointer to a started uri_load_hash_t
+     * @param   data    pointer to the data
+     * @param   len     data length
+     */
+    void uri_load_hash_update( uri_load_hash_t *hash, const uint8_t *data, size_t len );
+    /**
+     * @brief finish a hash and get the lower case hex digest
+     *
+     * @param   hash    pointer to a started uri_load_hash_t
+     * @param   hex     pointer to a char buffer
+     * @param   size    buffer size, URI_LOAD_HASH_HEX_LEN fits all
+     */
+    void uri_load_hash_end( uri_load_hash_t *hash, char *hex, size_t size );
+    /**
+     * @brief compare a hex digest, case insensitive
+     *
+     * @param   hex     hex digest from uri_load_hash_end()
+     * @param   digest  expected hex digest
+     *
+     * @return  true if equal
+     */
+    bool uri_load_hash_match( const char *hex, const char *digest );
+
+#endif // _URI_LOAD_HASH_H
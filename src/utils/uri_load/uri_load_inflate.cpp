@@ -0,0 +1,199 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "uri_load.h"
+#include "uri_load_inflate.h"
+#include "utils/alloc.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#ifdef NATIVE_64BIT
+    #include "utils/logging.h"
+#else
+    #include <Arduino.h>
+#endif
+
+static bool uri_load_inflate_enable = true;
+
+void uri_load_inflate_set_enable( bool enable ) {
+    uri_load_inflate_enable = enable;
+}
+
+bool uri_load_inflate_get_enable( void ) {
+    return( uri_load_inflate_enable );
+}
+
+uri_load_encoding_t uri_load_inflate_parse_encoding( const char *value ) {
+    value += strspn( value, " " );
+
+    if ( !*value || !strcasecmp( value, "identity" ) ) {
+        return( URI_LOAD_ENCODING_IDENTITY );
+    }
+    if ( !strcasecmp( value, "gzip" ) || !strcasecmp( value, "x-gzip" ) ) {
+        return( URI_LOAD_ENCODING_GZIP );
+    }
+    if ( !strcasecmp( value, "deflate" ) ) {
+        return( URI_LOAD_ENCODING_DEFLATE );
+    }
+    return( URI_LOAD_ENCODING_UNKNOWN );
+}
+
+#ifndef NATIVE_64BIT
+/**
+ * @brief uzlib source callback, refills the input buffer and returns the first byte
+ */
+static int uri_load_inflate_source_cb( struct uzlib_uncomp *uncomp ) {
+    uri_load_inflate_t *inflate = (uri_load_inflate_t *)uncomp;
+
+    int32_t len = inflate->read_cb( inflate->in, URI_LOAD_INFLATE_IN_SIZE, inflate->arg );
+    if ( len <= 0 ) {
+        inflate->failed = len < 0;
+        return( -1 );
+    }
+    uncomp->source = inflate->in + 1;
+    uncomp->source_limit = inflate->in + len;
+    return( inflate->in[ 0 ] );
+}
+#endif
+
+uri_load_inflate_t *uri_load_inflate_begin( uri_load_encoding_t encoding, uri_load_inflate_read_cb_t *read_cb, void *arg ) {
+    uri_load_inflate_t *inflate = new uri_load_inflate_t;
+
+    inflate->encoding = encoding;
+    inflate->read_cb = read_cb;
+    inflate->arg = arg;
+    inflate->in = (uint8_t*)MALLOC( URI_LOAD_INFLATE_IN_SIZE );
+    if ( !inflate->in ) {
+        URI_LOAD_ERROR_LOG("inflate input buffer alloc failed");
+        delete inflate;
+        return( NULL );
+    }
+#ifdef NATIVE_64BIT
+    /**
+     * 32 + window bits detects a gzip or zlib header by itself
+     */
+    memset( &inflate->z, 0, sizeof( inflate->z ) );
+    if ( inflateInit2( &inflate->z, 32 + MAX_WBITS ) != Z_OK ) {
+        URI_LOAD_ERROR_LOG("inflate init failed");
+        free( inflate->in );
+        delete inflate;
+        return( NULL );
+    }
+#else
+    /**
+     * the output buffer is handed out after every read, back references
+     * need their own window, into psram if available
+     */
+    inflate->dict = (uint8_t*)MALLOC( URI_LOAD_INFLATE_DICT_SIZE );
+    if ( !inflate->dict ) {
+        URI_LOAD_ERROR_LOG("inflate window alloc failed");
+        free( inflate->in );
+        delete inflate;
+        return( NULL );
+    }
+    uzlib_init();
+    memset( &inflate->uncomp, 0, sizeof( inflate->uncomp ) );
+    uzlib_uncompress_init( &inflate->uncomp, inflate->dict, URI_LOAD_INFLATE_DICT_SIZE );
+    inflate->uncomp.source = NULL;
+    inflate->uncomp.source_limit = NULL;
+    inflate->uncomp.source_read_cb = uri_load_inflate_source_cb;
+#endif
+    return( inflate );
+}
+
+int32_t uri_load_inflate_read( uri_load_inflate_t *inflate, uint8_t *buf, size_t size ) {
+    if ( !inflate || inflate->failed ) {
+        return( -1 );
+    }
+    if ( inflate->done || !size ) {
+        return( 0 );
+    }
+#ifdef NATIVE_64BIT
+    inflate->z.next_out = buf;
+    inflate->z.avail_out = size;
+
+    while( inflate->z.avail_out == size && !inflate->done ) {
+        if ( !inflate->z.avail_in ) {
+            int32_t len = inflate->read_cb( inflate->in, URI_LOAD_INFLATE_IN_SIZE, inflate->arg );
+            /**
+             * the body ends before the compressed stream, truncated
+             */
+            if ( len <= 0 ) {
+                URI_LOAD_ERROR_LOG("inflate input %s", len < 0 ? "failed" : "truncated" );
+                inflate->failed = true;
+                return( -1 );
+            }
+            inflate->z.next_in = inflate->in;
+            inflate->z.avail_in = len;
+        }
+        int ret = ::inflate( &inflate->z, Z_NO_FLUSH );
+        if ( ret == Z_STREAM_END ) {
+            inflate->done = true;
+        }
+        else if ( ret != Z_OK && ret != Z_BUF_ERROR ) {
+            URI_LOAD_ERROR_LOG("inflate failed: %d", ret );
+            inflate->failed = true;
+            return( -1 );
+        }
+    }
+    return( size - inflate->z.avail_out );
+#else
+    if ( !inflate->header ) {
+        int ret = inflate->encoding == URI_LOAD_ENCODING_GZIP ? uzlib_gzip_parse_header( &inflate->uncomp ) : uzlib_zlib_parse_header( &inflate->uncomp );
+        if ( ret < 0 ) {
+            URI_LOAD_ERROR_LOG("inflate header invalid: %d", ret );
+            inflate->failed = true;
+            return( -1 );
+        }
+        inflate->header = true;
+    }
+    inflate->uncomp.dest_start = buf;
+    inflate->uncomp.dest = buf;
+    inflate->uncomp.dest_limit = buf + size;
+
+    int ret = uzlib_uncompress_chksum( &inflate->uncomp );
+    if ( ret == TINF_DONE ) {
+        inflate->done = true;
+    }
+    else if ( ret != TINF_OK || inflate->failed ) {
+        URI_LOAD_ERROR_LOG("inflate failed: %d", ret );
+        inflate->failed = true;
+        return( -1 );
+    }
+    return( inflate->uncomp.dest - buf );
+#endif
+}
+
+void uri_load_inflate_end( uri_load_inflate_t *inflate ) {
+    if ( !inflate ) {
+        return;
+    }
+#ifdef NATIVE_64BIT
+    inflateEnd( &inflate->z );
+#else
+    free( inflate->dict );
+#endif
+    free( inflate->in );
+    delete inflate;
+}
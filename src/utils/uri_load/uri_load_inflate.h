@@ -0,0 +1,121 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _URI_LOAD_INFLATE_H
+    #define _URI_LOAD_INFLATE_H
+
+    #include <stddef.h>
+    #include <stdint.h>
+
+    #ifdef NATIVE_64BIT
+        #include <zlib.h>
+    #else
+        #include <uzlib/uzlib.h>
+    #endif
+
+    #define URI_LOAD_INFLATE_ACCEPT     "gzip, deflate"     /** @brief Accept-Encoding request header value */
+    #define URI_LOAD_INFLATE_IN_SIZE    1024                /** @brief compressed input buffer size */
+    #define URI_LOAD_INFLATE_DICT_SIZE  32768               /** @brief deflate window, back references reach this far */
+    /**
+     * @brief content encodings
+     */
+    typedef enum {
+        URI_LOAD_ENCODING_IDENTITY = 0,     /** @brief body as is */
+        URI_LOAD_ENCODING_GZIP,             /** @brief gzip, rfc 1952 */
+        URI_LOAD_ENCODING_DEFLATE,          /** @brief zlib wrapped deflate, rfc 1950 */
+        URI_LOAD_ENCODING_UNKNOWN           /** @brief not supported */
+    } uri_load_encoding_t;
+    /**
+     * @brief pull function for compressed data
+     *
+     * @param   buf     pointer to the destination buffer
+     * @param   size    buffer size
+     * @param   arg     read argument
+     *
+     * @return  number of bytes read, 0 at the end, -1 on error
+     */
+    typedef int32_t ( uri_load_inflate_read_cb_t ) ( uint8_t *buf, size_t size, void *arg );
+    /**
+     * @brief streaming inflater
+     */
+    typedef struct {
+    #ifndef NATIVE_64BIT
+        struct uzlib_uncomp uncomp;                 /** @brief uzlib state, first member, the read callback gets a pointer to it */
+        uint8_t *dict = NULL;                       /** @brief deflate window */
+        bool header = false;                        /** @brief gzip/zlib header parsed */
+    #else
+        z_stream z;                                 /** @brief zlib state */
+    #endif
+        uri_load_encoding_t encoding = URI_LOAD_ENCODING_IDENTITY;  /** @brief content encoding */
+        uri_load_inflate_read_cb_t *read_cb = NULL; /** @brief compressed data source */
+        void *arg = NULL;                           /** @brief read callback argument */
+        uint8_t *in = NULL;                         /** @brief compressed input buffer */
+        bool done = false;                          /** @brief end of the compressed stream */
+        bool failed = false;                        /** @brief broken or truncated stream */
+    } uri_load_inflate_t;
+    /**
+     * @brief enable or disable Accept-Encoding on requests
+     *
+     * @param   enable  true to enable
+     */
+    void uri_load_inflate_set_enable( bool enable );
+    /**
+     * @brief get the Accept-Encoding state
+     *
+     * @return  true if enabled
+     */
+    bool uri_load_inflate_get_enable( void );
+    /**
+     * @brief parse a Content-Encoding header value
+     *
+     * @param   value   header value
+     *
+     * @return  uri_load_encoding_t
+     */
+    uri_load_encoding_t uri_load_inflate_parse_encoding( const char *value );
+    /**
+     * @brief start a streaming inflate
+     *
+     * @param   encoding    URI_LOAD_ENCODING_GZIP or URI_LOAD_ENCODING_DEFLATE
+     * @param   read_cb     compressed data source
+     * @param   arg         read callback argument
+     *
+     * @return  pointer to a uri_load_inflate_t, NULL if failed
+     */
+    uri_load_inflate_t *uri_load_inflate_begin( uri_load_encoding_t encoding, uri_load_inflate_read_cb_t *read_cb, void *arg );
+    /**
+     * @brief read inflated bytes, pulls compressed data as needed
+     *
+     * @param   inflate     pointer to a started inflater
+     * @param   buf         pointer to the destination buffer
+     * @param   size        buffer size
+     *
+     * @return  number of bytes read, 0 at the end, -1 on error
+     */
+    int32_t uri_load_inflate_read( uri_load_inflate_t *inflate, uint8_t *buf, size_t size );
+    /**
+     * @brief free an inflater
+     *
+     * @param   inflate     pointer to a started inflater
+     */
+    void uri_load_inflate_end( uri_load_inflate_t *inflate );
+
+#endif // _URI_LOAD_INFLATE_H
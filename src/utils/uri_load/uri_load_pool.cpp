@@ -0,0 +1,532 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "uri_load.h"
+#include "uri_load_pool.h"
+#include "uri_load_cache.h"
+#include "uri_load_stream.h"
+#include "uri_load_dns.h"
+#include "hardware/powermgm.h"
+#include "utils/lock.h"
+
+#ifdef NATIVE_64BIT
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <string.h>
+    #include <time.h>
+    #include <pthread.h>
+    #include <openssl/ssl.h>
+    #include "utils/logging.h"
+
+    static pthread_mutex_t uri_load_pool_share_mutex[ CURL_LOCK_DATA_LAST ];   /** @brief one lock per shared data type */
+    static CURLSH *uri_load_pool_share = NULL;                                 /** @brief tls sessions shared by all connections */
+#else
+    #include <Arduino.h>
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/semphr.h>
+#endif
+static lock_mutex_t uri_load_pool_mutex = LOCK_MUTEX_INITIALIZER;      /** @brief uri_load is called from different tasks */
+
+static uri_load_conn_t *uri_load_pool[ URI_LOAD_POOL_SIZE ];       /** @brief pooled connections, NULL if free */
+static uri_load_pool_stats_t uri_load_pool_stats;
+static bool uri_load_pool_enable = true;
+
+static bool uri_load_pool_powermgm_event_cb( EventBits_t event, void *arg );
+static bool uri_load_pool_powermgm_loop_cb( EventBits_t event, void *arg );
+static void uri_load_pool_expire( bool all );
+#ifdef NATIVE_64BIT
+    static void uri_load_pool_bench( const char *uri );
+#endif
+
+static uint32_t uri_load_pool_now( void ) {
+#ifdef NATIVE_64BIT
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint64_t)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000 );
+#else
+    return( millis() );
+#endif
+}
+
+static void uri_load_pool_lock( void ) {
+    lock_mutex_take( &uri_load_pool_mutex );
+}
+
+static void uri_load_pool_unlock( void ) {
+    lock_mutex_give( &uri_load_pool_mutex );
+}
+
+#ifdef NATIVE_64BIT
+static void uri_load_pool_share_lock_cb( CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr ) {
+    pthread_mutex_lock( &uri_load_pool_share_mutex[ data ] );
+}
+
+static void uri_load_pool_share_unlock_cb( CURL *handle, curl_lock_data data, void *userptr ) {
+    pthread_mutex_unlock( &uri_load_pool_share_mutex[ data ] );
+}
+
+/**
+ * @brief openssl info callback, notes a resumed session at the end of the handshake
+ */
+static void uri_load_pool_ssl_info_cb( const SSL *ssl, int where, int ret ) {
+    if ( where & SSL_CB_HANDSHAKE_DONE ) {
+        uri_load_conn_t *conn = (uri_load_conn_t *)SSL_CTX_get_app_data( SSL_get_SSL_CTX( ssl ) );
+        if ( conn ) {
+            conn->resumed = SSL_session_reused( (SSL *)ssl );
+        }
+    }
+}
+
+/**
+ * @brief curl ssl context callback, called for every new tls connection
+ */
+static CURLcode uri_load_pool_ssl_ctx_cb( CURL *curl, void *ssl_ctx, void *userptr ) {
+    SSL_CTX_set_app_data( (SSL_CTX *)ssl_ctx, userptr );
+    SSL_CTX_set_info_callback( (SSL_CTX *)ssl_ctx, uri_load_pool_ssl_info_cb );
+    return( CURLE_OK );
+}
+#endif
+
+void uri_load_pool_setup( void ) {
+#ifdef NATIVE_64BIT
+    curl_global_init( CURL_GLOBAL_ALL );
+    /**
+     * a session ticket outlives the connection it came with, a new
+     * connection to the same host resumes instead of a full handshake
+     */
+    for( int i = 0 ; i < CURL_LOCK_DATA_LAST ; i++ ) {
+        pthread_mutex_init( &uri_load_pool_share_mutex[ i ], NULL );
+    }
+    uri_load_pool_share = curl_share_init();
+    if ( uri_load_pool_share ) {
+        curl_share_setopt( uri_load_pool_share, CURLSHOPT_LOCKFUNC, uri_load_pool_share_lock_cb );
+        curl_share_setopt( uri_load_pool_share, CURLSHOPT_UNLOCKFUNC, uri_load_pool_share_unlock_cb );
+        curl_share_setopt( uri_load_pool_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION );
+    }
+#endif
+    powermgm_register_cb( POWERMGM_STANDBY, uri_load_pool_powermgm_event_cb, "uri_load pool" );
+    powermgm_register_loop_cb( POWERMGM_WAKEUP | POWERMGM_SILENCE_WAKEUP, uri_load_pool_powermgm_loop_cb, "uri_load pool loop" );
+#ifdef NATIVE_64BIT
+    const char *bench = getenv( URI_LOAD_POOL_BENCH_ENV );
+    if ( bench && *bench ) {
+        uri_load_pool_bench( bench );
+    }
+#endif
+}
+
+/**
+ * @brief split a http/https uri into host, port and scheme
+ */
+static bool uri_load_pool_parse_uri( const char *uri, char *host, size_t size, uint16_t *port, bool *secure ) {
+    const char *host_p = strstr( uri, "://" );
+
+    if ( !host_p ) {
+        return( false );
+    }
+    *secure = !strncmp( uri, "https", 5 );
+    *port = *secure ? 443 : 80;
+    host_p += 3;
+    /**
+     * host ends at port, path or query
+     */
+    size_t len = strcspn( host_p, ":/?" );
+    if ( !len || len >= size ) {
+        return( false );
+    }
+    memcpy( host, host_p, len );
+    host[ len ] = '\0';
+    if ( host_p[ len ] == ':' ) {
+        *port = atoi( host_p + len + 1 );
+    }
+    return( true );
+}
+
+static uri_load_conn_t *uri_load_pool_create( const char *host, uint16_t port, bool secure ) {
+    uri_load_conn_t *conn = new uri_load_conn_t;
+
+    strncpy( conn->host, host, sizeof( conn->host ) - 1 );
+    conn->port = port;
+    conn->secure = secure;
+#ifdef NATIVE_64BIT
+    conn->curl = curl_easy_init();
+    conn->multi = curl_multi_init();
+    if ( !conn->curl || !conn->multi ) {
+        URI_LOAD_ERROR_LOG("curl init failed");
+        if ( conn->curl ) curl_easy_cleanup( conn->curl );
+        if ( conn->multi ) curl_multi_cleanup( conn->multi );
+        delete conn;
+        return( NULL );
+    }
+#else
+    if ( secure ) {
+        WiFiClientSecure *client = new WiFiClientSecure;
+        client->setInsecure();                                      /** allow insecure connection */
+        conn->client = client;
+    }
+    else {
+        conn->client = new UriLoadClient;
+    }
+    conn->http = new HTTPClient;
+    conn->http->setReuse( true );
+    conn->http->setTimeout( URI_LOAD_POOL_TIMEOUT );
+#endif
+    URI_LOAD_LOG("new connection to %s:%d", host, port );
+    return( conn );
+}
+
+static void uri_load_pool_destroy( uri_load_conn_t *conn ) {
+    URI_LOAD_LOG("close connection to %s:%d after %d requests", conn->host, conn->port, conn->requests );
+#ifdef NATIVE_64BIT
+    curl_easy_cleanup( conn->curl );
+    curl_multi_cleanup( conn->multi );
+    if ( conn->resolve ) {
+        curl_slist_free_all( conn->resolve );
+    }
+#else
+    conn->http->end();
+    conn->client->stop();
+    delete conn->http;
+    delete conn->client;
+#endif
+    delete conn;
+}
+
+uri_load_conn_t *uri_load_pool_acquire( const char *uri ) {
+    char host[ URI_LOAD_POOL_HOST_LEN ] = "";
+    uint16_t port = 0;
+    bool secure = false;
+    uri_load_conn_t *conn = NULL;
+
+    if ( !uri_load_pool_parse_uri( uri, host, sizeof( host ), &port, &secure ) ) {
+        URI_LOAD_ERROR_LOG("can't get host from %s", uri );
+        return( NULL );
+    }
+#ifdef NATIVE_64BIT
+    /**
+     * resolve before the pool is locked, curl gets the address as a resolve entry
+     */
+    char addr[ URI_LOAD_DNS_ADDR_LEN ] = "";
+    if ( !uri_load_dns_resolve( host, addr, sizeof( addr ) ) ) {
+        return( NULL );
+    }
+#endif
+
+    uri_load_pool_lock();
+    uri_load_pool_stats.requests++;
+    uri_load_pool_expire( false );
+
+    if ( uri_load_pool_enable ) {
+        int free_slot = -1;
+        int lru_slot = -1;
+        /**
+         * look for an idle connection to the same host
+         */
+        for( int i = 0 ; i < URI_LOAD_POOL_SIZE ; i++ ) {
+            uri_load_conn_t *entry = uri_load_pool[ i ];
+            if ( !entry ) {
+                if ( free_slot < 0 ) free_slot = i;
+                continue;
+            }
+            if ( entry->in_use ) {
+                continue;
+            }
+            if ( entry->port == port && entry->secure == secure && !strcmp( entry->host, host ) ) {
+                conn = entry;
+                break;
+            }
+            if ( lru_slot < 0 || entry->last_used < uri_load_pool[ lru_slot ]->last_used ) {
+                lru_slot = i;
+            }
+        }
+        /**
+         * no idle connection, use a free slot or evict the least recently used idle connection
+         */
+        if ( !conn ) {
+            if ( free_slot < 0 && lru_slot >= 0 ) {
+                uri_load_pool_destroy( uri_load_pool[ lru_slot ] );
+                uri_load_pool[ lru_slot ] = NULL;
+                uri_load_pool_stats.evicted++;
+                free_slot = lru_slot;
+            }
+            if ( free_slot >= 0 ) {
+                conn = uri_load_pool_create( host, port, secure );
+                if ( conn ) {
+                    conn->pooled = true;
+                    uri_load_pool[ free_slot ] = conn;
+                }
+            }
+        }
+    }
+    /**
+     * pool disabled or all connections in use, take a one shot connection
+     */
+    if ( !conn ) {
+        conn = uri_load_pool_create( host, port, secure );
+        if ( conn && uri_load_pool_enable ) {
+            uri_load_pool_stats.overflow++;
+        }
+    }
+    if ( conn ) {
+        conn->in_use = true;
+        conn->requests++;
+#ifdef NATIVE_64BIT
+        /**
+         * reset all options, the connection cache in the multi handle stays alive
+         */
+        curl_easy_reset( conn->curl );
+        curl_easy_setopt( conn->curl, CURLOPT_MAXAGE_CONN, (long)( URI_LOAD_POOL_IDLE_TIMEOUT / 1000 ) );
+        curl_easy_setopt( conn->curl, CURLOPT_SHARE, uri_load_pool_share );
+        if ( conn->secure ) {
+            conn->resumed = false;
+            curl_easy_setopt( conn->curl, CURLOPT_SSL_CTX_FUNCTION, uri_load_pool_ssl_ctx_cb );
+            curl_easy_setopt( conn->curl, CURLOPT_SSL_CTX_DATA, (void *)conn );
+        }
+        /**
+         * the + entry times out in curl like a resolved one, a changed address replaces it
+         */
+        char entry[ URI_LOAD_POOL_HOST_LEN + URI_LOAD_DNS_ADDR_LEN + 16 ] = "";
+        snprintf( entry, sizeof( entry ), strchr( addr, ':' ) ? "+%s:%d:[%s]" : "+%s:%d:%s", host, port, addr );
+        if ( conn->resolve ) {
+            curl_slist_free_all( conn->resolve );
+        }
+        conn->resolve = curl_slist_append( NULL, entry );
+        curl_easy_setopt( conn->curl, CURLOPT_RESOLVE, conn->resolve );
+        const char *cainfo = getenv( URI_LOAD_POOL_CAINFO_ENV );
+        if ( cainfo && *cainfo ) {
+            curl_easy_setopt( conn->curl, CURLOPT_CAINFO, cainfo );
+        }
+#else
+        if ( conn->client->connected() ) {
+            uri_load_pool_stats.reused++;
+        }
+        else {
+            uri_load_pool_stats.connects++;
+            if ( secure ) {
+                uri_load_pool_stats.handshakes++;
+            }
+        }
+#endif
+    }
+    uri_load_pool_unlock();
+
+    return( conn );
+}
+
+void uri_load_pool_release( uri_load_conn_t *conn, bool keep ) {
+    if ( !conn ) {
+        return;
+    }
+
+    uri_load_pool_lock();
+#ifdef NATIVE_64BIT
+    /**
+     * no new connect for this request means the connection was reused
+     */
+    long connects = 0;
+    curl_easy_getinfo( conn->curl, CURLINFO_NUM_CONNECTS, &connects );
+    if ( connects ) {
+        curl_off_t lookup_time = 0;
+        curl_off_t connect_time = 0;
+        curl_off_t handshake_time = 0;
+        curl_easy_getinfo( conn->curl, CURLINFO_NAMELOOKUP_TIME_T, &lookup_time );
+        curl_easy_getinfo( conn->curl, CURLINFO_CONNECT_TIME_T, &connect_time );
+        uri_load_pool_stats.connects++;
+        uri_load_pool_stats.connect_time += connect_time - lookup_time;
+        /**
+         * the tls handshake ends at the app connect time, the ssl
+         * handle tells if the session was resumed
+         */
+        if ( conn->secure ) {
+            curl_easy_getinfo( conn->curl, CURLINFO_APPCONNECT_TIME_T, &handshake_time );
+            uri_load_pool_stats.handshakes++;
+            uri_load_pool_stats.handshake_time += handshake_time - connect_time;
+            if ( conn->resumed ) {
+                uri_load_pool_stats.resumed++;
+            }
+        }
+    }
+    else {
+        uri_load_pool_stats.reused++;
+    }
+#else
+    conn->http->end();
+#endif
+    conn->in_use = false;
+    conn->last_used = uri_load_pool_now();
+    /**
+     * a one shot or failed connection is closed
+     */
+    if ( !conn->pooled || !keep ) {
+        for( int i = 0 ; i < URI_LOAD_POOL_SIZE ; i++ ) {
+            if ( uri_load_pool[ i ] == conn ) {
+                uri_load_pool[ i ] = NULL;
+            }
+        }
+        uri_load_pool_destroy( conn );
+    }
+    uri_load_pool_unlock();
+}
+
+static void uri_load_pool_expire( bool all ) {
+    for( int i = 0 ; i < URI_LOAD_POOL_SIZE ; i++ ) {
+        uri_load_conn_t *entry = uri_load_pool[ i ];
+        if ( !entry || entry->in_use ) {
+            continue;
+        }
+        if ( all || uri_load_pool_now() - entry->last_used > URI_LOAD_POOL_IDLE_TIMEOUT ) {
+            uri_load_pool_destroy( entry );
+            uri_load_pool[ i ] = NULL;
+            uri_load_pool_stats.expired++;
+        }
+    }
+}
+
+void uri_load_pool_flush( void ) {
+    uri_load_pool_lock();
+    uri_load_pool_expire( true );
+    uri_load_pool_unlock();
+}
+
+void uri_load_pool_set_enable( bool enable ) {
+    uri_load_pool_enable = enable;
+    if ( !enable ) {
+        uri_load_pool_flush();
+    }
+}
+
+uri_load_pool_stats_t *uri_load_pool_get_stats( void ) {
+    return( &uri_load_pool_stats );
+}
+
+static bool uri_load_pool_powermgm_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case POWERMGM_STANDBY:
+            /**
+             * wifi goes down, don't hold tls buffers for dead connections,
+             * the next network may resolve differently
+             */
+            uri_load_pool_flush();
+            uri_load_dns_flush();
+            break;
+    }
+    return( true );
+}
+
+static bool uri_load_pool_powermgm_loop_cb( EventBits_t event, void *arg ) {
+    static uint32_t last_check = 0;
+
+    if ( uri_load_pool_now() - last_check > 1000 ) {
+        last_check = uri_load_pool_now();
+        uri_load_pool_lock();
+        uri_load_pool_expire( false );
+        uri_load_pool_unlock();
+    }
+    return( true );
+}
+
+#ifndef NATIVE_64BIT
+int UriLoadClient::connect( const char *host, uint16_t port ) {
+    return( connect( host, port, URI_LOAD_POOL_TIMEOUT ) );
+}
+
+int UriLoadClient::connect( const char *host, uint16_t port, int32_t timeout ) {
+    char addr[ URI_LOAD_DNS_ADDR_LEN ] = "";
+    IPAddress ip;
+
+    if ( !uri_load_dns_resolve( host, addr, sizeof( addr ) ) || !ip.fromString( addr ) ) {
+        return( 0 );
+    }
+    return( WiFiClient::connect( ip, port, timeout ) );
+}
+#endif
+
+#ifdef NATIVE_64BIT
+/**
+ * @brief load a uri URI_LOAD_POOL_BENCH_COUNT times with and without connection reuse
+ */
+static void uri_load_pool_bench( const char *uri ) {
+    bool cache_enable = uri_load_cache_get_enable();
+    /**
+     * pool off, pool on and pool on with the response cache
+     */
+    for( int run = 0 ; run < 3 ; run++ ) {
+        bool enable = run >= 1;
+        uint32_t failed = 0;
+
+        uri_load_pool_set_enable( enable );
+        uri_load_cache_set_enable( run == 2 );
+        uri_load_pool_stats = uri_load_pool_stats_t();
+        uri_load_cache_stats_t cache_stats = *uri_load_cache_get_stats();
+        uri_load_stream_stats_t stream_stats = *uri_load_stream_get_stats();
+        uri_load_dns_stats_t dns_stats = *uri_load_dns_get_stats();
+        uint32_t start = uri_load_pool_now();
+
+        for( int i = 0 ; i < URI_LOAD_POOL_BENCH_COUNT ; i++ ) {
+            uri_load_dsc_t *uri_load_dsc = uri_load_to_ram( uri );
+            if ( !uri_load_dsc ) {
+                failed++;
+                continue;
+            }
+            uri_load_free_all( uri_load_dsc );
+        }
+
+        uint32_t time = uri_load_pool_now() - start;
+        URI_LOAD_INFO_LOG("benchmark %s, pool %s, cache %s: %d requests in %dms, %.1f req/s, %d connects, %d reused, %d failed",
+                            uri,
+                            enable ? "on" : "off",
+                            run == 2 ? "on" : "off",
+                            URI_LOAD_POOL_BENCH_COUNT,
+                            time,
+                            time ? URI_LOAD_POOL_BENCH_COUNT * 1000.0 / time : 0.0,
+                            uri_load_pool_stats.connects,
+                            uri_load_pool_stats.reused,
+                            failed );
+        URI_LOAD_INFO_LOG("stream: %d responses, %d compressed, %llu bytes on the wire for %llu body bytes",
+                            uri_load_stream_get_stats()->requests - stream_stats.requests,
+                            uri_load_stream_get_stats()->encoded - stream_stats.encoded,
+                            (unsigned long long)( uri_load_stream_get_stats()->wire_bytes - stream_stats.wire_bytes ),
+                            (unsigned long long)( uri_load_stream_get_stats()->body_bytes - stream_stats.body_bytes ) );
+        if ( uri_load_pool_stats.handshakes ) {
+            URI_LOAD_INFO_LOG("tls: %d handshakes, %d resumed, avg connect %.2fms, avg handshake %.2fms",
+                                uri_load_pool_stats.handshakes,
+                                uri_load_pool_stats.resumed,
+                                uri_load_pool_stats.connect_time / 1000.0 / uri_load_pool_stats.connects,
+                                uri_load_pool_stats.handshake_time / 1000.0 / uri_load_pool_stats.handshakes );
+        }
+        URI_LOAD_INFO_LOG("dns: %d lookups, %d hits, %d misses, %llums resolve time",
+                            uri_load_dns_get_stats()->lookups - dns_stats.lookups,
+                            uri_load_dns_get_stats()->hits - dns_stats.hits,
+                            uri_load_dns_get_stats()->misses - dns_stats.misses,
+                            (unsigned long long)( uri_load_dns_get_stats()->resolve_time - dns_stats.resolve_time ) );
+        if ( run == 2 ) {
+            uri_load_cache_stats_t *stats = uri_load_cache_get_stats();
+            URI_LOAD_INFO_LOG("cache: %d hits, %d revalidated, %d misses, %llu bytes saved",
+                                stats->hits - cache_stats.hits,
+                                stats->revalidated - cache_stats.revalidated,
+                                stats->misses - cache_stats.misses,
+                                (unsigned long long)( stats->bytes_saved - cache_stats.bytes_saved ) );
+        }
+    }
+    uri_load_cache_set_enable( cache_enable );
+    uri_load_pool_stats = uri_load_pool_stats_t();
+}
+#endif
@@ -0,0 +1,123 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _URI_LOAD_POOL_H
+    #define _URI_LOAD_POOL_H
+
+    #include <stdint.h>
+
+    #ifdef NATIVE_64BIT
+        #include <curl/curl.h>
+    #else
+        #include <HTTPClient.h>
+    #endif
+
+    #define URI_LOAD_POOL_SIZE          4           /** @brief max pooled connections over all hosts */
+    #define URI_LOAD_POOL_IDLE_TIMEOUT  15000       /** @brief close pooled connections after ms idle */
+    #define URI_LOAD_POOL_HOST_LEN      64          /** @brief max host name length */
+    #define URI_LOAD_POOL_TIMEOUT       1500        /** @brief http client timeout in ms */
+    #define URI_LOAD_POOL_BENCH_ENV     "HEDGE_URI_LOAD_BENCH"  /** @brief env var with a benchmark url on native */
+    #define URI_LOAD_POOL_CAINFO_ENV    "HEDGE_URI_LOAD_CAINFO" /** @brief env var with a ca bundle on native, e.g. for a local tls test server */
+    #define URI_LOAD_POOL_BENCH_COUNT   200         /** @brief requests per benchmark run */
+    /**
+     * @brief pooled http/https connection
+     */
+    typedef struct {
+        char host[ URI_LOAD_POOL_HOST_LEN ] = "";   /** @brief host name */
+        uint16_t port = 0;                          /** @brief host port */
+        bool secure = false;                        /** @brief https connection */
+        bool in_use = false;                        /** @brief connection is acquired */
+        bool pooled = false;                        /** @brief connection is in the pool, false for a one shot connection */
+        uint32_t last_used = 0;                     /** @brief last release time in ms */
+        uint32_t requests = 0;                      /** @brief requests over this connection */
+    #ifdef NATIVE_64BIT
+        CURL *curl = NULL;                          /** @brief curl easy handle */
+        CURLM *multi = NULL;                        /** @brief curl multi handle, holds the connection cache */
+        struct curl_slist *resolve = NULL;          /** @brief host address from the dns cache */
+        bool resumed = false;                       /** @brief tls handshake of the last request resumed a session */
+    #else
+        WiFiClient *client = NULL;                  /** @brief tcp or tls client */
+        HTTPClient *http = NULL;                    /** @brief http client bound to the client */
+    #endif
+    } uri_load_conn_t;
+    #ifndef NATIVE_64BIT
+    /**
+     * @brief plain tcp client that connects over the uri_load dns cache
+     */
+    class UriLoadClient : public WiFiClient {
+        public:
+            int connect( const char *host, uint16_t port );
+            int connect( const char *host, uint16_t port, int32_t timeout );
+    };
+    #endif
+    /**
+     * @brief connection pool statistics
+     */
+    typedef struct {
+        uint32_t requests = 0;                      /** @brief acquired connections */
+        uint32_t reused = 0;                        /** @brief requests over an already open connection */
+        uint32_t connects = 0;                      /** @brief requests with a new connect */
+        uint32_t expired = 0;                       /** @brief connections closed after idle timeout */
+        uint32_t evicted = 0;                       /** @brief idle connections closed for another host */
+        uint32_t overflow = 0;                      /** @brief one shot connections, pool was full */
+        uint32_t handshakes = 0;                    /** @brief tls handshakes */
+        uint32_t resumed = 0;                       /** @brief tls handshakes with a resumed session */
+        uint64_t connect_time = 0;                  /** @brief total tcp connect time in us, native only */
+        uint64_t handshake_time = 0;                /** @brief total tls handshake time in us, native only */
+    } uri_load_pool_stats_t;
+    /**
+     * @brief setup the connection pool, closes idle connections in the background
+     */
+    void uri_load_pool_setup( void );
+    /**
+     * @brief get a connection for a http/https uri, an idle connection to the same
+     * host is reused, otherwise a new one is created
+     *
+     * @param   uri     http or https uri
+     *
+     * @return  pointer to a uri_load_conn_t, NULL if failed
+     */
+    uri_load_conn_t *uri_load_pool_acquire( const char *uri );
+    /**
+     * @brief give a connection back to the pool
+     *
+     * @param   conn    pointer to a acquired connection
+     * @param   keep    true to keep the connection open for the next request, false after an error
+     */
+    void uri_load_pool_release( uri_load_conn_t *conn, bool keep );
+    /**
+     * @brief close all idle connections
+     */
+    void uri_load_pool_flush( void );
+    /**
+     * @brief enable or disable connection reuse, disabled every request gets a one shot connection
+     *
+     * @param   enable  true to enable
+     */
+    void uri_load_pool_set_enable( bool enable );
+    /**
+     * @brief get the connection pool statistics
+     *
+     * @return  pointer to a uri_load_pool_stats_t structure
+     */
+    uri_load_pool_stats_t *uri_load_pool_get_stats( void );
+
+#endif // _URI_LOAD_POOL_H
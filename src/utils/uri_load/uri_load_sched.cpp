@@ -0,0 +1,483 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "uri_load_sched.h"
+#include "hardware/powermgm.h"
+#include "utils/alloc.h"
+#include "utils/lock.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef NATIVE_64BIT
+    #include <pthread.h>
+    #include <time.h>
+    #include "utils/logging.h"
+
+    static pthread_cond_t uri_load_sched_work_cond = PTHREAD_COND_INITIALIZER;  /** @brief a job is queued */
+    static pthread_cond_t uri_load_sched_done_cond = PTHREAD_COND_INITIALIZER;  /** @brief a job is done */
+    static pthread_t uri_load_sched_worker_task[ URI_LOAD_SCHED_WORKERS ];
+#else
+    #include <Arduino.h>
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/semphr.h>
+    #include <freertos/task.h>
+
+    static TaskHandle_t uri_load_sched_worker_task[ URI_LOAD_SCHED_WORKERS ];
+#endif
+static lock_mutex_t uri_load_sched_mutex = LOCK_MUTEX_INITIALIZER;
+
+static uri_load_job_t *uri_load_sched_jobs = NULL;                  /** @brief queued, running and not yet picked up jobs */
+static uri_load_sched_stats_t uri_load_sched_stats;
+static uint32_t uri_load_sched_seq = 0;
+static bool uri_load_sched_started = false;
+
+static bool uri_load_sched_powermgm_event_cb( EventBits_t event, void *arg );
+#ifdef NATIVE_64BIT
+    static void uri_load_sched_test( const char *uri );
+#endif
+
+static void uri_load_sched_lock( void ) {
+    lock_mutex_take( &uri_load_sched_mutex );
+}
+
+static void uri_load_sched_unlock( void ) {
+    lock_mutex_give( &uri_load_sched_mutex );
+}
+
+/**
+ * @brief wake up all workers, call with lock held
+ */
+static void uri_load_sched_signal_work( void ) {
+#ifdef NATIVE_64BIT
+    pthread_cond_broadcast( &uri_load_sched_work_cond );
+#else
+    for( int i = 0 ; i < URI_LOAD_SCHED_WORKERS ; i++ ) {
+        if ( uri_load_sched_worker_task[ i ] ) {
+            xTaskNotifyGive( uri_load_sched_worker_task[ i ] );
+        }
+    }
+#endif
+}
+
+/**
+ * @brief wait for the next queued job, call with lock held
+ */
+static void uri_load_sched_wait_work( void ) {
+#ifdef NATIVE_64BIT
+    pthread_cond_wait( &uri_load_sched_work_cond, &uri_load_sched_mutex );
+#else
+    uri_load_sched_unlock();
+    ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+    uri_load_sched_lock();
+#endif
+}
+
+/**
+ * @brief wait for the next finished job, call with lock held
+ */
+static void uri_load_sched_wait_done( void ) {
+#ifdef NATIVE_64BIT
+    pthread_cond_wait( &uri_load_sched_done_cond, &uri_load_sched_mutex );
+#else
+    uri_load_sched_unlock();
+    vTaskDelay( pdMS_TO_TICKS( 10 ) );
+    uri_load_sched_lock();
+#endif
+}
+
+static void uri_load_sched_signal_done( void ) {
+#ifdef NATIVE_64BIT
+    pthread_cond_broadcast( &uri_load_sched_done_cond );
+#endif
+}
+
+/**
+ * @brief remove a job from the list and free it, call with lock held
+ */
+static void uri_load_sched_free_job( uri_load_job_t *job ) {
+    for( uri_load_job_t **entry = &uri_load_sched_jobs ; *entry ; entry = &(*entry)->next ) {
+        if ( *entry == job ) {
+            *entry = job->next;
+            break;
+        }
+    }
+    if ( job->dsc ) {
+        uri_load_free_all( job->dsc );
+    }
+    free( job->uri );
+    delete job;
+}
+
+/**
+ * @brief get the next job for a worker, the first worker is kept free
+ * for visible requests, call with lock held
+ */
+static uri_load_job_t *uri_load_sched_next_job( int worker ) {
+    uri_load_job_t *next = NULL;
+
+    for( uri_load_job_t *job = uri_load_sched_jobs ; job ; job = job->next ) {
+        if ( job->state != URI_LOAD_JOB_QUEUED ) {
+            continue;
+        }
+        if ( worker == 0 && job->prio != URI_LOAD_PRIO_VISIBLE ) {
+            continue;
+        }
+        if ( !next || job->prio < next->prio || ( job->prio == next->prio && job->seq < next->seq ) ) {
+            next = job;
+        }
+    }
+    return( next );
+}
+
+static void uri_load_sched_worker( int worker ) {
+    uri_load_sched_lock();
+    while( true ) {
+        uri_load_job_t *job = uri_load_sched_next_job( worker );
+        if ( !job ) {
+            uri_load_sched_wait_work();
+            continue;
+        }
+        job->state = URI_LOAD_JOB_RUNNING;
+        uri_load_sched_stats.queued--;
+        uri_load_sched_stats.in_flight++;
+        if ( uri_load_sched_stats.in_flight > uri_load_sched_stats.max_in_flight ) {
+            uri_load_sched_stats.max_in_flight = uri_load_sched_stats.in_flight;
+        }
+        uri_load_sched_unlock();
+        /**
+         * a running job is never freed, the uri stays valid, jobs are map
+         * tiles that go into the tile store, the response cache would only
+         * hold a second copy
+         */
+        URI_LOAD_LOG("worker %d: load %s", worker, job->uri );
+        uri_load_dsc_t *dsc = uri_load_to_ram( job->uri, NULL, URI_LOAD_NO_CACHE );
+
+        uri_load_sched_lock();
+        uri_load_sched_stats.in_flight--;
+        if ( dsc ) {
+            uri_load_sched_stats.completed++;
+        }
+        else {
+            uri_load_sched_stats.failed++;
+        }
+        job->state = URI_LOAD_JOB_DONE;
+        job->dsc = dsc;
+        /**
+         * nobody waits anymore, the response cache still has it
+         */
+        if ( !job->refs ) {
+            if ( dsc ) {
+                uri_load_sched_stats.dropped++;
+            }
+            uri_load_sched_free_job( job );
+        }
+        else if ( job->done_cb ) {
+            job->done_cb( job->done_arg );
+        }
+        uri_load_sched_signal_done();
+    }
+}
+
+#ifdef NATIVE_64BIT
+static void *uri_load_sched_worker_thread( void *arg ) {
+    uri_load_sched_worker( (int)(intptr_t)arg );
+    return( NULL );
+}
+#else
+static void uri_load_sched_worker_Task( void *pvParameters ) {
+    uri_load_sched_worker( (int)(intptr_t)pvParameters );
+    vTaskDelete( NULL );
+}
+#endif
+
+/**
+ * @brief start the workers at the first request, call with lock held
+ */
+static void uri_load_sched_start( void ) {
+    if ( uri_load_sched_started ) {
+        return;
+    }
+    uri_load_sched_started = true;
+
+    for( int i = 0 ; i < URI_LOAD_SCHED_WORKERS ; i++ ) {
+#ifdef NATIVE_64BIT
+        pthread_create( &uri_load_sched_worker_task[ i ], NULL, uri_load_sched_worker_thread, (void*)(intptr_t)i );
+#else
+        xTaskCreate(    uri_load_sched_worker_Task,         /* Function to implement the task */
+                        "uri_load worker Task",             /* Name of the task */
+                        URI_LOAD_SCHED_STACK_SIZE,          /* Stack size in words */
+                        (void*)(intptr_t)i,                 /* Task input parameter */
+                        1,                                  /* Priority of the task */
+                        &uri_load_sched_worker_task[ i ] ); /* Task handle. */
+#endif
+    }
+    URI_LOAD_INFO_LOG("download scheduler started with %d workers", URI_LOAD_SCHED_WORKERS );
+}
+
+void uri_load_sched_setup( void ) {
+    powermgm_register_cb( POWERMGM_STANDBY, uri_load_sched_powermgm_event_cb, "uri_load sched" );
+#ifdef NATIVE_64BIT
+    const char *test = getenv( URI_LOAD_SCHED_TEST_ENV );
+    if ( test && *test ) {
+        uri_load_sched_test( test );
+    }
+#endif
+}
+
+uri_load_job_t *uri_load_sched_submit( const char *uri, uri_load_prio_t prio ) {
+    uri_load_job_t *job = NULL;
+
+    if ( !uri || prio >= URI_LOAD_PRIO_NUM ) {
+        return( NULL );
+    }
+
+    uri_load_sched_lock();
+    uri_load_sched_start();
+    uri_load_sched_stats.submitted++;
+    /**
+     * attach to a queued or running job for the same uri
+     */
+    for( job = uri_load_sched_jobs ; job ; job = job->next ) {
+        if ( job->state != URI_LOAD_JOB_DONE && !strcmp( job->uri, uri ) ) {
+            break;
+        }
+    }
+    if ( job ) {
+        uri_load_sched_stats.coalesced++;
+        URI_LOAD_LOG("coalesce request: %s", uri );
+        if ( prio < job->prio ) {
+            job->prio = prio;
+            uri_load_sched_signal_work();
+        }
+    }
+    else {
+        job = new uri_load_job_t;
+        job->uri = (char*)MALLOC( strlen( uri ) + 1 );
+        if ( !job->uri ) {
+            URI_LOAD_ERROR_LOG("job uri alloc failed");
+            delete job;
+            uri_load_sched_unlock();
+            return( NULL );
+        }
+        strncpy( job->uri, uri, strlen( uri ) + 1 );
+        job->prio = prio;
+        job->seq = uri_load_sched_seq++;
+        job->next = uri_load_sched_jobs;
+        uri_load_sched_jobs = job;
+        uri_load_sched_stats.queued++;
+        uri_load_sched_signal_work();
+    }
+    job->refs++;
+    uri_load_sched_unlock();
+    return( job );
+}
+
+uri_load_dsc_t *uri_load_sched_wait( uri_load_job_t *job ) {
+    uri_load_dsc_t *dsc = NULL;
+
+    if ( !job ) {
+        return( NULL );
+    }
+
+    uri_load_sched_lock();
+    while( job->state != URI_LOAD_JOB_DONE ) {
+        uri_load_sched_wait_done();
+    }
+    /**
+     * the last waiter gets the result, all others a copy
+     */
+    if ( job->dsc ) {
+        if ( job->refs == 1 ) {
+            dsc = job->dsc;
+            job->dsc = NULL;
+        }
+        else {
+            dsc = uri_load_copy( job->dsc );
+        }
+    }
+    job->refs--;
+    if ( !job->refs ) {
+        uri_load_sched_free_job( job );
+    }
+    uri_load_sched_unlock();
+    return( dsc );
+}
+
+void uri_load_sched_cancel( uri_load_job_t *job ) {
+    if ( !job ) {
+        return;
+    }
+
+    uri_load_sched_lock();
+    job->refs--;
+    if ( !job->refs ) {
+        switch( job->state ) {
+            case URI_LOAD_JOB_QUEUED:
+                uri_load_sched_stats.queued--;
+                uri_load_sched_stats.cancelled++;
+                uri_load_sched_free_job( job );
+                break;
+            case URI_LOAD_JOB_DONE:
+                uri_load_sched_free_job( job );
+                break;
+            default:
+                /**
+                 * the worker drops the result
+                 */
+                break;
+        }
+    }
+    uri_load_sched_unlock();
+}
+
+bool uri_load_sched_is_done( uri_load_job_t *job ) {
+    bool done = false;
+
+    if ( !job ) {
+        return( false );
+    }
+
+    uri_load_sched_lock();
+    done = job->state == URI_LOAD_JOB_DONE;
+    uri_load_sched_unlock();
+    return( done );
+}
+
+void uri_load_sched_notify( uri_load_job_t *job, uri_load_sched_done_cb_t *cb, void *arg ) {
+    if ( !job ) {
+        return;
+    }
+
+    uri_load_sched_lock();
+    job->done_cb = cb;
+    job->done_arg = arg;
+    if ( job->state == URI_LOAD_JOB_DONE && cb ) {
+        cb( arg );
+    }
+    uri_load_sched_unlock();
+}
+
+void uri_load_sched_cancel_prio( uri_load_prio_t prio ) {
+    uri_load_sched_lock();
+    uri_load_job_t *job = uri_load_sched_jobs;
+    while( job ) {
+        uri_load_job_t *next = job->next;
+        if ( job->state == URI_LOAD_JOB_QUEUED && job->prio == prio ) {
+            uri_load_sched_stats.queued--;
+            uri_load_sched_stats.cancelled++;
+            job->cancelled = true;
+            job->state = URI_LOAD_JOB_DONE;
+            /**
+             * without waiters it is gone, waiters free it
+             */
+            if ( !job->refs ) {
+                uri_load_sched_free_job( job );
+            }
+            else if ( job->done_cb ) {
+                job->done_cb( job->done_arg );
+            }
+        }
+        job = next;
+    }
+    uri_load_sched_signal_done();
+    uri_load_sched_unlock();
+}
+
+uri_load_dsc_t *uri_load_sched_to_ram( const char *uri, uri_load_prio_t prio ) {
+    return( uri_load_sched_wait( uri_load_sched_submit( uri, prio ) ) );
+}
+
+uri_load_sched_stats_t *uri_load_sched_get_stats( void ) {
+    return( &uri_load_sched_stats );
+}
+
+static bool uri_load_sched_powermgm_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case POWERMGM_STANDBY:
+            /**
+             * nothing is on screen anymore
+             */
+            uri_load_sched_cancel_prio( URI_LOAD_PRIO_PREFETCH );
+            uri_load_sched_cancel_prio( URI_LOAD_PRIO_BACKGROUND );
+            break;
+    }
+    return( true );
+}
+
+#ifdef NATIVE_64BIT
+static const char *uri_load_sched_test_uri = NULL;                  /** @brief base uri of the native test */
+static uint32_t uri_load_sched_test_failed = 0;                     /** @brief failed requests in the native test */
+/**
+ * @brief native test, URI_LOAD_SCHED_TEST_THREADS threads request the same
+ * URI_LOAD_SCHED_TEST_URIS uris with mixed priorities at once, the identical
+ * ones are coalesced
+ */
+static void *uri_load_sched_test_thread( void *arg ) {
+    int thread = (int)(intptr_t)arg;
+    char request[ 512 ] = "";
+    /**
+     * every thread starts with an other uri
+     */
+    for( int i = 0 ; i < URI_LOAD_SCHED_TEST_URIS ; i++ ) {
+        int uri = ( thread + i ) % URI_LOAD_SCHED_TEST_URIS;
+        snprintf( request, sizeof( request ), "%s?%d", uri_load_sched_test_uri, uri );
+        uri_load_dsc_t *dsc = uri_load_sched_to_ram( request, (uri_load_prio_t)( uri % URI_LOAD_PRIO_NUM ) );
+        if ( !dsc ) {
+            __sync_fetch_and_add( &uri_load_sched_test_failed, 1 );
+            continue;
+        }
+        uri_load_free_all( dsc );
+    }
+    return( NULL );
+}
+
+static void uri_load_sched_test( const char *uri ) {
+    pthread_t thread[ URI_LOAD_SCHED_TEST_THREADS ];
+    struct timespec start, end;
+
+    uri_load_sched_test_uri = uri;
+    uri_load_sched_test_failed = 0;
+    uri_load_sched_stats = uri_load_sched_stats_t();
+
+    clock_gettime( CLOCK_MONOTONIC, &start );
+    for( int i = 0 ; i < URI_LOAD_SCHED_TEST_THREADS ; i++ ) {
+        pthread_create( &thread[ i ], NULL, uri_load_sched_test_thread, (void*)(intptr_t)i );
+    }
+    for( int i = 0 ; i < URI_LOAD_SCHED_TEST_THREADS ; i++ ) {
+        pthread_join( thread[ i ], NULL );
+    }
+    clock_gettime( CLOCK_MONOTONIC, &end );
+
+    uint32_t time = ( end.tv_sec - start.tv_sec ) * 1000 + ( end.tv_nsec - start.tv_nsec ) / 1000000;
+    URI_LOAD_INFO_LOG("scheduler test %s: %d threads, %d requests in %dms, %d failed",
+                        uri,
+                        URI_LOAD_SCHED_TEST_THREADS,
+                        uri_load_sched_stats.submitted,
+                        time,
+                        uri_load_sched_test_failed );
+    URI_LOAD_INFO_LOG("  %d transfers, %d coalesced, max %d in flight",
+                        uri_load_sched_stats.completed + uri_load_sched_stats.failed,
+                        uri_load_sched_stats.coalesced,
+                        uri_load_sched_stats.max_in_flight );
+}
+#endif
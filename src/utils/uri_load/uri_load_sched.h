@@ -0,0 +1,161 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _URI_LOAD_SCHED_H
+    #define _URI_LOAD_SCHED_H
+
+    #include <stddef.h>
+    #include <stdint.h>
+    #include "uri_load.h"
+
+    #ifdef NATIVE_64BIT
+        #define URI_LOAD_SCHED_WORKERS      4       /** @brief max transfers in flight */
+    #else
+        #define URI_LOAD_SCHED_WORKERS      2       /** @brief max transfers in flight */
+    #endif
+    #define URI_LOAD_SCHED_STACK_SIZE       5000    /** @brief worker task stack size in words */
+    #define URI_LOAD_SCHED_TEST_ENV         "HEDGE_URI_LOAD_SCHED_TEST" /** @brief env var with a test uri on native */
+    #define URI_LOAD_SCHED_TEST_THREADS     8       /** @brief requesting threads in the native test */
+    #define URI_LOAD_SCHED_TEST_URIS        6       /** @brief different uris per thread in the native test */
+    /**
+     * @brief priority classes, a lower value is served first, the first
+     * worker only serves URI_LOAD_PRIO_VISIBLE
+     */
+    typedef enum {
+        URI_LOAD_PRIO_VISIBLE = 0,                  /** @brief something on screen waits for it */
+        URI_LOAD_PRIO_PREFETCH,                     /** @brief probably needed soon */
+        URI_LOAD_PRIO_BACKGROUND,                   /** @brief no one waits for it */
+        URI_LOAD_PRIO_NUM
+    } uri_load_prio_t;
+    /**
+     * @brief job state
+     */
+    typedef enum {
+        URI_LOAD_JOB_QUEUED = 0,                    /** @brief waits for a worker */
+        URI_LOAD_JOB_RUNNING,                       /** @brief transfer in flight */
+        URI_LOAD_JOB_DONE                           /** @brief finished, failed or cancelled */
+    } uri_load_job_state_t;
+    /**
+     * @brief job done callback, called from the worker with the scheduler
+     * lock held, must not call the scheduler
+     *
+     * @param   arg     argument from uri_load_sched_notify()
+     */
+    typedef void ( uri_load_sched_done_cb_t ) ( void *arg );
+    /**
+     * @brief download job, shared by all requests for the same uri
+     */
+    typedef struct uri_load_job_t {
+        char *uri = NULL;                           /** @brief requested url */
+        uri_load_prio_t prio = URI_LOAD_PRIO_BACKGROUND;    /** @brief highest requested priority */
+        uri_load_job_state_t state = URI_LOAD_JOB_QUEUED;   /** @brief job state */
+        uint32_t seq = 0;                           /** @brief submit order inside a priority */
+        uint32_t refs = 0;                          /** @brief requests waiting for the result */
+        bool cancelled = false;                     /** @brief cancelled, the result is dropped */
+        bool taken = false;                         /** @brief the result is handed out, further waiters get a copy */
+        uri_load_dsc_t *dsc = NULL;                 /** @brief result, NULL if failed */
+        uri_load_sched_done_cb_t *done_cb = NULL;   /** @brief called when the job is done, NULL if unused */
+        void *done_arg = NULL;                      /** @brief argument for done_cb */
+        struct uri_load_job_t *next = NULL;         /** @brief next job in the list */
+    } uri_load_job_t;
+    /**
+     * @brief scheduler statistics
+     */
+    typedef struct {
+        uint32_t submitted = 0;                     /** @brief requests */
+        uint32_t coalesced = 0;                     /** @brief requests attached to a job for the same uri */
+        uint32_t cancelled = 0;                     /** @brief jobs cancelled before they ran */
+        uint32_t dropped = 0;                       /** @brief results nobody waited for anymore */
+        uint32_t completed = 0;                     /** @brief finished transfers */
+        uint32_t failed = 0;                        /** @brief failed transfers */
+        uint32_t queued = 0;                        /** @brief jobs waiting for a worker */
+        uint32_t in_flight = 0;                     /** @brief transfers running */
+        uint32_t max_in_flight = 0;                 /** @brief max transfers running at once */
+    } uri_load_sched_stats_t;
+    /**
+     * @brief setup download scheduler, the workers start with the first request
+     */
+    void uri_load_sched_setup( void );
+    /**
+     * @brief request a uri, a job for the same uri is shared and gets the
+     * higher priority
+     *
+     * @param   uri     requested url
+     * @param   prio    priority class
+     *
+     * @return  job handle, release it with uri_load_sched_wait() or uri_load_sched_cancel()
+     */
+    uri_load_job_t *uri_load_sched_submit( const char *uri, uri_load_prio_t prio );
+    /**
+     * @brief wait for a job and release the handle
+     *
+     * @param   job     job handle from uri_load_sched_submit()
+     *
+     * @return  pointer to a uri_load_dsc_t owned by the caller, NULL if failed or cancelled
+     */
+    uri_load_dsc_t *uri_load_sched_wait( uri_load_job_t *job );
+    /**
+     * @brief release a job handle without the result, a queued job without
+     * other requests is removed, a running one is finished and dropped
+     *
+     * @param   job     job handle from uri_load_sched_submit()
+     */
+    void uri_load_sched_cancel( uri_load_job_t *job );
+    /**
+     * @brief check if a job is done, uri_load_sched_wait() does not block then
+     *
+     * @param   job     job handle from uri_load_sched_submit()
+     *
+     * @return  true if finished, failed or cancelled
+     */
+    bool uri_load_sched_is_done( uri_load_job_t *job );
+    /**
+     * @brief get called when a job is done instead of waiting for it, a job
+     * has one callback, the last one set wins, a done job calls it at once
+     *
+     * @param   job     job handle from uri_load_sched_submit()
+     * @param   cb      callback, called with the scheduler lock held
+     * @param   arg     callback argument
+     */
+    void uri_load_sched_notify( uri_load_job_t *job, uri_load_sched_done_cb_t *cb, void *arg );
+    /**
+     * @brief cancel all queued jobs of a priority class, waiters get NULL
+     *
+     * @param   prio    priority class
+     */
+    void uri_load_sched_cancel_prio( uri_load_prio_t prio );
+    /**
+     * @brief load a uri into ram through the scheduler, blocks until done
+     *
+     * @param   uri     requested url
+     * @param   prio    priority class
+     *
+     * @return  pointer to a uri_load_dsc_t, NULL if failed
+     */
+    uri_load_dsc_t *uri_load_sched_to_ram( const char *uri, uri_load_prio_t prio );
+    /**
+     * @brief get the scheduler statistics
+     *
+     * @return  pointer to a uri_load_sched_stats_t structure
+     */
+    uri_load_sched_stats_t *uri_load_sched_get_stats( void );
+
+#endif // _URI_LOAD_SCHED_H
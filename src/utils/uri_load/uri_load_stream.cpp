@@ -0,0 +1,905 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "uri_load_stream.h"
+#include "utils/alloc.h"
+
+#include <time.h>
+
+#ifdef NATIVE_64BIT
+    #include <stdlib.h>
+    #include <string.h>
+    #include <unistd.h>
+    #include <sys/types.h>
+    #include <pwd.h>
+    #include "utils/logging.h"
+#else
+    #include <Arduino.h>
+#endif
+
+static uri_load_stream_stats_t uri_load_stream_stats;
+
+static void uri_load_stream_close_conn( uri_load_stream_t *stream );
+static int32_t uri_load_stream_read_raw_cb( uint8_t *buf, size_t size, void *arg );
+
+#ifdef NATIVE_64BIT
+/**
+ * @brief curl write callback, takes one chunk at a time and pauses the
+ * transfer until the chunk is read
+ */
+static size_t uri_load_stream_write_cb( void *contents, size_t size, size_t nmemb, void *userp ) {
+    uri_load_stream_t *stream = (uri_load_stream_t *)userp;
+    size_t realsize = size * nmemb;
+
+    if ( stream->buf_pos < stream->buf_len ) {
+        stream->paused = true;
+        return( CURL_WRITEFUNC_PAUSE );
+    }
+    /**
+     * curl never hands more than CURL_MAX_WRITE_SIZE bytes in one call
+     */
+    if ( !stream->buf ) {
+        stream->buf = (uint8_t*)MALLOC( CURL_MAX_WRITE_SIZE );
+        if ( !stream->buf ) {
+            URI_LOAD_ERROR_LOG("stream buffer alloc failed");
+            return( 0 );
+        }
+    }
+    memcpy( stream->buf, contents, realsize );
+    stream->buf_len = realsize;
+    stream->buf_pos = 0;
+    return( realsize );
+}
+
+/**
+ * @brief curl header callback, collects the cache headers of the last response
+ */
+static size_t uri_load_stream_header_cb( char *buffer, size_t size, size_t nitems, void *userp ) {
+    uri_load_stream_t *stream = (uri_load_stream_t *)userp;
+    size_t realsize = size * nitems;
+    char line[ URI_LOAD_CACHE_TAG_LEN * 2 ] = "";
+
+    if ( realsize >= sizeof( line ) ) {
+        return( realsize );
+    }
+    memcpy( line, buffer, realsize );
+    line[ strcspn( line, "\r\n" ) ] = '\0';
+    /**
+     * a status line starts a new response, e.g. after a redirect
+     */
+    if ( !strncmp( line, "HTTP/", 5 ) ) {
+        stream->meta = uri_load_cache_meta_t();
+        stream->encoding = URI_LOAD_ENCODING_IDENTITY;
+        return( realsize );
+    }
+    char *value = strchr( line, ':' );
+    if ( value ) {
+        *value++ = '\0';
+        value += strspn( value, " " );
+        if ( !strcasecmp( line, "Content-Encoding" ) ) {
+            stream->encoding = uri_load_inflate_parse_encoding( value );
+        }
+        uri_load_cache_parse_header( &stream->meta, line, value );
+    }
+    return( realsize );
+}
+
+/**
+ * @brief run the transfer until a chunk is there or the transfer is done
+ */
+static void uri_load_stream_pump( uri_load_stream_t *stream ) {
+    CURLM *multi = stream->conn->multi;
+
+    while( !stream->done && stream->buf_pos >= stream->buf_len ) {
+        int running = 0;
+        int msgs = 0;
+        CURLMsg *msg = NULL;
+
+        if ( stream->paused ) {
+            stream->paused = false;
+            curl_easy_pause( stream->conn->curl, CURLPAUSE_CONT );
+            if ( stream->buf_pos < stream->buf_len ) {
+                break;
+            }
+        }
+        if ( curl_multi_perform( multi, &running ) != CURLM_OK ) {
+            stream->failed = true;
+            stream->done = true;
+            break;
+        }
+        while( ( msg = curl_multi_info_read( multi, &msgs ) ) ) {
+            if ( msg->msg == CURLMSG_DONE ) {
+                if ( msg->data.result != CURLE_OK ) {
+                    URI_LOAD_ERROR_LOG("curl transfer failed: %s", curl_easy_strerror( msg->data.result ) );
+                    stream->failed = true;
+                }
+                stream->done = true;
+            }
+        }
+        if ( stream->buf_pos < stream->buf_len || stream->done ) {
+            break;
+        }
+        curl_multi_wait( multi, NULL, 0, 100, NULL );
+    }
+}
+#else
+/**
+ * @brief open a http/https uri with the HTTPClient over a pooled connection
+ */
+static bool uri_load_stream_open_client( uri_load_stream_t *stream, const char *uri, uri_load_cache_meta_t *validators, uint32_t offset, const char *if_range, bool compress ) {
+    const char * headerKeys[] = { "location", "redirect", "ETag", "Last-Modified", "Cache-Control", "Content-Encoding", "Transfer-Encoding" };
+    const size_t numberOfHeaders = 7;
+    String location = uri;
+
+    for( int redirect = 0 ; redirect <= URI_LOAD_STREAM_MAX_REDIRECT ; redirect++ ) {
+        int httpCode = 0;
+        /**
+         * get a connection from the pool, a kept alive connection can be closed
+         * by the server in the meantime, try a fresh one in this case
+         */
+        for( int retry = 0 ; retry < 2 ; retry++ ) {
+            stream->conn = uri_load_pool_acquire( location.c_str() );
+            if ( !stream->conn ) {
+                return( false );
+            }
+            bool reused = stream->conn->client->connected();
+            stream->conn->http->begin( *stream->conn->client, location.c_str() );
+            stream->conn->http->collectHeaders( headerKeys, numberOfHeaders );
+            stream->conn->http->setUserAgent( HARDWARE_NAME "-" __FIRMWARE__ );
+            if ( validators && *validators->etag ) {
+                stream->conn->http->addHeader( "If-None-Match", validators->etag );
+            }
+            if ( validators && *validators->last_modified ) {
+                stream->conn->http->addHeader( "If-Modified-Since", validators->last_modified );
+            }
+            /**
+             * the HTTPClient always sends its own identity Accept-Encoding, a
+             * listed gzip/deflate still wins on common servers
+             */
+            if ( compress ) {
+                stream->conn->http->addHeader( "Accept-Encoding", URI_LOAD_INFLATE_ACCEPT );
+            }
+            if ( offset ) {
+                stream->conn->http->addHeader( "Range", String( "bytes=" ) + String( offset ) + "-" );
+                if ( if_range && *if_range ) {
+                    stream->conn->http->addHeader( "If-Range", if_range );
+                }
+            }
+            httpCode = stream->conn->http->GET();
+            if ( httpCode > 0 || !reused ) {
+                break;
+            }
+            URI_LOAD_LOG("kept alive connection lost, reconnect");
+            uri_load_pool_release( stream->conn, false );
+            stream->conn = NULL;
+        }
+        /**
+         * request successfull?
+         */
+        if ( httpCode == HTTP_CODE_OK || ( httpCode == HTTP_CODE_NOT_MODIFIED && validators ) || ( ( httpCode == HTTP_CODE_PARTIAL_CONTENT || httpCode == HTTP_CODE_RANGE_NOT_SATISFIABLE ) && offset ) ) {
+            stream->code = httpCode;
+            stream->size = stream->conn->http->getSize();
+            stream->client = stream->conn->http->getStreamPtr();
+            for( size_t i = 2 ; i < numberOfHeaders ; i++ ) {
+                if ( stream->conn->http->hasHeader( headerKeys[ i ] ) ) {
+                    uri_load_cache_parse_header( &stream->meta, headerKeys[ i ], stream->conn->http->header( headerKeys[ i ] ).c_str() );
+                }
+            }
+            if ( stream->conn->http->hasHeader( "Content-Encoding" ) ) {
+                stream->encoding = uri_load_inflate_parse_encoding( stream->conn->http->header( "Content-Encoding" ).c_str() );
+            }
+            /**
+             * the HTTPClient only decodes chunked bodies in writeToStream(),
+             * the raw stream still carries the chunk framing
+             */
+            if ( stream->conn->http->hasHeader( "Transfer-Encoding" ) ) {
+                stream->chunked = strcasestr( stream->conn->http->header( "Transfer-Encoding" ).c_str(), "chunked" ) != NULL;
+            }
+            return( true );
+        }
+        /**
+         * check for a 301/302 redirect
+         */
+        if ( httpCode == 301 || httpCode == 302 ) {
+            if ( stream->conn->http->header("location") != "" ) {
+                location = stream->conn->http->header("location");
+            }
+            else {
+                location = stream->conn->http->header("redirect");
+            }
+            URI_LOAD_INFO_LOG("301/302 redirect to: %s", location.c_str() );
+            uri_load_pool_release( stream->conn, true );
+            stream->conn = NULL;
+            if ( location != "" ) {
+                continue;
+            }
+        }
+        URI_LOAD_ERROR_LOG("http connection abort, code: %d", httpCode );
+        break;
+    }
+    if ( stream->conn ) {
+        uri_load_pool_release( stream->conn, false );
+        stream->conn = NULL;
+    }
+    return( false );
+}
+#endif
+
+uri_load_stream_t *uri_load_stream_open( const char *uri ) {
+    return( uri_load_stream_open( uri, 0, NULL, 0 ) );
+}
+
+uri_load_stream_t *uri_load_stream_open( const char *uri, uint32_t offset, const char *if_range ) {
+    return( uri_load_stream_open( uri, offset, if_range, 0 ) );
+}
+
+uri_load_stream_t *uri_load_stream_open( const char *uri, uint32_t offset, const char *if_range, uint32_t flags ) {
+    uri_load_stream_t *stream = new uri_load_stream_t;
+
+    URI_LOAD_LOG("open stream: %s, offset %d", uri, offset );
+
+    if ( strstr( uri, "file://" ) ) {
+#ifdef NATIVE_64BIT
+        char filepath[512] = "";
+        /**
+         * resolve local filepath on native uni*x maschine
+         */
+        if ( getenv("HOME") )
+            snprintf( filepath, sizeof( filepath ), "%s/.hedge%s", getpwuid(getuid())->pw_dir, strstr( uri, "://" ) + 3 );
+#else
+        const char *filepath = strstr( uri, "://" ) + 3;
+#endif
+        stream->file = fopen( filepath, "rb" );
+        if ( !stream->file ) {
+            URI_LOAD_ERROR_LOG("file open failed: %s", filepath );
+            delete stream;
+            return( NULL );
+        }
+        fseek( stream->file, 0, SEEK_END );
+        stream->size = ftell( stream->file );
+        stream->wire_size = stream->size;
+        fseek( stream->file, 0, SEEK_SET );
+        return( stream );
+    }
+
+    if ( !strstr( uri, "http://" ) && !strstr( uri, "https://" ) ) {
+        URI_LOAD_ERROR_LOG("uri not supported");
+        delete stream;
+        return( NULL );
+    }
+    /**
+     * a fresh cached response needs no request at all, ranges bypass the cache
+     */
+    bool use_cache = !offset && !( flags & URI_LOAD_NO_CACHE );
+    bool compress = !offset && !( flags & URI_LOAD_IDENTITY ) && uri_load_inflate_get_enable();
+    uri_load_cache_meta_t cached_meta;
+    FILE *cached = use_cache ? uri_load_cache_open( uri, &cached_meta ) : NULL;
+    if ( cached && cached_meta.expires > time( NULL ) ) {
+        URI_LOAD_LOG("fresh from cache: %s", uri );
+        uri_load_cache_count( true, false, cached_meta.size );
+        stream->file = cached;
+        stream->size = cached_meta.size;
+        stream->wire_size = stream->size;
+        return( stream );
+    }
+#ifdef NATIVE_64BIT
+    stream->conn = uri_load_pool_acquire( uri );
+    if ( !stream->conn ) {
+        if ( cached ) fclose( cached );
+        delete stream;
+        return( NULL );
+    }
+    /**
+     * revalidate a cached response, a 304 has no body
+     */
+    if ( cached && *cached_meta.etag ) {
+        char header[ URI_LOAD_CACHE_TAG_LEN + 32 ] = "";
+        snprintf( header, sizeof( header ), "If-None-Match: %s", cached_meta.etag );
+        stream->headers = curl_slist_append( stream->headers, header );
+    }
+    if ( cached && *cached_meta.last_modified ) {
+        char header[ URI_LOAD_CACHE_TAG_LEN + 32 ] = "";
+        snprintf( header, sizeof( header ), "If-Modified-Since: %s", cached_meta.last_modified );
+        stream->headers = curl_slist_append( stream->headers, header );
+    }
+    /**
+     * ask for a compressed body, curl hands the encoded bytes through
+     * as long as CURLOPT_ACCEPT_ENCODING is not set, a range is always
+     * requested on the identity body
+     */
+    if ( compress ) {
+        stream->headers = curl_slist_append( stream->headers, "Accept-Encoding: " URI_LOAD_INFLATE_ACCEPT );
+    }
+    /**
+     * resume, a server that ignores the range or has a changed body sends a 200
+     */
+    if ( offset ) {
+        char header[ URI_LOAD_CACHE_TAG_LEN + 32 ] = "";
+        snprintf( header, sizeof( header ), "Range: bytes=%u-", offset );
+        stream->headers = curl_slist_append( stream->headers, header );
+        if ( if_range && *if_range ) {
+            snprintf( header, sizeof( header ), "If-Range: %s", if_range );
+            stream->headers = curl_slist_append( stream->headers, header );
+        }
+    }
+    curl_easy_setopt( stream->conn->curl, CURLOPT_URL, uri );
+    curl_easy_setopt( stream->conn->curl, CURLOPT_HTTPHEADER, stream->headers );
+    curl_easy_setopt( stream->conn->curl, CURLOPT_HEADERFUNCTION, uri_load_stream_header_cb );
+    curl_easy_setopt( stream->conn->curl, CURLOPT_HEADERDATA, (void *)stream );
+    curl_easy_setopt( stream->conn->curl, CURLOPT_WRITEFUNCTION, uri_load_stream_write_cb );
+    curl_easy_setopt( stream->conn->curl, CURLOPT_WRITEDATA, (void *)stream );
+    curl_easy_setopt( stream->conn->curl, CURLOPT_USERAGENT, HARDWARE_NAME "-" __FIRMWARE__ );
+    curl_easy_setopt( stream->conn->curl, CURLOPT_FOLLOWLOCATION, 1L );
+    curl_easy_setopt( stream->conn->curl, CURLOPT_MAXREDIRS, (long)URI_LOAD_STREAM_MAX_REDIRECT );
+    curl_easy_setopt( stream->conn->curl, CURLOPT_FAILONERROR, 1L );
+    curl_multi_add_handle( stream->conn->multi, stream->conn->curl );
+    /**
+     * run until the first chunk, now the status and content length are known
+     */
+    uri_load_stream_pump( stream );
+    long code = 0;
+    curl_off_t size = -1;
+    curl_easy_getinfo( stream->conn->curl, CURLINFO_RESPONSE_CODE, &code );
+    if ( stream->failed && !( code == 416 && offset ) ) {
+        if ( cached ) fclose( cached );
+        uri_load_stream_close( stream );
+        return( NULL );
+    }
+    stream->failed = false;
+    curl_easy_getinfo( stream->conn->curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &size );
+    stream->code = code;
+    stream->size = size;
+#else
+    /**
+     * tls buffers into psram
+     */
+    bool secure = strstr( uri, "https://" ) != NULL;
+    if ( secure ) {
+        heap_caps_malloc_extmem_enable( 1 );
+    }
+    bool opened = uri_load_stream_open_client( stream, uri, cached ? &cached_meta : NULL, offset, if_range, compress );
+    if ( secure ) {
+        heap_caps_malloc_extmem_enable( 16 * 1024 );
+    }
+    if ( !opened ) {
+        if ( cached ) fclose( cached );
+        delete stream;
+        return( NULL );
+    }
+#endif
+    /**
+     * 416, the range starts at or behind the end, an empty body and the
+     * caller decides if the partial body is complete
+     */
+    if ( stream->code == 416 ) {
+        URI_LOAD_LOG("range not satisfiable: %s, offset %d", uri, offset );
+        uri_load_stream_close_conn( stream );
+        stream->offset = offset;
+        stream->size = 0;
+        stream->wire_size = 0;
+        stream->done = true;
+        return( stream );
+    }
+    /**
+     * not modified, the body comes from the cache
+     */
+    if ( stream->code == 304 && cached ) {
+        URI_LOAD_LOG("not modified, from cache: %s", uri );
+        uri_load_cache_refresh( uri, &stream->meta );
+        uri_load_cache_count( false, true, cached_meta.size );
+        stream->done = true;
+        uri_load_stream_close_conn( stream );
+        stream->file = cached;
+        stream->size = cached_meta.size;
+        stream->wire_size = stream->size;
+        stream->received = 0;
+        stream->done = false;
+        return( stream );
+    }
+    if ( cached ) {
+        fclose( cached );
+    }
+    /**
+     * a compressed body has no known length until it is inflated
+     */
+    stream->wire_size = stream->size;
+    uri_load_stream_stats.requests++;
+    if ( stream->encoding == URI_LOAD_ENCODING_UNKNOWN ) {
+        URI_LOAD_ERROR_LOG("content encoding not supported");
+        stream->failed = true;
+        uri_load_stream_close( stream );
+        return( NULL );
+    }
+    if ( stream->encoding != URI_LOAD_ENCODING_IDENTITY ) {
+        stream->inflate = uri_load_inflate_begin( stream->encoding, uri_load_stream_read_raw_cb, (void*)stream );
+        if ( !stream->inflate ) {
+            stream->failed = true;
+            uri_load_stream_close( stream );
+            return( NULL );
+        }
+        uri_load_stream_stats.encoded++;
+        stream->size = -1;
+    }
+    if ( stream->code == 206 && offset ) {
+        stream->offset = offset;
+        return( stream );
+    }
+    if ( stream->code != 200 ) {
+        URI_LOAD_ERROR_LOG("http connection abort, code: %d", stream->code );
+        stream->failed = true;
+        uri_load_stream_close( stream );
+        return( NULL );
+    }
+    /**
+     * copy a cacheable body into a new cache entry while it is read
+     */
+    if ( uri_load_cache_get_enable() && use_cache ) {
+        uri_load_cache_count( false, false, 0 );
+        stream->meta.size = stream->size;
+        if ( uri_load_cache_is_cacheable( &stream->meta ) ) {
+            stream->cache_file = uri_load_cache_create( uri, &stream->meta );
+            stream->cache_uri = stream->cache_file ? strdup( uri ) : NULL;
+        }
+    }
+    return( stream );
+}
+
+#ifndef NATIVE_64BIT
+/**
+ * @brief read the next chunk size line of a chunked body, the zero length
+ * chunk and its trailers end the body and leave the connection reusable
+ *
+ * @param   stream  pointer to the stream
+ *
+ * @return  true if a chunk or the end of the body follows, false on error
+ */
+static bool uri_load_stream_next_chunk( uri_load_stream_t *stream ) {
+    String line;
+
+    if ( stream->chunk_crlf ) {
+        line = stream->client->readStringUntil( '\n' );
+        stream->chunk_crlf = false;
+        line.trim();
+        if ( line.length() ) {
+            URI_LOAD_ERROR_LOG("chunk not terminated by crlf");
+            stream->failed = true;
+            return( false );
+        }
+    }
+    line = stream->client->readStringUntil( '\n' );
+    line.trim();
+    if ( !line.length() || !isxdigit( line[ 0 ] ) ) {
+        URI_LOAD_ERROR_LOG("invalid chunk size line");
+        stream->failed = true;
+        return( false );
+    }
+    /**
+     * chunk extensions after a ';' are ignored by strtoul
+     */
+    stream->chunk_left = strtoul( line.c_str(), NULL, 16 );
+    if ( stream->chunk_left ) {
+        return( true );
+    }
+    /**
+     * skip the trailer up to the empty line
+     */
+    do {
+        line = stream->client->readStringUntil( '\n' );
+        line.trim();
+    } while( line.length() );
+    stream->done = true;
+    return( true );
+}
+#endif
+
+/**
+ * @brief read bytes as they come from the wire or file
+ */
+static int32_t uri_load_stream_read_raw( uri_load_stream_t *stream, uint8_t *buf, size_t size ) {
+    size_t len = 0;
+
+    if ( stream->failed ) {
+        return( -1 );
+    }
+#ifdef NATIVE_64BIT
+    if ( ( stream->done && stream->buf_pos >= stream->buf_len ) || !size ) {
+        return( 0 );
+    }
+#else
+    if ( stream->done || !size ) {
+        return( 0 );
+    }
+#endif
+
+    if ( stream->file ) {
+        len = fread( buf, 1, size, stream->file );
+        if ( len == 0 ) {
+            stream->done = true;
+        }
+    }
+    else {
+#ifdef NATIVE_64BIT
+        uri_load_stream_pump( stream );
+        len = stream->buf_len - stream->buf_pos;
+        if ( len > size ) {
+            len = size;
+        }
+        memcpy( buf, stream->buf + stream->buf_pos, len );
+        stream->buf_pos += len;
+        if ( stream->failed ) {
+            return( -1 );
+        }
+#else
+        /**
+         * wait for data, the content length or the last chunk ends the body,
+         * without both the server closes the connection
+         */
+        uint32_t last_data = millis();
+        while( len == 0 ) {
+            if ( stream->wire_size >= 0 && stream->wire >= (uint32_t)stream->wire_size ) {
+                stream->done = true;
+                break;
+            }
+            if ( stream->chunked && !stream->chunk_left ) {
+                if ( !uri_load_stream_next_chunk( stream ) || stream->done ) {
+                    break;
+                }
+                continue;
+            }
+            size_t available = stream->client->available();
+            if ( available ) {
+                if ( stream->wire_size >= 0 && available > stream->wire_size - stream->wire ) {
+                    available = stream->wire_size - stream->wire;
+                }
+                if ( stream->chunked && available > stream->chunk_left ) {
+                    available = stream->chunk_left;
+                }
+                len = stream->client->readBytes( buf, available < size ? available : size );
+                if ( stream->chunked ) {
+                    stream->chunk_left -= len;
+                    stream->chunk_crlf = true;
+                }
+                break;
+            }
+            if ( !stream->conn->http->connected() ) {
+                stream->done = true;
+                stream->failed = stream->wire_size >= 0;
+                break;
+            }
+            if ( millis() - last_data > URI_LOAD_POOL_TIMEOUT ) {
+                URI_LOAD_ERROR_LOG("stream read timeout");
+                stream->failed = true;
+                break;
+            }
+            delay( 1 );
+        }
+        if ( stream->failed ) {
+            return( -1 );
+        }
+#endif
+        uri_load_stream_stats.wire_bytes += len;
+    }
+    stream->wire += len;
+#ifndef NATIVE_64BIT
+    /**
+     * curl ends the transfer by itself, here the content length ends it
+     */
+    if ( stream->wire_size >= 0 && stream->wire >= (uint32_t)stream->wire_size ) {
+        stream->done = true;
+    }
+#endif
+    return( len );
+}
+
+/**
+ * @brief inflate source, pulls the compressed body
+ */
+static int32_t uri_load_stream_read_raw_cb( uint8_t *buf, size_t size, void *arg ) {
+    return( uri_load_stream_read_raw( (uri_load_stream_t *)arg, buf, size ) );
+}
+
+int32_t uri_load_stream_read( uri_load_stream_t *stream, uint8_t *buf, size_t size ) {
+    int32_t len = 0;
+
+    if ( !stream || stream->failed ) {
+        return( -1 );
+    }
+    if ( stream->inflate ) {
+        len = uri_load_inflate_read( stream->inflate, buf, size );
+        if ( len < 0 ) {
+            stream->failed = true;
+            return( -1 );
+        }
+        /**
+         * read up to the end of the body, only then the connection can be reused
+         */
+        if ( len == 0 && size ) {
+            while( uri_load_stream_read_raw( stream, buf, size ) > 0 );
+        }
+    }
+    else {
+        len = uri_load_stream_read_raw( stream, buf, size );
+        if ( len < 0 ) {
+            return( -1 );
+        }
+    }
+    /**
+     * copy into the new cache entry, a too big body is not cached
+     */
+    if ( stream->cache_file && len ) {
+        if ( stream->received + len > URI_LOAD_CACHE_MAX_ENTRY_SIZE || fwrite( buf, 1, len, stream->cache_file ) != (size_t)len ) {
+            uri_load_cache_commit( stream->cache_uri, stream->cache_file, false );
+            stream->cache_file = NULL;
+        }
+    }
+    stream->received += len;
+    if ( !stream->file ) {
+        uri_load_stream_stats.body_bytes += len;
+    }
+    return( len );
+}
+
+/**
+ * @brief hand the connection back, only a completely read body leaves the
+ * connection in a known state
+ */
+static void uri_load_stream_close_conn( uri_load_stream_t *stream ) {
+    if ( !stream->conn ) {
+        return;
+    }
+#ifdef NATIVE_64BIT
+    curl_multi_remove_handle( stream->conn->multi, stream->conn->curl );
+    curl_easy_setopt( stream->conn->curl, CURLOPT_HTTPHEADER, NULL );
+    if ( stream->headers ) {
+        curl_slist_free_all( stream->headers );
+        stream->headers = NULL;
+    }
+    if ( stream->buf ) {
+        free( stream->buf );
+        stream->buf = NULL;
+    }
+    stream->buf_len = stream->buf_pos = 0;
+#else
+    stream->client = NULL;
+#endif
+    uri_load_pool_release( stream->conn, stream->done && !stream->failed );
+    stream->conn = NULL;
+}
+
+void uri_load_stream_close( uri_load_stream_t *stream ) {
+    if ( !stream ) {
+        return;
+    }
+    if ( stream->file ) {
+        fclose( stream->file );
+    }
+    /**
+     * keep the new cache entry only with a complete body
+     */
+    if ( stream->cache_file ) {
+        uri_load_cache_commit( stream->cache_uri, stream->cache_file, stream->done && !stream->failed );
+    }
+    if ( stream->cache_uri ) {
+        free( stream->cache_uri );
+    }
+    uri_load_inflate_end( stream->inflate );
+    uri_load_stream_close_conn( stream );
+    delete stream;
+}
+
+uri_load_stream_stats_t *uri_load_stream_get_stats( void ) {
+    return( &uri_load_stream_stats );
+}
+
+bool uri_load_stream( const char *uri, uri_load_sink_cb_t *sink, void *arg, progress_cb_t *progresscb ) {
+    bool retval = false;
+    uint8_t *block = (uint8_t*)MALLOC( URI_BLOCK_SIZE );
+
+    if ( !block ) {
+        URI_LOAD_ERROR_LOG("block alloc failed");
+        return( false );
+    }
+
+    uri_load_stream_t *stream = uri_load_stream_open( uri );
+    if ( stream ) {
+        while( true ) {
+            int32_t len = uri_load_stream_read( stream, block, URI_BLOCK_SIZE );
+            if ( len < 0 ) {
+                URI_LOAD_ERROR_LOG("download failed");
+                break;
+            }
+            if ( len == 0 ) {
+                retval = true;
+                break;
+            }
+            if ( !sink( block, len, arg ) ) {
+                URI_LOAD_ERROR_LOG("sink abort");
+                break;
+            }
+            if ( progresscb && stream->wire_size > 0 ) {
+                progresscb( ( 100 * (uint64_t)stream->wire ) / stream->wire_size );
+            }
+        }
+        uri_load_stream_close( stream );
+    }
+    free( block );
+    return( retval );
+}
+
+bool uri_load_stream( const char *uri, uri_load_sink_cb_t *sink, void *arg ) {
+    return( uri_load_stream( uri, sink, arg, NULL ) );
+}
+
+bool uri_load_sink_file( const uint8_t *data, size_t len, void *arg ) {
+    FILE *file = (FILE*)arg;
+
+    if ( fwrite( data, 1, len, file ) != len ) {
+        URI_LOAD_ERROR_LOG("error while write");
+        return( false );
+    }
+    return( true );
+}
+
+bool uri_load_sink_ram( const uint8_t *data, size_t len, void *arg ) {
+    uri_load_ram_sink_t *ram = (uri_load_ram_sink_t*)arg;
+    /**
+     * grow in URI_BLOCK_SIZE steps if the preset capacity is too small
+     */
+    if ( ram->size + len + 1 > ram->capacity || !ram->data ) {
+        uint32_t capacity = ram->size + len + 1 > ram->capacity ? ram->size + len + 1 + URI_BLOCK_SIZE : ram->capacity;
+        uint8_t *ptr = (uint8_t*)REALLOC( ram->data, capacity );
+        if ( !ptr ) {
+            URI_LOAD_ERROR_LOG("ram sink alloc failed, %d bytes", capacity );
+            return( false );
+        }
+        ram->data = ptr;
+        ram->capacity = capacity;
+    }
+    if ( len ) {
+        memcpy( ram->data + ram->size, data, len );
+    }
+    ram->size += len;
+    ram->data[ ram->size ] = '\0';
+    return( true );
+}
+
+UriLoadStream::~UriLoadStream() {
+    end();
+}
+
+bool UriLoadStream::begin( const char *uri ) {
+    end();
+    stream = uri_load_stream_open( uri );
+    return( stream != NULL );
+}
+
+void UriLoadStream::end( void ) {
+    /**
+     * json can end before the body, read the rest to keep the connection
+     */
+    if ( stream && stream->size >= 0 && stream->size - stream->received <= URI_LOAD_STREAM_BUF_SIZE ) {
+        while( fill() ) {
+            buf_pos = buf_len;
+        }
+    }
+    uri_load_stream_close( stream );
+    stream = NULL;
+    buf_len = buf_pos = 0;
+    free( body.data );
+    body = uri_load_ram_sink_t();
+    body_pos = 0;
+}
+
+bool UriLoadStream::fill( void ) {
+    if ( buf_pos < buf_len ) {
+        return( true );
+    }
+    /**
+     * a buffered body is read from ram
+     */
+    if ( body.data ) {
+        if ( body_pos >= body.size ) {
+            return( false );
+        }
+        buf_len = body.size - body_pos < sizeof( buf ) ? body.size - body_pos : sizeof( buf );
+        memcpy( buf, body.data + body_pos, buf_len );
+        body_pos += buf_len;
+        buf_pos = 0;
+        return( true );
+    }
+    int32_t len = uri_load_stream_read( stream, buf, sizeof( buf ) );
+    if ( len <= 0 ) {
+        return( false );
+    }
+    buf_len = len;
+    buf_pos = 0;
+    return( true );
+}
+
+int UriLoadStream::read( void ) {
+    if ( !stream || !fill() ) {
+        return( -1 );
+    }
+    return( buf[ buf_pos++ ] );
+}
+
+size_t UriLoadStream::readBytes( char *buffer, size_t length ) {
+    size_t count = 0;
+
+    while( stream && count < length && fill() ) {
+        size_t len = buf_len - buf_pos < length - count ? buf_len - buf_pos : length - count;
+        memcpy( buffer + count, buf + buf_pos, len );
+        buf_pos += len;
+        count += len;
+    }
+    return( count );
+}
+
+int32_t UriLoadStream::size( void ) {
+    if ( body.data ) {
+        return( body.size );
+    }
+    return( stream ? stream->size : -1 );
+}
+
+/**
+ * @brief read the whole body into ram, the inflated length is known after
+ */
+bool UriLoadStream::buffer( void ) {
+    uint8_t chunk[ URI_LOAD_STREAM_BUF_SIZE ];
+    int32_t len;
+
+    if ( !stream || body.data ) {
+        return( body.data != NULL );
+    }
+    /**
+     * a empty body is a valid body
+     */
+    if ( !uri_load_sink_ram( NULL, 0, &body ) ) {
+        return( false );
+    }
+    while( ( len = uri_load_stream_read( stream, chunk, sizeof( chunk ) ) ) > 0 ) {
+        if ( !uri_load_sink_ram( chunk, len, &body ) ) {
+            len = -1;
+            break;
+        }
+    }
+    if ( len < 0 ) {
+        URI_LOAD_ERROR_LOG("buffer body failed");
+        free( body.data );
+        body = uri_load_ram_sink_t();
+        return( false );
+    }
+    body_pos = 0;
+    return( true );
+}
+
+size_t UriLoadStream::jsonSize( uint32_t factor ) {
+    /**
+     * size the document like the former full ram download did, with the
+     * inflated length, never from a guess
+     */
+    if ( size() < 0 ) {
+        buffer();
+    }
+    return( size() > 0 ? size() * factor : URI_LOAD_STREAM_JSON_SIZE );
+}
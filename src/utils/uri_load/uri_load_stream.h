@@ -0,0 +1,242 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _URI_LOAD_STREAM_H
+    #define _URI_LOAD_STREAM_H
+
+    #include <stdio.h>
+    #include <stdint.h>
+    #include "uri_load.h"
+    #include "uri_load_pool.h"
+    #include "uri_load_cache.h"
+    #include "uri_load_inflate.h"
+
+    #define URI_LOAD_STREAM_MAX_REDIRECT    5       /** @brief max followed 301/302 redirects */
+    #define URI_LOAD_STREAM_BUF_SIZE        512     /** @brief UriLoadStream read buffer */
+    #define URI_LOAD_STREAM_JSON_SIZE       8192    /** @brief json document size when the content length is unknown */
+    /**
+     * @brief open download stream, pull the body with uri_load_stream_read()
+     */
+    typedef struct {
+        uri_load_conn_t *conn = NULL;       /** @brief pooled http/https connection */
+        FILE *file = NULL;                  /** @brief file:// or cached source */
+        int code = 0;                       /** @brief http status */
+        uint32_t offset = 0;                /** @brief body start in the resource, non zero on a 206 */
+        int32_t size = -1;                  /** @brief body length, -1 if unknown or compressed */
+        uint32_t received = 0;              /** @brief body bytes read so far */
+        int32_t wire_size = -1;             /** @brief content length on the wire, -1 if unknown */
+        uint32_t wire = 0;                  /** @brief bytes read from the wire so far */
+        uri_load_encoding_t encoding = URI_LOAD_ENCODING_IDENTITY;  /** @brief content encoding of the response */
+        uri_load_inflate_t *inflate = NULL; /** @brief inflater for a compressed body */
+        bool done = false;                  /** @brief body complete */
+        bool failed = false;                /** @brief transfer failed */
+        uri_load_cache_meta_t meta;         /** @brief cache headers of the response */
+        FILE *cache_file = NULL;            /** @brief new cache entry, the body is copied into */
+        char *cache_uri = NULL;             /** @brief uri of the new cache entry */
+    #ifdef NATIVE_64BIT
+        struct curl_slist *headers = NULL;  /** @brief conditional request headers */
+        uint8_t *buf = NULL;                /** @brief chunk from the curl write callback */
+        size_t buf_len = 0;                 /** @brief bytes in buf */
+        size_t buf_pos = 0;                 /** @brief read position in buf */
+        bool paused = false;                /** @brief transfer paused until buf is read */
+    #else
+        WiFiClient *client = NULL;          /** @brief body stream of the http client */
+        bool chunked = false;               /** @brief body uses chunked transfer encoding */
+        bool chunk_crlf = false;            /** @brief a chunk crlf is pending before the next size line */
+        uint32_t chunk_left = 0;            /** @brief body bytes left in the current chunk */
+    #endif
+    } uri_load_stream_t;
+    /**
+     * @brief stream statistics, network responses only
+     */
+    typedef struct {
+        uint32_t requests = 0;              /** @brief responses with a body from the network */
+        uint32_t encoded = 0;               /** @brief responses with a compressed body */
+        uint64_t wire_bytes = 0;            /** @brief body bytes on the wire */
+        uint64_t body_bytes = 0;            /** @brief body bytes after inflate */
+    } uri_load_stream_stats_t;
+    /**
+     * @brief sink function for uri_load_stream(), called for every body chunk
+     *
+     * @param   data    pointer to the chunk
+     * @param   len     chunk length, max URI_BLOCK_SIZE
+     * @param   arg     sink argument
+     *
+     * @return  true to continue, false to abort the download
+     */
+    typedef bool ( uri_load_sink_cb_t ) ( const uint8_t *data, size_t len, void *arg );
+    /**
+     * @brief ram sink argument, see uri_load_sink_ram()
+     */
+    typedef struct {
+        uint8_t *data = NULL;               /** @brief received data, zero terminated */
+        uint32_t size = 0;                  /** @brief received bytes */
+        uint32_t capacity = 0;              /** @brief allocated bytes */
+    } uri_load_ram_sink_t;
+    /**
+     * @brief open a http/https/file uri for reading, redirects are followed,
+     * fresh or revalidated responses come from the cache, a gzip or deflate
+     * encoded body is inflated while it is read
+     *
+     * @param   uri     requested url
+     *
+     * @return  pointer to a uri_load_stream_t, NULL if failed or not status 200
+     */
+    uri_load_stream_t *uri_load_stream_open( const char *uri );
+    /**
+     * @brief open a http/https uri from an offset, the body starts at the
+     * offset if the server answers with 206, a 200 sends the full body
+     *
+     * @param   uri         requested url
+     * @param   offset      range start, 0 for the full body
+     * @param   if_range    etag or last-modified of the partial body, NULL to resume unconditional
+     *
+     * @return  pointer to a uri_load_stream_t, stream->offset is the body start,
+     *          a range behind the end gives an empty body with stream->code 416
+     */
+    uri_load_stream_t *uri_load_stream_open( const char *uri, uint32_t offset, const char *if_range );
+    /**
+     * @brief open a http/https uri from an offset with request flags
+     *
+     * @param   uri         requested url
+     * @param   offset      range start, 0 for the full body
+     * @param   if_range    etag or last-modified of the partial body, NULL to resume unconditional
+     * @param   flags       URI_LOAD_NO_CACHE, URI_LOAD_IDENTITY or 0
+     *
+     * @return  pointer to a uri_load_stream_t, see above
+     */
+    uri_load_stream_t *uri_load_stream_open( const char *uri, uint32_t offset, const char *if_range, uint32_t flags );
+    /**
+     * @brief read body bytes, blocks until data is available
+     *
+     * @param   stream  pointer to a open stream
+     * @param   buf     pointer to the destination buffer
+     * @param   size    buffer size
+     *
+     * @return  number of bytes read, 0 at the end of the body, -1 on error
+     */
+    int32_t uri_load_stream_read( uri_load_stream_t *stream, uint8_t *buf, size_t size );
+    /**
+     * @brief close a stream, a completely read connection goes back into the pool
+     *
+     * @param   stream  pointer to a open stream
+     */
+    void uri_load_stream_close( uri_load_stream_t *stream );
+    /**
+     * @brief get the stream statistics
+     *
+     * @return  pointer to a uri_load_stream_stats_t structure
+     */
+    uri_load_stream_stats_t *uri_load_stream_get_stats( void );
+    /**
+     * @brief download a uri and hand the body in URI_BLOCK_SIZE chunks to a sink
+     *
+     * @param   uri         requested url
+     * @param   sink        sink function
+     * @param   arg         sink argument
+     * @param   progresscb  pointer to a call back funtion or NULL
+     *
+     * @return  true if success
+     */
+    bool uri_load_stream( const char *uri, uri_load_sink_cb_t *sink, void *arg, progress_cb_t *progresscb );
+    /**
+     * @brief download a uri and hand the body in URI_BLOCK_SIZE chunks to a sink
+     *
+     * @param   uri         requested url
+     * @param   sink        sink function
+     * @param   arg         sink argument
+     *
+     * @return  true if success
+     */
+    bool uri_load_stream( const char *uri, uri_load_sink_cb_t *sink, void *arg );
+    /**
+     * @brief file sink, writes all chunks into a open file
+     *
+     * @param   arg     FILE pointer
+     */
+    bool uri_load_sink_file( const uint8_t *data, size_t len, void *arg );
+    /**
+     * @brief ram sink, appends all chunks to a zero terminated buffer, a preset
+     * capacity is allocated at once, e.g. for a png that is decoded in one go
+     *
+     * @param   arg     pointer to a uri_load_ram_sink_t
+     */
+    bool uri_load_sink_ram( const uint8_t *data, size_t len, void *arg );
+    /**
+     * @brief pull stream for ArduinoJson, deserializeJson( doc, stream ) parses
+     * the body while it arrives, no ram copy of the body is needed if the
+     * content length is known, a compressed or chunked body is inflated into
+     * ram by jsonSize() to size the document from its real length
+     */
+    class UriLoadStream {
+        public:
+            ~UriLoadStream();
+            /**
+             * @brief open a uri
+             *
+             * @param   uri     requested url
+             *
+             * @return  true if the body can be read
+             */
+            bool begin( const char *uri );
+            /**
+             * @brief close the stream
+             */
+            void end( void );
+            /**
+             * @brief read one byte
+             *
+             * @return  byte or -1 at the end
+             */
+            int read( void );
+            /**
+             * @brief read bytes
+             *
+             * @return  number of bytes read
+             */
+            size_t readBytes( char *buffer, size_t length );
+            /**
+             * @brief content length
+             *
+             * @return  body size in bytes, -1 if unknown
+             */
+            int32_t size( void );
+            /**
+             * @brief suggested json document size, factor times body length,
+             * a body without a known length is read into ram first
+             *
+             * @param   factor  json document size per body byte
+             *
+             * @return  json document size
+             */
+            size_t jsonSize( uint32_t factor );
+        private:
+            bool fill( void );
+            bool buffer( void );
+            uri_load_stream_t *stream = NULL;
+            uri_load_ram_sink_t body;                   /** @brief inflated body if the length is unknown */
+            size_t body_pos = 0;                        /** @brief read position in body */
+            uint8_t buf[ URI_LOAD_STREAM_BUF_SIZE ];
+            size_t buf_len = 0;
+            size_t buf_pos = 0;
+    };
+
+#endif // _URI_LOAD_STREAM_H
@@ -35,6 +35,10 @@
     #include <ESPAsyncWebServer.h>
     #include <SPIFFSEditor.h>
     #include <ESP32SSDP.h>
+    #include "utils/fbstream/fbstream.h"
+    #include "utils/latency/latency.h"
+    #include "utils/rendergov/rendergov.h"
+    #include "utils/alloc.h"
 
     AsyncWebServer asyncserver( WEBSERVERPORT );
     TaskHandle_t _WEBSERVER_Task;
@@ -137,6 +141,30 @@ void handleUpdate( AsyncWebServerRequest *request, const String& filename, size_
   }
 }
 
+/**
+ * minimal canvas viewer for the fbstream websocket, see fbstream.h for the packet format
+ */
+static const char* fbstreamIndex =
+    "<!DOCTYPE html>\n<html><head><title>fbstream</title></head><body>"
+    "\n<canvas id='fb' width='240' height='240'></canvas>"
+    "\n<div id='st'></div>"
+    "\n<script>"
+    "\nvar c=document.getElementById('fb'),g=c.getContext('2d'),img=g.createImageData(c.width,c.height),n=0,b=0;"
+    "\nvar ws=new WebSocket('ws://'+location.host+'/fbstream');ws.binaryType='arraybuffer';"
+    "\nfunction put(o,p){var d=img.data;d[o*4]=(p>>8)&0xf8;d[o*4+1]=(p>>3)&0xfc;d[o*4+2]=(p<<3)&0xf8;d[o*4+3]=255;}"
+    "\nws.onmessage=function(e){var v=new DataView(e.data),f=v.getUint8(3),x=v.getUint16(4,1),y=v.getUint16(6,1),w=v.getUint16(8,1),h=v.getUint16(10,1),i=16,k=0;"
+    "\n if(v.getUint8(0)!=70||v.getUint8(1)!=66)return;"
+    "\n if(x+w>c.width||y+h>c.height){c.width=Math.max(c.width,x+w);c.height=Math.max(c.height,y+h);img=g.createImageData(c.width,c.height);}"
+    "\n function o(){return (y+Math.floor(k/w))*c.width+x+k%w;}"
+    "\n if(f&1)for(k=0;k<w*h;k++)put(o(),0);k=0;"
+    "\n while(i<e.data.byteLength&&k<w*h){var t=v.getUint8(i++),r=(t&0x3f)+1;"
+    "\n  if(t&0x80){r=(t&0x7f)+1;while(r--){put(o(),v.getUint16(i,1));i+=2;k++;}}"
+    "\n  else if(t&0x40){var p=v.getUint16(i,1);i+=2;while(r--){put(o(),p);k++;}}"
+    "\n  else k+=r;}"
+    "\n g.putImageData(img,0,0);n++;b+=e.data.byteLength;"
+    "\n document.getElementById('st').innerHTML=n+' packets, '+b+' bytes';};"
+    "\n</script></body></html>";
+
 /*
  *
  */
@@ -169,6 +197,9 @@ void asyncwebserver_start(void){
       "<li><a target=\"cont\" href=\"/network\">/network</a> - Display network information"
       "<li><a target=\"cont\" href=\"/shot\">/shot</a> - Capture a screen shot"
       "<li><a target=\"cont\" href=\"/screen.png\">/screen.png</a> - Retrieve the image in png format, open it with gimp"
+      "<li><a target=\"cont\" href=\"/fbstream.htm\">/fbstream.htm</a> - Live view of the screen"
+      "<li><a target=\"cont\" href=\"/rendergov\">/rendergov</a> - Display render governor statistics"
+      "<li><a target=\"cont\" href=\"/latency\">/latency</a> - Touch to photon latency histogram, /latency?reset clears it"
       "<li><a target=\"_blank\" href=\"/edit\">/edit</a> - View, edit, upload, and delete files"
       "</ul>"
       "<p><div style=\"color:red;\">Caution:</div> Use these with care:"
@@ -235,6 +266,34 @@ void asyncwebserver_start(void){
     request->send(200, "text/html", html);
   });
 
+  asyncserver.on("/rendergov", HTTP_GET, [](AsyncWebServerRequest *request) {
+    rendergov_stats_t *stats = rendergov_get_stats();
+    String html = (String) "<html><head><meta charset=\"utf-8\"></head><body><h3>Render Governor</h3>" +
+                  "<b>Quality: </b>" + ( stats->quality == RENDERGOV_QUALITY_FULL ? "full" : "reduced" ) + "<br>" +
+                  "<b>Animation frames: </b>" + stats->frames + "<br>" +
+                  "<b>Avg frame interval: </b>" + stats->avg_frame_interval + "ms<br>" +
+                  "<b>LVGL idle: </b>" + stats->idle + "%<br>" +
+                  "<b>Reduced: </b>" + stats->reduced + "<br>" +
+                  "<b>Restored: </b>" + stats->restored + "<br>" +
+                  "<b>Time reduced: </b>" + (uint32_t)stats->reduced_time + "ms<br>" +
+                  "</body></html>";
+    request->send(200, "text/html", html);
+  });
+
+  asyncserver.on("/latency", HTTP_GET, [](AsyncWebServerRequest *request) {
+    char *report = (char*)MALLOC( LATENCY_REPORT_SIZE );
+    if ( !report ) {
+      request->send(500, "text/plain", "out of memory");
+      return;
+    }
+    latency_get_report( report, LATENCY_REPORT_SIZE );
+    request->send(200, "text/plain", report );
+    free( report );
+    if ( request->hasParam("reset") ) {
+      latency_reset_stats();
+    }
+  });
+
 /*
   asyncserver.on("/battery", HTTP_GET, [](AsyncWebServerRequest *request) {
     TTGOClass * ttgo = TTGOClass::getWatch();
@@ -400,6 +459,18 @@ void asyncwebserver_start(void){
     [](AsyncWebServerRequest *request, const String &filename, size_t index, uint8_t *data, size_t len, bool final) { handleUpdate(request, filename, index, data, len, final); }
   );
 
+  asyncserver.on("/fbstream.htm", HTTP_GET, [](AsyncWebServerRequest *request) {
+    request->send(200, "text/html", fbstreamIndex);
+  });
+  /**
+   * the websocket handler is owned by the server, add it only once
+   */
+  static bool fbstream_handler_added = false;
+  if ( !fbstream_handler_added ) {
+    asyncserver.addHandler( fbstream_get_handler() );
+    fbstream_handler_added = true;
+  }
+
   asyncserver.on("/description.xml", HTTP_GET, [](AsyncWebServerRequest *request) {
     byte mac[6];
     WiFi.macAddress(mac);
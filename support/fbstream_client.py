@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+#
+# fbstream test client
+#
+# connects to the framebuffer stream of the native emulator (raw tcp on
+# localhost:8081) or a watch (websocket ws://<ip>/fbstream), decodes the
+# delta packets into a local frame, prints statistics and writes the last
+# frame as screen.ppm
+#
+# usage:
+#   fbstream_client.py                          native emulator
+#   fbstream_client.py ws://192.168.1.42/fbstream
+#   fbstream_client.py -n 100 -o out.ppm        stop after 100 packets
+#
+import argparse
+import base64
+import os
+import socket
+import struct
+import sys
+import time
+from urllib.parse import urlparse
+
+HEADER = struct.Struct("<2sBBHHHHI")
+VERSION = 1
+FLAG_KEYFRAME = 0x01
+
+
+def recv_exact(sock, size):
+    data = bytearray()
+    while len(data) < size:
+        chunk = sock.recv(size - len(data))
+        if not chunk:
+            raise EOFError("connection closed")
+        data += chunk
+    return bytes(data)
+
+
+def tcp_packets(host, port):
+    sock = socket.create_connection((host, port))
+    while True:
+        header = recv_exact(sock, HEADER.size)
+        length = HEADER.unpack(header)[7]
+        yield header + recv_exact(sock, length)
+
+
+def ws_packets(url):
+    u = urlparse(url)
+    sock = socket.create_connection((u.hostname, u.port or 80))
+    key = base64.b64encode(os.urandom(16)).decode()
+    sock.sendall(("GET %s HTTP/1.1\r\nHost: %s\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                  "Sec-WebSocket-Key: %s\r\nSec-WebSocket-Version: 13\r\n\r\n" % (u.path or "/", u.hostname, key)).encode())
+    response = b""
+    while b"\r\n\r\n" not in response:
+        response += recv_exact(sock, 1)
+    if b" 101 " not in response.split(b"\r\n")[0]:
+        raise ConnectionError(response.split(b"\r\n")[0].decode())
+    message = b""
+    while True:
+        b0, b1 = recv_exact(sock, 2)
+        length = b1 & 0x7f
+        if length == 126:
+            length = struct.unpack(">H", recv_exact(sock, 2))[0]
+        elif length == 127:
+            length = struct.unpack(">Q", recv_exact(sock, 8))[0]
+        payload = recv_exact(sock, length)
+        opcode = b0 & 0x0f
+        if opcode == 0x8:
+            raise EOFError("websocket closed")
+        if opcode in (0x0, 0x2):
+            message += payload
+            if b0 & 0x80:
+                yield message
+                message = b""
+
+
+class Frame:
+    def __init__(self):
+        self.width = 0
+        self.height = 0
+        self.pixel = []
+
+    def grow(self, width, height):
+        if width <= self.width and height <= self.height:
+            return
+        width, height = max(width, self.width), max(height, self.height)
+        pixel = [0] * (width * height)
+        for y in range(self.height):
+            pixel[y * width:y * width + self.width] = self.pixel[y * self.width:(y + 1) * self.width]
+        self.width, self.height, self.pixel = width, height, pixel
+
+    def decode(self, packet):
+        magic, version, flags, x, y, w, h, length = HEADER.unpack_from(packet)
+        if magic != b"FB" or version != VERSION or len(packet) != HEADER.size + length:
+            raise ValueError("malformed packet")
+        self.grow(x + w, y + h)
+        if flags & FLAG_KEYFRAME:
+            for line in range(h):
+                o = (y + line) * self.width + x
+                self.pixel[o:o + w] = [0] * w
+        pos, n, count = HEADER.size, 0, w * h
+
+        def offset(k):
+            return (y + k // w) * self.width + x + k % w
+
+        while pos < len(packet) and n < count:
+            token = packet[pos]
+            pos += 1
+            if token & 0x80:
+                run = (token & 0x7f) + 1
+                for p in struct.unpack_from("<%dH" % run, packet, pos):
+                    self.pixel[offset(n)] = p
+                    n += 1
+                pos += run * 2
+            elif token & 0x40:
+                run = (token & 0x3f) + 1
+                p = struct.unpack_from("<H", packet, pos)[0]
+                pos += 2
+                for _ in range(run):
+                    self.pixel[offset(n)] = p
+                    n += 1
+            else:
+                n += (token & 0x3f) + 1
+        if n > count:
+            raise ValueError("token overrun")
+        return flags, w * h * 2
+
+    def write_ppm(self, filename):
+        with open(filename, "wb") as f:
+            f.write(b"P6\n%d %d\n255\n" % (self.width, self.height))
+            out = bytearray()
+            for p in self.pixel:
+                out += bytes(((p >> 8) & 0xf8, (p >> 3) & 0xfc, (p << 3) & 0xf8))
+            f.write(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="fbstream test client")
+    parser.add_argument("url", nargs="?", default="tcp://127.0.0.1:8081", help="tcp://host:port or ws://host/fbstream")
+    parser.add_argument("-n", "--packets", type=int, default=0, help="stop after n packets")
+    parser.add_argument("-o", "--output", default="screen.ppm", help="ppm file for the last frame")
+    args = parser.parse_args()
+
+    u = urlparse(args.url)
+    packets = ws_packets(args.url) if u.scheme == "ws" else tcp_packets(u.hostname, u.port or 8081)
+
+    frame = Frame()
+    count = keyframes = raw = wire = 0
+    start = time.time()
+    try:
+        for packet in packets:
+            flags, size = frame.decode(packet)
+            count += 1
+            keyframes += 1 if flags & FLAG_KEYFRAME else 0
+            raw += size
+            wire += len(packet)
+            if count % 50 == 0:
+                elapsed = time.time() - start
+                print("%d packets (%d keyframes), %.1f packets/s, %d kB raw, %d kB wire, ratio %.2f"
+                      % (count, keyframes, count / elapsed, raw // 1024, wire // 1024, wire / max(raw, 1)))
+                frame.write_ppm(args.output)
+            if args.packets and count >= args.packets:
+                break
+    except (EOFError, KeyboardInterrupt):
+        pass
+    if frame.width:
+        frame.write_ppm(args.output)
+    print("total: %d packets, %d bytes raw, %d bytes wire, ratio %.2f" % (count, raw, wire, wire / max(raw, 1)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+#
+# uri_load loopback benchmark server
+#
+# small keep-alive http/1.1 server for the uri_load connection pool
+# and response cache benchmark, answers every GET with a fixed size
+# body and counts tcp connections and requests
+#
+# usage:
+#   uri_load_bench_server.py                    listen on 127.0.0.1:8089
+#   uri_load_bench_server.py -p 8090 -s 16384   other port, 16k body
+#   uri_load_bench_server.py -e                 send ETag/Last-Modified, 304 on a match
+#   uri_load_bench_server.py -e -m 60           and Cache-Control: max-age=60
+#   uri_load_bench_server.py -e -c 10000        answer Range requests, drop every
+#                                               full response after 10000 bytes
+#   uri_load_bench_server.py -z                 json body, gzip/deflate encoded if
+#                                               the client sends Accept-Encoding
+#   uri_load_bench_server.py -t cert.pem        https with a certificate and key in
+#                                               cert.pem, counts resumed sessions
+#
+# a self signed certificate for 127.0.0.1 is made with
+#   openssl req -x509 -newkey rsa:2048 -nodes -days 365 -subj /CN=127.0.0.1 \
+#       -addext subjectAltName=IP:127.0.0.1 -keyout cert.pem -out cert.pem
+# and given to the emulator with HEDGE_URI_LOAD_CAINFO=cert.pem
+#
+# then run the native emulator with
+#   HEDGE_URI_LOAD_BENCH=http://127.0.0.1:8089/tile.png
+# it loads the uri with connection reuse off and on and logs req/s for both
+#
+import argparse
+import email.utils
+import gzip
+import http.server
+import socketserver
+import ssl
+import sys
+import threading
+import zlib
+
+stats_lock = threading.Lock()
+connections = 0
+requests = 0
+not_modified = 0
+partial = 0
+wire_bytes = 0
+body_bytes = 0
+resumed = 0
+
+
+class BenchHandler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    # the body goes out in a separate write, don't let nagle delay it
+    disable_nagle_algorithm = True
+    body = b""
+    etag = None
+    last_modified = None
+    max_age = None
+    cut = None
+    encoded = {}
+
+    def setup(self):
+        global connections, resumed
+        super().setup()
+        with stats_lock:
+            connections += 1
+            if getattr(self.request, "session_reused", False):
+                resumed += 1
+
+    def select_encoding(self):
+        accept = [e.split(";")[0].strip() for e in self.headers.get("Accept-Encoding", "").split(",")]
+        for encoding in ("gzip", "deflate"):
+            if encoding in self.encoded and encoding in accept:
+                return encoding
+        return None
+
+    def variant_etag(self, encoding):
+        # every encoding is a variant with its own validator
+        if not self.etag or not encoding:
+            return self.etag
+        return self.etag[:-1] + '-' + encoding + '"'
+
+    def send_cache_headers(self, encoding=None):
+        if self.etag:
+            self.send_header("ETag", self.variant_etag(encoding))
+            self.send_header("Last-Modified", self.last_modified)
+        if self.max_age is not None:
+            self.send_header("Cache-Control", "max-age=%d" % self.max_age)
+
+    def do_GET(self):
+        global requests, not_modified, partial, wire_bytes, body_bytes
+        with stats_lock:
+            requests += 1
+        encoding = None if self.headers.get("Range") else self.select_encoding()
+        if self.etag and (self.headers.get("If-None-Match") == self.variant_etag(encoding) or
+                          self.headers.get("If-Modified-Since") == self.last_modified):
+            with stats_lock:
+                not_modified += 1
+            self.send_response(304)
+            self.send_cache_headers(encoding)
+            self.end_headers()
+            return
+        # a range is only served if the If-Range validator still matches
+        offset = 0
+        byte_range = self.headers.get("Range", "")
+        if_range = self.headers.get("If-Range")
+        if byte_range.startswith("bytes=") and byte_range.endswith("-") and \
+                (if_range is None or if_range in (self.etag, self.last_modified)):
+            offset = int(byte_range[6:-1])
+        if offset and offset < len(self.body):
+            with stats_lock:
+                partial += 1
+            self.send_response(206)
+            self.send_header("Content-Range", "bytes %d-%d/%d" % (offset, len(self.body) - 1, len(self.body)))
+        else:
+            offset = 0
+            self.send_response(200)
+        payload = self.encoded[encoding] if encoding else self.body[offset:]
+        self.send_header("Content-Type", "application/json" if self.encoded else "application/octet-stream")
+        if encoding:
+            self.send_header("Content-Encoding", encoding)
+        self.send_header("Content-Length", str(len(payload)))
+        self.send_cache_headers(encoding)
+        self.end_headers()
+        cut = self.cut and not offset
+        with stats_lock:
+            wire_bytes += len(payload[:self.cut] if cut else payload)
+            body_bytes += 0 if cut else len(self.body) - offset
+        if cut:
+            payload = payload[:self.cut]
+        self.wfile.write(payload)
+        if cut:
+            self.wfile.flush()
+            self.close_connection = True
+            self.connection.shutdown(2)
+
+    def log_message(self, format, *args):
+        pass
+
+
+def main():
+    parser = argparse.ArgumentParser(description="uri_load loopback benchmark server")
+    parser.add_argument("-p", "--port", type=int, default=8089, help="tcp port")
+    parser.add_argument("-s", "--size", type=int, default=4096, help="response body size")
+    parser.add_argument("-e", "--etag", action="store_true", help="send validators, answer 304 on a match")
+    parser.add_argument("-m", "--max-age", type=int, default=None, help="send Cache-Control: max-age")
+    parser.add_argument("-c", "--cut", type=int, default=None, help="drop full responses after n bytes")
+    parser.add_argument("-z", "--gzip", action="store_true", help="json body, gzip/deflate content-encoding")
+    parser.add_argument("-t", "--tls", default=None, help="serve https with this pem certificate and key")
+    args = parser.parse_args()
+
+    BenchHandler.body = bytes(i % 251 for i in range(args.size))
+    if args.gzip:
+        # something like a weather forecast list
+        items = []
+        while sum(len(i) + 1 for i in items) < args.size:
+            n = len(items)
+            items.append('{"dt":%d,"main":{"temp":%.2f,"humidity":%d},"weather":[{"id":%d,"main":"Clouds","description":"broken clouds"}]}' %
+                         (1600000000 + n * 10800, 280 + (n * 7 % 23) / 3, 40 + n % 50, 800 + n % 5))
+        BenchHandler.body = ("[" + ",".join(items) + "]").encode()
+        BenchHandler.encoded = {"gzip": gzip.compress(BenchHandler.body), "deflate": zlib.compress(BenchHandler.body)}
+    if args.etag:
+        BenchHandler.etag = '"%x"' % args.size
+        BenchHandler.last_modified = email.utils.formatdate(usegmt=True)
+    BenchHandler.max_age = args.max_age
+    BenchHandler.cut = args.cut
+    socketserver.ThreadingTCPServer.allow_reuse_address = True
+    server = socketserver.ThreadingTCPServer(("127.0.0.1", args.port), BenchHandler)
+    server.daemon_threads = True
+    if args.tls:
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(args.tls)
+        server.socket = context.wrap_socket(server.socket, server_side=True)
+    print("listen on 127.0.0.1:%d, %d bytes body" % (args.port, len(BenchHandler.body)), flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    print("%d requests over %d connections, %d not modified, %d partial" % (requests, connections, not_modified, partial))
+    print("%d bytes on the wire for %d body bytes" % (wire_bytes, body_bytes))
+    if args.tls:
+        print("%d of %d tls sessions resumed" % (resumed, connections))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())